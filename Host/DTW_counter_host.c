@@ -0,0 +1,46 @@
+/******************************************************************************
+* File Name          : DTW_counter_host.c
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Host replacement for the DTW_CYCCNT counter
+*******************************************************************************/
+/*
+'DTW_counter.h' maps DTWTIME to 'DTW_counter_host()' when HOSTBUILD is defined.
+Like DTW_CYCCNT it is a free-running 32b count that wraps, so the usual
+"end - start" unsigned differences work unchanged.
+
+x86: the time stamp counter (invariant TSC on anything recent).
+Otherwise: CLOCK_MONOTONIC scaled to the F407's 168 MHz so that durations
+read in the same units as on the board.
+*/
+#include <stdint.h>
+#include <time.h>
+#include "DTW_counter.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/******************************************************************************
+ * void DTW_counter_init(void);
+ * @brief 	: Nothing to set up on the host
+*******************************************************************************/
+void DTW_counter_init(void)
+{
+	return;
+}
+/******************************************************************************
+ * unsigned int DTW_counter_host(void);
+ * @brief 	: Read host cycle counter
+ * @return	: low 32 bits of the count
+*******************************************************************************/
+unsigned int DTW_counter_host(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return (unsigned int)__rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned int)((uint64_t)ts.tv_sec * 168000000ULL + ((uint64_t)ts.tv_nsec * 168) / 1000);
+#endif
+}
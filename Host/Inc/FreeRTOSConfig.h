@@ -0,0 +1,68 @@
+/******************************************************************************
+* File Name          : FreeRTOSConfig.h (Host)
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : FreeRTOS configuration for the host build
+*******************************************************************************/
+/*
+Mirrors 'Inc/FreeRTOSConfig.h' where it matters to Ourwares/Ourtasks (tick
+rate, priorities, API inclusion) so task timing and notification behavior
+match the DiscoveryF4.  The Cortex-M interrupt priority items are dropped;
+the POSIX port has no NVIC.
+
+'Host/Inc' is searched ahead of 'Inc' so this file shadows the target one.
+*/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+#include <assert.h>
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      0
+#define configUSE_TICK_HOOK                      0
+#define configCPU_CLOCK_HZ                       ( 168000000UL ) // What the F407 runs at
+#define configTICK_RATE_HZ                       ((TickType_t)512)
+#define configMAX_PRIORITIES                     ( 7 )
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)4096) // pthread needs room
+#define configTOTAL_HEAP_SIZE                    ((size_t)(1024*1024))
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                12
+#define configCHECK_FOR_STACK_OVERFLOW           0
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          ( 2 )
+
+/* Software timer definitions. */
+#define configUSE_TIMERS                         1
+#define configTIMER_TASK_PRIORITY                ( 2 )
+#define configTIMER_QUEUE_LENGTH                 10
+#define configTIMER_TASK_STACK_DEPTH             configMINIMAL_STACK_SIZE
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet            1
+#define INCLUDE_uxTaskPriorityGet           1
+#define INCLUDE_vTaskDelete                 1
+#define INCLUDE_vTaskCleanUpResources       0
+#define INCLUDE_vTaskSuspend                1
+#define INCLUDE_vTaskDelayUntil             1
+#define INCLUDE_vTaskDelay                  1
+#define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+#define INCLUDE_xTaskGetCurrentTaskHandle   1
+
+/* Host tasks: priority used by the stimulus task that plays "interrupt". */
+#define configHOST_ISR_PRIORITY             ( configMAX_PRIORITIES - 1 )
+
+/* On the host an assert is something to stop and look at. */
+#define configASSERT( x ) assert( x )
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,29 @@
+/******************************************************************************
+* File Name          : cmsis_gcc.h (Host)
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Stand-in for the CMSIS core intrinsics 'cmsis_os.c' uses
+*******************************************************************************/
+/*
+'cmsis_os.c' includes "cmsis_gcc.h" by name to get __get_IPSR(), which is an
+ARM 'mrs' instruction.  'Host/Inc' is ahead of 'Drivers/CMSIS/Include' in the
+host include path so this file is found instead.  The CMSIS headers pulled in
+through 'stm32f4xx_hal.h' still get the real one (same-directory include).
+
+IPSR is non-zero while 'hal_stubs.c' is delivering a simulated interrupt, so
+the osXXX calls take their "FromISR" paths just as they would on the F4.
+*/
+
+#ifndef __HOST_CMSIS_GCC_H
+#define __HOST_CMSIS_GCC_H
+
+#include <stdint.h>
+
+extern volatile uint32_t halstub_ipsr; // Non-zero = inside a stub "ISR"
+
+static inline uint32_t __get_IPSR(void)
+{
+	return halstub_ipsr;
+}
+
+#endif
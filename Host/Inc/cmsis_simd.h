@@ -0,0 +1,46 @@
+/******************************************************************************
+* File Name          : cmsis_simd.h (Host)
+* Date First Issued  : 10/18/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : C stand-ins for the Cortex-M4 DSP packed intrinsics
+*******************************************************************************/
+/*
+The real 'cmsis_gcc.h' (through 'stm32f4xx_hal.h') declares __UADD16 etc. as
+inline 'asm', which the host compiler can't assemble.  Include this after
+'stm32f4xx_hal.h' and the names become the C versions below, so the packed
+code compiles on the host and can be checked and timed against the C loop.
+
+The GE flags are per halfword: bit 0 for the low halfword, bit 1 for the high.
+__USUB16 sets them (no borrow, i.e. op1 >= op2) and __SEL reads them, just as
+the instructions do, so an __USUB16/__SEL pair must stay in one file.
+*/
+
+#ifndef __HOST_CMSIS_SIMD_H
+#define __HOST_CMSIS_SIMD_H
+
+#include <stdint.h>
+
+static uint32_t host_ge; // APSR.GE stand-in: bit 0 low halfword, bit 1 high
+
+static inline uint32_t host_uadd16(uint32_t op1, uint32_t op2)
+{ // Two 16b adds, carries discarded
+	return ((op1 + op2) & 0xffff) | ((((op1 >> 16) + (op2 >> 16)) & 0xffff) << 16);
+}
+static inline uint32_t host_usub16(uint32_t op1, uint32_t op2)
+{ // Two 16b subtracts; GE = no borrow
+	uint32_t lo = op1 & 0xffff;
+	uint32_t hi = op1 >> 16;
+	host_ge = ((lo >= (op2 & 0xffff)) << 0) | ((hi >= (op2 >> 16)) << 1);
+	return ((lo - (op2 & 0xffff)) & 0xffff) | (((hi - (op2 >> 16)) & 0xffff) << 16);
+}
+static inline uint32_t host_sel(uint32_t op1, uint32_t op2)
+{ // Halfword from op1 where GE is set, else op2
+	uint32_t m = ((host_ge & 1) ? 0x0000ffff : 0) | ((host_ge & 2) ? 0xffff0000 : 0);
+	return (op1 & m) | (op2 & ~m);
+}
+
+#define __UADD16 host_uadd16
+#define __USUB16 host_usub16
+#define __SEL    host_sel
+
+#endif
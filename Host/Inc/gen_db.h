@@ -0,0 +1,40 @@
+/******************************************************************************
+* File Name          : gen_db.h (Host)
+* Date First Issued  : 10/18/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Payload type codes for the host build
+*******************************************************************************/
+/*
+The board build takes 'gen_db.h' from the GliderWinchCommons database tree
+(generated from 'PAYLOAD_TYPE_INSERT.sql'), which is not part of this repo.
+The host build needs only the payload type codes 'payload_extract.c' switches
+on, so this file supplies them and 'make host' builds from a clean checkout.
+
+The numbers are the host's own: distinct, but not the database's.  Nothing on
+the host stores or sends them.
+*/
+
+#ifndef __GEN_DB_HOST
+#define __GEN_DB_HOST
+
+#define UNDEF         0
+#define FF            1
+#define U32           2
+#define S32           3
+#define xFF           4
+#define xxFF          5
+#define xxU32         6
+#define xxS32         7
+#define FF_FF         8
+#define U32_U32       9
+#define S32_S32       10
+#define U8_FF         11
+#define U8_U32        12
+#define U8_S32        13
+#define U8_U8_FF      14
+#define U8_U8_U32     15
+#define U8_U8_S32     16
+#define U8_U8_U8_U32  17
+#define UNIXTIME      18
+
+#endif
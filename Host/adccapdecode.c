@@ -0,0 +1,164 @@
+/******************************************************************************
+* File Name          : adccapdecode.c
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation
+* Description        : Decode raw ADC capture streams ('adccapture.c') to text
+*******************************************************************************/
+/*
+Build: make adccapdecode
+Run:   ./build_host/adccapdecode [file]   (stdin when no file)
+ e.g.  cat /dev/ttyACM0 > cap.bin, then ./build_host/adccapdecode cap.bin > cap.txt
+
+The input may have other bytes (e.g. text) around the captures; each capture
+is found by its header magic, the trailer sum is checked, and it is printed as
+'#' comment lines followed by one line per scan--
+  block scan t_us ch0 ch1 ... (raw ADC readings)
+'t_us' is relative to the trigger scan.  The scan period comes from the
+average block-to-block DTW time; a block that came late (a 1/2 DMA buffer
+the ADCTask did not get to in time) is flagged with a comment.
+
+The fields are pulled out byte by byte (little endian) at the offsets of
+'struct ADCCAPHDR' etc. in 'Ourtasks/adccapture.h', so the host's packing
+and byte order do not matter.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ADCCAPMAGIC    0x43434441 // Same as adccapture.h
+#define ADCCAPMAGICEND 0x44434441
+#define ADCCAPVERSION  1
+#define HDRSIZE  32 // sizeof(struct ADCCAPHDR)
+#define TRLSIZE   8 // sizeof(struct ADCCAPTRL)
+
+static uint32_t get16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t get32(const uint8_t* p) { return get16(p) | (get16(p + 2) << 16); }
+
+static int decode(const uint8_t* p, size_t n, size_t* pused);
+
+/* *************************************************************************
+ * int main(int argc, char** argv);
+ * @brief	: Read the whole input, decode each capture found
+ * @return	: 0 = at least one good capture; 1 = none
+ * *************************************************************************/
+int main(int argc, char** argv)
+{
+	FILE* fp = stdin;
+	uint8_t* pbuf = NULL;
+	size_t size = 0;
+	size_t max = 0;
+	size_t n;
+	size_t i = 0;
+	size_t used;
+	int good = 0;
+
+	if (argc > 1)
+	{
+		fp = fopen(argv[1], "rb");
+		if (fp == NULL) { perror(argv[1]); return 1; }
+	}
+	do
+	{
+		if (size == max)
+		{
+			max = (max == 0) ? 65536 : max * 2;
+			pbuf = realloc(pbuf, max);
+			if (pbuf == NULL) { fprintf(stderr, "out of memory\n"); return 1; }
+		}
+		n = fread(pbuf + size, 1, max - size, fp);
+		size += n;
+	} while (n != 0);
+
+	while ((i + HDRSIZE + TRLSIZE) <= size)
+	{
+		if (get32(pbuf + i) != ADCCAPMAGIC) { i += 1; continue; }
+		if (decode(pbuf + i, size - i, &used) == 0)
+		{
+			good += 1;
+			i += used;
+		}
+		else
+			i += 1; // Not a capture after all; keep looking
+	}
+	if (good == 0) fprintf(stderr, "no good captures found\n");
+	return (good == 0);
+}
+/* *************************************************************************
+ * static int decode(const uint8_t* p, size_t n, size_t* pused);
+ * @brief	: Check and print one capture
+ * @param	: p = pointer to header magic
+ * @param	: n = bytes available from 'p'
+ * @param	: pused = bytes in this capture (when OK)
+ * @return	: 0 = OK; -1 = bad or incomplete
+ * *************************************************************************/
+static int decode(const uint8_t* p, size_t n, size_t* pused)
+{
+	uint32_t nchan    = p[5];
+	uint32_t nscan    = p[6];
+	uint32_t trigsrc  = p[7];
+	uint32_t nblk     = get16(p + 8);
+	uint32_t trigblk  = get16(p + 10);
+	uint32_t trigscan = get16(p + 12);
+	uint32_t dtwhz    = get32(p + 24);
+	uint32_t blksize  = 4 + 2 * nchan * nscan; // sizeof(struct ADCCAPBLK)
+	size_t total = HDRSIZE + (size_t)nblk * blksize + TRLSIZE;
+	const uint8_t* pb;
+	double scanus;
+	double t;
+	uint32_t sum = 0;
+	uint32_t dt;
+	size_t i;
+	uint32_t b;
+	uint32_t s;
+	uint32_t c;
+
+	if ((p[4] != ADCCAPVERSION) || (nchan == 0) || (nscan == 0) || (nblk == 0) || (dtwhz == 0))
+		return -1;
+	if (total > n)
+	{
+		fprintf(stderr, "capture truncated: %zu of %zu bytes\n", n, total);
+		return -1;
+	}
+	if (get32(p + total - 4) != ADCCAPMAGICEND) return -1;
+	for (i = 0; i < (total - TRLSIZE); i += 2) sum += get16(p + i);
+	if (sum != get32(p + total - 8))
+	{
+		fprintf(stderr, "capture %u: bad sum %08x vs %08x\n", get32(p + 20), sum, get32(p + total - 8));
+		return -1;
+	}
+
+	/* Scan period from the average block interval */
+	pb = p + HDRSIZE;
+	scanus = 0;
+	if (nblk > 1)
+		scanus = (double)(uint32_t)(get32(pb + (nblk - 1) * blksize) - get32(pb)) / (nblk - 1) / nscan * 1e6 / dtwhz;
+
+	printf("# capture %u: %u blocks x %u scans x %u channels, scan period %.3f us\n",
+		get32(p + 20), nblk, nscan, nchan, scanus);
+	printf("# trigger: src 0x%x block %u scan %u; level chan %u edge %u level %u; npost %u\n",
+		trigsrc, trigblk, trigscan, p[14], p[15], get16(p + 16), get16(p + 18));
+	printf("# block scan t_us");
+	for (c = 0; c < nchan; c++) printf(" ch%u", c);
+	printf("\n");
+
+	for (b = 0; b < nblk; b++, pb += blksize)
+	{
+		if (b > 0)
+		{
+			dt = get32(pb) - get32(pb - blksize);
+			if ((scanus > 0) && ((double)dt * 1e6 / dtwhz > 1.5 * scanus * nscan))
+				printf("# block %u: late by %.1f us\n", b, (double)dt * 1e6 / dtwhz - scanus * nscan);
+		}
+		for (s = 0; s < nscan; s++)
+		{
+			t = ((double)((int32_t)b - (int32_t)trigblk) * nscan + ((int32_t)s - (int32_t)trigscan)) * scanus;
+			printf("%u %u %.1f", b, s, t);
+			for (c = 0; c < nchan; c++)
+				printf(" %u", get16(pb + 4 + 2 * (s * nchan + c)));
+			printf("\n");
+		}
+	}
+	*pused = total;
+	return 0;
+}
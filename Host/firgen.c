@@ -0,0 +1,217 @@
+/******************************************************************************
+* File Name          : firgen.c
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation
+* Description        : FIR coefficient tables for fir_poly.c, made at build time
+*******************************************************************************/
+/*
+Build & run: make firtables (the firmware build runs it when this file is
+newer than Ourtasks/fir_coef.c/.h)
+             ./build_host/firgen Ourtasks/fir_coef
+
+Windowed sinc low pass for each spec below, normalized to a dc gain of 1,
+written out in polyphase order (see fir_poly.h) as 'fir_coef.c' plus the
+FIRSPEC_ codes in 'fir_coef.h'.
+
+The response is checked here: each table's comment has the gain at fc
+and the worst gain in the stop band (f >= fstop).  For a decimating spec
+fstop is where the band that folds back onto the pass band starts
+(1/m - pass band edge).  A spec whose worst stop band gain is above its
+'maxdb' fails the build (the .c/.h are removed).
+
+fc, f: ratio of the filter's input rate, e.g. 0.1 = one tenth of it.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define WIN_HAMMING  0
+#define WIN_BLACKMAN 1
+
+struct FIRGENSPEC
+{
+	const char* name;
+	int ntap;
+	int m;        // Decimation
+	double fc;    // Cutoff: sinc edge (about -6 dB for long filters)
+	int win;      // WIN_
+	double fstop; // Stop band start
+	double maxdb; // Worst allowed gain in the stop band (dB)
+	const char* note;
+};
+
+static const struct FIRGENSPEC spec[] =
+{
+/*	 name     ntap  m  fc     window        fstop  maxdb */
+	{"CURAA4",   32, 4, 0.080, WIN_BLACKMAN, 0.210, -60.0, "Motor current: anti-alias, then 1/4 rate"},
+	{"TORQUE15", 15, 1, 0.050, WIN_HAMMING,  0.200, -40.0, "Torque lever: linear phase smoothing"},
+	{"MBX2",     16, 2, 0.200, WIN_HAMMING,  0.400, -40.0, "Mailbox readings: smooth, then 1/2 rate"},
+};
+#define NSPEC (int)(sizeof(spec) / sizeof(spec[0]))
+
+#define MAXTAP 255
+
+/* |H(f)| */
+static double gain(const double* h, int n, double f)
+{
+	double re = 0;
+	double im = 0;
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		re += h[i] * cos(2 * M_PI * f * i);
+		im -= h[i] * sin(2 * M_PI * f * i);
+	}
+	return sqrt(re * re + im * im);
+}
+
+static void design(const struct FIRGENSPEC* ps, double* h)
+{
+	double c = (ps->ntap - 1) / 2.0;
+	double t;
+	double w;
+	double sum = 0;
+	int i;
+
+	for (i = 0; i < ps->ntap; i++)
+	{
+		t = i - c;
+		h[i] = (t == 0) ? 2 * ps->fc : sin(2 * M_PI * ps->fc * t) / (M_PI * t);
+		t = 2 * M_PI * i / (ps->ntap - 1);
+		if (ps->win == WIN_BLACKMAN)
+			w = 0.42 - 0.5 * cos(t) + 0.08 * cos(2 * t);
+		else
+			w = 0.54 - 0.46 * cos(t);
+		h[i] *= w;
+		sum += h[i];
+	}
+	for (i = 0; i < ps->ntap; i++)
+		h[i] /= sum;
+	return;
+}
+
+static void banner(FILE* fp, const char* name, const char* desc)
+{
+	fprintf(fp, "/******************************************************************************\n");
+	fprintf(fp, "* File Name          : %s\n", name);
+	fprintf(fp, "* Date First Issued  : 10/17/2026\n");
+	fprintf(fp, "* Board              : DiscoveryF4\n");
+	fprintf(fp, "* Description        : %s\n", desc);
+	fprintf(fp, "*******************************************************************************/\n");
+	fprintf(fp, "/* Generated by Host/firgen.c: edit the specs there, then 'make firtables'. */\n");
+	return;
+}
+
+int main(int argc, char** argv)
+{
+	double h[MAXTAP];
+	double f;
+	double g;
+	double gfc;
+	double gstop;
+	char fname[256];
+	const char* base;
+	const char* pbase;
+	FILE* fph;
+	FILE* fpc;
+	int fail = 0;
+	int s;
+	int l;
+	int p;
+	int j;
+	int i;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: firgen <output path without .c/.h>\n");
+		return 1;
+	}
+	base  = argv[1];
+	pbase = strrchr(base, '/');
+	pbase = (pbase == NULL) ? base : pbase + 1;
+
+	snprintf(fname, sizeof(fname), "%s.h", base);
+	fph = fopen(fname, "w");
+	snprintf(fname, sizeof(fname), "%s.c", base);
+	fpc = fopen(fname, "w");
+	if ((fph == NULL) || (fpc == NULL)) {perror(fname); return 1;}
+
+	snprintf(fname, sizeof(fname), "%s.h", pbase);
+	banner(fph, fname, "FIR coefficient tables (fir_poly.h)");
+	fprintf(fph, "\n#ifndef __FIR_COEF\n#define __FIR_COEF\n\n#include \"fir_poly.h\"\n\n");
+	fprintf(fph, "/* Codes for 'fpw.fir.spec' and index into firspec[] */\n");
+
+	snprintf(fname, sizeof(fname), "%s.c", pbase);
+	banner(fpc, fname, "FIR coefficient tables (fir_poly.h)");
+	fprintf(fpc, "\n#include \"%s.h\"\n", pbase);
+
+	for (s = 0; s < NSPEC; s++)
+	{
+		const struct FIRGENSPEC* ps = &spec[s];
+
+		if ((ps->ntap < 2) || (ps->ntap > MAXTAP) || (ps->m < 1) || (ps->m > 255))
+		{
+			fprintf(stderr, "firgen: %s: bad ntap or m\n", ps->name);
+			return 1;
+		}
+		design(ps, h);
+		l = (ps->ntap + ps->m - 1) / ps->m;
+
+		/* Response check */
+		gfc = gain(h, ps->ntap, ps->fc);
+		gstop = 0;
+		for (f = ps->fstop; f <= 0.5; f += 0.0005)
+		{
+			g = gain(h, ps->ntap, f);
+			if (g > gstop) gstop = g;
+		}
+		if (20 * log10(gstop) > ps->maxdb)
+		{
+			fprintf(stderr, "firgen: %s: stop band gain %.1f dB above %.1f dB\n",
+				ps->name, 20 * log10(gstop), ps->maxdb);
+			fail = 1;
+		}
+
+		fprintf(fph, "#define FIRSPEC_%-10s %d // %s\n", ps->name, s, ps->note);
+
+		fprintf(fpc, "\n/* %s: %s\n", ps->name, ps->note);
+		fprintf(fpc, "   %d taps, %s window, 1/%d, fc %.4f: %.2f dB at fc; stop band (f >= %.4f) %.1f dB max\n",
+			ps->ntap, (ps->win == WIN_BLACKMAN) ? "Blackman" : "Hamming", ps->m, ps->fc,
+			20 * log10(gfc), ps->fstop, 20 * log10(gstop));
+		fprintf(fpc, "   Phase order: %d phases of %d taps. */\n", ps->m, l);
+		fprintf(fpc, "static const float h_%s[%d] =\n{", ps->name, ps->m * l);
+		for (p = 0; p < ps->m; p++)
+		{
+			fprintf(fpc, "\n\t");
+			for (j = 0; j < l; j++)
+			{
+				i = p + j * ps->m;
+				fprintf(fpc, "%.9ef,%s", (i < ps->ntap) ? h[i] : 0.0, (j < l - 1) ? " " : "");
+			}
+		}
+		fprintf(fpc, "\n};\n");
+	}
+
+	fprintf(fph, "#define FIRSPECNUM %d\n\n", NSPEC);
+	fprintf(fph, "extern const struct FIRPOLYSPEC firspec[FIRSPECNUM];\n\n#endif\n");
+
+	fprintf(fpc, "\nconst struct FIRPOLYSPEC firspec[FIRSPECNUM] =\n{\n");
+	for (s = 0; s < NSPEC; s++)
+	{
+		l = (spec[s].ntap + spec[s].m - 1) / spec[s].m;
+		fprintf(fpc, "\t{h_%s, %d, %d, %d},\n", spec[s].name, spec[s].ntap, spec[s].m, l);
+	}
+	fprintf(fpc, "};\n");
+
+	fclose(fph);
+	fclose(fpc);
+	if (fail != 0)
+	{ // No tables: so that make does not take them as up to date
+		snprintf(fname, sizeof(fname), "%s.h", base);
+		remove(fname);
+		snprintf(fname, sizeof(fname), "%s.c", base);
+		remove(fname);
+	}
+	return fail;
+}
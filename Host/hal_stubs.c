@@ -0,0 +1,775 @@
+/******************************************************************************
+* File Name          : hal_stubs.c
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : HAL_CAN/HAL_UART/HAL_ADC stand-ins: inject & capture traffic
+*******************************************************************************/
+/*
+See 'hal_stubs.h' for the scheme.  Only the HAL routines the Ourwares/Ourtasks
+code calls are here.  Each handle gets a small slot (looked up by the handle
+address) holding what the real peripheral would have held.
+
+The CAN mailboxes are modeled: 'HAL_CAN_AddTxMessage' takes the lowest empty
+mailbox and writes the TIR/TDTR/TDLR/TDHR of the handle's 'Instance' (host RAM
+in place of the bxCAN registers), so code reading the registers directly still
+sees sensible values.  A mailbox "sends" (is captured, and its complete callback
+issued) only when 'halstub_can_isr' is called.  'halstub_can_bus' instead steps
+the bus a msg time at a time with the TX interrupt running late, as the real
+one does: the hardware empties a mailbox when its msg is sent, before the
+callback has run.
+
+The status registers are kept up to date as well (TSR TMEx and CODE; RFxR FMP
+and the FIFO output mailboxes), so the can_iface.c direct register path
+(CHEATINGONHAL) runs against the same model.  Its register writes that start
+something in the hardware (TXRQ, ABRQ, RFOM) come here as the 'halstub_can_txrq',
+'_abrq' and '_rfom' calls.
+
+The callbacks are declared weak here, the way the HAL does, so the ones the
+firmware does not supply are no-ops.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal_stubs.h"
+#include "usbd_cdc_if.h"
+#include "morse.h"
+
+struct HALSTUBCOUNTS halstubct;
+
+volatile uint32_t halstub_ipsr; // Non-zero = inside a stub "ISR" (see 'Host/Inc/cmsis_gcc.h')
+
+/* Factory calibration, VREFINT & TS_CAL1/TS_CAL2, typical F407 values */
+uint16_t halstub_factorycal[3] = {1501, 955, 1203};
+
+#define HALSTUBNUMCAN   2	// CAN1, CAN2
+#define HALSTUBNUMUART  6	// usart1 - usart6
+#define HALSTUBNUMADC   3	// ADC1 - ADC3
+
+#define NUMTXMBX 3	// bxCAN has three TX mailboxes
+
+struct HALSTUBCAN
+{
+	CAN_HandleTypeDef* phcan;
+	struct CANRCVBUF txring[HALSTUBCANTXRING]; // Captured TX msgs
+	uint32_t txin;
+	uint32_t txout;
+	struct CANRCVBUF rxfifo[2][HALSTUBCANRXFIFO]; // Hardware RX FIFOs
+	uint8_t rxin[2];
+	uint8_t rxn[2];
+	uint8_t txpend;   // Bit per mailbox: loaded, not sent
+	uint8_t txabort;  // Bit per mailbox: abort requested
+	uint8_t txdone;   // Bit per mailbox: sent, complete callback not run yet (halstub_can_bus)
+	uint8_t txdue[NUMTXMBX]; // Slots until that callback runs
+	uint8_t rxovr;    // Bit per RX FIFO: overrun (FOVR), error callback not run yet
+};
+
+struct HALSTUBUART
+{
+	UART_HandleTypeDef* phuart;
+	uint8_t  txring[HALSTUBUARTRING]; // Captured TX bytes
+	uint32_t txin;
+	uint32_t txout;
+	uint8_t* ptx;     // Transfer in progress (NULL = idle)
+	uint16_t ntx;
+	uint8_t* prxbuf;  // Receive buffer (dma or char)
+	uint16_t rxsize;
+	uint16_t rxidx;
+	uint8_t  rxdma;   // 1 = circular dma; 0 = _IT
+	DMA_HandleTypeDef  hdmarx; // Stand-in so __HAL_DMA_GET_COUNTER works
+	DMA_Stream_TypeDef dmastream;
+};
+
+struct HALSTUBADC
+{
+	ADC_HandleTypeDef* phadc;
+	uint16_t* pdma;
+	uint32_t length;
+};
+
+static struct HALSTUBCAN  canstub[HALSTUBNUMCAN];
+static struct HALSTUBUART uartstub[HALSTUBNUMUART];
+static struct HALSTUBADC  adcstub[HALSTUBNUMADC];
+
+static uint8_t  cdcring[HALSTUBCDCRING];
+static uint32_t cdcin;
+static uint32_t cdcout;
+
+/* Weak callbacks: the firmware supplies the ones it uses. */
+__attribute__((weak)) void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan){}
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){}
+__attribute__((weak)) void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){}
+__attribute__((weak)) void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart){}
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){}
+__attribute__((weak)) void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc){}
+__attribute__((weak)) void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc){}
+
+/* *************************************************************************
+ * static struct HALSTUBxxx* xxxslot(xxx_HandleTypeDef* ph);
+ * @brief	: Find (or assign) the stub slot for a handle
+ * @return	: pointer to slot; morse_trap if all slots are taken
+ * *************************************************************************/
+static struct HALSTUBCAN* canslot(CAN_HandleTypeDef* phcan)
+{
+	int i;
+	for (i = 0; i < HALSTUBNUMCAN; i++)
+	{
+		if (canstub[i].phcan == phcan) return &canstub[i];
+		if (canstub[i].phcan == NULL)
+		{
+			canstub[i].phcan = phcan;
+			return &canstub[i];
+		}
+	}
+	morse_trap(900);
+	return NULL;
+}
+static struct HALSTUBCAN* caninstslot(CAN_TypeDef* pinst)
+{
+	int i;
+	for (i = 0; i < HALSTUBNUMCAN; i++)
+		if ((canstub[i].phcan != NULL) && (canstub[i].phcan->Instance == pinst)) return &canstub[i];
+	morse_trap(903);
+	return NULL;
+}
+static struct HALSTUBUART* uartslot(UART_HandleTypeDef* phuart)
+{
+	int i;
+	for (i = 0; i < HALSTUBNUMUART; i++)
+	{
+		if (uartstub[i].phuart == phuart) return &uartstub[i];
+		if (uartstub[i].phuart == NULL)
+		{
+			uartstub[i].phuart = phuart;
+			uartstub[i].hdmarx.Instance = &uartstub[i].dmastream;
+			return &uartstub[i];
+		}
+	}
+	morse_trap(901);
+	return NULL;
+}
+static struct HALSTUBADC* adcslot(ADC_HandleTypeDef* phadc)
+{
+	int i;
+	for (i = 0; i < HALSTUBNUMADC; i++)
+	{
+		if (adcstub[i].phadc == phadc) return &adcstub[i];
+		if (adcstub[i].phadc == NULL)
+		{
+			adcstub[i].phadc = phadc;
+			return &adcstub[i];
+		}
+	}
+	morse_trap(902);
+	return NULL;
+}
+/* ======================================================================== */
+/* CAN                                                                      */
+/* ======================================================================== */
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef *hcan, CAN_FilterTypeDef *sFilterConfig)
+{
+	canslot(hcan);
+	return HAL_OK;
+}
+/* *************************************************************************
+ * static void canregsync(struct HALSTUBCAN* ps);
+ * @brief	: Show the model in the bxCAN status registers, as the hardware would
+ * *************************************************************************/
+static void canregsync(struct HALSTUBCAN* ps)
+{
+	CAN_TypeDef* pinst = ps->phcan->Instance;
+	struct CANRCVBUF* pcan;
+	uint32_t tsr;
+	int i;
+
+	if (pinst == NULL) return;
+
+	/* TX: empty mailboxes, and CODE = the lowest empty one */
+	tsr = pinst->TSR & ~(CAN_TSR_TME | CAN_TSR_CODE);
+	for (i = NUMTXMBX - 1; i >= 0; i--)
+	{
+		if ((ps->txpend & (1 << i)) == 0)
+			tsr = (tsr & ~CAN_TSR_CODE) | (CAN_TSR_TME0 << i) | ((uint32_t)i << CAN_TSR_CODE_Pos);
+	}
+	pinst->TSR = tsr;
+
+	/* RX: msgs pending, and the oldest in the FIFO output mailbox */
+	pinst->RF0R = (pinst->RF0R & ~CAN_RF0R_FMP0) | ps->rxn[0];
+	pinst->RF1R = (pinst->RF1R & ~CAN_RF1R_FMP1) | ps->rxn[1];
+	for (i = 0; i < 2; i++)
+	{
+		if (ps->rxn[i] == 0) continue;
+		pcan = &ps->rxfifo[i][(ps->rxin[i] + HALSTUBCANRXFIFO - ps->rxn[i]) % HALSTUBCANRXFIFO];
+		pinst->sFIFOMailBox[i].RIR  = pcan->id;
+		pinst->sFIFOMailBox[i].RDTR = pcan->dlc;
+		pinst->sFIFOMailBox[i].RDLR = pcan->cd.ui[0];
+		pinst->sFIFOMailBox[i].RDHR = pcan->cd.ui[1];
+	}
+	return;
+}
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef *hcan)
+{
+	canregsync(canslot(hcan));
+	hcan->State = HAL_CAN_STATE_LISTENING;
+	return HAL_OK;
+}
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef *hcan, uint32_t ActiveITs)
+{
+	return HAL_OK;
+}
+HAL_StatusTypeDef HAL_CAN_DeactivateNotification(CAN_HandleTypeDef *hcan, uint32_t InactiveITs)
+{
+	return HAL_OK;
+}
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef *hcan)
+{
+	struct HALSTUBCAN* ps = canslot(hcan);
+	uint32_t n = 0;
+	int i;
+	for (i = 0; i < NUMTXMBX; i++)
+		if ((ps->txpend & (1 << i)) == 0) n += 1;
+	return n;
+}
+uint32_t HAL_CAN_IsTxMessagePending(CAN_HandleTypeDef *hcan, uint32_t TxMailboxes)
+{
+	struct HALSTUBCAN* ps = canslot(hcan);
+	return ((ps->txpend & TxMailboxes) != 0);
+}
+/* *************************************************************************
+ * HAL_StatusTypeDef HAL_CAN_AddTxMessage(...);
+ * @brief	: Load the lowest empty mailbox (HAL header -> hardware register format)
+ * *************************************************************************/
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef *hcan, CAN_TxHeaderTypeDef *pHeader, uint8_t aData[], uint32_t *pTxMailbox)
+{
+	struct HALSTUBCAN* ps = canslot(hcan);
+	uint32_t tir;
+	uint32_t ui[2];
+	int i;
+
+	for (i = 0; i < NUMTXMBX; i++)
+		if ((ps->txpend & (1 << i)) == 0) break;
+	if (i >= NUMTXMBX)
+	{
+		hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+		return HAL_ERROR;
+	}
+	if (pHeader->IDE == CAN_ID_STD)
+		tir = (pHeader->StdId << 21) | pHeader->RTR;
+	else
+		tir = (pHeader->ExtId << 3) | pHeader->IDE | pHeader->RTR;
+
+	memcpy(ui, aData, 8);
+	if (hcan->Instance != NULL)
+	{ // Registers as the bxCAN would show them (TXRQ set)
+		hcan->Instance->sTxMailBox[i].TDTR = pHeader->DLC;
+		hcan->Instance->sTxMailBox[i].TDLR = ui[0];
+		hcan->Instance->sTxMailBox[i].TDHR = ui[1];
+		hcan->Instance->sTxMailBox[i].TIR  = tir | CAN_TI0R_TXRQ;
+	}
+	ps->txpend |= (1 << i);
+	canregsync(ps);
+	*pTxMailbox = (CAN_TX_MAILBOX0 << i);
+	return HAL_OK;
+}
+HAL_StatusTypeDef HAL_CAN_AbortTxRequest(CAN_HandleTypeDef *hcan, uint32_t TxMailboxes)
+{
+	struct HALSTUBCAN* ps = canslot(hcan);
+	ps->txabort |= (TxMailboxes & ps->txpend);
+	return HAL_OK;
+}
+/* *************************************************************************
+ * HAL_StatusTypeDef HAL_CAN_GetRxMessage(...);
+ * @brief	: Take a msg from the simulated hardware FIFO
+ * *************************************************************************/
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef *hcan, uint32_t RxFifo, CAN_RxHeaderTypeDef *pHeader, uint8_t aData[])
+{
+	struct HALSTUBCAN* ps = canslot(hcan);
+	struct CANRCVBUF* pcan;
+	uint8_t f = (RxFifo == CAN_RX_FIFO0) ? 0 : 1;
+	uint8_t idx;
+
+	if (ps->rxn[f] == 0)
+	{
+		hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+		return HAL_ERROR;
+	}
+	idx = (ps->rxin[f] + HALSTUBCANRXFIFO - ps->rxn[f]) % HALSTUBCANRXFIFO;
+	pcan = &ps->rxfifo[f][idx];
+	ps->rxn[f] -= 1;
+	canregsync(ps);
+
+	pHeader->IDE = pcan->id & CAN_ID_EXT;
+	pHeader->RTR = pcan->id & CAN_RTR_REMOTE;
+	if (pHeader->IDE == CAN_ID_STD)
+		pHeader->StdId = pcan->id >> 21;
+	else
+		pHeader->ExtId = pcan->id >> 3;
+	pHeader->DLC = pcan->dlc & 0xf;
+	pHeader->Timestamp = 0;
+	pHeader->FilterMatchIndex = 0;
+	memcpy(aData, &pcan->cd.uc[0], 8);
+	halstubct.canrx += 1;
+	return HAL_OK;
+}
+/* *************************************************************************
+ * int halstub_can_inject(CAN_HandleTypeDef* phcan, uint32_t RxFifo, struct CANRCVBUF* pcan);
+ * @brief	: Put a CAN msg in the simulated hardware RX FIFO
+ * *************************************************************************/
+int halstub_can_inject(CAN_HandleTypeDef* phcan, uint32_t RxFifo, struct CANRCVBUF* pcan)
+{
+	struct HALSTUBCAN* ps = canslot(phcan);
+	uint8_t f = (RxFifo == CAN_RX_FIFO0) ? 0 : 1;
+
+	if (ps->rxn[f] >= HALSTUBCANRXFIFO)
+	{ // bxCAN FIFO overrun (FOVR): newest msg is lost
+		halstubct.canrxovr += 1;
+		ps->rxovr |= (1 << f);
+		return -1;
+	}
+	ps->rxfifo[f][ps->rxin[f]] = *pcan;
+	ps->rxin[f] = (ps->rxin[f] + 1) % HALSTUBCANRXFIFO;
+	ps->rxn[f] += 1;
+	canregsync(ps);
+	return 0;
+}
+/* *************************************************************************
+ * void halstub_can_txrq(CAN_TypeDef* pinst, int i, uint32_t tir);
+ * @brief	: Direct register TX request: TIR = tir | TXRQ (TDTR, TDLR, TDHR already written)
+ * *************************************************************************/
+void halstub_can_txrq(CAN_TypeDef* pinst, int i, uint32_t tir)
+{
+	struct HALSTUBCAN* ps = caninstslot(pinst);
+	if ((ps->txpend & (1 << i)) != 0) morse_trap(904); // Mailbox not empty
+	pinst->sTxMailBox[i].TIR = tir | CAN_TI0R_TXRQ;
+	ps->txpend |= (1 << i);
+	canregsync(ps);
+	return;
+}
+/* *************************************************************************
+ * void halstub_can_abrq(CAN_TypeDef* pinst, int i);
+ * @brief	: Direct register TX abort request (TSR ABRQx)
+ * *************************************************************************/
+void halstub_can_abrq(CAN_TypeDef* pinst, int i)
+{
+	HAL_CAN_AbortTxRequest(caninstslot(pinst)->phcan, (CAN_TX_MAILBOX0 << i));
+	return;
+}
+/* *************************************************************************
+ * void halstub_can_rfom(CAN_TypeDef* pinst, int f);
+ * @brief	: Direct register RX FIFO release (RFxR RFOMx): next msg to the output mailbox
+ * *************************************************************************/
+void halstub_can_rfom(CAN_TypeDef* pinst, int f)
+{
+	struct HALSTUBCAN* ps = caninstslot(pinst);
+	if (ps->rxn[f] == 0) return; // (Hardware ignores it too)
+	ps->rxn[f] -= 1;
+	halstubct.canrx += 1;
+	canregsync(ps);
+	return;
+}
+static void (* const txcplt[NUMTXMBX])(CAN_HandleTypeDef*) =
+{
+	HAL_CAN_TxMailbox0CompleteCallback,
+	HAL_CAN_TxMailbox1CompleteCallback,
+	HAL_CAN_TxMailbox2CompleteCallback,
+};
+/* Mailbox 'i', if an abort was requested, frees up and issues its callback. */
+static void txabort(struct HALSTUBCAN* ps, CAN_HandleTypeDef* phcan, int i)
+{
+	static void (* const abrt[NUMTXMBX])(CAN_HandleTypeDef*) =
+	{
+		HAL_CAN_TxMailbox0AbortCallback,
+		HAL_CAN_TxMailbox1AbortCallback,
+		HAL_CAN_TxMailbox2AbortCallback,
+	};
+	if ((ps->txabort & (1 << i)) == 0) return;
+	ps->txabort &= ~(1 << i);
+	ps->txpend  &= ~(1 << i);
+	if (phcan->Instance != NULL)
+		phcan->Instance->sTxMailBox[i].TIR &= ~CAN_TI0R_TXRQ;
+	canregsync(ps);
+	halstubct.cantxabort += 1;
+	abrt[i](phcan);
+	return;
+}
+/* Send one mailbox in bxCAN order: lowest id (highest priority), then lowest
+   mailbox number.  Returns the mailbox, now empty; -1 = none loaded. */
+static int txsend(struct HALSTUBCAN* ps, CAN_HandleTypeDef* phcan)
+{
+	struct CANRCVBUF* pcan;
+	uint32_t tir;
+	int i;
+	int j = -1;
+
+	for (i = 0; i < NUMTXMBX; i++)
+	{
+		if ((ps->txpend & (1 << i)) == 0) continue;
+		if (phcan->Instance == NULL) { j = i; break; }
+		tir = phcan->Instance->sTxMailBox[i].TIR & ~CAN_TI0R_TXRQ;
+		if ((j < 0) || (tir < (phcan->Instance->sTxMailBox[j].TIR & ~CAN_TI0R_TXRQ)))
+			j = i;
+	}
+	if (j < 0) return -1;
+	ps->txpend &= ~(1 << j);
+	if (phcan->Instance != NULL)
+	{
+		pcan = &ps->txring[ps->txin % HALSTUBCANTXRING];
+		pcan->id  = phcan->Instance->sTxMailBox[j].TIR & ~CAN_TI0R_TXRQ;
+		pcan->dlc = phcan->Instance->sTxMailBox[j].TDTR & 0xf;
+		pcan->cd.ui[0] = phcan->Instance->sTxMailBox[j].TDLR;
+		pcan->cd.ui[1] = phcan->Instance->sTxMailBox[j].TDHR;
+		phcan->Instance->sTxMailBox[j].TIR &= ~CAN_TI0R_TXRQ;
+		canregsync(ps);
+		ps->txin += 1;
+		if ((ps->txin - ps->txout) > HALSTUBCANTXRING)
+			ps->txout = ps->txin - HALSTUBCANTXRING; // Drop oldest capture
+	}
+	halstubct.cantx += 1;
+	return j;
+}
+/* *************************************************************************
+ * void halstub_can_isr(CAN_HandleTypeDef* phcan, uint8_t ntx);
+ * @brief	: Simulated CAN interrupt: aborts, up to 'ntx' TX completions, RX FIFOs
+ * *************************************************************************/
+void halstub_can_isr(CAN_HandleTypeDef* phcan, uint8_t ntx)
+{
+	struct HALSTUBCAN* ps = canslot(phcan);
+	int j;
+
+	halstub_ipsr = 1;
+
+	/* Aborted mailboxes free up first. */
+	for (j = 0; j < NUMTXMBX; j++)
+		txabort(ps, phcan, j);
+
+	/* Mailboxes go out in bxCAN order: lowest id (highest priority) first. */
+	while (ntx > 0)
+	{
+		j = txsend(ps, phcan);
+		if (j < 0) break;
+		ntx -= 1;
+		txcplt[j](phcan);
+	}
+
+	/* RX FIFOs: the HAL calls once; the callback empties the FIFO. */
+	if (ps->rxn[0] != 0) HAL_CAN_RxFifo0MsgPendingCallback(phcan);
+	if (ps->rxn[1] != 0) HAL_CAN_RxFifo1MsgPendingCallback(phcan);
+
+	/* FIFO overruns: the HAL sets the error code and calls back last. */
+	if (ps->rxovr != 0)
+	{
+		if ((ps->rxovr & 1) != 0) phcan->ErrorCode |= HAL_CAN_ERROR_RX_FOV0;
+		if ((ps->rxovr & 2) != 0) phcan->ErrorCode |= HAL_CAN_ERROR_RX_FOV1;
+		ps->rxovr = 0;
+		HAL_CAN_ErrorCallback(phcan);
+	}
+
+	halstub_ipsr = 0;
+	return;
+}
+/* *************************************************************************
+ * uint32_t halstub_can_bus(CAN_HandleTypeDef* phcan, uint32_t nslot, uint8_t lat);
+ * @brief	: Simulated bus time: one msg per slot, TX interrupt 'lat' slots late
+ * *************************************************************************/
+uint32_t halstub_can_bus(CAN_HandleTypeDef* phcan, uint32_t nslot, uint8_t lat)
+{
+	struct HALSTUBCAN* ps = canslot(phcan);
+	uint32_t idle = 0;
+	uint32_t s;
+	int i;
+	int j;
+	int k;
+
+	for (s = 0; s < nslot; s++)
+	{
+		/* Interrupt, when the first completion is due or an abort was requested:
+		   like HAL_CAN_IRQHandler it does every mailbox finished by then, in
+		   mailbox order. */
+		halstub_ipsr = 1;
+		k = (ps->txabort != 0);
+		for (i = 0; i < NUMTXMBX; i++)
+			if (((ps->txdone & (1 << i)) != 0) && (ps->txdue[i]-- == 0)) k = 1;
+		for (i = 0; (k != 0) && (i < NUMTXMBX); i++)
+		{
+			txabort(ps, phcan, i);
+			if ((ps->txdone & (1 << i)) != 0)
+			{
+				ps->txdone &= ~(1 << i);
+				txcplt[i](phcan);
+			}
+		}
+		halstub_ipsr = 0;
+
+		/* The bus sends a loaded mailbox; the hardware empties it now. */
+		j = txsend(ps, phcan);
+		if (j < 0)
+		{
+			idle += 1;
+			continue;
+		}
+		ps->txdone |= (1 << j);
+		ps->txdue[j] = lat;
+	}
+	return idle; // (Callbacks still owed run in the next call's slots)
+}
+/* *************************************************************************
+ * int halstub_can_get_tx(CAN_HandleTypeDef* phcan, struct CANRCVBUF* pcan);
+ * @brief	: Take the oldest captured CAN TX msg
+ * *************************************************************************/
+int halstub_can_get_tx(CAN_HandleTypeDef* phcan, struct CANRCVBUF* pcan)
+{
+	struct HALSTUBCAN* ps = canslot(phcan);
+	if (ps->txout == ps->txin) return -1;
+	*pcan = ps->txring[ps->txout % HALSTUBCANTXRING];
+	ps->txout += 1;
+	return 0;
+}
+/* ======================================================================== */
+/* UART                                                                     */
+/* ======================================================================== */
+static HAL_StatusTypeDef uart_tx_start(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	struct HALSTUBUART* ps = uartslot(huart);
+	if (ps->ptx != NULL) return HAL_BUSY;
+	ps->ptx = pData;
+	ps->ntx = Size;
+	huart->gState = HAL_UART_STATE_BUSY_TX;
+	return HAL_OK;
+}
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	return uart_tx_start(huart, pData, Size);
+}
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	return uart_tx_start(huart, pData, Size);
+}
+/* *************************************************************************
+ * void halstub_uart_isr(UART_HandleTypeDef* phuart);
+ * @brief	: Simulated uart TX interrupt: finish the transfer in progress
+ * *************************************************************************/
+void halstub_uart_isr(UART_HandleTypeDef* phuart)
+{
+	struct HALSTUBUART* ps = uartslot(phuart);
+	uint32_t i;
+
+	if (ps->ptx == NULL) return;
+	for (i = 0; i < ps->ntx; i++)
+	{
+		ps->txring[ps->txin % HALSTUBUARTRING] = ps->ptx[i];
+		ps->txin += 1;
+	}
+	if ((ps->txin - ps->txout) > HALSTUBUARTRING)
+		ps->txout = ps->txin - HALSTUBUARTRING; // Drop oldest capture
+	halstubct.uarttx += ps->ntx;
+	ps->ptx = NULL;
+	phuart->gState = HAL_UART_STATE_READY;
+
+	halstub_ipsr = 1;
+	HAL_UART_TxCpltCallback(phuart);
+	halstub_ipsr = 0;
+	return;
+}
+/* *************************************************************************
+ * uint32_t halstub_uart_get_tx(UART_HandleTypeDef* phuart, uint8_t* pc, uint32_t max);
+ * @brief	: Take captured uart TX bytes
+ * *************************************************************************/
+uint32_t halstub_uart_get_tx(UART_HandleTypeDef* phuart, uint8_t* pc, uint32_t max)
+{
+	struct HALSTUBUART* ps = uartslot(phuart);
+	uint32_t n = 0;
+	while ((ps->txout != ps->txin) && (n < max))
+	{
+		*pc++ = ps->txring[ps->txout % HALSTUBUARTRING];
+		ps->txout += 1; n += 1;
+	}
+	return n;
+}
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	struct HALSTUBUART* ps = uartslot(huart);
+	ps->prxbuf = pData;
+	ps->rxsize = Size;
+	ps->rxidx  = 0;
+	ps->rxdma  = 1;
+	ps->dmastream.NDTR = Size;
+	huart->hdmarx = &ps->hdmarx;
+	huart->RxState = HAL_UART_STATE_BUSY_RX;
+	return HAL_OK;
+}
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+	struct HALSTUBUART* ps = uartslot(huart);
+	ps->prxbuf = pData;
+	ps->rxsize = Size;
+	ps->rxidx  = 0;
+	ps->rxdma  = 0;
+	huart->RxState = HAL_UART_STATE_BUSY_RX;
+	return HAL_OK;
+}
+/* *************************************************************************
+ * int halstub_uart_inject(UART_HandleTypeDef* phuart, const uint8_t* pc, uint32_t n);
+ * @brief	: Deliver bytes to the uart receive side (dma circular or char-by-char)
+ * *************************************************************************/
+int halstub_uart_inject(UART_HandleTypeDef* phuart, const uint8_t* pc, uint32_t n)
+{
+	struct HALSTUBUART* ps = uartslot(phuart);
+	uint32_t i;
+
+	halstub_ipsr = 1;
+	for (i = 0; i < n; i++)
+	{
+		if ((ps->prxbuf == NULL) || (ps->rxsize == 0)) break; // Receive not started
+		ps->prxbuf[ps->rxidx++] = pc[i];
+		halstubct.uartrx += 1;
+		if (ps->rxdma != 0)
+		{ // Circular dma: NDTR counts down, callbacks at half & full
+			ps->dmastream.NDTR = ps->rxsize - ps->rxidx;
+			if (ps->rxidx == (ps->rxsize >> 1))
+				HAL_UART_RxHalfCpltCallback(phuart);
+			if (ps->rxidx >= ps->rxsize)
+			{
+				ps->rxidx = 0;
+				ps->dmastream.NDTR = ps->rxsize;
+				HAL_UART_RxCpltCallback(phuart);
+			}
+		}
+		else
+		{ // _IT: one transfer, callback re-arms
+			if (ps->rxidx >= ps->rxsize)
+			{
+				ps->rxsize = 0;
+				phuart->RxState = HAL_UART_STATE_READY;
+				HAL_UART_RxCpltCallback(phuart);
+			}
+		}
+	}
+	halstub_ipsr = 0;
+	return i;
+}
+/* ======================================================================== */
+/* ADC                                                                      */
+/* ======================================================================== */
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* pData, uint32_t Length)
+{
+	struct HALSTUBADC* ps = adcslot(hadc);
+	ps->pdma   = (uint16_t*)pData;
+	ps->length = Length;
+	hadc->State = HAL_ADC_STATE_REG_BUSY;
+	return HAL_OK;
+}
+/* *************************************************************************
+ * void halstub_adc_inject(ADC_HandleTypeDef* phadc, const uint16_t* pseq, uint8_t half);
+ * @brief	: Fill one half of the ADC dma buffer and issue its callback
+ * *************************************************************************/
+void halstub_adc_inject(ADC_HandleTypeDef* phadc, const uint16_t* pseq, uint8_t half)
+{
+	struct HALSTUBADC* ps = adcslot(phadc);
+	uint32_t n = ps->length >> 1;
+
+	if (ps->pdma == NULL) return; // ADC not started
+	memcpy(ps->pdma + (half ? n : 0), pseq, n * sizeof(uint16_t));
+	halstubct.adchalf += 1;
+
+	halstub_ipsr = 1;
+	if (half == 0)
+		HAL_ADC_ConvHalfCpltCallback(phadc);
+	else
+		HAL_ADC_ConvCpltCallback(phadc);
+	halstub_ipsr = 0;
+	return;
+}
+/* ======================================================================== */
+/* FLASH: sectors 10 & 11 only                                              */
+/* ======================================================================== */
+/* Peripheral registers: APB offsets 0-32 KB, so bits 14:10 are as on the board. */
+uint8_t halstub_periph[HOSTPERIPHSIZE] __attribute__((aligned(HOSTPERIPHSIZE)));
+
+/* Erased; programming can only clear bits, as the real thing. */
+uint8_t halstub_flash[HALSTUBFLASHSIZE] = {[0 ... HALSTUBFLASHSIZE - 1] = 0xff};
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void){return HAL_OK;}
+HAL_StatusTypeDef HAL_FLASH_Lock(void){return HAL_OK;}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError)
+{
+	uint32_t i;
+	*SectorError = 0xffffffff;
+	for (i = pEraseInit->Sector; i < pEraseInit->Sector + pEraseInit->NbSectors; i++)
+	{
+		if ((i < 10) || (i > 11)) continue; // Not modeled
+		memset(&halstub_flash[(i - 10) * (HALSTUBFLASHSIZE / 2)], 0xff, HALSTUBFLASHSIZE / 2);
+		halstubct.flasherase += 1;
+	}
+	return HAL_OK;
+}
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+	uint32_t n = 1 << TypeProgram; // BYTE 0, HALFWORD 1, WORD 2, DOUBLEWORD 3
+	uint32_t i;
+
+	if ((Address < HALSTUBFLASHADDR) || (Address + n > HALSTUBFLASHADDR + HALSTUBFLASHSIZE))
+		return HAL_ERROR;
+	for (i = 0; i < n; i++)
+		halstub_flash[Address - HALSTUBFLASHADDR + i] &= (uint8_t)(Data >> (8 * i));
+	halstubct.flashprog += n;
+	return HAL_OK;
+}
+/* ======================================================================== */
+/* GPIO, USB-CDC, misc                                                      */
+/* ======================================================================== */
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin){}
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState){}
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+	return GPIO_PIN_RESET;
+}
+uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
+{
+	uint32_t i;
+	for (i = 0; i < Len; i++)
+	{
+		cdcring[cdcin % HALSTUBCDCRING] = Buf[i];
+		cdcin += 1;
+	}
+	if ((cdcin - cdcout) > HALSTUBCDCRING)
+		cdcout = cdcin - HALSTUBCDCRING; // Drop oldest capture
+	halstubct.cdctx += Len;
+	return USBD_OK;
+}
+/* *************************************************************************
+ * uint32_t halstub_cdc_get_tx(uint8_t* pc, uint32_t max);
+ * @brief	: Take captured USB-CDC TX bytes
+ * *************************************************************************/
+uint32_t halstub_cdc_get_tx(uint8_t* pc, uint32_t max)
+{
+	uint32_t n = 0;
+	while ((cdcout != cdcin) && (n < max))
+	{
+		*pc++ = cdcring[cdcout % HALSTUBCDCRING];
+		cdcout += 1; n += 1;
+	}
+	return n;
+}
+/* *************************************************************************
+ * void morse_trap(uint16_t x);
+ * @brief	: Host version of the panic: say which trap and stop
+ * *************************************************************************/
+void morse_trap(uint16_t x)
+{
+	fprintf(stderr, "morse_trap: %u\n", x);
+	abort();
+}
+/* *************************************************************************
+ * void xPortSysTickHandler(void);
+ * @brief	: 'cmsis_os.c' osSystickHandler references it; the POSIX port ticks itself
+ * *************************************************************************/
+__attribute__((weak)) void xPortSysTickHandler(void){}
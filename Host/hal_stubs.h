@@ -0,0 +1,139 @@
+/******************************************************************************
+* File Name          : hal_stubs.h
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : HAL_CAN/HAL_UART/HAL_ADC stand-ins: inject & capture traffic
+*******************************************************************************/
+/*
+The Ourwares/Ourtasks code calls the ST HAL as if the F407 were there.  On the
+host these routines stand in for the HAL drivers:
+
+- Outgoing traffic (CAN TX mailboxes, uart TX, USB-CDC TX) is captured into
+  per-handle rings that a test/benchmark task drains with the 'get' calls.
+
+- Incoming traffic (CAN RX FIFO, uart RX dma/char, ADC dma buffer) is injected
+  with the 'inject' calls.
+
+- The HAL callbacks (the interrupt side of the firmware) only run from
+  'halstub_xxx_isr' calls, made by whatever task is playing the part of the
+  interrupt (see 'host_main.c').  That task runs at the highest priority so a
+  callback completes before any other task continues, the way an ISR would.
+
+- Flash sectors 10 & 11 (ADC parameter images) are RAM, 'halstub_flash';
+  erase sets bytes to 0xff and programming only clears bits.
+
+- The peripheral registers (the 'Instance' in the handles) are RAM,
+  'halstub_periph', at the board's offsets (HOSTPERIPH(CAN1_BASE) etc. in
+  'periphidx.h'), so the table lookups from the base address work unchanged.
+*/
+
+#ifndef __HAL_STUBS
+#define __HAL_STUBS
+
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+#include "common_can.h"
+#include "periphidx.h"
+
+#define HALSTUBCANTXRING 256	// Captured CAN TX msgs (per CAN module)
+#define HALSTUBCANRXFIFO 3     // bxCAN hardware RX FIFO depth
+#define HALSTUBUARTRING 4096	// Captured uart TX bytes (per uart)
+#define HALSTUBCDCRING 4096	// Captured USB-CDC TX bytes
+#define HALSTUBFLASHADDR 0x080C0000 // Modeled flash: sectors 10 & 11
+#define HALSTUBFLASHSIZE (256 * 1024)
+
+/* Running counts, for benchmarks and for checking nothing was lost. */
+struct HALSTUBCOUNTS
+{
+	uint32_t cantx;       // CAN msgs taken from TX mailboxes
+	uint32_t cantxabort;  // CAN TX mailboxes aborted
+	uint32_t canrx;       // CAN msgs handed to HAL_CAN_GetRxMessage
+	uint32_t canrxovr;    // CAN msgs lost: hardware FIFO full
+	uint32_t uarttx;      // uart bytes sent
+	uint32_t uartrx;      // uart bytes received
+	uint32_t adchalf;     // ADC dma half-buffer callbacks
+	uint32_t cdctx;       // USB-CDC bytes sent
+	uint32_t flasherase;  // Flash sectors erased
+	uint32_t flashprog;   // Flash bytes programmed
+};
+
+/* *************************************************************************/
+void halstub_can_isr(CAN_HandleTypeDef* phcan, uint8_t ntx);
+/* @brief	: Simulated CAN interrupt: aborts, up to 'ntx' TX completions, RX FIFOs
+ * @param	: phcan = pointer to 'MX CAN handle
+ * @param	: ntx = max number of TX mailboxes that "finish sending" in this call
+ * *************************************************************************/
+uint32_t halstub_can_bus(CAN_HandleTypeDef* phcan, uint32_t nslot, uint8_t lat);
+/* @brief	: Simulated bus time: each slot sends one loaded TX mailbox (bxCAN order)
+ * @param	: phcan = pointer to 'MX CAN handle
+ * @param	: nslot = number of msg times to run
+ * @param	: lat = slots after its msg went out that a mailbox's complete callback runs
+ *		:  (callbacks not yet due are kept for the next call)
+ * @return	: number of slots the bus sat idle (no mailbox loaded)
+ * *************************************************************************/
+int halstub_can_inject(CAN_HandleTypeDef* phcan, uint32_t RxFifo, struct CANRCVBUF* pcan);
+/* @brief	: Put a CAN msg in the simulated hardware RX FIFO
+ * @param	: phcan = pointer to 'MX CAN handle
+ * @param	: RxFifo = CAN_RX_FIFO0 or CAN_RX_FIFO1
+ * @param	: pcan = pointer to msg in hardware format (common_can.h)
+ * @return	: 0 = OK; -1 = FIFO full (msg counted as overrun and dropped)
+ * *************************************************************************/
+void halstub_can_txrq(CAN_TypeDef* pinst, int i, uint32_t tir);
+/* @brief	: Direct register TX request: TIR = tir | TXRQ (TDTR, TDLR, TDHR already written)
+ * @param	: pinst = pointer to CAN registers (handle 'Instance')
+ * @param	: i = mailbox (0 - 2), must be empty
+ * @param	: tir = identifier register, less TXRQ
+ * *************************************************************************/
+void halstub_can_abrq(CAN_TypeDef* pinst, int i);
+/* @brief	: Direct register TX abort request (TSR ABRQx)
+ * @param	: pinst = pointer to CAN registers (handle 'Instance')
+ * @param	: i = mailbox (0 - 2)
+ * *************************************************************************/
+void halstub_can_rfom(CAN_TypeDef* pinst, int f);
+/* @brief	: Direct register RX FIFO release (RFxR RFOMx): next msg to the output mailbox
+ * @param	: pinst = pointer to CAN registers (handle 'Instance')
+ * @param	: f = FIFO (0, 1)
+ * *************************************************************************/
+int halstub_can_get_tx(CAN_HandleTypeDef* phcan, struct CANRCVBUF* pcan);
+/* @brief	: Take the oldest captured CAN TX msg
+ * @param	: phcan = pointer to 'MX CAN handle
+ * @param	: pcan = pointer to receive msg in hardware format
+ * @return	: 0 = OK; -1 = nothing captured
+ * *************************************************************************/
+void halstub_uart_isr(UART_HandleTypeDef* phuart);
+/* @brief	: Simulated uart TX interrupt: finish the transfer in progress
+ * @param	: phuart = pointer to 'MX uart handle
+ * *************************************************************************/
+int halstub_uart_inject(UART_HandleTypeDef* phuart, const uint8_t* pc, uint32_t n);
+/* @brief	: Deliver bytes to the uart receive side (dma circular or char-by-char)
+ * @param	: phuart = pointer to 'MX uart handle
+ * @param	: pc = pointer to bytes
+ * @param	: n = number of bytes
+ * @return	: number of bytes delivered
+ * *************************************************************************/
+uint32_t halstub_uart_get_tx(UART_HandleTypeDef* phuart, uint8_t* pc, uint32_t max);
+/* @brief	: Take captured uart TX bytes
+ * @param	: phuart = pointer to 'MX uart handle
+ * @param	: pc = pointer to output buffer
+ * @param	: max = size of output buffer
+ * @return	: number of bytes copied
+ * *************************************************************************/
+void halstub_adc_inject(ADC_HandleTypeDef* phadc, const uint16_t* pseq, uint8_t half);
+/* @brief	: Fill one half of the ADC dma buffer and issue its callback
+ * @param	: phadc = pointer to 'MX ADC handle
+ * @param	: pseq = pointer to readings: ADC1DMANUMSEQ scans of NbrOfConversion
+ * @param	: half = 0 = first half (ConvHalfCplt); 1 = second half (ConvCplt)
+ * *************************************************************************/
+uint32_t halstub_cdc_get_tx(uint8_t* pc, uint32_t max);
+/* @brief	: Take captured USB-CDC TX bytes
+ * @param	: pc = pointer to output buffer
+ * @param	: max = size of output buffer
+ * @return	: number of bytes copied
+ * *************************************************************************/
+
+extern struct HALSTUBCOUNTS halstubct;
+extern volatile uint32_t halstub_ipsr;
+extern uint16_t halstub_factorycal[3];
+extern uint8_t halstub_flash[HALSTUBFLASHSIZE];
+
+#endif
@@ -0,0 +1,383 @@
+/******************************************************************************
+* File Name          : host_main.c
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Host build: 'main.c' setup, plus a task that plays the hardware
+*******************************************************************************/
+/*
+'make host' builds the Ourwares/Ourtasks tasks with this file in place of
+'Src/main.c', 'hal_stubs.c' in place of the HAL drivers, and the FreeRTOS
+POSIX port in place of ARM_CM4F.
+
+The task setup follows 'main.c' (same sizes, same priorities).  In place of
+the default task there is 'StartStimulusTask', which runs at the highest
+priority and does what the interrupts would--
+
+- Every tick: one ADC dma half buffer (alternating halves) of synthetic
+  readings, then a CAN "interrupt" on each module and a uart TX completion.
+
+- Every 64 ticks: a CAN msg into CAN1 RX FIFO0 (MailboxTask/GatewayTask path).
+
+- Every 512 ticks (1 sec): one line of ADC readings, the DTWTIME cycle counts
+  for adcfastsum (adcsumdbg), adcparams_internal (adcdbg2), and the channel
+  pipelines (adcchandbg, max), ADCTask 1/2 buffers missed and the largest
+  latency and processing time (adctiming), and the stub traffic counts to
+  stdout.
+  Captured CAN/uart/CDC output is drained (counted, not printed; the gateway
+  traffic is binary).
+
+Run time in seconds is the first argument (default 10); 0 = run forever.
+
+'host_main c [file]' runs 3 secs with a raw ADC capture: a CAN command arms a
+level trigger on the pot ramp, a low priority task streams the capture out
+the CDC when it completes, and the CDC output goes to 'file' (default
+adccapture.bin) for 'adccapdecode'.
+
+'host_main <letter> [arg]' runs one of the checks and benchmarks in place of
+the above (hostcheck.h lists them; the file for each subsystem describes its
+own).  They do not start the scheduler, and the exit status is the result.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cmsis_os.h"
+#include "stm32f4xx_hal.h"
+#include "hal_stubs.h"
+#include "hostcheck.h"
+#include "DTW_counter.h"
+#include "morse.h"
+#include "SerialTaskSend.h"
+#include "SerialTaskReceive.h"
+#include "yprintf.h"
+#include "cdc_txbuff.h"
+#include "CanTask.h"
+#include "can_iface.h"
+#include "canfilter_setup.h"
+#include "MailboxTask.h"
+#include "GatewayTask.h"
+#include "ADCTask.h"
+#include "adctask.h"
+#include "adcparams.h"
+#include "adccapture.h"
+#include "adctiming.h"
+
+/* Globals 'main.c' supplies on the board */
+ADC_HandleTypeDef hadc1;
+CAN_HandleTypeDef hcan1;
+CAN_HandleTypeDef hcan2;
+UART_HandleTypeDef huart2;
+UART_HandleTypeDef huart6;
+
+struct CAN_CTLBLOCK* pctl0;	// Pointer to CAN1 control block
+struct CAN_CTLBLOCK* pctl1;	// Pointer to CAN2 control block
+uint32_t debugTX1c;
+
+extern uint32_t adcdbg2;
+
+static uint32_t runsecs = 10;	// Run time (0 = forever)
+static FILE* capfp;            // Capture mode: CDC output file; NULL = not capture mode
+
+static void StartStimulusTask(void const * argument);
+static void stimulus_adc(void);
+static void drain_output(void);
+static void StartCaptureTask(void const * argument);
+
+/* Checks and benchmarks (hostcheck.h): 'host_main <mode> [arg]' */
+static const struct HOSTMODE
+{
+	char mode;
+	int (*pfunc)(const char* arg);
+} hostmode[] =
+{
+	{'q', hostqcheck},
+	{'s', hostsnapstress},
+	{'a', hostsumcheck},
+	{'p', hostpipebench},
+	{'f', hostfirbench},
+	{'m', hostmedbench},
+	{'i', hostiircheck},
+	{'t', hosttxqbench},
+	{'b', hostmbxbench},
+	{'e', hostcancheck},
+	{'r', hostrxringcheck},
+};
+#define HOSTMODENUM (sizeof(hostmode) / sizeof(hostmode[0]))
+
+/* *************************************************************************
+ * Static allocation support for the idle & timer tasks ('freertos.c' on the board)
+ * *************************************************************************/
+static StaticTask_t xIdleTaskTCBBuffer;
+static StackType_t xIdleStack[configMINIMAL_STACK_SIZE];
+void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize )
+{
+  *ppxIdleTaskTCBBuffer = &xIdleTaskTCBBuffer;
+  *ppxIdleTaskStackBuffer = &xIdleStack[0];
+  *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+static StaticTask_t xTimerTaskTCBBuffer;
+static StackType_t xTimerStack[configTIMER_TASK_STACK_DEPTH];
+void vApplicationGetTimerTaskMemory( StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize )
+{
+  *ppxTimerTaskTCBBuffer = &xTimerTaskTCBBuffer;
+  *ppxTimerTaskStackBuffer = &xTimerStack[0];
+  *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+/* *************************************************************************
+ * int main(int argc, char** argv);
+ * @brief	: Same order of setup as 'Src/main.c'
+ * *************************************************************************/
+int main(int argc, char** argv)
+{
+	BaseType_t ret;	   // Used for returns from function calls
+	osMessageQId Qidret; // Functin call return
+	HAL_StatusTypeDef Cret;
+	unsigned int i;
+
+	if ((argc > 1) && (argv[1][0] == 'c'))
+	{
+		capfp = fopen((argc > 2) ? argv[2] : "adccapture.bin", "wb");
+		if (capfp == NULL) { perror("capture file"); return 1; }
+		runsecs = 3;
+	}
+	else if ((argc > 1) && ((argv[1][0] < '0') || (argv[1][0] > '9')))
+	{ // A check or benchmark in place of the run
+		for (i = 0; i < HOSTMODENUM; i++)
+		{
+			if (hostmode[i].mode == argv[1][0])
+				return hostmode[i].pfunc((argc > 2) ? argv[2] : NULL);
+		}
+		printf("host_main [secs] | c [file] | q | s [secs] | a | p | f | m | i | t | b | e [file] | r\n");
+		return 1;
+	}
+	else if (argc > 1) runsecs = strtoul(argv[1], NULL, 0);
+
+	DTW_counter_init();
+
+	/* What the MX_xxx_Init routines leave in the handles that our code looks at. */
+	hadc1.Instance = &adc1regs;
+	hadc1.Init.NbrOfConversion = ADC1IDX_ADCSCANSIZE;
+	hcan1.Instance = &can1regs;
+	hcan2.Instance = &can2regs;
+	huart2.Instance = &usart2regs;
+	huart6.Instance = &usart6regs;
+
+	xSerialTaskSendCreate(0);	// Create task and set Task priority
+
+	#define NUMCIRBCB6  16 // Size of circular buffer of BCB for usart6
+	ret = xSerialTaskSendAdd(&huart6, NUMCIRBCB6, 0); // char-by-char
+	if (ret < 0) morse_trap(1);
+
+	#define NUMCIRBCB2  16 // Size of circular buffer of BCB for usart2
+	ret = xSerialTaskSendAdd(&huart2, NUMCIRBCB2, 1); // dma
+	if (ret < 0) morse_trap(2);
+
+	yprintf_init();
+
+	xSerialTaskReceiveCreate(0);
+
+	#define NUMCDCBUFF 3	// Number of CDC task local buffers
+	#define CDCBUFFSIZE 64*16	// Best buff size is multiples of usb packet size
+	struct CDCBUFFPTR* pret;
+	pret = cdc_txbuff_init(NUMCDCBUFF, CDCBUFFSIZE);
+	if (pret == NULL) morse_trap(3);
+
+	Qidret = xCdcTxTaskSendCreate(3);
+	if (Qidret < 0) morse_trap(4);
+
+	Qidret = xCanTxTaskCreate(0, 32); // CanTask priority, Number of msgs in queue
+	if (Qidret < 0) morse_trap(5);
+
+	pctl0 = can_iface_init(&hcan1, 0, 32, 64);
+	if (pctl0 == NULL) morse_trap(7);
+	if (pctl0->ret < 0) morse_trap(77);
+
+	pctl1 = can_iface_init(&hcan2, 1,32, 64);
+	if (pctl1 == NULL) morse_trap(8);
+	if (pctl1->ret < 0) morse_trap(88);
+
+	Cret = canfilter_setup_first(0, &hcan1, 15); // CAN1
+	if (Cret == HAL_ERROR) morse_trap(9);
+	Cret = canfilter_setup_first(1, &hcan2, 15); // CAN2
+	if (Cret == HAL_ERROR) morse_trap(10);
+
+	xMailboxTaskCreate(2);
+	xGatewayTaskCreate(1);
+
+	struct MAILBOXCANNUM* pmbxret;
+	pmbxret = MailboxTask_add_CANlist(pctl0, 48);
+	if (pmbxret == NULL) morse_trap(16);
+	pmbxret = MailboxTask_add_CANlist(pctl1, 48);
+	if (pmbxret == NULL) morse_trap(17);
+
+	HAL_CAN_Start(&hcan1);
+	HAL_CAN_Start(&hcan2);
+
+	xADCTaskCreate(3);
+
+	/* The hardware */
+	osThreadDef(stimulusTask, StartStimulusTask, osPriorityRealtime, 0, 1024);
+	if (osThreadCreate(osThread(stimulusTask), NULL) == NULL) morse_trap(18);
+
+	if (capfp != NULL)
+	{
+		osThreadDef(captureTask, StartCaptureTask, osPriorityLow, 0, 256);
+		if (osThreadCreate(osThread(captureTask), NULL) == NULL) morse_trap(19);
+	}
+
+	osKernelStart();
+
+	return 0;
+}
+/* *************************************************************************
+ * static void StartStimulusTask(void const * argument);
+ * @brief	: Plays the part of the interrupts (see top of file)
+ * *************************************************************************/
+static void StartStimulusTask(void const * argument)
+{
+	struct CANRCVBUF can;
+	struct ADCTIMING adct;
+	uint32_t tick = 0;
+	int i;
+
+	/* Test CAN msg, as the default task on the board uses */
+	can.id = 0xc2200000;
+	can.dlc = 8;
+	for (i = 0; i < 8; i++)
+		can.cd.uc[i] = 0x30 + i;
+
+	for ( ;; )
+	{
+		osDelay(1);
+		tick += 1;
+
+		stimulus_adc();
+
+		if ((capfp != NULL) && (tick == 256))
+		{ // Arm: pot channel rising through mid-scale, 800 scans after
+			struct CANRCVBUF cmd;
+			cmd.id  = ADCCAPTURE_CANID;
+			cmd.dlc = 7;
+			cmd.cd.ull = 0;
+			cmd.cd.uc[0] = ADCCAPCMD_ARM;
+			cmd.cd.uc[1] = ADC1IDX_RESISRPOT;
+			cmd.cd.uc[2] = ADCCAPEDGE_RISE;
+			cmd.cd.uc[3] = 2048 & 0xff; cmd.cd.uc[4] = 2048 >> 8;
+			cmd.cd.uc[5] = 800 & 0xff;  cmd.cd.uc[6] = 800 >> 8;
+			halstub_can_inject(&hcan1, CAN_RX_FIFO0, &cmd);
+		}
+
+		if ((tick & 63) == 0)
+		{
+			can.cd.ui[1] = tick;
+			halstub_can_inject(&hcan1, CAN_RX_FIFO0, &can);
+		}
+		halstub_can_isr(&hcan1, 3);
+		halstub_can_isr(&hcan2, 3);
+		halstub_uart_isr(&huart2);
+		halstub_uart_isr(&huart6);
+
+		drain_output();
+
+		if ((tick % configTICK_RATE_HZ) == 0)
+		{
+			adctiming_get(&adct);
+			printf("%5u ADC: %8.3f %8.3f %8.3f %8.3f %6u sum %5u dbg2 %6u chan %6u/%6u miss %u lat %u proc %u | CAN tx %u rx %u ovr %u | uart %u cdc %u\n",
+				(unsigned int)(tick / configTICK_RATE_HZ),
+				adc1data.adc1calreading[ADC1IDX_CURRENTTOTAL].f,
+				adc1data.adc1calreading[ADC1IDX_12VRAWSUPPLY].f,
+				adc1data.adc1calreadingfilt[ADC1IDX_RESISRPOT].f,
+				adc1data.adc1calreading[ADC1IDX_INTERNALTEMP].f,
+				(unsigned int)adc1data.ctr,
+				(unsigned int)adcsumdbg,
+				(unsigned int)adcdbg2,
+				(unsigned int)adcchandbg,
+				(unsigned int)adcchandbgmax,
+				(unsigned int)adct.missed,
+				(unsigned int)adct.latmax,
+				(unsigned int)adct.procmax,
+				(unsigned int)halstubct.cantx,
+				(unsigned int)halstubct.canrx,
+				(unsigned int)halstubct.canrxovr,
+				(unsigned int)halstubct.uarttx,
+				(unsigned int)halstubct.cdctx);
+			fflush(stdout);
+
+			if ((runsecs != 0) && ((tick / configTICK_RATE_HZ) >= runsecs))
+			{
+				if (capfp != NULL) fclose(capfp);
+				exit(0);
+			}
+		}
+	}
+}
+/* *************************************************************************
+ * static void stimulus_adc(void);
+ * @brief	: One half dma buffer: fixed levels, pot ramp, a little noise
+ * *************************************************************************/
+static void stimulus_adc(void)
+{
+	/* Rough mid-scale levels for each channel in scan order */
+	static const uint16_t level[ADC1IDX_ADCSCANSIZE] =
+	{ 2048, 1850, 1700, 1720, 0, 2100, 2730, 3100, 955, 1501 };
+	static uint16_t dma[ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE];
+	static uint8_t half;
+	static uint16_t pot;
+	static uint32_t lfsr = 0xACE1u;
+	int i;
+	int j;
+
+	pot = (pot + 7) & 4095; // Pot sweeps full scale every ~1.2 sec
+
+	for (i = 0; i < ADC1DMANUMSEQ; i++)
+	{
+		for (j = 0; j < ADC1IDX_ADCSCANSIZE; j++)
+		{
+			lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+			dma[i*ADC1IDX_ADCSCANSIZE + j] = ((j == ADC1IDX_RESISRPOT) ? pot : level[j]) + (lfsr & 0x7);
+		}
+	}
+	halstub_adc_inject(&hadc1, dma, half);
+	half ^= 1;
+	return;
+}
+/* *************************************************************************
+ * static void drain_output(void);
+ * @brief	: Empty the capture rings (halstubct keeps the counts)
+ * *************************************************************************/
+static void drain_output(void)
+{
+	static uint8_t buf[256];
+	struct CANRCVBUF can;
+	uint32_t n;
+
+	while (halstub_uart_get_tx(&huart6, buf, sizeof(buf)) != 0);
+	while ((n = halstub_cdc_get_tx(buf, sizeof(buf))) != 0)
+		if (capfp != NULL) fwrite(buf, 1, n, capfp);
+	while (halstub_uart_get_tx(&huart2, buf, sizeof(buf)) != 0);
+	while (halstub_can_get_tx(&hcan1, &can) == 0);
+	while (halstub_can_get_tx(&hcan2, &can) == 0);
+	return;
+}
+/* *************************************************************************
+ * static void StartCaptureTask(void const * argument);
+ * @brief	: Capture mode: send a completed capture (the board's default task does this)
+ * *************************************************************************/
+static void StartCaptureTask(void const * argument)
+{
+	int n;
+
+	for ( ;; )
+	{
+		osDelay(10);
+		if (adccapture_ready())
+		{
+			n = adccapture_send(NULL);
+			printf("capture %u: trigger src 0x%x, %u blocks, %d bytes sent\n",
+				(unsigned int)adccapture.hdr.seq, adccapture.hdr.trigsrc,
+				adccapture.hdr.nblk, n);
+		}
+	}
+}
@@ -0,0 +1,627 @@
+/******************************************************************************
+* File Name          : hostadc.c
+* Date First Issued  : 10/18/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Host checks: ADC fixed-point path, adcsnap
+*******************************************************************************/
+/*
+'host_main q' does not start the scheduler: it runs adcparams_qcheck on each
+float channel as 'adcparamsinit.c' sets it up, at nominal and +/-5% Vdd
+compensation, and prints the fixed-point (_Q calibtype) error against the
+float path on the same sums, less the float path's own rounding bound.
+Then iir_q1 (the _Q IIR1 filter) steps up and down from 0 at several
+coefficients, against the exact 1 - coef^n response for its Q31 'onemcoef'.
+iir_biquad_q (the _Q IIR2 filter) runs each biquad spec in iir_coef.h on
+steps and on pseudo-random readings, against the same cascade in double
+with the float coefficients; a _Q channel must take an IIR2 biquad spec
+and refuse any other.
+Last, the combinations adcparams_pipe_chan refuses (a _Q calibtype with a
+FIR or MEDIAN filter; comptype VOLTV5; 'decim' over ADCDECIMMAX,
+when ADC1DMANUMSEQ lets a uint16_t reach it) must leave the channel with
+no handlers and the ADCPIPEERR_ code in adc1soa.pipeerr[].  Exit status 1
+if a channel exceeds QCHECKLSB LSBs, a step is off by more than IIRQLSB
+(IIRBQLSB) LSBs or does not settle on the input, or a refused setup is taken.
+
+'host_main s [secs]' does not start the scheduler: plain threads stress
+adcsnap (default 5 secs).  A writer fills adc1data/adcommon from a counter
+and calls adcsnap_publish as fast as it can; SNAPREADERS readers call
+adcsnap_read and check every field came from the same counter value.  One
+more reader copies adc1data directly, as a control that the check does see
+tears.  Exit status 1 if any adcsnap_read copy is torn.
+
+'host_main a' does not start the scheduler: adcfastsum_simd and
+adcfastsum_stat_simd (the packed code, with the C stand-ins for the DSP
+intrinsics in 'Host/Inc/cmsis_simd.h') against adcfastsum_c and
+adcfastsum_stat_c on the same 1/2 dma buffers: noise, all 0, all 4095, and
+alternating 0/4095.  Every sum, sum of squares, min, and max must match.
+DTWTIME ticks per call are printed for both, over SUMBENCHN calls; the host
+ticks for the packed code time the stand-ins, not the M4, so on the board
+'adcsumdbg' (with and without ADCFASTSUM_NOSIMD) is the measure.  Exit
+status 1 if any result differs.
+
+'host_main p' does not start the scheduler: PIPEBENCHN 1/2 dma buffers of
+the host_main levels plus noise go through adcfastsum_stat,
+adcparams_decimate, adcparams_internal and adcparams_all, as ADCTask runs
+them.  Prints DTWTIME ticks per 1/2 buffer for adcparams_internal and
+adcparams_all, and how often each comptype's fused cache sequence moved
+(after PIPEBENCHWARM buffers).  Build the host with -DADCPARAMS_NOFUSE for
+the separate stages to compare.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "hostcheck.h"
+#include "adcparams.h"
+#include "adcsnap.h"
+#include "adcfastsum.h"
+#include "DTW_counter.h"
+#include "iir_q1.h"
+#include "iir_biquad_q.h"
+#include "iir_coef.h"
+
+#define QCHECKLSB 4 // Fixed-point error bound: LSBs of 'qfrac'
+#define IIRQLSB 2   // iir_q1 step error bound: LSBs of the input
+#define IIRQSTEP (1000 << 16) // iir_q1 step size (Q16, as the Vdd filter)
+#define IIRBQLSB 2  // iir_biquad_q error bound: LSBs of the input
+#define IIRBQN 2000 // iir_biquad_q: readings per input
+#define SNAPREADERS 3 // Snapshot stress: adcsnap_read threads
+#define SUMBENCHN 100000 // adcfastsum: calls timed per version
+#define PIPEBENCHN 200000 // Channel pipelines: 1/2 buffers timed
+#define PIPEBENCHWARM 2000 // Channel pipelines: 1/2 buffers before counting
+
+/* *************************************************************************
+ * static int iirqstep(double coef, int32_t step);
+ * @brief	: iir_q1 step response against 1 - coef^n
+ * @param	: coef = filter coefficient (0 < coef < 1)
+ * @param	: step = input after one reading of 0 (skip count 1)
+ * @return	: 0 = within IIRQLSB and settled; 1 = not
+ * *************************************************************************/
+static int iirqstep(double coef, int32_t step)
+{
+	struct FILTERIIRQ1 f;
+	double cn = 1.0; // coef^n, coef as the filter has it (Q31)
+	double cq;
+	double err;
+	double errmax = 0;
+	int32_t y = 0;
+	int n;
+	int nend = 20.0 / (1.0 - coef); // 20 time constants
+
+	f.skipctr  = 1;
+	f.onemcoef = IIR_Q1_COEF(1 - coef);
+	cq = 1.0 - (double)f.onemcoef / 2147483648.0;
+	iir_q1_q(&f, 0);
+	for (n = 1; n <= nend; n++)
+	{
+		y = iir_q1_q(&f, step);
+		cn *= cq;
+		err = (double)y - (double)step * (1.0 - cn);
+		if (err < 0) err = -err;
+		if (err > errmax) errmax = err;
+	}
+	printf("iir_q1 coef %.4f step %+d: maxerr %.2f lsb, final %+d%s\n", coef, (int)step,
+		errmax, (int)y, ((errmax > IIRQLSB) || (y != step)) ? " FAIL" : "");
+	return ((errmax > IIRQLSB) || (y != step));
+}
+/* *************************************************************************
+ * static int bqqcheck(uint8_t spec, int32_t amp, int noise);
+ * @brief	: iir_biquad_q against the same cascade in double (float coefficients)
+ * @param	: spec = iirspec[] index (IIRSPECTYPE_BQ)
+ * @param	: amp = step size; or noise: readings spread +/-amp
+ * @param	: noise = 0: step from 0 (skip count 1); 1: pseudo-random readings
+ * @return	: 0 = within IIRBQLSB (and a step settled on the input); 1 = not
+ * *************************************************************************/
+static int bqqcheck(uint8_t spec, int32_t amp, int noise)
+{
+	const struct BIQUADSPEC* ps = &iirspec[spec].u.bq;
+	struct FILTERBIQUADQ f = {0};
+	double z[BIQUADMAXSECT][4] = {{0}}; // x1, x2, y1, y2
+	double x;
+	double err;
+	double errmax = 0;
+	uint32_t lcg = 12345;
+	int32_t xn = 0;
+	int32_t y = 0;
+	int n;
+	int i;
+	int ret;
+
+	if (iir_biquad_q_init(&f, ps, 1) != 0)
+	{
+		printf("iir_biquad_q spec %u: init refused FAIL\n", spec);
+		return 1;
+	}
+	iir_biquad_q_q(&f, 0);
+	for (n = 1; n <= IIRBQN; n++)
+	{
+		if (noise != 0)
+		{
+			lcg = lcg * 1664525 + 1013904223;
+			xn = (int32_t)(((int64_t)(lcg >> 8) * 2 * amp) >> 24) - amp;
+		}
+		else
+			xn = amp;
+		y = iir_biquad_q_q(&f, xn);
+
+		x = xn;
+		for (i = 0; i < ps->nsect; i++)
+		{
+			const struct BIQUADCOEF* pc = &ps->sect[i];
+			double yd = pc->b0 * x + pc->b1 * z[i][0] + pc->b2 * z[i][1] - pc->a1 * z[i][2] - pc->a2 * z[i][3];
+			z[i][1] = z[i][0]; z[i][0] = x;
+			z[i][3] = z[i][2]; z[i][2] = yd;
+			x = yd;
+		}
+		err = (double)y - x;
+		if (err < 0) err = -err;
+		if (err > errmax) errmax = err;
+	}
+	ret = ((errmax > IIRBQLSB) || ((noise == 0) && (y != amp)));
+	printf("iir_biquad_q spec %u %s %+d: maxerr %.2f lsb, final %+d%s\n", spec, (noise != 0) ? "noise" : "step ",
+		(int)amp, errmax, (int)y, (ret != 0) ? " FAIL" : "");
+	free(f.pz);
+	return ret;
+}
+/* *************************************************************************
+ * static int qbqchan(int i, uint8_t spec, int8_t err);
+ * @brief	: Channel 'i' set up _Q with an IIR2 filter 'spec': taken (err 0), or refused with 'err'
+ * @return	: 0 = as expected; 1 = not
+ * *************************************************************************/
+static int qbqchan(int i, uint8_t spec, int8_t err)
+{
+	struct ADCPARAM xprms = adc1channelstuff[i].xprms;
+	union ADCPARAMWORK fpw = adc1channelstuff[i].fpw;
+	int ret;
+
+	adc1channelstuff[i].xprms.calibtype = ADC1PARAM_CALIBTYPE_OFSC_Q;
+	adc1channelstuff[i].xprms.filttype  = ADCFILTERTYPE_IIR2;
+	adc1channelstuff[i].xprms.comptype  = ADC1PARAM_COMPTYPE_RATIOVDD;
+	adc1channelstuff[i].xprms.qfrac     = 8;
+	adc1channelstuff[i].fpw.iir2.spec    = spec;
+	adc1channelstuff[i].fpw.iir2.skipctr = 4;
+	adcparams_reload();
+	ret = ((adc1soa.pipeerr[i] != err) || ((adc1channelstuff[i].pipe.nstage == 0) != (err != 0)));
+	printf("chan %d OFSC_Q IIR2 spec %u: pipeerr %d (expect %d)%s\n", i,
+		spec, adc1soa.pipeerr[i], err, (ret != 0) ? " FAIL" : "");
+
+	adc1channelstuff[i].xprms = xprms;
+	adc1channelstuff[i].fpw   = fpw;
+	adcparams_reload();
+	return ret;
+}
+/* *************************************************************************
+ * static int qreject(int i, uint8_t calibtype, uint8_t filttype, uint8_t comptype, int8_t err);
+ * @brief	: Channel 'i' set up with the codes must be refused with 'err'
+ * @return	: 0 = refused as expected; 1 = not
+ * *************************************************************************/
+static int qreject(int i, uint8_t calibtype, uint8_t filttype, uint8_t comptype, int8_t err)
+{
+	struct ADCPARAM xprms = adc1channelstuff[i].xprms;
+	int ret;
+
+	adc1channelstuff[i].xprms.calibtype = calibtype;
+	adc1channelstuff[i].xprms.filttype  = filttype;
+	adc1channelstuff[i].xprms.comptype  = comptype;
+	adc1channelstuff[i].xprms.qfrac     = 8;
+	adcparams_reload();
+	ret = ((adc1soa.pipeerr[i] != err) || (adc1channelstuff[i].pipe.nstage != 0));
+	printf("chan %d calibtype %u filttype %u comptype %u: pipeerr %d (expect %d)%s\n", i,
+		calibtype, filttype, comptype, adc1soa.pipeerr[i], err, (ret != 0) ? " FAIL" : "");
+
+	adc1channelstuff[i].xprms = xprms;
+	adcparams_reload();
+	return ret;
+}
+#if (ADCDECIMMAX < 0xffff)
+/* *************************************************************************
+ * static int decreject(int i, uint16_t decim);
+ * @brief	: Channel 'i' with 'decim' must be refused with ADCPIPEERR_DECIM
+ * @return	: 0 = refused as expected; 1 = not
+ * *************************************************************************/
+static int decreject(int i, uint16_t decim)
+{
+	uint16_t save = adc1channelstuff[i].xprms.decim;
+	int ret;
+
+	adc1channelstuff[i].xprms.decim = decim;
+	adcparams_reload();
+	ret = ((adc1soa.pipeerr[i] != ADCPIPEERR_DECIM) || (adc1channelstuff[i].pipe.nstage != 0) ||
+	       (adc1soa.decn[i] > ADCDECIMMAX));
+	printf("chan %d decim %u (max %u): pipeerr %d (expect %d)%s\n", i, decim, (unsigned int)ADCDECIMMAX,
+		adc1soa.pipeerr[i], ADCPIPEERR_DECIM, (ret != 0) ? " FAIL" : "");
+
+	adc1channelstuff[i].xprms.decim = save;
+	adcparams_reload();
+	return ret;
+}
+#endif
+/* *************************************************************************
+ * int hostqcheck(const char* arg);
+ * @brief	: Fixed-point vs. float path error for each channel; iir_q1 step (see top of file)
+ * @param	: arg = not used
+ * @return	: 0 = all within QCHECKLSB; 1 = not
+ * *************************************************************************/
+int hostqcheck(const char* arg)
+{
+	static const uint32_t r[3] = { (1 << 30), (uint32_t)(0.95 * (1 << 30)), (uint32_t)(1.05 * (1 << 30)) };
+	static const double iirc[4] = { 0.5, 0.9, 0.99, 0.999 };
+	double err;
+	double lsb;
+	uint8_t qfrac;
+	int ret = 0;
+	int i;
+	int j;
+
+	adcparams_init();
+
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{ // Vref, temperature, and 5v are done in adcparams_internal
+		if ((i == ADC1IDX_INTERNALVREF) || (i == ADC1IDX_INTERNALTEMP) ||
+		    (i == ADC1IDX_5VOLTSUPPLY)) continue;
+
+		for (j = 0; j < 3; j++)
+		{
+			err = adcparams_qcheck(i, r[j], &qfrac);
+			if (err < 0)
+			{
+				printf("chan %d r %.2f: no fixed-point equivalent\n", i, (double)r[j] / (1 << 30));
+				continue;
+			}
+			lsb = 1.0 / (double)((uint64_t)1 << qfrac);
+			printf("chan %d r %.2f: qfrac %2u maxerr %.3g (%.2f lsb)%s\n", i, (double)r[j] / (1 << 30),
+				qfrac, err, err / lsb, (err > QCHECKLSB * lsb) ? " FAIL" : "");
+			if (err > QCHECKLSB * lsb) ret = 1;
+		}
+	}
+
+	for (j = 0; j < 4; j++)
+	{
+		ret |= iirqstep(iirc[j],  IIRQSTEP);
+		ret |= iirqstep(iirc[j], -IIRQSTEP);
+	}
+
+	for (j = 0; j < IIRSPECNUM; j++)
+	{
+		if (iirspec[j].type != IIRSPECTYPE_BQ) continue;
+		ret |= bqqcheck(j,  IIRQSTEP, 0);
+		ret |= bqqcheck(j, -IIRQSTEP, 0);
+		ret |= bqqcheck(j,  IIRQSTEP, 1);
+	}
+
+	ret |= qbqchan(ADC1IDX_HALLLEVER, IIRSPEC_ADCLP4, 0);
+	ret |= qbqchan(ADC1IDX_HALLLEVER, IIRSPEC_ADCF1, ADCPIPEERR_FILT); // Not a biquad spec
+	ret |= qreject(ADC1IDX_HALLLEVER, ADC1PARAM_CALIBTYPE_POLY2_Q, ADCFILTERTYPE_FIR,
+		ADC1PARAM_COMPTYPE_RATIOVDD, ADCPIPEERR_QFILT);
+	ret |= qreject(ADC1IDX_HALLLEVER, ADC1PARAM_CALIBTYPE_POLY3_Q, ADCFILTERTYPE_MEDIAN,
+		ADC1PARAM_COMPTYPE_RATIOVDD, ADCPIPEERR_QFILT);
+	ret |= qreject(ADC1IDX_HALLLEVER, ADC1PARAM_CALIBTYPE_OFSC, ADCFILTERTYPE_IIR1,
+		ADC1PARAM_COMPTYPE_VOLTV5, ADCPIPEERR_COMP);
+	ret |= qreject(ADC1IDX_HALLLEVER, ADC1PARAM_CALIBTYPE_OFSC_Q, ADCFILTERTYPE_IIR1,
+		ADC1PARAM_COMPTYPE_VOLTV5, ADCPIPEERR_COMP);
+#if (ADCDECIMMAX < 0xffff)
+	ret |= decreject(ADC1IDX_HALLLEVER, ADCDECIMMAX + 1);
+#endif
+	return ret;
+}
+/* *************************************************************************
+ * Snapshot stress (see top of file)
+ * *************************************************************************/
+static volatile int snapstop;   // 1 = threads quit
+static uint32_t snaptorn[SNAPREADERS + 1]; // Torn copies (last = control)
+static uint32_t snapreads[SNAPREADERS + 1];// Copies checked
+
+/* Value of each field for writer count 'k' (floats exact: < 2^24) */
+#define SNAPF(k,i) ((float)(((k) & 0xffff) + (i)))
+
+/* Writer: every field of the set from one count, then publish. */
+static void* snapwriter(void* arg)
+{
+	uint32_t k = 0;
+	int i;
+
+	while (snapstop == 0)
+	{
+		k += 1;
+		for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+		{
+			adc1data.adc1calreading[i].f     = SNAPF(k, i);
+			adc1data.adc1calreadingfilt[i].f = SNAPF(k, i + 1);
+			adc1data.adcs1sum[i]   = k + i;
+			adc1data.adcs1sumsq[i] = k ^ i;
+			adc1data.adcs1min[i]   = (uint16_t)(k + i);
+			adc1data.adcs1max[i]   = (uint16_t)(k - i);
+		}
+		adcommon.fvdd          = SNAPF(k, 20);
+		adcommon.fvddfilt      = SNAPF(k, 21);
+		adcommon.degC          = SNAPF(k, 22);
+		adcommon.degCfilt      = SNAPF(k, 23);
+		adcommon.f5_Vddratio   = SNAPF(k, 24);
+		adcommon.f5vsupply     = SNAPF(k, 25);
+		adcommon.f5vsupplyfilt = SNAPF(k, 26);
+		adcommon.ivdd          = (uint16_t)k;
+		adcommon.qdegCfilt     = (int32_t)(k * 5);
+		adcommon.dmact         = k * 3;
+		adc1data.ctr           = k;
+		adcsnap_publish();
+	}
+	return arg;
+}
+/* Number of fields in 'p' that did not come from count p->ctr */
+static int snapbad(struct ADCSNAP* p)
+{
+	uint32_t k = p->ctr;
+	int bad = 0;
+	int i;
+
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		bad += (p->cal[i].f     != SNAPF(k, i));
+		bad += (p->calfilt[i].f != SNAPF(k, i + 1));
+		bad += (p->sum[i]   != k + i);
+		bad += (p->sumsq[i] != (k ^ i));
+		bad += (p->min[i]   != (uint16_t)(k + i));
+		bad += (p->max[i]   != (uint16_t)(k - i));
+	}
+	bad += (p->fvdd          != SNAPF(k, 20));
+	bad += (p->fvddfilt      != SNAPF(k, 21));
+	bad += (p->degC          != SNAPF(k, 22));
+	bad += (p->degCfilt      != SNAPF(k, 23));
+	bad += (p->f5_Vddratio   != SNAPF(k, 24));
+	bad += (p->f5vsupply     != SNAPF(k, 25));
+	bad += (p->f5vsupplyfilt != SNAPF(k, 26));
+	bad += (p->ivdd          != (uint16_t)k);
+	bad += (p->qdegCfilt     != (int32_t)(k * 5));
+	bad += (p->dmact         != k * 3);
+	return bad;
+}
+/* Reader: adcsnap_read copies; 'arg' = index in snaptorn/snapreads */
+static void* snapreader(void* arg)
+{
+	int n = (int)(intptr_t)arg;
+	struct ADCSNAP snap;
+
+	while (snapstop == 0)
+	{
+		if (adcsnap_read(&snap) == 0) continue; // Nothing published yet
+		snapreads[n] += 1;
+		if (snapbad(&snap) != 0) snaptorn[n] += 1;
+	}
+	return arg;
+}
+/* Control: copy adc1data/adcommon directly, no adcsnap */
+static void* snapcontrol(void* arg)
+{
+	struct ADCSNAP snap;
+
+	while (snapstop == 0)
+	{
+		snap.ctr = adc1data.ctr;
+		memcpy(snap.cal,     (void*)adc1data.adc1calreading,     sizeof(snap.cal));
+		memcpy(snap.calfilt, (void*)adc1data.adc1calreadingfilt, sizeof(snap.calfilt));
+		memcpy(snap.sum,     (void*)adc1data.adcs1sum,   sizeof(snap.sum));
+		memcpy(snap.sumsq,   (void*)adc1data.adcs1sumsq, sizeof(snap.sumsq));
+		memcpy(snap.min,     (void*)adc1data.adcs1min,   sizeof(snap.min));
+		memcpy(snap.max,     (void*)adc1data.adcs1max,   sizeof(snap.max));
+		snap.fvdd          = adcommon.fvdd;
+		snap.fvddfilt      = adcommon.fvddfilt;
+		snap.degC          = adcommon.degC;
+		snap.degCfilt      = adcommon.degCfilt;
+		snap.f5_Vddratio   = adcommon.f5_Vddratio;
+		snap.f5vsupply     = adcommon.f5vsupply;
+		snap.f5vsupplyfilt = adcommon.f5vsupplyfilt;
+		snap.ivdd          = adcommon.ivdd;
+		snap.qdegCfilt     = adcommon.qdegCfilt;
+		snap.dmact         = adcommon.dmact;
+		if (snap.ctr == 0) continue;
+		snapreads[SNAPREADERS] += 1;
+		if (snapbad(&snap) != 0) snaptorn[SNAPREADERS] += 1;
+	}
+	return arg;
+}
+/* *************************************************************************
+ * int hostsnapstress(const char* arg);
+ * @brief	: adcsnap writer vs. readers on threads (see top of file)
+ * @param	: arg = run time, secs (NULL = 5)
+ * @return	: 0 = no torn adcsnap_read copies; 1 = some
+ * *************************************************************************/
+int hostsnapstress(const char* arg)
+{
+	uint32_t secs = (arg != NULL) ? strtoul(arg, NULL, 0) : 5;
+	pthread_t tw;
+	pthread_t tr[SNAPREADERS + 1];
+	int ret = 0;
+	int i;
+
+	pthread_create(&tw, NULL, snapwriter, NULL);
+	for (i = 0; i < SNAPREADERS; i++)
+		pthread_create(&tr[i], NULL, snapreader, (void*)(intptr_t)i);
+	pthread_create(&tr[SNAPREADERS], NULL, snapcontrol, NULL);
+
+	sleep(secs);
+	snapstop = 1;
+	pthread_join(tw, NULL);
+	for (i = 0; i <= SNAPREADERS; i++)
+		pthread_join(tr[i], NULL);
+
+	printf("publishes %u, reader retries %u\n", (unsigned int)(adcsnapdb.seq >> 1),
+		(unsigned int)adcsnapdb.retry);
+	for (i = 0; i < SNAPREADERS; i++)
+	{
+		printf("adcsnap_read %d: %10u copies, %u torn%s\n", i, (unsigned int)snapreads[i],
+			(unsigned int)snaptorn[i], (snaptorn[i] != 0) ? " FAIL" : "");
+		if (snaptorn[i] != 0) ret = 1;
+	}
+	printf("control (direct): %10u copies, %u torn\n", (unsigned int)snapreads[SNAPREADERS],
+		(unsigned int)snaptorn[SNAPREADERS]);
+	return ret;
+}
+/* *************************************************************************
+ * static void sumfill(uint16_t* pdma, int pat);
+ * @brief	: Fill a 1/2 dma buffer with a test pattern
+ * @param	: pdma = pointer to 1/2 dma buffer
+ * @param	: pat = 0 noise, 1 all 0, 2 all 4095, 3 alternating 0/4095
+ * *************************************************************************/
+static void sumfill(uint16_t* pdma, int pat)
+{
+	int i;
+	for (i = 0; i < (ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE); i++)
+	{
+		switch (pat)
+		{
+		case 0: pdma[i] = rand() & 0xfff; break;
+		case 1: pdma[i] = 0; break;
+		case 2: pdma[i] = 4095; break;
+		default: pdma[i] = ((i / ADC1IDX_ADCSCANSIZE) & 1) ? 4095 : 0; break;
+		}
+	}
+	return;
+}
+/* *************************************************************************
+ * int hostsumcheck(const char* arg);
+ * @brief	: adcfastsum packed vs. C: same results, ticks (see top of file)
+ * @param	: arg = not used
+ * @return	: 0 = all results the same; 1 = not
+ * *************************************************************************/
+int hostsumcheck(const char* arg)
+{
+#ifdef ADCFASTSUM_PACKED
+	static const char* patname[4] = {"noise", "all 0", "all 4095", "0/4095"};
+	static uint16_t dma[ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE] __attribute__((aligned(4)));
+	static struct ADC1DATA st[2]; // [0] packed, [1] C
+	uint32_t sum[2][ADC1IDX_ADCSCANSIZE];
+	uint32_t t0;
+	uint32_t dt[4];
+	int bad;
+	int ret = 0;
+	int pat;
+	int k;
+	int n;
+
+	srand(1);
+	for (pat = 0; pat < 4; pat++)
+	{
+		sumfill(dma, pat);
+		adcfastsum_simd(sum[0], dma);
+		adcfastsum_c(sum[1], dma);
+		adcfastsum_stat_simd(&st[0], dma);
+		adcfastsum_stat_c(&st[1], dma);
+
+		bad = 0;
+		for (k = 0; k < ADC1IDX_ADCSCANSIZE; k++)
+		{
+			if ((sum[0][k] != sum[1][k]) ||
+			    (st[0].adcs1sum[k]   != st[1].adcs1sum[k])   ||
+			    (st[0].adcs1sum[k]   != sum[1][k])           ||
+			    (st[0].adcs1sumsq[k] != st[1].adcs1sumsq[k]) ||
+			    (st[0].adcs1min[k]   != st[1].adcs1min[k])   ||
+			    (st[0].adcs1max[k]   != st[1].adcs1max[k]))
+			{
+				printf("  %-8s chan %d: sum %u/%u stat sum %u/%u sq %u/%u min %u/%u max %u/%u\n",
+					patname[pat], k,
+					(unsigned int)sum[0][k], (unsigned int)sum[1][k],
+					(unsigned int)st[0].adcs1sum[k], (unsigned int)st[1].adcs1sum[k],
+					(unsigned int)st[0].adcs1sumsq[k], (unsigned int)st[1].adcs1sumsq[k],
+					st[0].adcs1min[k], st[1].adcs1min[k],
+					st[0].adcs1max[k], st[1].adcs1max[k]);
+				bad += 1;
+			}
+		}
+		printf("%-8s: %s\n", patname[pat], (bad == 0) ? "packed = C" : "FAIL");
+		if (bad != 0) ret = 1;
+	}
+
+	/* Ticks per call, noise in */
+	sumfill(dma, 0);
+	t0 = DTWTIME;
+	for (n = 0; n < SUMBENCHN; n++) adcfastsum_simd(sum[0], dma);
+	dt[0] = DTWTIME - t0;
+	t0 = DTWTIME;
+	for (n = 0; n < SUMBENCHN; n++) adcfastsum_c(sum[1], dma);
+	dt[1] = DTWTIME - t0;
+	t0 = DTWTIME;
+	for (n = 0; n < SUMBENCHN; n++) adcfastsum_stat_simd(&st[0], dma);
+	dt[2] = DTWTIME - t0;
+	t0 = DTWTIME;
+	for (n = 0; n < SUMBENCHN; n++) adcfastsum_stat_c(&st[1], dma);
+	dt[3] = DTWTIME - t0;
+
+	printf("ticks/call (%d scans x %d chans): sum packed %.1f C %.1f, stat packed %.1f C %.1f\n",
+		ADC1DMANUMSEQ, ADC1IDX_ADCSCANSIZE,
+		(double)dt[0] / SUMBENCHN, (double)dt[1] / SUMBENCHN,
+		(double)dt[2] / SUMBENCHN, (double)dt[3] / SUMBENCHN);
+	return ret;
+#else
+	printf("ADC1IDX_ADCSCANSIZE %d is odd: no packed adcfastsum\n", ADC1IDX_ADCSCANSIZE);
+	return 0;
+#endif
+}
+/* *************************************************************************
+ * int hostpipebench(const char* arg);
+ * @brief	: Channel pipeline ticks and fused cache rebuilds (see top of file)
+ * @param	: arg = not used
+ * @return	: 0
+ * *************************************************************************/
+int hostpipebench(const char* arg)
+{
+	/* Same levels as the host_main stimulus */
+	static const uint16_t level[ADC1IDX_ADCSCANSIZE] =
+	{ 2048, 1850, 1700, 1720, 0, 2100, 2730, 3100, 955, 1501 };
+	static uint16_t dma[ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE] __attribute__((aligned(4)));
+	uint32_t seq0[ADC1PARAM_COMPTYPE_NUM];
+	uint32_t lfsr = 0xACE1u;
+	uint32_t ready;
+	uint32_t t0;
+	uint64_t dtint = 0;
+	uint64_t dtall = 0;
+	uint32_t nused = 0; // Bit per comptype some channel uses
+	int i;
+	int j;
+	int n;
+
+	adcparams_init();
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		if (adc1channelstuff[i].pipe.nstage != 0)
+			nused |= (1 << adc1channelstuff[i].xprms.comptype);
+	}
+
+	for (n = 0; n < PIPEBENCHWARM + PIPEBENCHN; n++)
+	{
+		if (n == PIPEBENCHWARM)
+		{
+			for (j = 0; j < ADC1PARAM_COMPTYPE_NUM; j++) seq0[j] = adcommon.compseq[j];
+			dtint = 0; dtall = 0;
+		}
+		for (i = 0; i < (ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE); i++)
+		{
+			lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+			dma[i] = level[i % ADC1IDX_ADCSCANSIZE] + (lfsr & 0x7);
+		}
+		adcfastsum_stat(&adc1data, dma);
+		ready = adcparams_decimate(&adc1data, dma);
+		t0 = DTWTIME;
+		adcparams_internal(&adcommon, &adc1data);
+		dtint += (uint32_t)(DTWTIME - t0);
+		t0 = DTWTIME;
+		adcparams_all(ready);
+		dtall += (uint32_t)(DTWTIME - t0);
+	}
+#ifdef ADCPARAMS_NOFUSE
+	printf("ADCPARAMS_NOFUSE: separate load/comp/cal stages\n");
+#else
+	printf("fused load/comp/cal, per-comptype cache (ADCCOMPHYST %g)\n", (double)ADCCOMPHYST);
+#endif
+	printf("ticks per 1/2 buffer: adcparams_internal %.1f  adcparams_all %.1f\n",
+		(double)dtint / PIPEBENCHN, (double)dtall / PIPEBENCHN);
+	for (j = 0; j < ADC1PARAM_COMPTYPE_NUM; j++)
+	{
+		if ((nused & (1 << j)) == 0) continue;
+		printf("  comptype %d: compseq moved %u times in %d buffers\n", j,
+			(unsigned int)(adcommon.compseq[j] - seq0[j]), PIPEBENCHN);
+	}
+	return 0;
+}
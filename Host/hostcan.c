@@ -0,0 +1,570 @@
+/******************************************************************************
+* File Name          : hostcan.c
+* Date First Issued  : 10/18/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Host checks: CAN TX queue and mailboxes, HAL/direct, RX buffer
+*******************************************************************************/
+/*
+'host_main t' does not start the scheduler: the CAN TX pending queue
+(can_txq, FIFO per id) against the sorted linked list can_driver_put used
+before, at depths 8 to 253.  Each is filled to the depth, then TXQBENCHN
+times one msg is put and the next one to send is popped.  Three loads:
+random ids (from 32, so many repeats), every msg with the same id (the
+list's worst case: a new msg goes after all of them), and any of the 2048
+standard ids or an extended id on each (one per key, so the list's full id
+order is also can_txq's).  DTWTIME ticks per put and per pop, less the cost
+of reading DTWTIME: average and 99.9th percentile.
+Then a msg popped and put back with can_txq_requeue must come out ahead of
+the others with its id.  Exit status 1 if the two send in a different order
+(same id msgs must keep their order), or the requeued msg does not.
+
+'host_main b' does not start the scheduler: can_iface TX on CAN1 with one
+mailbox used (as before) and with all three, against 'halstub_can_bus' (one
+msg time per slot, the TX complete interrupt running 0 - 2 slots after the
+msg went out).  The queue is kept MBXBENCHQ deep with random ids (from 32)
+for MBXBENCHN slots.  Msgs per slot, idle slots, aborts, and the per-mailbox
+completion counts (txcplt).  Exit status 1 if any msg is lost or sent twice,
+or msgs with the same id go out of order.
+
+'host_main e [file]' does not start the scheduler: CANCHECKN pseudo-random
+msgs (any id bits, dlc 0 - 15) through CAN1 RX (1 - 3 at a time into a FIFO,
+then its interrupt), then CANCHECKN through TX (bursts of 1 - 3 on the bus
+model), with whichever can_iface.c path the build has (HAL, or direct
+registers with CANDIRECT=1).  The msgs as the firmware saw them (RX) and as
+they left the mailboxes (TX) are written to 'file' (default canframes.bin);
+'make cancheck' runs both builds and compares the files.  Exit status 1 if
+any differs from what the HAL would make of it (standard ids: only the STID
+and RTR bits), or a TX msg is lost.
+
+'host_main r' does not start the scheduler: the CAN1 RX circular buffer,
+RXRINGSIZE msgs, with three readers: one that takes everything after each
+interrupt, and two that take 0 - 4 at random (falling behind), one
+CANRXDROPOLD and one CANRXDROPNEW.  RXRINGN interrupts with 1 - 4 numbered
+msgs each (4 overruns the hardware FIFO).  Per reader: msgs taken, overruns,
+lag high-water mark.  Then a stall: the drop-newest reader takes nothing for
+RXRINGSIZE - 1 msgs while the others take each one.  Exit status 1 if a
+reader gets a msg out of order or twice; or the counts do not add up (each
+slow reader's taken + overruns, and the first reader's taken, are what went
+in the buffer, which with what the FIFO lost is all that was sent, and
+can_rx0err counted each FIFO overrun); or in the stall the drop-oldest reader
+loses any msg, or the drop-newest reader does not get the first
+RXRINGSIZE / 2 and then the newest.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hostcheck.h"
+#include "DTW_counter.h"
+#include "can_iface.h"
+#include "can_txq.h"
+
+#define TXQBENCHN (1 << 16) // CAN TX queue benchmark: put/pop pairs per depth
+#define MBXBENCHN (1 << 16) // CAN TX mailbox benchmark: bus slots per run
+#define MBXBENCHQ 16        // CAN TX mailbox benchmark: msgs kept queued
+#define CANCHECKN 4096      // CAN HAL/direct check: msgs each way
+#define RXRINGN 8192        // CAN RX buffer check: interrupts
+#define RXRINGSIZE 16       // CAN RX buffer check: circular buffer size (numrx)
+#define RXRINGRDRS 3        // CAN RX buffer check: readers
+
+/* *************************************************************************
+ * static void txqlist_put(struct CAN_POOLBLOCK* phead, struct CAN_POOLBLOCK* pnew);
+ * static struct CAN_POOLBLOCK* txqlist_pop(struct CAN_POOLBLOCK* phead);
+ * @brief	: Reference: the sorted linked list can_driver_put kept before can_txq
+ * *************************************************************************/
+static void txqlist_put(struct CAN_POOLBLOCK* phead, struct CAN_POOLBLOCK* pnew)
+{
+	volatile struct CAN_POOLBLOCK* pfor;
+	for (pfor = phead; pfor->plinknext != NULL; pfor = pfor->plinknext)
+	{
+		if (pnew->can.id < (pfor->plinknext)->can.id) break;
+	}
+	pnew->plinknext = pfor->plinknext;
+	pfor->plinknext = pnew;
+	return;
+}
+static struct CAN_POOLBLOCK* txqlist_pop(struct CAN_POOLBLOCK* phead)
+{
+	volatile struct CAN_POOLBLOCK* p = phead->plinknext;
+	if (p != NULL) phead->plinknext = p->plinknext;
+	return (struct CAN_POOLBLOCK*)p;
+}
+static int cmpu32(const void* a, const void* b)
+{
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+/* Average and 99.9th percentile of 'n' tick counts (sorts them) */
+static uint32_t txqdtw; // Ticks for reading DTWTIME back to back (subtracted)
+static void txqstat(uint32_t* pt, int n, double* pavg, uint32_t* pp999)
+{
+	double sum = 0;
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		pt[i] = (pt[i] > txqdtw) ? pt[i] - txqdtw : 0;
+		sum += pt[i];
+	}
+	qsort(pt, n, sizeof(uint32_t), cmpu32);
+	*pavg  = sum / n;
+	*pp999 = pt[(n * 999) / 1000];
+	return;
+}
+/* *************************************************************************
+ * int hosttxqbench(const char* arg);
+ * @brief	: CAN TX queue: can_txq vs. sorted list (see top of file)
+ * @return	: 0 = same send order; 1 = not
+ * *************************************************************************/
+#define TXQBENCHMAXD (CANTXQMAXPOOL - 1)
+static const char* txqload[3] = {"random ids", "one id    ", "std + ext "};
+#define TXQBENCHNDEPTH 6
+static const int txqdepth[TXQBENCHNDEPTH] = {8, 16, 32, 64, 128, TXQBENCHMAXD};
+/* Msg id for load 'w' (see top of file) */
+static uint32_t txqid(int w)
+{
+	uint32_t id;
+
+	if (w == 0) return ((uint32_t)(rand() & 31) * 37 + 0x100) << 21;
+	if (w == 1) return 0x345 << 21;
+	id = (uint32_t)(rand() & 2047);
+	if ((rand() & 1) == 0) return id << 21;
+	return (id << 21) | (((id * 0x2f1) & 0x3ffff) << 3) | CAN_ID_EXT; // One extended id per key
+}
+int hosttxqbench(const char* arg)
+{
+	static struct CAN_POOLBLOCK blkl[TXQBENCHMAXD + 1]; // List
+	static struct CAN_POOLBLOCK blkh[TXQBENCHMAXD + 1]; // can_txq
+	static uint32_t tputl[TXQBENCHN], tpopl[TXQBENCHN];
+	static uint32_t tputh[TXQBENCHN], tpoph[TXQBENCHN];
+	static struct CANTXQ q;
+	struct CAN_POOLBLOCK headl;
+	struct CAN_POOLBLOCK* pl;
+	struct CAN_POOLBLOCK* ph;
+	double avg[4];
+	uint32_t p999[4];
+	uint32_t t0;
+	uint32_t id;
+	uint32_t serial;
+	uint32_t bad;
+	int ret = 0;
+	int w;
+	int d;
+	int j;
+	int k;
+
+	/* Cost of the timing itself: median of back to back reads */
+	for (k = 0; k < TXQBENCHN; k++)
+	{
+		t0 = DTWTIME;
+		tputl[k] = DTWTIME - t0;
+	}
+	qsort(tputl, TXQBENCHN, sizeof(uint32_t), cmpu32);
+	txqdtw = tputl[TXQBENCHN / 2];
+	printf("DTWTIME read: %u ticks (subtracted)\n", (unsigned int)txqdtw);
+
+	for (w = 0; w < 3; w++)
+	for (j = 0; j < TXQBENCHNDEPTH; j++)
+	{
+		d = txqdepth[j];
+		srand(d);
+		memset(blkl, 0, sizeof(blkl));
+		memset(blkh, 0, sizeof(blkh));
+		headl.plinknext = NULL;
+		if (can_txq_init(&q, blkh, d + 1) != 0) return 1;
+		serial = 0;
+
+		/* Fill to depth 'd' */
+		for (k = 0; k < d; k++)
+		{
+			id = txqid(w);
+			blkl[k].can.id = blkh[k].can.id = id;
+			blkl[k].can.cd.ui[0] = blkh[k].can.cd.ui[0] = serial++;
+			txqlist_put(&headl, &blkl[k]);
+			can_txq_put(&q, &blkh[k]);
+		}
+		pl = &blkl[d]; // Spare block
+		ph = &blkh[d];
+
+		/* Steady state: put one, pop one (the popped block is the next spare) */
+		bad = 0;
+		for (k = 0; k < TXQBENCHN; k++)
+		{
+			id = txqid(w);
+			pl->can.id = ph->can.id = id;
+			pl->can.cd.ui[0] = ph->can.cd.ui[0] = serial++;
+
+			t0 = DTWTIME;
+			txqlist_put(&headl, pl);
+			tputl[k] = DTWTIME - t0;
+			t0 = DTWTIME;
+			pl = txqlist_pop(&headl);
+			tpopl[k] = DTWTIME - t0;
+
+			t0 = DTWTIME;
+			can_txq_put(&q, ph);
+			tputh[k] = DTWTIME - t0;
+			t0 = DTWTIME;
+			ph = (struct CAN_POOLBLOCK*)can_txq_pop(&q);
+			tpoph[k] = DTWTIME - t0;
+
+			if ((pl->can.id != ph->can.id) || (pl->can.cd.ui[0] != ph->can.cd.ui[0])) bad += 1;
+		}
+		/* Drain: the rest must come out the same too */
+		for (k = 0; k < d; k++)
+		{
+			pl = txqlist_pop(&headl);
+			ph = (struct CAN_POOLBLOCK*)can_txq_pop(&q);
+			if ((pl == NULL) || (ph == NULL) || (pl->can.cd.ui[0] != ph->can.cd.ui[0])) bad += 1;
+		}
+		if ((txqlist_pop(&headl) != NULL) || (can_txq_pop(&q) != NULL)) bad += 1;
+
+		txqstat(tputl, TXQBENCHN, &avg[0], &p999[0]);
+		txqstat(tpopl, TXQBENCHN, &avg[1], &p999[1]);
+		txqstat(tputh, TXQBENCHN, &avg[2], &p999[2]);
+		txqstat(tpoph, TXQBENCHN, &avg[3], &p999[3]);
+		printf("%s depth %3d: put list %7.1f (99.9%% %5u) txq %6.1f (99.9%% %4u); "
+			"pop list %5.1f (99.9%% %4u) txq %6.1f (99.9%% %4u); order differs %u%s\n",
+			txqload[w], d, avg[0], (unsigned int)p999[0], avg[2], (unsigned int)p999[2],
+			avg[1], (unsigned int)p999[1], avg[3], (unsigned int)p999[3],
+			(unsigned int)bad, (bad != 0) ? " FAIL" : "");
+		if (bad != 0) ret = 1;
+	}
+
+	/* requeue: a msg popped and put back is ahead of the rest with its id,
+	   a lower priority id stays behind them, a higher one goes ahead. */
+	memset(blkh, 0, sizeof(blkh));
+	can_txq_init(&q, blkh, 5);
+	for (k = 0; k < 4; k++)
+	{
+		blkh[k].can.id = ((k < 3) ? 0x345 : 0x346) << 21;
+		blkh[k].can.cd.ui[0] = k;
+		can_txq_put(&q, &blkh[k]);
+	}
+	ph = (struct CAN_POOLBLOCK*)can_txq_pop(&q);
+	blkh[4].can.id = 0x344 << 21;
+	blkh[4].can.cd.ui[0] = 4;
+	can_txq_put(&q, &blkh[4]);
+	can_txq_requeue(&q, ph);
+	bad = 0;
+	for (k = 0; k < 5; k++)
+	{
+		ph = (struct CAN_POOLBLOCK*)can_txq_pop(&q);
+		if ((ph == NULL) || (ph->can.cd.ui[0] != (uint32_t)((k == 0) ? 4 : k - 1))) bad += 1;
+	}
+	if (can_txq_pop(&q) != NULL) bad += 1;
+	printf("requeue: order differs %u%s\n", (unsigned int)bad, (bad != 0) ? " FAIL" : "");
+	if (bad != 0) ret = 1;
+	return ret;
+}
+/* *************************************************************************
+ * int hostmbxbench(const char* arg);
+ * @brief	: CAN TX: one mailbox vs. three, with a late TX interrupt (see top of file)
+ * @return	: 0 = every msg sent once, in order for its id; 1 = not
+ * *************************************************************************/
+int hostmbxbench(const char* arg)
+{
+	static const uint8_t nmbx[2] = {1, CANTXMBX};
+	uint32_t nextput[32]; // Per id: next serial to put
+	uint32_t nextget[32]; // Per id: next serial expected out
+	struct CAN_CTLBLOCK* pctl;
+	struct CANRCVBUF can;
+	uint32_t put;
+	uint32_t sent;
+	uint32_t nrun;  // Msgs sent in the MBXBENCHN slots
+	uint32_t idle;
+	uint32_t abrt;
+	uint32_t bad;
+	uint32_t s;
+	int ret = 0;
+	int lat;
+	int m;
+	int k;
+
+	hcan1.Instance = &can1regs;
+	pctl = can_iface_init(&hcan1, 0, MBXBENCHQ + CANTXMBX, 16);
+	if ((pctl == NULL) || (pctl->ret < 0)) return 1;
+	HAL_CAN_Start(&hcan1);
+
+	for (m = 0; m < 2; m++)
+	for (lat = 0; lat <= 2; lat++)
+	{
+		srand(lat + 1);
+		pctl->ntxmbx = nmbx[m]; // (All mailboxes are empty between runs)
+		memset(pctl->txcplt, 0, sizeof(pctl->txcplt));
+		memset(nextput, 0, sizeof(nextput));
+		memset(nextget, 0, sizeof(nextget));
+		abrt = halstubct.cantxabort;
+		put = sent = idle = bad = 0;
+
+		nrun = 0;
+		for (s = 0; s < MBXBENCHN + 4 * MBXBENCHQ; s++)
+		{
+			/* Keep the queue topped up (after MBXBENCHN slots, drain it) */
+			if (s == MBXBENCHN) nrun = sent;
+			while ((s < MBXBENCHN) && ((put - sent) < MBXBENCHQ))
+			{
+				k = rand() & 31;
+				can.id  = (uint32_t)(k * 37 + 0x100) << 21;
+				can.dlc = 8;
+				can.cd.ui[0] = nextput[k]++;
+				can.cd.ui[1] = k;
+				if (can_driver_put(pctl, &can, 4, 0) != 0) { bad += 1; break; }
+				put += 1;
+			}
+			k = halstub_can_bus(&hcan1, 1, lat);
+			if (s < MBXBENCHN) idle += k;
+
+			while (halstub_can_get_tx(&hcan1, &can) == 0)
+			{
+				k = can.cd.ui[1] & 31;
+				if (can.cd.ui[0] != nextget[k]) bad += 1; // Lost, repeated, or out of order
+				nextget[k] = can.cd.ui[0] + 1;
+				sent += 1;
+			}
+		}
+		if (sent != put) bad += 1;
+
+		printf("mailboxes %d, TX interrupt %d slot(s) late: %.3f msgs/slot (%u idle of %u); "
+			"aborts %u; txcplt %u %u %u; errors %u%s\n",
+			nmbx[m], lat, (double)nrun / MBXBENCHN, (unsigned int)idle, (unsigned int)MBXBENCHN,
+			(unsigned int)(halstubct.cantxabort - abrt),
+			(unsigned int)pctl->txcplt[0], (unsigned int)pctl->txcplt[1], (unsigned int)pctl->txcplt[2],
+			(unsigned int)bad, (bad != 0) ? " FAIL" : "");
+		if (bad != 0) ret = 1;
+	}
+	return ret;
+}
+/* *************************************************************************
+ * int hostcancheck(const char* arg);
+ * @brief	: CAN RX & TX through can_iface, frames to a file (see top of file)
+ * @param	: arg = output file (NULL = canframes.bin)
+ * @return	: 0 = all as the HAL path makes them; 1 = not (or file error)
+ * *************************************************************************/
+static uint32_t cclcg; // Same sequence every run, every build
+static uint32_t ccrand(void)
+{
+	cclcg = cclcg * 1664525 + 1013904223;
+	return cclcg;
+}
+/* Msg id as HAL_CAN_GetRxMessage/canmsg_compress or HAL_CAN_AddTxMessage leave it */
+static uint32_t cchalid(uint32_t id)
+{
+	if ((id & CAN_ID_EXT) != 0) return (id & ~0x1);
+	return (id & (CAN_TI0R_STID | CAN_TI0R_RTR));
+}
+static int ccsame(struct CANRCVBUF* pa, struct CANRCVBUF* pb)
+{
+	return ((pa->id == cchalid(pb->id)) && (pa->dlc == (pb->dlc & 0xf)) &&
+		(pa->cd.ui[0] == pb->cd.ui[0]) && (pa->cd.ui[1] == pb->cd.ui[1]));
+}
+int hostcancheck(const char* arg)
+{
+	const char* fname = (arg != NULL) ? arg : "canframes.bin";
+	static struct CANRCVBUF rx[CANCHECKN]; // As the firmware got them
+	static struct CANRCVBUF tx[CANCHECKN]; // As they left the mailboxes
+	struct CANRCVBUF in[3];
+	struct CANRCVBUF can;
+	struct CAN_CTLBLOCK* pctl;
+	struct CANTAKEPTR* ptake;
+	struct CANRCVBUFN* pn;
+	uint32_t nrx = 0;
+	uint32_t ntx = 0;
+	uint32_t bad = 0;
+	uint32_t s;
+	FILE* fp;
+	int n;
+	int f;
+	int j;
+	int k;
+
+	hcan1.Instance = &can1regs;
+	pctl = can_iface_init(&hcan1, 0, 8, 64);
+	if ((pctl == NULL) || (pctl->ret < 0)) return 1;
+	ptake = can_iface_add_take(pctl);
+	if (ptake == NULL) return 1;
+	HAL_CAN_Start(&hcan1);
+	cclcg = 1;
+
+	/* RX: any bits in the id (standard ids with junk in the extended field) */
+	for (k = 0; k < CANCHECKN; k += n)
+	{
+		f = ccrand() & 1;
+		n = 1 + (ccrand() % 3);
+		if (n > (CANCHECKN - k)) n = CANCHECKN - k;
+		for (j = 0; j < n; j++)
+		{
+			in[j].id  = ccrand();
+			in[j].dlc = ccrand() & 0xf;
+			in[j].cd.ui[0] = ccrand();
+			in[j].cd.ui[1] = ccrand();
+			halstub_can_inject(&hcan1, (f == 0) ? CAN_RX_FIFO0 : CAN_RX_FIFO1, &in[j]);
+		}
+		halstub_can_isr(&hcan1, 0);
+		for (j = 0; (pn = can_iface_get_CANmsg(ptake)) != NULL; j++)
+		{
+			if (nrx < CANCHECKN) rx[nrx++] = pn->can;
+			if ((j >= n) || !ccsame(&pn->can, &in[j])) bad += 1;
+		}
+		if (j != n) bad += 1;
+	}
+
+	/* TX: ids can_driver_put takes; a burst may go out in priority order */
+	for (k = 0; k < CANCHECKN; k += n)
+	{
+		n = 1 + (ccrand() % 3);
+		if (n > (CANCHECKN - k)) n = CANCHECKN - k;
+		for (j = 0; j < n; j++)
+		{
+			in[j].id  = cchalid(ccrand());
+			in[j].dlc = ccrand() & 0xf;
+			in[j].cd.ui[0] = ccrand();
+			in[j].cd.ui[1] = ccrand();
+			if (can_driver_put(pctl, &in[j], 4, 0) != 0) bad += 1;
+		}
+		for (s = 0; s < 8; s++)
+			halstub_can_bus(&hcan1, 1, (k >> 1) & 1); // (Interrupt on time, or a slot late)
+		while (halstub_can_get_tx(&hcan1, &can) == 0)
+		{
+			if (ntx < CANCHECKN) tx[ntx++] = can;
+			for (j = 0; j < n; j++)
+				if (ccsame(&can, &in[j])) break;
+			if (j >= n) bad += 1;
+		}
+	}
+	if (ntx != CANCHECKN) bad += 1;
+
+	fp = fopen(fname, "wb");
+	if (fp == NULL) { perror(fname); return 1; }
+	fwrite(rx, sizeof(struct CANRCVBUF), nrx, fp);
+	fwrite(tx, sizeof(struct CANRCVBUF), ntx, fp);
+	fclose(fp);
+
+#ifdef CHEATINGONHAL
+	printf("can_iface direct register path: ");
+#else
+	printf("can_iface HAL path: ");
+#endif
+	printf("RX %u, TX %u msgs to %s; not as the HAL makes them %u%s\n",
+		(unsigned int)nrx, (unsigned int)ntx, fname, (unsigned int)bad, (bad != 0) ? " FAIL" : "");
+	return (bad != 0);
+}
+/* *************************************************************************
+ * int hostrxringcheck(const char* arg);
+ * @brief	: CAN RX circular buffer readers: lag and overruns (see top of file)
+ * @return	: 0 = OK; 1 = a msg out of order, or counts do not add up
+ * *************************************************************************/
+int hostrxringcheck(const char* arg)
+{
+	static const char* name[RXRINGRDRS] = {"keeps up", "slow, drop oldest", "slow, drop newest"};
+	struct CAN_CTLBLOCK* pctl;
+	struct CANTAKEPTR* ptake[RXRINGRDRS];
+	struct CANRCVBUFN* pn;
+	struct CANRCVBUF can;
+	uint32_t nrx[RXRINGRDRS] = {0};
+	uint32_t last[RXRINGRDRS] = {0}; // Msg numbers start at 1
+	uint32_t exp[2];
+	uint32_t seq = 0;
+	uint32_t bad = 0;
+	uint32_t stall = 0;
+	uint32_t added;
+	uint32_t s0;
+	uint32_t ovr1;
+	uint32_t ovr2;
+	int n;
+	int j;
+	int k;
+	int r;
+
+	hcan1.Instance = &can1regs;
+	pctl = can_iface_init(&hcan1, 0, 4, RXRINGSIZE);
+	if ((pctl == NULL) || (pctl->ret < 0)) return 1;
+	for (r = 0; r < RXRINGRDRS; r++)
+	{
+		ptake[r] = can_iface_add_take(pctl);
+		if (ptake[r] == NULL) return 1;
+	}
+	ptake[2]->policy = CANRXDROPNEW;
+	HAL_CAN_Start(&hcan1);
+	cclcg = 1;
+	memset(&can, 0, sizeof(can));
+	can.id  = (0x123 << 21);
+	can.dlc = 8;
+
+	for (k = 0; k < RXRINGN; k++)
+	{
+		n = 1 + (ccrand() % 4);
+		for (j = 0; j < n; j++)
+		{
+			can.cd.ui[0] = ++seq;
+			halstub_can_inject(&hcan1, CAN_RX_FIFO0, &can);
+		}
+		halstub_can_isr(&hcan1, 0);
+
+		/* Reader 0 empties its queue; 1 and 2 take 0 - 4 (or all, the last time) */
+		for (r = 0; r < RXRINGRDRS; r++)
+		{
+			j = ((r == 0) || (k == (RXRINGN - 1))) ? RXRINGSIZE : (ccrand() % 5);
+			while ((j-- > 0) && ((pn = can_iface_get_CANmsg(ptake[r])) != NULL))
+			{
+				if (pn->can.cd.ui[0] <= last[r]) bad += 1; // Out of order, or again
+				last[r] = pn->can.cd.ui[0];
+				nrx[r] += 1;
+			}
+		}
+	}
+
+	added = nrx[0]; // Reader 0 never falls behind
+	if (ptake[0]->overrun != 0) bad += 1;
+	if ((nrx[1] + ptake[1]->overrun) != added) bad += 1;
+	if ((nrx[2] + ptake[2]->overrun) != added) bad += 1;
+	if ((added + halstubct.canrxovr) != seq) bad += 1;
+	if (pctl->can_errors.can_rx0err != halstubct.canrxovr) bad += 1; // (At most one lost per interrupt)
+
+	printf("RX buffer %u msgs, %u interrupts: %u msgs sent, %u lost in the FIFO (can_rx0err %u), %u added (can_msgovrflow %u)\n",
+		RXRINGSIZE, RXRINGN, (unsigned int)seq, (unsigned int)halstubct.canrxovr,
+		(unsigned int)pctl->can_errors.can_rx0err, (unsigned int)added,
+		(unsigned int)pctl->can_errors.can_msgovrflow);
+	for (r = 0; r < RXRINGRDRS; r++)
+	{
+		if (ptake[r]->lagmax > (RXRINGSIZE - 1)) bad += 1;
+		printf("reader %d (%s): taken %6u, overrun %6u, lag high-water %2u\n", r, name[r],
+			(unsigned int)nrx[r], (unsigned int)ptake[r]->overrun, (unsigned int)ptake[r]->lagmax);
+	}
+	if (ptake[2]->lagmax > (RXRINGSIZE / 2)) bad += 1;
+
+	/* Stall (all readers empty now): reader 2 takes nothing, one msg per
+	   interrupt, while 0 and 1 take each one as it comes. */
+	s0   = seq;
+	ovr1 = ptake[1]->overrun;
+	ovr2 = ptake[2]->overrun;
+	exp[0] = exp[1] = s0;
+	for (k = 0; k < (RXRINGSIZE - 1); k++)
+	{
+		can.cd.ui[0] = ++seq;
+		halstub_can_inject(&hcan1, CAN_RX_FIFO0, &can);
+		halstub_can_isr(&hcan1, 0);
+		for (r = 0; r < 2; r++)
+			while ((pn = can_iface_get_CANmsg(ptake[r])) != NULL)
+				if (pn->can.cd.ui[0] != ++exp[r]) stall += 1;
+	}
+	if ((exp[0] != seq) || (exp[1] != seq) || (ptake[1]->overrun != ovr1)) stall += 1;
+
+	/* Reader 2: the first half buffer it held, then the newest */
+	for (k = 1; (pn = can_iface_get_CANmsg(ptake[2])) != NULL; k++)
+		if (pn->can.cd.ui[0] != s0 + k) stall += 1;
+	if ((k - 1) != (RXRINGSIZE / 2)) stall += 1;
+	if ((ptake[2]->overrun - ovr2) != (RXRINGSIZE - 1 - RXRINGSIZE / 2)) stall += 1;
+	can.cd.ui[0] = ++seq;
+	halstub_can_inject(&hcan1, CAN_RX_FIFO0, &can);
+	halstub_can_isr(&hcan1, 0);
+	pn = can_iface_get_CANmsg(ptake[2]);
+	if ((pn == NULL) || (pn->can.cd.ui[0] != seq)) stall += 1;
+
+	printf("stall: drop-newest reader held %d, held out %u; drop-oldest reader lost %u%s\n",
+		k - 1, (unsigned int)(ptake[2]->overrun - ovr2), (unsigned int)(ptake[1]->overrun - ovr1),
+		(stall != 0) ? " FAIL" : "");
+	bad += stall;
+	if (bad != 0) printf("FAIL %u\n", (unsigned int)bad);
+	return (bad != 0);
+}
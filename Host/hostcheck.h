@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name          : hostcheck.h
+* Date First Issued  : 10/18/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Host build checks and benchmarks ('host_main <mode> [arg]')
+*******************************************************************************/
+/*
+Each runs in place of the normal host run, without starting the scheduler,
+and returns the exit status: 0 = OK, 1 = a check failed.  One file per
+subsystem, with a description of each at the top--
+
+  hostadc.c   q  fixed-point (_Q) path against the float path
+              s  adcsnap tear-free stress
+              a  adcfastsum packed (DSP) against C
+              p  channel pipelines: ticks, fused cache rebuilds
+  hostfilt.c  f  FIR (fir_poly) ticks and error
+              m  median_f / Hampel against a sorted array
+              i  IIR (iir_coef.c) step and gain
+  hostcan.c   t  CAN TX pending queue
+              b  CAN TX mailboxes on the bus model
+              e  CAN frames, HAL or direct register path
+              r  CAN RX buffer readers
+*/
+
+#ifndef __HOSTCHECK
+#define __HOSTCHECK
+
+#include <stdint.h>
+#include "stm32f4xx_hal.h"
+#include "hal_stubs.h"
+
+/* Globals 'main.c' supplies on the board (host_main.c) */
+extern ADC_HandleTypeDef hadc1;
+extern CAN_HandleTypeDef hcan1;
+extern CAN_HandleTypeDef hcan2;
+extern UART_HandleTypeDef huart2;
+extern UART_HandleTypeDef huart6;
+
+/* Host RAM standing in for the peripheral registers (hal_stubs.c) */
+#define can1regs   (*(CAN_TypeDef*)  HOSTPERIPH(CAN1_BASE))
+#define can2regs   (*(CAN_TypeDef*)  HOSTPERIPH(CAN2_BASE))
+#define usart2regs (*(USART_TypeDef*)HOSTPERIPH(USART2_BASE))
+#define usart6regs (*(USART_TypeDef*)HOSTPERIPH(USART6_BASE))
+#define adc1regs   (*(ADC_TypeDef*)  HOSTPERIPH(ADC1_BASE))
+
+/* hostadc.c */
+int hostqcheck(const char* arg);
+/* @brief	: Fixed-point vs. float path for each channel
+ * @param	: arg = not used
+ * @return	: 0 = OK; 1 = not
+ * *************************************************************************/
+int hostsnapstress(const char* arg);
+/* @brief	: adcsnap writer vs. readers on threads
+ * @param	: arg = run time, secs (NULL = 5)
+ * @return	: 0 = no torn adcsnap_read copies; 1 = some
+ * *************************************************************************/
+int hostsumcheck(const char* arg);
+/* @brief	: adcfastsum packed vs. C: same results, ticks per call
+ * @param	: arg = not used
+ * @return	: 0 = all results the same; 1 = not
+ * *************************************************************************/
+int hostpipebench(const char* arg);
+/* @brief	: Channel pipelines: ticks per 1/2 buffer, fused cache rebuilds
+ * @param	: arg = not used
+ * @return	: 0
+ * *************************************************************************/
+
+/* hostfilt.c */
+int hostfirbench(const char* arg);
+/* @brief	: fir_poly ticks per input/output and error
+ * @param	: arg = not used
+ * @return	: 0 = all within FIRBENCHERR; 1 = not
+ * *************************************************************************/
+int hostmedbench(const char* arg);
+/* @brief	: median_f against a sorted array; Hampel spikes
+ * @param	: arg = not used
+ * @return	: 0 = all medians as the reference; 1 = not
+ * *************************************************************************/
+int hostiircheck(const char* arg);
+/* @brief	: iir_coef.c filters run by the firmware code: step and gain
+ * @param	: arg = not used
+ * @return	: 0 = all within IIRCHECKSTEP, IIRCHECKDB; 1 = not
+ * *************************************************************************/
+
+/* hostcan.c */
+int hosttxqbench(const char* arg);
+/* @brief	: can_txq against the sorted list: ticks per put and pop
+ * @param	: arg = not used
+ * @return	: 0 = same send order; 1 = not
+ * *************************************************************************/
+int hostmbxbench(const char* arg);
+/* @brief	: can_iface TX, one and three mailboxes, on the bus model
+ * @param	: arg = not used
+ * @return	: 0 = no msg lost, sent twice, or out of order; 1 = some
+ * *************************************************************************/
+int hostcancheck(const char* arg);
+/* @brief	: CAN RX & TX through can_iface, frames to a file
+ * @param	: arg = output file (NULL = canframes.bin)
+ * @return	: 0 = all as the HAL path makes them; 1 = not (or file error)
+ * *************************************************************************/
+int hostrxringcheck(const char* arg);
+/* @brief	: CAN RX buffer readers: lag and overruns
+ * @param	: arg = not used
+ * @return	: 0 = OK; 1 = a msg out of order, or counts do not add up
+ * *************************************************************************/
+
+#endif
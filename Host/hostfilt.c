@@ -0,0 +1,318 @@
+/******************************************************************************
+* File Name          : hostfilt.c
+* Date First Issued  : 10/18/2026
+* Board              : Linux workstation (FreeRTOS POSIX port)
+* Description        : Host checks: FIR, median, and IIR filters
+*******************************************************************************/
+/*
+'host_main f' does not start the scheduler: each fir_coef.c filter is fed
+FIRBENCHN inputs of noise and the DTWTIME ticks per input and per output are
+printed, with the largest difference from a direct (not polyphase) double
+evaluation.  Exit status 1 if any exceeds FIRBENCHERR.
+
+'host_main m' does not start the scheduler: median_f for windows of 5 to
+63, on MEDBENCHN inputs.  Plain median: DTWTIME ticks per input, against a
+sorted-array (insert/delete by shifting) median as the reference for both
+time and value.  Hampel (3 MADs): a noisy sine with a spike on 1% of the
+inputs; spikes let through, good readings changed, and ticks per input.
+Exit status 1 if any median differs from the reference.
+
+'host_main i' does not start the scheduler: each iir_coef.c filter, run by
+the firmware code (iir_f1, iir_f2, iir_biquad) from its iirspec[]
+coefficients, against the response Host/iirgen.c checked at build time: the
+step response at the iirresp[] points, and the gain at each iirrespf[]
+frequency above -60 dB (sine in, amplitude of the output over 100 cycles).
+Exit status 1 if the step is off by more than IIRCHECKSTEP or a gain by more
+than IIRCHECKDB dB.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "hostcheck.h"
+#include "DTW_counter.h"
+#include "fir_coef.h"
+#include "median_f.h"
+#include "iir_coef.h"
+#include "iir_f1.h"
+#include "morse.h"
+
+#define FIRBENCHN (1 << 20) // FIR benchmark: inputs per filter
+#define FIRBENCHERR 1E-5    // FIR benchmark: max error vs. double (input +/-1)
+#define MEDBENCHN (1 << 18) // Median benchmark: inputs per window length
+#define IIRCHECKSTEP 1E-4   // IIR check: max step response error
+#define IIRCHECKDB   0.05   // IIR check: max gain error (dB)
+
+/* *************************************************************************
+ * int hostfirbench(const char* arg);
+ * @brief	: fir_poly ticks per input/output and error (see top of file)
+ * @return	: 0 = all within FIRBENCHERR; 1 = not
+ * *************************************************************************/
+int hostfirbench(const char* arg)
+{
+	static float x[FIRBENCHN];
+	static struct FIRPOLY fir;
+	const struct FIRPOLYSPEC* ps;
+	uint32_t t0;
+	uint32_t dt;
+	uint32_t nout;
+	double ref;
+	double err;
+	float y;
+	int ret = 0;
+	int s;
+	int n;
+	int i;
+	int k;
+
+	srand(1);
+	for (n = 0; n < FIRBENCHN; n++)
+		x[n] = 2.0f * ((float)rand() / (float)RAND_MAX) - 1.0f;
+
+	for (s = 0; s < FIRSPECNUM; s++)
+	{
+		ps = &firspec[s];
+		if (fir_poly_init(&fir, ps) != 0)
+		{
+			printf("spec %d: fir_poly_init failed\n", s);
+			return 1;
+		}
+
+		/* Timing: the filter alone */
+		nout = 0;
+		t0 = DTWTIME;
+		for (n = 0; n < FIRBENCHN; n++)
+			nout += fir_poly_in(&fir, x[n], &y);
+		dt = DTWTIME - t0;
+
+		/* Error: again from the start, each output against h[] direct form.
+		   h[i] is phase i % m, tap i / m; inputs before x[0] are x[0]. */
+		fir_poly_init(&fir, ps);
+		err = 0;
+		for (n = 0; n < FIRBENCHN; n++)
+		{
+			if (fir_poly_in(&fir, x[n], &y) == 0) continue;
+			ref = 0;
+			for (i = 0; i < ps->m * ps->l; i++)
+			{
+				k = n - i;
+				ref += (double)ps->ph[(i % ps->m) * ps->l + (i / ps->m)] * x[(k < 0) ? 0 : k];
+			}
+			if (fabs(ref - y) > err) err = fabs(ref - y);
+		}
+
+		printf("spec %d: %2u taps, m %u: %6.1f ticks/input %7.1f ticks/output, maxerr %.3g%s\n",
+			s, ps->ntap, ps->m, (double)dt / FIRBENCHN, (double)dt / nout, err,
+			(err > FIRBENCHERR) ? " FAIL" : "");
+		if (err > FIRBENCHERR) ret = 1;
+	}
+	return ret;
+}
+/* *************************************************************************
+ * Median benchmark (see top of file)
+ * *************************************************************************/
+/* Reference: window kept sorted; the oldest is found and shifted out, the
+   new value shifted in. */
+static float medsort(float* ps, float* pring, int n, int k, float x)
+{
+	float old = pring[k % n];
+	int i = 0;
+
+	pring[k % n] = x;
+	while (ps[i] != old) i++;
+	for (; i < n - 1; i++) ps[i] = ps[i + 1];
+	for (i = n - 1; (i > 0) && (ps[i - 1] > x); i--) ps[i] = ps[i - 1];
+	ps[i] = x;
+	return ps[n / 2];
+}
+/* *************************************************************************
+ * int hostmedbench(const char* arg);
+ * @brief	: median_f time and check (see top of file)
+ * @return	: 0 = all medians match the reference; 1 = not
+ * *************************************************************************/
+int hostmedbench(const char* arg)
+{
+	static const uint8_t wn[] = {5, 15, 31, 63};
+	static float x[MEDBENCHN];
+	static float clean[MEDBENCHN];
+	static uint8_t spike[MEDBENCHN];
+	static float y[MEDBENCHN];
+	static struct FILTERMEDF med;
+	float ring[MEDIANFMAX];
+	float sorted[MEDIANFMAX];
+	uint32_t t0;
+	uint32_t dtmed;
+	uint32_t dtref;
+	uint32_t dtham;
+	uint32_t bad;
+	uint32_t passed;
+	uint32_t changed;
+	uint32_t nspike;
+	int ret = 0;
+	int w;
+	int n;
+	int k;
+	int h;
+
+	/* Noisy sine (+/-1, noise +/-0.02), spikes of +/-5 on 1% of the inputs. */
+	srand(1);
+	nspike = 0;
+	for (k = 0; k < MEDBENCHN; k++)
+	{
+		clean[k] = sinf(k * 0.01f) + 0.02f * (2.0f * ((float)rand() / (float)RAND_MAX) - 1.0f);
+		spike[k] = ((rand() % 100) == 0);
+		x[k] = clean[k] + ((spike[k] != 0) ? ((k & 1) ? 5.0f : -5.0f) : 0);
+		nspike += spike[k];
+	}
+
+	for (w = 0; w < (int)sizeof(wn); w++)
+	{
+		n = wn[w];
+		h = (n - 1) / 2;
+
+		/* Plain median vs. the sorted array */
+		if (median_f_init(&med, n, 0, 0) != 0) return 1;
+		t0 = DTWTIME;
+		for (k = 0; k < MEDBENCHN; k++)
+			y[k] = median_f_f(&med, x[k]);
+		dtmed = DTWTIME - t0;
+
+		for (k = 0; k < n; k++) {ring[k] = x[0]; sorted[k] = x[0];}
+		bad = 0;
+		t0 = DTWTIME;
+		for (k = 0; k < MEDBENCHN; k++)
+			if (medsort(sorted, ring, n, k, x[k]) != y[k]) bad += 1;
+		dtref = DTWTIME - t0;
+
+		/* Hampel: spikes let through; good readings changed (beyond the noise) */
+		if (median_f_init(&med, n, 3.0f, 0.05f) != 0) return 1;
+		t0 = DTWTIME;
+		for (k = 0; k < MEDBENCHN; k++)
+			y[k] = median_f_f(&med, x[k]);
+		dtham = DTWTIME - t0;
+		passed  = 0;
+		changed = 0;
+		for (k = h; k < MEDBENCHN; k++)
+		{ // y[k] is for x[k - h]
+			if (spike[k - h] != 0)
+				passed += (fabsf(y[k] - clean[k - h]) > 1.0f);
+			else
+				changed += (y[k] != x[k - h]);
+		}
+
+		printf("n %2d: median %6.1f ticks/input (sorted array %6.1f) %u differ%s; "
+			"Hampel %6.1f ticks/input, spikes passed %u of %u, good changed %u (%u replaced)\n",
+			n, (double)dtmed / MEDBENCHN, (double)dtref / MEDBENCHN, (unsigned int)bad,
+			(bad != 0) ? " FAIL" : "", (double)dtham / MEDBENCHN, (unsigned int)passed,
+			(unsigned int)nspike, (unsigned int)changed, (unsigned int)med.nrej);
+		if (bad != 0) ret = 1;
+	}
+	return ret;
+}
+/* *************************************************************************
+ * static void iirstart(const struct IIRSPEC* ps);
+ * static float iirone(const struct IIRSPEC* ps, float x);
+ * @brief	: Zero the filter for 'ps' / filter one input, with the firmware code
+ * *************************************************************************/
+static struct FILTERIIRF1 iirchk_f1;
+static struct FILTERIIRF2 iirchk_f2;
+static struct BIQUADBANK  iirchk_bq;
+static void iirstart(const struct IIRSPEC* ps)
+{
+	switch (ps->type)
+	{
+	case IIRSPECTYPE_F1:
+		iirchk_f1.coef     = ps->u.f1coef;
+		iirchk_f1.onemcoef = 1 - ps->u.f1coef;
+		iirchk_f1.z1       = 0;
+		iirchk_f1.skipctr  = 0;
+		break;
+	case IIRSPECTYPE_F2:
+		iir_f2_init(&iirchk_f2, &ps->u.f2, 0);
+		break;
+	case IIRSPECTYPE_BQ:
+		if (iir_biquad_init(&iirchk_bq, &ps->u.bq, 1, 0) != 0) morse_trap(20);
+		break;
+	}
+	return;
+}
+static float iirone(const struct IIRSPEC* ps, float x)
+{
+	float y = 0;
+	switch (ps->type)
+	{
+	case IIRSPECTYPE_F1: y = iir_f1_f(&iirchk_f1, x); break;
+	case IIRSPECTYPE_F2: y = iir_f2_f(&iirchk_f2, x); break;
+	case IIRSPECTYPE_BQ: iir_biquad_run(&iirchk_bq, &x, &y); break;
+	}
+	return y;
+}
+/* *************************************************************************
+ * int hostiircheck(const char* arg);
+ * @brief	: iir_coef.c filters against their build-time response (see top of file)
+ * @return	: 0 = all within bounds; 1 = not
+ * *************************************************************************/
+int hostiircheck(const char* arg)
+{
+	const struct IIRSPEC* ps;
+	const struct IIRRESP* pr;
+	double errstep;
+	double errdb;
+	double c;
+	double sn;
+	double w;
+	double y;
+	int ret = 0;
+	int npt;
+	int ncyc;
+	int s;
+	int j;
+	int k;
+
+	for (s = 0; s < IIRSPECNUM; s++)
+	{
+		ps = &iirspec[s];
+		pr = &iirresp[s];
+
+		/* Step response */
+		errstep = 0;
+		iirstart(ps);
+		for (k = 0; k <= (IIRRESPNSTEP - 1) * pr->dt; k++)
+		{
+			y = iirone(ps, 1.0f);
+			if ((k % pr->dt) == 0)
+				if (fabs(y - pr->step[k / pr->dt]) > errstep) errstep = fabs(y - pr->step[k / pr->dt]);
+		}
+
+		/* Gain: settle, then correlate over 100 cycles */
+		errdb = 0;
+		npt = 0;
+		for (j = 0; j < IIRRESPNF; j++)
+		{
+			if ((pr->db[j] < -60) || (iirrespf[j] >= 0.5f)) continue;
+			w = 2 * M_PI * iirrespf[j];
+			ncyc = (int)(100.0 / iirrespf[j] + 0.5);
+			iirstart(ps);
+			for (k = 0; k < 4 * pr->settle; k++)
+				iirone(ps, (float)sin(w * k));
+			c  = 0;
+			sn = 0;
+			for (; k < 4 * pr->settle + ncyc; k++)
+			{
+				y   = iirone(ps, (float)sin(w * k));
+				c  += y * cos(w * k);
+				sn += y * sin(w * k);
+			}
+			y = 20 * log10(2 * sqrt(c * c + sn * sn) / ncyc);
+			if (fabs(y - pr->db[j]) > errdb) errdb = fabs(y - pr->db[j]);
+			npt += 1;
+		}
+
+		printf("spec %d type %d order %d fc %.6f: step max err %.2e; gain max err %.4f dB (%d points)%s\n",
+			s, ps->type, ps->order, ps->fc, errstep, errdb, npt,
+			((errstep > IIRCHECKSTEP) || (errdb > IIRCHECKDB)) ? " FAIL" : "");
+		if ((errstep > IIRCHECKSTEP) || (errdb > IIRCHECKDB)) ret = 1;
+	}
+	return ret;
+}
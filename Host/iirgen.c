@@ -0,0 +1,421 @@
+/******************************************************************************
+* File Name          : iirgen.c
+* Date First Issued  : 10/17/2026
+* Board              : Linux workstation
+* Description        : IIR coefficient tables (iir_spec.h), made and checked at build time
+*******************************************************************************/
+/*
+Build & run: make iirtables (the firmware build runs it when this file is
+newer than Ourtasks/iir_coef.c/.h)
+             ./build_host/iirgen Ourtasks/iir_coef
+
+Grown out of 'iir2/iir2.c' (the earlevel.com biquad), which printed one
+filter's coefficients and step response for graphing.  Each spec below is
+designed in double here, rounded to the float the target uses, and written
+out as iirspec[] in 'iir_coef.c' plus the IIRSPEC_ codes in 'iir_coef.h'.
+The target loads the coefficients (iir_f2_init, iir_biquad_init) and does
+no trig.
+
+Types (fc is the -3 dB point unless noted)--
+IIR1: one pole, y = coef*y + (1-coef)*x (iir_f1, iir_q1).  coef from the
+      exact -3 dB point: c = (2 - cos w) - sqrt((2 - cos w)^2 - 1).
+IIR2: two poles, no zeros (iir_f2): the bilinear biquad's poles with its
+      zeros dropped, so the gain at fc is Q / cos^2(pi*fc).
+BIQUAD: low pass biquad cascade (iir_biquad), order 2 - 8 even.  Order 2
+      has the Q given (gain at fc is Q); order 4 - 8 are Butterworth, with
+      the section Q's from the pole angles.
+The numerator gain is set from the rounded float poles, so that the dc gain
+stays 1 when the poles crowd z = 1 (low fc).
+
+The response is checked with the float coefficients, and written out as
+iirresp[]: the gain at the iirrespf[] frequencies (4 per decade up to 1/2
+the sample rate) and the step response.  The build fails (the .c/.h are
+removed) if a spec has--
+ - fc not between 0 and 1/2 the sample rate, or a bad order for its type
+ - a pole on or outside the unit circle
+ - dc gain off 1 by more than DCERR
+ - gain at fc off the design by more than FCDBERR dB
+ - a step response that does not settle within 1% of 1
+
+fc, fs: Hz.  A channel's sample rate is its output rate: ADCRATE(xprms.decim).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <complex.h>
+
+#define IIRGEN_IIR1   1 // Same codes as IIRSPECTYPE_ (iir_spec.h)
+#define IIRGEN_IIR2   2
+#define IIRGEN_BIQUAD 3
+
+/* ADC1 1/2 DMA buffer rate (Hz): ADC clock 84 MHz / 4 = 21 MHz; one scan is
+   8 x (56 + 12) + 2 x (480 + 12) = 1528 clocks (main.c MX_ADC1_Init), and
+   there are ADC1DMANUMSEQ (16) scans in 1/2 buffer. */
+#define ADCHALFRATE (21E6 / (1528.0 * 16))
+/* ADC channel output rate with xprms.decim = 'd' */
+#define ADCRATE(d) (ADCHALFRATE / (d))
+
+struct IIRGENSPEC
+{
+	const char* name;
+	int type;     // IIRGEN_
+	int order;
+	double fc;    // Cutoff (Hz)
+	double q;     // Q (IIR2, BIQUAD order 2)
+	double fs;    // Sample rate (Hz)
+	const char* note;
+};
+
+static const struct IIRGENSPEC spec[] =
+{
+/*	 name      type           order  fc     Q       fs */
+	{"F2TEST",  IIRGEN_IIR2,   2,  50.0, 0.707,  1000.0,      "DefaultTask iir_f2 step printout"},
+	{"ADCLP4",  IIRGEN_BIQUAD, 4,  40.0, 0.7071, ADCRATE(1),  "ADC channels: 4th order Butterworth"},
+	{"ADCLP2",  IIRGEN_BIQUAD, 2,   2.0, 0.5,    ADCRATE(16), "Slow ADC channels (decim 16): no overshoot"},
+	{"ADCF1",   IIRGEN_IIR1,   1,   5.0, 0,      ADCRATE(1),  "ADC channels: one pole (iir_f1, iir_q1)"},
+};
+#define NSPEC (int)(sizeof(spec) / sizeof(spec[0]))
+
+#define MAXSECT  4      // BIQUADMAXSECT
+#define NF      16      // IIRRESPNF
+#define NSTEP   32      // IIRRESPNSTEP
+#define DCERR   1E-5    // Largest dc gain error
+#define FCDBERR 0.05    // Largest gain error at fc (dB)
+#define MAXSIM  4000000 // Longest step response run
+
+/* One section as the target runs it (in double):
+   y = b0*x + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2] */
+struct SECT
+{
+	double b0, b1, b2, a1, a2;
+};
+
+/* The float coefficients written out */
+struct COEF
+{
+	float f1coef;
+	float f2[3];          // b1, b2, gain (struct IIRF2SPEC)
+	float bq[MAXSECT][5]; // b0, b1, b2, a1, a2 (struct BIQUADCOEF)
+	int nsect;
+};
+
+static double fr(double x) { return (double)(float)x; }
+
+/* Design: float coefficients, and the sections the target runs.  Returns number of sections. */
+static int design(const struct IIRGENSPEC* ps, struct COEF* pc, struct SECT* s)
+{
+	double f = ps->fc / ps->fs;
+	double K = tan(M_PI * f);
+	double w = 2 * M_PI * f;
+	double cw;
+	double qs;
+	double norm;
+	double a1;
+	double a2;
+	double b0;
+	int i;
+
+	memset(pc, 0, sizeof(struct COEF));
+	memset(s, 0, MAXSECT * sizeof(struct SECT));
+	switch (ps->type)
+	{
+	case IIRGEN_IIR1:
+		cw = 2 - cos(w);
+		pc->f1coef = cw - sqrt(cw * cw - 1);
+		s[0].b0 = (float)(1.0f - pc->f1coef); // 'onemcoef' (made on the target)
+		s[0].a1 = -(double)pc->f1coef;
+		return 1;
+
+	case IIRGEN_IIR2:
+		norm = 1 / (1 + K / ps->q + K * K);
+		a1 = fr(2 * (K * K - 1) * norm);
+		a2 = fr((1 - K / ps->q + K * K) * norm);
+		pc->f2[0] = a1;
+		pc->f2[1] = -a2;
+		pc->f2[2] = 1 + a1 + a2;
+		s[0].b0 = pc->f2[2];
+		s[0].a1 = a1;
+		s[0].a2 = a2;
+		return 1;
+
+	case IIRGEN_BIQUAD:
+		pc->nsect = ps->order / 2;
+		for (i = 0; i < pc->nsect; i++)
+		{
+			qs = ps->q;
+			if (pc->nsect > 1)
+				qs = 1.0 / (2.0 * cos((2 * i + 1) * M_PI / (2.0 * ps->order)));
+			norm = 1 / (1 + K / qs + K * K);
+			a1 = fr(2 * (K * K - 1) * norm);
+			a2 = fr((1 - K / qs + K * K) * norm);
+			b0 = fr((1 + a1 + a2) / 4);
+			pc->bq[i][0] = b0;
+			pc->bq[i][1] = 2 * b0;
+			pc->bq[i][2] = b0;
+			pc->bq[i][3] = a1;
+			pc->bq[i][4] = a2;
+			s[i].b0 = b0; s[i].b1 = 2 * b0; s[i].b2 = b0; s[i].a1 = a1; s[i].a2 = a2;
+		}
+		return pc->nsect;
+	}
+	return 0;
+}
+
+/* |H(f)|, f = ratio of the sample rate */
+static double gain(const struct SECT* s, int n, double f)
+{
+	double complex z1 = cexp(-I * 2 * M_PI * f);
+	double complex h = 1;
+	int i;
+	for (i = 0; i < n; i++)
+		h *= (s[i].b0 + s[i].b1 * z1 + s[i].b2 * z1 * z1) / (1 + s[i].a1 * z1 + s[i].a2 * z1 * z1);
+	return cabs(h);
+}
+
+/* Unit step from zero state: 'nsim' outputs into py[] */
+static void step(const struct SECT* s, int n, double* py, int nsim)
+{
+	double x1[MAXSECT] = {0}, x2[MAXSECT] = {0};
+	double y1[MAXSECT] = {0}, y2[MAXSECT] = {0};
+	double x;
+	double y;
+	int k;
+	int i;
+
+	for (k = 0; k < nsim; k++)
+	{
+		x = 1;
+		for (i = 0; i < n; i++)
+		{
+			y = s[i].b0 * x + s[i].b1 * x1[i] + s[i].b2 * x2[i] - s[i].a1 * y1[i] - s[i].a2 * y2[i];
+			x2[i] = x1[i]; x1[i] = x;
+			y2[i] = y1[i]; y1[i] = y;
+			x = y;
+		}
+		py[k] = x;
+	}
+	return;
+}
+
+static double db(double g) { return (g < 1E-10) ? -200.0 : 20 * log10(g); }
+
+static void banner(FILE* fp, const char* name, const char* desc)
+{
+	fprintf(fp, "/******************************************************************************\n");
+	fprintf(fp, "* File Name          : %s\n", name);
+	fprintf(fp, "* Date First Issued  : 10/17/2026\n");
+	fprintf(fp, "* Board              : DiscoveryF4\n");
+	fprintf(fp, "* Description        : %s\n", desc);
+	fprintf(fp, "*******************************************************************************/\n");
+	fprintf(fp, "/* Generated by Host/iirgen.c: edit the specs there, then 'make iirtables'. */\n");
+	return;
+}
+
+static const char* tname[] = {"", "IIR1", "IIR2", "BIQUAD"};
+static const char* tcode[] = {"", "IIRSPECTYPE_F1", "IIRSPECTYPE_F2", "IIRSPECTYPE_BQ"};
+
+int main(int argc, char** argv)
+{
+	static double y[MAXSIM];
+	static struct COEF coef[sizeof(spec) / sizeof(spec[0])];
+	static float rdb[sizeof(spec) / sizeof(spec[0])][NF];
+	static float rstep[sizeof(spec) / sizeof(spec[0])][NSTEP];
+	static double over[sizeof(spec) / sizeof(spec[0])];
+	static int settle[sizeof(spec) / sizeof(spec[0])];
+	static int dt[sizeof(spec) / sizeof(spec[0])];
+	struct SECT s[MAXSECT];
+	double ff[NF];
+	double f;
+	double gdc;
+	double gfc;
+	double gwant;
+	double peak;
+	char fname[256];
+	const char* base;
+	const char* pbase;
+	FILE* fph;
+	FILE* fpc;
+	int fail = 0;
+	int nsim;
+	int ns;
+	int k;
+	int i;
+	int j;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: iirgen <output path without .c/.h>\n");
+		return 1;
+	}
+	base  = argv[1];
+	pbase = strrchr(base, '/');
+	pbase = (pbase == NULL) ? base : pbase + 1;
+
+	snprintf(fname, sizeof(fname), "%s.h", base);
+	fph = fopen(fname, "w");
+	snprintf(fname, sizeof(fname), "%s.c", base);
+	fpc = fopen(fname, "w");
+	if ((fph == NULL) || (fpc == NULL)) {perror(fname); return 1;}
+
+	snprintf(fname, sizeof(fname), "%s.h", pbase);
+	banner(fph, fname, "IIR coefficient tables (iir_spec.h)");
+	fprintf(fph, "\n#ifndef __IIR_COEF\n#define __IIR_COEF\n\n#include \"iir_spec.h\"\n\n");
+	fprintf(fph, "/* Codes for 'fpw.iir2.spec' and index into iirspec[], iirresp[] */\n");
+
+	snprintf(fname, sizeof(fname), "%s.c", pbase);
+	banner(fpc, fname, "IIR coefficient tables (iir_spec.h)");
+	fprintf(fpc, "\n#include \"%s.h\"\n", pbase);
+
+	for (j = 0; j < NF; j++)
+		ff[j] = 0.5 * pow(10.0, -(NF - 1 - j) / 4.0);
+
+	for (i = 0; i < NSPEC; i++)
+	{
+		const struct IIRGENSPEC* ps = &spec[i];
+
+		f = ps->fc / ps->fs;
+		if ((f <= 0) || (f >= 0.5))
+		{
+			fprintf(stderr, "iirgen: %s: fc %.4f Hz not between 0 and fs/2 (%.4f Hz)\n", ps->name, ps->fc, ps->fs / 2);
+			fail = 1; continue;
+		}
+		if (((ps->type == IIRGEN_IIR1) && (ps->order != 1)) ||
+		    ((ps->type == IIRGEN_IIR2) && (ps->order != 2)) ||
+		    ((ps->type == IIRGEN_BIQUAD) && ((ps->order < 2) || (ps->order > 2 * MAXSECT) || ((ps->order & 1) != 0))) ||
+		    (ps->type < IIRGEN_IIR1) || (ps->type > IIRGEN_BIQUAD))
+		{
+			fprintf(stderr, "iirgen: %s: bad type or order\n", ps->name);
+			fail = 1; continue;
+		}
+		if ((ps->type != IIRGEN_IIR1) && !((ps->type == IIRGEN_BIQUAD) && (ps->order > 2)) && (ps->q <= 0))
+		{
+			fprintf(stderr, "iirgen: %s: bad Q\n", ps->name);
+			fail = 1; continue;
+		}
+		ns = design(ps, &coef[i], s);
+
+		/* Poles inside the unit circle */
+		for (k = 0; k < ns; k++)
+		{
+			if ((fabs(s[k].a2) >= 1) || (fabs(s[k].a1) >= 1 + s[k].a2))
+			{
+				fprintf(stderr, "iirgen: %s: section %d unstable (a1 %.9f a2 %.9f)\n", ps->name, k, s[k].a1, s[k].a2);
+				fail = 1;
+			}
+		}
+
+		/* dc gain, and gain at fc */
+		gdc = gain(s, ns, 0);
+		if (fabs(gdc - 1) > DCERR)
+		{
+			fprintf(stderr, "iirgen: %s: dc gain %.9f\n", ps->name, gdc);
+			fail = 1;
+		}
+		gfc = gain(s, ns, f);
+		gwant = M_SQRT1_2;
+		if (ps->type == IIRGEN_IIR2)
+			gwant = ps->q / (cos(M_PI * f) * cos(M_PI * f));
+		else if ((ps->type == IIRGEN_BIQUAD) && (ps->order == 2))
+			gwant = ps->q;
+		if (fabs(db(gfc) - db(gwant)) > FCDBERR)
+		{
+			fprintf(stderr, "iirgen: %s: gain at fc %.3f dB, design %.3f dB\n", ps->name, db(gfc), db(gwant));
+			fail = 1;
+		}
+		for (j = 0; j < NF; j++)
+			rdb[i][j] = db(gain(s, ns, ff[j]));
+
+		/* Step response: settles within 1% of 1 */
+		nsim = (int)(50.0 / f) + 100;
+		if (nsim > MAXSIM) nsim = MAXSIM;
+		step(s, ns, y, nsim);
+		peak = 0;
+		settle[i] = 0;
+		for (k = 0; k < nsim; k++)
+		{
+			if (y[k] > peak) peak = y[k];
+			if (fabs(y[k] - 1) > 0.01) settle[i] = k + 1;
+		}
+		if ((settle[i] >= nsim - nsim / 4) || (settle[i] > 0xffff))
+		{
+			fprintf(stderr, "iirgen: %s: step response does not settle (%d of %d samples; end %.6f)\n",
+				ps->name, settle[i], nsim, y[nsim - 1]);
+			fail = 1;
+		}
+		over[i] = (peak > 1) ? peak - 1 : 0;
+		dt[i] = (2 * settle[i] + NSTEP - 2) / (NSTEP - 1); // Out to twice the settling time
+		if (dt[i] < 1) dt[i] = 1;
+		for (j = 0; j < NSTEP; j++)
+			rstep[i][j] = (j * dt[i] < nsim) ? y[j * dt[i]] : y[nsim - 1];
+
+		fprintf(fph, "#define IIRSPEC_%-8s %d // %s\n", ps->name, i, ps->note);
+
+		fprintf(fpc, "\n/* %s: %s\n", ps->name, ps->note);
+		fprintf(fpc, "   %s order %d, fc %.3f Hz at %.3f Hz (%.6f)", tname[ps->type], ps->order, ps->fc, ps->fs, f);
+		if ((ps->type == IIRGEN_IIR2) || ((ps->type == IIRGEN_BIQUAD) && (ps->order == 2)))
+			fprintf(fpc, ", Q %.4f", ps->q);
+		fprintf(fpc, "\n   dc gain %.7f; %.2f dB at fc; step overshoot %.1f%%, within 1%% after %d samples */\n",
+			gdc, db(gfc), 100 * over[i], settle[i]);
+	}
+
+	fprintf(fph, "#define IIRSPECNUM %d\n\n", NSPEC);
+	fprintf(fph, "extern const struct IIRSPEC iirspec[IIRSPECNUM];\n");
+	fprintf(fph, "extern const struct IIRRESP iirresp[IIRSPECNUM];\n");
+	fprintf(fph, "extern const float iirrespf[IIRRESPNF];\n\n#endif\n");
+
+	fprintf(fpc, "\nconst struct IIRSPEC iirspec[IIRSPECNUM] =\n{\n");
+	for (i = 0; i < NSPEC; i++)
+	{
+		const struct IIRGENSPEC* ps = &spec[i];
+		const struct COEF* pc = &coef[i];
+		fprintf(fpc, "\t{ /* %s */\n", ps->name);
+		switch (ps->type)
+		{
+		case IIRGEN_IIR1:
+			fprintf(fpc, "\t\t.u.f1coef = %.9ef,\n", pc->f1coef);
+			break;
+		case IIRGEN_IIR2:
+			fprintf(fpc, "\t\t.u.f2 = {%.9ef, %.9ef, %.9ef},\n", pc->f2[0], pc->f2[1], pc->f2[2]);
+			break;
+		case IIRGEN_BIQUAD:
+			fprintf(fpc, "\t\t.u.bq = {{\n");
+			for (k = 0; k < pc->nsect; k++)
+				fprintf(fpc, "\t\t\t{%.9ef, %.9ef, %.9ef, %.9ef, %.9ef},\n",
+					pc->bq[k][0], pc->bq[k][1], pc->bq[k][2], pc->bq[k][3], pc->bq[k][4]);
+			fprintf(fpc, "\t\t\t}, %d},\n", pc->nsect);
+			break;
+		}
+		fprintf(fpc, "\t\t.fc = %.9ef, .q = %.9ef, .type = %s, .order = %d\n\t},\n",
+			ps->fc / ps->fs, ps->q, tcode[ps->type], ps->order);
+	}
+	fprintf(fpc, "};\n");
+
+	fprintf(fpc, "\n/* Response (float coefficients): not used by the firmware; 'host_main i' checks the filters against it. */\n");
+	fprintf(fpc, "const float iirrespf[IIRRESPNF] =\n{\n\t");
+	for (j = 0; j < NF; j++)
+		fprintf(fpc, "%.9ef,%s", ff[j], (j == NF - 1) ? "\n" : (((j & 7) == 7) ? "\n\t" : " "));
+	fprintf(fpc, "};\n\nconst struct IIRRESP iirresp[IIRSPECNUM] =\n{\n");
+	for (i = 0; i < NSPEC; i++)
+	{
+		fprintf(fpc, "\t{ /* %s */\n\t\t{", spec[i].name);
+		for (j = 0; j < NF; j++)
+			fprintf(fpc, "%.3ff,%s", rdb[i][j], (j == NF - 1) ? "},\n" : (((j & 7) == 7) ? "\n\t\t " : " "));
+		fprintf(fpc, "\t\t{");
+		for (j = 0; j < NSTEP; j++)
+			fprintf(fpc, "%.9ef,%s", rstep[i][j], (j == NSTEP - 1) ? "},\n" : (((j & 7) == 7) ? "\n\t\t " : " "));
+		fprintf(fpc, "\t\t%.6ef, %d, %d\n\t},\n", over[i], dt[i], settle[i]);
+	}
+	fprintf(fpc, "};\n");
+
+	fclose(fph);
+	fclose(fpc);
+	if (fail != 0)
+	{ // No tables: so that make does not take them as up to date
+		snprintf(fname, sizeof(fname), "%s.h", base);
+		remove(fname);
+		snprintf(fname, sizeof(fname), "%s.c", base);
+		remove(fname);
+	}
+	return fail;
+}
@@ -0,0 +1,373 @@
+/******************************************************************************
+* File Name          : adccapture.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Pre/post trigger capture of raw ADC DMA readings
+*******************************************************************************/
+/*
+The ring lives in CCM RAM (section '.ccmnoinit', NOLOAD in the linker script,
+so it is neither zeroed nor copied at startup).  DMA cannot reach CCM RAM,
+which is fine since the blocks are copied by the ADCTask.
+
+Only the ADCTask writes the ring, and only in the ARMED and TRIGGERED states.
+Once DONE the ring is left alone until 'adccapture_send' (another task) has
+streamed it out, so the sender reads it without locking.
+
+With the level trigger the trigger scan is the first scan of the block that
+crosses the level.  Requested triggers (CAN, button, API) arrive between
+blocks and are placed at scan 0 of the next block.
+*/
+
+#include <string.h>
+#include "adccapture.h"
+#include "DTW_counter.h"
+#include "cdc_txbuff.h"
+
+#ifdef HOSTBUILD
+static struct ADCCAPBLK adccapring[ADCCAPTURE_NBLK];
+#else
+static struct ADCCAPBLK adccapring[ADCCAPTURE_NBLK] __attribute__ ((section (".ccmnoinit")));
+#endif
+
+struct ADCCAPTURE adccapture;
+
+static void capture_done(struct ADCCAPTURE* p);
+static void send_piece(struct SERIALSENDTASKBCB* pbcb, uint8_t* pbuf, uint16_t size);
+
+/* *************************************************************************
+ * int adccapture_init(struct CAN_CTLBLOCK* pctl, uint32_t canid, uint32_t notebit);
+ * @brief	: Initialize capture; optionally add a CAN command mailbox
+ * @param	: pctl = CAN control block for commands; NULL = no CAN commands
+ * @param	: canid = CAN ID of command msg
+ * @param	: notebit = ADCTask notification bit for the command mailbox
+ * @return	: 0 = OK; -1 = mailbox add failed
+ * NOTE: call from the ADCTask (mailbox notifications go to the current task)
+ * *************************************************************************/
+int adccapture_init(struct CAN_CTLBLOCK* pctl, uint32_t canid, uint32_t notebit)
+{
+	struct ADCCAPTURE* p = &adccapture;
+
+	/* Default: total motor current rising through mid-scale, 1/2 the ring after. */
+	p->cfg.trigchan  = ADC1IDX_CURRENTTOTAL;
+	p->cfg.trigedge  = ADCCAPEDGE_NONE;
+	p->cfg.triglevel = 2048;
+	p->cfg.npost     = (ADCCAPTURE_NBLK / 2) * ADC1DMANUMSEQ;
+	p->cfg.rearm     = 0;
+	p->state = ADCCAPST_IDLE;
+	p->pmbx  = NULL;
+
+	if (pctl == NULL) return 0;
+
+	/* The command is taken from the raw payload, so the payload type is not used. */
+	p->pmbx = MailboxTask_add(pctl, canid, NULL, notebit, 0, 0);
+	if (p->pmbx == NULL) return -1;
+	return 0;
+}
+/* *************************************************************************
+ * void adccapture_put(uint16_t* pdma);
+ * @brief	: Record a 1/2 DMA buffer, check triggers (ADCTask)
+ * @param	: pdma = pointer to 1/2 dma buffer
+ * *************************************************************************/
+void adccapture_put(uint16_t* pdma)
+{
+	struct ADCCAPTURE* p = &adccapture;
+	struct ADCCAPBLK* pblk;
+	uint16_t* pr;
+	uint16_t rem;
+	uint32_t npost;
+	uint8_t trig;
+	int i;
+
+#ifdef ADCCAPTURE_BUTTON_PORT
+	/* Button: act on the press edge. */
+	trig = (HAL_GPIO_ReadPin(ADCCAPTURE_BUTTON_PORT, ADCCAPTURE_BUTTON_PIN) == ADCCAPTURE_BUTTON_ACTIVE);
+	if ((trig != 0) && (p->button == 0))
+	{
+		if ((p->state == ADCCAPST_IDLE) || (p->state == ADCCAPST_DONE))
+			adccapture_arm(NULL);
+		else
+			adccapture_trigger(ADCCAPTRIG_BUTTON);
+	}
+	p->button = trig;
+#endif
+
+	if ((p->state != ADCCAPST_ARMED) && (p->state != ADCCAPST_TRIGGERED))
+		return;
+
+	/* Copy 1/2 dma buffer into ring. */
+	pblk = &adccapring[p->idx];
+	pblk->dtw = DTWTIME;
+	memcpy(&pblk->raw[0], pdma, sizeof(pblk->raw));
+
+	if (p->state == ADCCAPST_ARMED)
+	{
+		taskENTER_CRITICAL();
+		trig = p->trigreq;
+		p->trigreq = 0;
+		taskEXIT_CRITICAL();
+
+		i = 0;
+		if ((trig == 0) && (p->cfg.trigedge != ADCCAPEDGE_NONE))
+		{ // Look for the first scan crossing the level
+			pr = pdma + p->cfg.trigchan;
+			if (p->nfill == 0) p->prev = *pr; // No crossing into the first block
+			for (i = 0; i < ADC1DMANUMSEQ; i++)
+			{
+				if ( ((p->cfg.trigedge & ADCCAPEDGE_RISE) && (p->prev <  p->cfg.triglevel) && (*pr >= p->cfg.triglevel)) ||
+				     ((p->cfg.trigedge & ADCCAPEDGE_FALL) && (p->prev >= p->cfg.triglevel) && (*pr <  p->cfg.triglevel)) )
+				{
+					trig = ADCCAPTRIG_LEVEL;
+					break;
+				}
+				p->prev = *pr;
+				pr += ADC1IDX_ADCSCANSIZE;
+			}
+		}
+		if (trig != 0)
+		{
+			p->trigidx  = p->idx;
+			p->trigscan = i;
+			p->trigsrc  = trig;
+			p->dtwtrig  = pblk->dtw;
+
+			/* Blocks after this one to cover 'npost' scans; the trigger block stays in the ring. */
+			rem = (ADC1DMANUMSEQ - 1) - i;
+			npost = 0;
+			if (p->cfg.npost > rem)
+				npost = (p->cfg.npost - rem + (ADC1DMANUMSEQ - 1)) / ADC1DMANUMSEQ;
+			if (npost > (ADCCAPTURE_NBLK - 1)) npost = (ADCCAPTURE_NBLK - 1);
+			p->nleft = npost;
+			p->state = ADCCAPST_TRIGGERED;
+		}
+	}
+	else
+	{
+		p->nleft -= 1;
+	}
+
+	/* Advance ring */
+	p->idx += 1;
+	if (p->idx >= ADCCAPTURE_NBLK) p->idx = 0;
+	if (p->nfill < ADCCAPTURE_NBLK) p->nfill += 1;
+
+	if ((p->state == ADCCAPST_TRIGGERED) && (p->nleft == 0))
+		capture_done(p);
+
+	return;
+}
+/* *************************************************************************
+ * static void capture_done(struct ADCCAPTURE* p);
+ * @brief	: Freeze ring and build the stream header
+ * *************************************************************************/
+static void capture_done(struct ADCCAPTURE* p)
+{
+	struct ADCCAPHDR* ph = &p->hdr;
+	uint16_t first = (p->idx + ADCCAPTURE_NBLK - p->nfill) % ADCCAPTURE_NBLK;
+
+	p->seq += 1;
+	ph->magic     = ADCCAPMAGIC;
+	ph->version   = ADCCAPVERSION;
+	ph->nchan     = ADC1IDX_ADCSCANSIZE;
+	ph->nscan     = ADC1DMANUMSEQ;
+	ph->trigsrc   = p->trigsrc;
+	ph->nblk      = p->nfill;
+	ph->trigblk   = (p->trigidx + ADCCAPTURE_NBLK - first) % ADCCAPTURE_NBLK;
+	ph->trigscan  = p->trigscan;
+	ph->trigchan  = p->cfg.trigchan;
+	ph->trigedge  = p->cfg.trigedge;
+	ph->triglevel = p->cfg.triglevel;
+	ph->npost     = p->cfg.npost;
+	ph->seq       = p->seq;
+	ph->dtwhz     = DTWTIMEHZ;
+	ph->dtwtrig   = p->dtwtrig;
+
+	p->state = ADCCAPST_DONE;
+	return;
+}
+/* *************************************************************************
+ * void adccapture_cancmd(void);
+ * @brief	: Handle CAN command mailbox notification (ADCTask)
+ * *************************************************************************/
+void adccapture_cancmd(void)
+{
+	struct ADCCAPTURECFG cfg;
+	struct CANRCVBUF* pcan;
+
+	if (adccapture.pmbx == NULL) return;
+	pcan = &adccapture.pmbx->ncan.can;
+
+	switch (pcan->cd.uc[0])
+	{
+	case ADCCAPCMD_ARM:
+		if ((pcan->dlc & 0xf) >= 7)
+		{
+			cfg = adccapture.cfg;
+			cfg.trigchan  = pcan->cd.uc[1];
+			cfg.trigedge  = pcan->cd.uc[2];
+			cfg.triglevel = pcan->cd.uc[3] | (pcan->cd.uc[4] << 8);
+			cfg.npost     = pcan->cd.uc[5] | (pcan->cd.uc[6] << 8);
+			adccapture_arm(&cfg);
+		}
+		else
+			adccapture_arm(NULL);
+		break;
+
+	case ADCCAPCMD_TRIGGER:
+		adccapture_trigger(ADCCAPTRIG_CAN);
+		break;
+
+	case ADCCAPCMD_DISARM:
+		adccapture_disarm();
+		break;
+	}
+	return;
+}
+/* *************************************************************************
+ * int adccapture_arm(struct ADCCAPTURECFG* pcfg);
+ * @brief	: Start recording and look for a trigger
+ * @param	: pcfg = pointer to config; NULL = use current config
+ * @return	: 0 = OK; -1 = capture is being sent, or bad config
+ * *************************************************************************/
+int adccapture_arm(struct ADCCAPTURECFG* pcfg)
+{
+	struct ADCCAPTURE* p = &adccapture;
+
+	if (pcfg != NULL)
+	{
+		if (pcfg->trigchan >= ADC1IDX_ADCSCANSIZE) return -1;
+		if (pcfg->trigedge > ADCCAPEDGE_BOTH) return -1;
+	}
+
+taskENTER_CRITICAL();
+	if (p->state == ADCCAPST_SENDING) {taskEXIT_CRITICAL(); return -1;}
+	if (pcfg != NULL) p->cfg = *pcfg;
+	p->idx     = 0;
+	p->nfill   = 0;
+	p->trigreq = 0;
+	p->state   = ADCCAPST_ARMED;
+taskEXIT_CRITICAL();
+	return 0;
+}
+/* *************************************************************************
+ * void adccapture_disarm(void);
+ * @brief	: Stop recording (a completed capture is discarded)
+ * *************************************************************************/
+void adccapture_disarm(void)
+{
+taskENTER_CRITICAL();
+	if (adccapture.state != ADCCAPST_SENDING)
+		adccapture.state = ADCCAPST_IDLE;
+taskEXIT_CRITICAL();
+	return;
+}
+/* *************************************************************************
+ * void adccapture_trigger(uint8_t src);
+ * @brief	: Request a trigger (any task)
+ * @param	: src = ADCCAPTRIG_ bit to record as the source
+ * *************************************************************************/
+void adccapture_trigger(uint8_t src)
+{
+taskENTER_CRITICAL();
+	adccapture.trigreq |= src;
+taskEXIT_CRITICAL();
+	return;
+}
+/* *************************************************************************
+ * int adccapture_ready(void);
+ * @brief	: Check for a completed capture
+ * @return	: 1 = capture waiting to be sent; 0 = not
+ * *************************************************************************/
+int adccapture_ready(void)
+{
+	return (adccapture.state == ADCCAPST_DONE);
+}
+/* *************************************************************************
+ * int adccapture_send(struct SERIALSENDTASKBCB* pbcb);
+ * @brief	: Stream a completed capture (blocks until queued/sent)
+ * @param	: pbcb = BCB for the uart (getserialbuf); NULL = CDC (USB)
+ * @return	: number of bytes sent; -1 = no capture
+ * NOTE: call from a low priority task; pbcb's buffer is restored when done.
+ * *************************************************************************/
+int adccapture_send(struct SERIALSENDTASKBCB* pbcb)
+{
+	struct ADCCAPTURE* p = &adccapture;
+	uint16_t* ph;
+	uint16_t* phend;
+	uint8_t* pbufsave = NULL;
+	uint32_t sum = 0;
+	uint16_t k;
+	uint16_t n;
+	int i;
+
+taskENTER_CRITICAL();
+	if (p->state != ADCCAPST_DONE) {taskEXIT_CRITICAL(); return -1;}
+	p->state = ADCCAPST_SENDING;
+taskEXIT_CRITICAL();
+
+	/* Trailer check sum: header and all blocks, as sent. */
+	ph = (uint16_t*)&p->hdr;
+	for (i = 0; i < (int)(sizeof(struct ADCCAPHDR) / 2); i++) sum += *ph++;
+	k = (p->idx + ADCCAPTURE_NBLK - p->nfill) % ADCCAPTURE_NBLK;
+	for (n = 0; n < p->nfill; n++)
+	{
+		ph = (uint16_t*)&adccapring[k];
+		phend = ph + (sizeof(struct ADCCAPBLK) / 2);
+		while (ph != phend) sum += *ph++;
+		k += 1; if (k >= ADCCAPTURE_NBLK) k = 0;
+	}
+	p->trl.sum   = sum;
+	p->trl.magic = ADCCAPMAGICEND;
+
+	/* Send header, blocks oldest first, trailer. Ring blocks are sent in place. */
+	if (pbcb != NULL) pbufsave = pbcb->pbuf;
+	send_piece(pbcb, (uint8_t*)&p->hdr, sizeof(struct ADCCAPHDR));
+	k = (p->idx + ADCCAPTURE_NBLK - p->nfill) % ADCCAPTURE_NBLK;
+	for (n = 0; n < p->nfill; n++)
+	{
+		send_piece(pbcb, (uint8_t*)&adccapring[k], sizeof(struct ADCCAPBLK));
+		k += 1; if (k >= ADCCAPTURE_NBLK) k = 0;
+	}
+	send_piece(pbcb, (uint8_t*)&p->trl, sizeof(struct ADCCAPTRL));
+
+	if (pbcb != NULL)
+	{ // Wait for the last piece to go before handing the BCB back
+		xSemaphoreTake(pbcb->semaphore, portMAX_DELAY);
+		pbcb->pbuf = pbufsave;
+		pbcb->size = 0;
+		xSemaphoreGive(pbcb->semaphore);
+	}
+	else
+	{ // Wait for CdcTxTask (higher priority) to copy the queued pieces
+		while (uxQueueMessagesWaiting(CdcTxTaskSendQHandle) != 0) osDelay(1);
+	}
+	i = sizeof(struct ADCCAPHDR) + p->nfill * sizeof(struct ADCCAPBLK) + sizeof(struct ADCCAPTRL);
+
+	p->state = ADCCAPST_IDLE;
+	if (p->cfg.rearm != 0) adccapture_arm(NULL);
+	return i;
+}
+/* *************************************************************************
+ * static void send_piece(struct SERIALSENDTASKBCB* pbcb, uint8_t* pbuf, uint16_t size);
+ * @brief	: Queue one piece of the stream to the uart or CDC
+ * @param	: pbcb = BCB for the uart; NULL = CDC
+ * @param	: pbuf = bytes to send (must stay put until sent)
+ * @param	: size = number of bytes
+ * *************************************************************************/
+static void send_piece(struct SERIALSENDTASKBCB* pbcb, uint8_t* pbuf, uint16_t size)
+{
+	struct CDCTXTASKBCB cdc;
+
+	if (pbcb == NULL)
+	{ // CdcTxTask copies into its local buffers
+		cdc.pbuf = pbuf;
+		cdc.size = size;
+		mCdcTxQueueBuf(&cdc);
+		return;
+	}
+	/* The semaphore is given back by SerialTaskSend when the previous piece has gone. */
+	xSemaphoreTake(pbcb->semaphore, portMAX_DELAY);
+	pbcb->pbuf = pbuf;
+	pbcb->size = size;
+	vSerialTaskSendQueueBuf(&pbcb);
+	return;
+}
@@ -0,0 +1,189 @@
+/******************************************************************************
+* File Name          : adccapture.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Pre/post trigger capture of raw ADC DMA readings
+*******************************************************************************/
+/*
+ADCTask hands each 1/2 DMA buffer (ADC1DMANUMSEQ scans of ADC1IDX_ADCSCANSIZE
+raw readings) to 'adccapture_put'.  While armed the buffers are copied into a
+ring of blocks in CCM RAM, so the ring always holds the most recent
+ADCCAPTURE_NBLK blocks.  When a trigger is seen, 'npost' more scans are
+recorded (rounded up to whole blocks) and the ring is frozen for sending.
+
+Triggers--
+ - Level: a raw reading of 'trigchan' crossing 'triglevel' (rising, falling or
+   either), checked scan by scan.
+ - CAN: msg with the ID given to 'adccapture_init' (see ADCCAPCMD_ below).
+ - Pushbutton: polled each 1/2 DMA buffer when ADCCAPTURE_BUTTON_PORT is
+   defined.  Press while idle arms; press while armed triggers.
+ - 'adccapture_trigger' from any task.
+
+Stream (little endian)--
+ struct ADCCAPHDR
+ struct ADCCAPBLK x nblk, oldest first
+ struct ADCCAPTRL: sum of all uint16_t halfwords of the above, end marker
+'Host/adccapdecode.c' checks and converts a stream to text columns.
+*/
+
+#ifndef __ADCCAPTURE
+#define __ADCCAPTURE
+
+#include <stdint.h>
+#include "adcparams.h"
+#include "SerialTaskSend.h"
+#include "MailboxTask.h"
+
+/* Ring size: blocks of one 1/2 DMA buffer (324 bytes) each; 180 -> 58320 bytes
+   of the 64K CCM RAM, about 2880 scans (~210 ms). */
+#ifndef ADCCAPTURE_NBLK
+  #define ADCCAPTURE_NBLK 180
+#endif
+
+#define ADCCAPMAGIC    0x43434441 // "ADCC" header
+#define ADCCAPMAGICEND 0x44434441 // "ADCD" trailer
+#define ADCCAPVERSION  1
+
+/* Capture state */
+#define ADCCAPST_IDLE      0 // Not recording
+#define ADCCAPST_ARMED     1 // Recording, looking for a trigger
+#define ADCCAPST_TRIGGERED 2 // Recording post-trigger blocks
+#define ADCCAPST_DONE      3 // Frozen, waiting to be sent
+#define ADCCAPST_SENDING   4 // Being streamed out
+
+/* Trigger source bits (ADCCAPHDR.trigsrc) */
+#define ADCCAPTRIG_LEVEL  (1 << 0)
+#define ADCCAPTRIG_CAN    (1 << 1)
+#define ADCCAPTRIG_BUTTON (1 << 2)
+#define ADCCAPTRIG_API    (1 << 3)
+
+/* Level trigger edge */
+#define ADCCAPEDGE_NONE 0 // Level trigger off
+#define ADCCAPEDGE_RISE 1
+#define ADCCAPEDGE_FALL 2
+#define ADCCAPEDGE_BOTH 3
+
+/* CAN command msg ID (CAN1) */
+#ifndef ADCCAPTURE_CANID
+  #define ADCCAPTURE_CANID 0xD0800000
+#endif
+
+/* CAN command: payload [0] */
+#define ADCCAPCMD_ARM     0 // [1] chan, [2] edge, [3]-[4] level, [5]-[6] npost (dlc 7+); else last config
+#define ADCCAPCMD_TRIGGER 1
+#define ADCCAPCMD_DISARM  2
+
+/* Pushbutton (optional).  PA0 (Discovery user button) is ADC IN0, so the
+   default build has no button; e.g. -DADCCAPTURE_BUTTON_PORT=GPIOE
+   -DADCCAPTURE_BUTTON_PIN=GPIO_PIN_2 */
+#ifndef ADCCAPTURE_BUTTON_ACTIVE
+  #define ADCCAPTURE_BUTTON_ACTIVE GPIO_PIN_SET // Pin level when pressed
+#endif
+
+/* Trigger and post-trigger length */
+struct ADCCAPTURECFG
+{
+	uint16_t triglevel; // Raw ADC level for level trigger
+	uint16_t npost;     // Scans to record after the trigger scan
+	uint8_t  trigchan;  // ADC1IDX_ of channel for level trigger
+	uint8_t  trigedge;  // ADCCAPEDGE_
+	uint8_t  rearm;     // 1 = re-arm after sending
+};
+
+/* Stream header (32 bytes) */
+struct ADCCAPHDR
+{
+	uint32_t magic;     // ADCCAPMAGIC
+	uint8_t  version;   // ADCCAPVERSION
+	uint8_t  nchan;     // ADC1IDX_ADCSCANSIZE
+	uint8_t  nscan;     // ADC1DMANUMSEQ: scans per block
+	uint8_t  trigsrc;   // ADCCAPTRIG_ bit(s) that triggered
+	uint16_t nblk;      // Number of blocks that follow
+	uint16_t trigblk;   // Block (0 = first sent) holding the trigger scan
+	uint16_t trigscan;  // Scan within 'trigblk'
+	uint8_t  trigchan;  // Level trigger config
+	uint8_t  trigedge;
+	uint16_t triglevel;
+	uint16_t npost;     // Scans requested after the trigger
+	uint32_t seq;       // Capture count
+	uint32_t dtwhz;     // DTW counts per second
+	uint32_t dtwtrig;   // DTWTIME when the trigger block was processed
+};
+
+/* One 1/2 DMA buffer */
+struct ADCCAPBLK
+{
+	uint32_t dtw; // DTWTIME when copied
+	uint16_t raw[ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE]; // Scans, as in the dma buffer
+};
+
+/* Stream trailer */
+struct ADCCAPTRL
+{
+	uint32_t sum;   // Sum of header and block halfwords
+	uint32_t magic; // ADCCAPMAGICEND
+};
+
+/* Capture control */
+struct ADCCAPTURE
+{
+	struct ADCCAPTURECFG cfg;
+	struct ADCCAPHDR hdr;  // Built when the capture completes
+	struct ADCCAPTRL trl;
+	struct MAILBOXCAN* pmbx; // CAN command mailbox; NULL = none
+	uint32_t seq;      // Captures completed
+	uint32_t dtwtrig;  // DTWTIME of trigger block
+	uint16_t idx;      // Next ring block to fill
+	uint16_t nfill;    // Blocks filled since armed (max ADCCAPTURE_NBLK)
+	uint16_t trigidx;  // Ring index of trigger block
+	uint16_t trigscan; // Scan within trigger block
+	uint16_t nleft;    // Post-trigger blocks still to fill
+	uint16_t prev;     // Last reading of 'trigchan' (level crossing)
+	volatile uint8_t state;   // ADCCAPST_
+	volatile uint8_t trigreq; // ADCCAPTRIG_ bits requested from outside the ADCTask
+	uint8_t trigsrc;   // Bits that caused the trigger
+	uint8_t button;    // Last button state
+};
+
+/* *************************************************************************/
+int adccapture_init(struct CAN_CTLBLOCK* pctl, uint32_t canid, uint32_t notebit);
+/* @brief	: Initialize capture; optionally add a CAN command mailbox
+ * @param	: pctl = CAN control block for commands; NULL = no CAN commands
+ * @param	: canid = CAN ID of command msg
+ * @param	: notebit = ADCTask notification bit for the command mailbox
+ * @return	: 0 = OK; -1 = mailbox add failed
+ * NOTE: call from the ADCTask (mailbox notifications go to the current task)
+ * *************************************************************************/
+void adccapture_put(uint16_t* pdma);
+/* @brief	: Record a 1/2 DMA buffer, check triggers (ADCTask)
+ * @param	: pdma = pointer to 1/2 dma buffer
+ * *************************************************************************/
+void adccapture_cancmd(void);
+/* @brief	: Handle CAN command mailbox notification (ADCTask)
+ * *************************************************************************/
+int adccapture_arm(struct ADCCAPTURECFG* pcfg);
+/* @brief	: Start recording and look for a trigger
+ * @param	: pcfg = pointer to config; NULL = use current config
+ * @return	: 0 = OK; -1 = capture is being sent
+ * *************************************************************************/
+void adccapture_disarm(void);
+/* @brief	: Stop recording (a completed capture is discarded)
+ * *************************************************************************/
+void adccapture_trigger(uint8_t src);
+/* @brief	: Request a trigger (any task)
+ * @param	: src = ADCCAPTRIG_ bit to record as the source
+ * *************************************************************************/
+int adccapture_ready(void);
+/* @brief	: Check for a completed capture
+ * @return	: 1 = capture waiting to be sent; 0 = not
+ * *************************************************************************/
+int adccapture_send(struct SERIALSENDTASKBCB* pbcb);
+/* @brief	: Stream a completed capture (blocks until queued/sent)
+ * @param	: pbcb = BCB for the uart (getserialbuf); NULL = CDC (USB)
+ * @return	: number of bytes sent; -1 = no capture
+ * NOTE: call from a low priority task; pbcb's buffer is restored when done.
+ * *************************************************************************/
+
+extern struct ADCCAPTURE adccapture;
+
+#endif
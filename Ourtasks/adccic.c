@@ -0,0 +1,221 @@
+/******************************************************************************
+* File Name          : adccic.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : CIC decimator for ADC channels, integer
+*******************************************************************************/
+/*
+Register width: the output before scaling is at most
+(largest input) * rate^order, e.g. 4095 * 16 * 256^4 < 2^48, so the
+integrators and combs are 64b (two instruction adds on the M4).
+*/
+#include <math.h>
+#include "adccic.h"
+
+static int cic_out(struct ADCCIC* pc, uint32_t* pout);
+
+/* *************************************************************************
+ * static float cic_droop(float f, int order, int rate, int pre);
+ * @brief	: Pass band gain: CIC plus the 'pre' boxcar in front of it
+ * @param	: f = frequency, ratio of the output rate (0 < f < 0.5)
+ * @return	: gain (1.0 at dc)
+ * *************************************************************************/
+static float cic_droop(float f, int order, int rate, int pre)
+{
+	float fi = f / rate; // Ratio of the CIC input rate
+	float d;
+	float g = 1;
+	int i;
+
+	d = sinf(3.14159265f * f) / (rate * sinf(3.14159265f * fi));
+	for (i = 0; i < order; i++) g *= d;
+	if (pre > 1)
+		g *= sinf(3.14159265f * fi) / (pre * sinf(3.14159265f * fi / pre));
+	return g;
+}
+/* *************************************************************************
+ * int adccic_init(struct ADCCIC* pc, uint8_t order, uint16_t rate, uint16_t pre, uint8_t comp, uint32_t full);
+ * @brief	: Set up and zero a CIC decimator
+ * @param	: pc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: order = 1 - ADCCICMAXORDER
+ * @param	: rate = inputs per output (ADCCICMINRATE - ADCCICMAXRATE)
+ * @param	: pre = samples summed in each input (1 = raw; droop compensation only)
+ * @param	: comp = 1: droop compensation FIR on the output
+ * @param	: full = output full scale (largest input * rate)
+ * @return	: 0 = OK; -1 = bad order or rate ('order' left 0)
+ * *************************************************************************/
+/*
+Compensation: with D = droop and c = 2 - 2cos(2*pi*f) the compensated gain
+is D*(1 + a*c); least squares over the band gives
+	a = sum(D*c*(1 - D)) / sum((D*c)^2)
+*/
+#define CICFITPTS 16 // Compensation fit: points in the band
+int adccic_init(struct ADCCIC* pc, uint8_t order, uint16_t rate, uint16_t pre, uint8_t comp, uint32_t full)
+{
+	float f;
+	float d;
+	float c;
+	float num = 0;
+	float den = 0;
+	uint64_t g = 1;
+	int i;
+
+	pc->order = 0;
+	if ((order < 1) || (order > ADCCICMAXORDER)) return -1;
+	if ((rate < ADCCICMINRATE) || (rate > ADCCICMAXRATE)) return -1;
+
+	for (i = 0; i < ADCCICMAXORDER; i++)
+	{
+		pc->integ[i] = 0;
+		pc->comb[i]  = 0;
+	}
+	pc->rate = rate;
+	pc->ct   = rate;
+	pc->fill = order;
+	pc->prime = 1;
+	pc->full = full;
+
+	/* Output scale: a shift when rate is a power of 2. */
+	for (i = 1; i < order; i++) g *= rate;
+	pc->gdiv   = g;
+	pc->gshift = 0;
+	if ((rate & (rate - 1)) == 0)
+	{
+		pc->gdiv = 0;
+		while (g > 1) {g >>= 1; pc->gshift += 1;}
+	}
+
+	/* Droop compensation coefficient. */
+	pc->compa = 0;
+	if (comp != 0)
+	{
+		for (i = 1; i <= CICFITPTS; i++)
+		{
+			f = (ADCCICPASS * i) / CICFITPTS;
+			d = cic_droop(f, order, rate, pre);
+			c = 2.0f - 2.0f * cosf(2.0f * 3.14159265f * f);
+			num += d * c * (1.0f - d);
+			den += d * c * d * c;
+		}
+		pc->compa = (int32_t)((num / den) * 65536.0f + 0.5f);
+	}
+	pc->order = order;
+	return 0;
+}
+/* *************************************************************************
+ * static int cic_out(struct ADCCIC* pc, uint32_t* pout);
+ * @brief	: Combs, scale, compensation (every 'rate' inputs)
+ * @return	: 1 = new output in *pout; 0 = start-up, none
+ * *************************************************************************/
+static int cic_out(struct ADCCIC* pc, uint32_t* pout)
+{
+	uint64_t v = pc->integ[pc->order - 1];
+	uint64_t t;
+	uint32_t x;
+	int64_t  y;
+	int i;
+
+	pc->ct = pc->rate;
+	for (i = 0; i < pc->order; i++)
+	{
+		t = v - pc->comb[i];
+		pc->comb[i] = v;
+		v = t;
+	}
+
+	if (pc->fill != 0)
+	{ // Start-up: combs not full yet
+		pc->fill -= 1;
+		return 0;
+	}
+
+	/* Same full scale as a plain sum of 'rate' inputs (rounded). */
+	if (pc->gdiv == 0)
+		x = (v + (((uint64_t)1 << pc->gshift) >> 1)) >> pc->gshift;
+	else
+		x = (v + (pc->gdiv >> 1)) / pc->gdiv;
+
+	if (pc->compa != 0)
+	{
+		if (pc->prime != 0)
+		{ // First output: as if it had always been there
+			pc->prime = 0;
+			pc->x1 = x;
+			pc->x2 = x;
+		}
+		y = (int64_t)pc->x1 + ((((int64_t)pc->x1 * 2 - x - pc->x2) * pc->compa) >> 16);
+		pc->x2 = pc->x1;
+		pc->x1 = x;
+		if (y < 0) y = 0;
+		if (y > pc->full) y = pc->full;
+		x = y;
+	}
+	*pout = x;
+	return 1;
+}
+/* *************************************************************************
+ * int adccic_in(struct ADCCIC* pc, uint32_t x, uint32_t* pout);
+ * @brief	: One input
+ * @param	: pc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new input
+ * @param	: pout = Pointer for output (only stored when there is one)
+ * @return	: 1 = new output in *pout; 0 = not yet
+ * *************************************************************************/
+int adccic_in(struct ADCCIC* pc, uint32_t x, uint32_t* pout)
+{
+	uint64_t acc = x;
+	int i;
+
+	for (i = 0; i < pc->order; i++)
+	{
+		pc->integ[i] += acc;
+		acc = pc->integ[i];
+	}
+	pc->ct -= 1;
+	if (pc->ct != 0) return 0;
+	return cic_out(pc, pout);
+}
+/* *************************************************************************
+ * int adccic_blk(struct ADCCIC* pc, const uint16_t* px, int stride, int n, uint32_t* pout);
+ * @brief	: 'n' inputs, e.g. one channel's raw samples in the DMA buffer
+ * @param	: pc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: px = Pointer to first input
+ * @param	: stride = distance between inputs (e.g. ADC1IDX_ADCSCANSIZE)
+ * @param	: n = number of inputs
+ * @param	: pout = Pointer for output (latest, if more than one)
+ * @return	: number of outputs (0 = none)
+ * *************************************************************************/
+/* Integrators kept in locals for the run of inputs. */
+int adccic_blk(struct ADCCIC* pc, const uint16_t* px, int stride, int n, uint32_t* pout)
+{
+	uint64_t i0 = pc->integ[0];
+	uint64_t i1 = pc->integ[1];
+	uint64_t i2 = pc->integ[2];
+	uint64_t i3 = pc->integ[3];
+	uint8_t order = pc->order;
+	int nout = 0;
+
+	while (n-- > 0)
+	{
+		i0 += *px;
+		if (order > 1) i1 += i0;
+		if (order > 2) i2 += i1;
+		if (order > 3) i3 += i2;
+		px += stride;
+
+		pc->ct -= 1;
+		if (pc->ct == 0)
+		{
+			pc->integ[0] = i0;
+			pc->integ[1] = i1;
+			pc->integ[2] = i2;
+			pc->integ[3] = i3;
+			nout += cic_out(pc, pout);
+		}
+	}
+	pc->integ[0] = i0;
+	pc->integ[1] = i1;
+	pc->integ[2] = i2;
+	pc->integ[3] = i3;
+	return nout;
+}
@@ -0,0 +1,90 @@
+/******************************************************************************
+* File Name          : adccic.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : CIC decimator for ADC channels, integer
+*******************************************************************************/
+/*
+Cascaded integrator-comb: 'order' integrators at the input rate, one
+output per 'rate' inputs, then 'order' combs at the output rate.  Same
+response as 'order' boxcar sums of 'rate' in a row (order 1 = the plain sum
+adcparams_decimate does), with nulls at every multiple of the output rate,
+so the bands that fold onto dc are cut 'order' times as hard.  Adds and
+subtracts only; the registers wrap (modulo 2^64), which the combs undo.
+
+Inputs: either the 1/2 DMA buffer sums (adcfastsum_stat) or the raw
+samples of the channel straight from the DMA buffer (adccic_blk), which puts
+the first stage at the scan rate instead of the 1/2 buffer rate.  A sum
+input is itself a boxcar of 'pre' samples; the droop compensation allows
+for it.
+
+The output is divided by rate^(order-1) so it has the same full scale as a
+plain sum of the same inputs: the calibration, compensation and 'outbits'
+set up for the channel's decimated sum apply unchanged.
+
+Droop: the pass band falls off as (sin(pi*f)/(rate*sin(pi*f/rate)))^order.
+'comp' = 1 adds a 3 tap linear phase FIR at the output rate,
+	y = x[n-1] + a*(2*x[n-1] - x[n] - x[n-2])
+with 'a' fit at init (least squares) to flatten 0 - ADCCICPASS of the
+output rate; one output more delay.
+
+The first 'order' outputs are the start-up transient and are not given.
+*/
+
+#ifndef __ADCCIC
+#define __ADCCIC
+
+#include <stdint.h>
+
+#define ADCCICMAXORDER 4
+#define ADCCICMINRATE  2
+#define ADCCICMAXRATE  256
+#define ADCCICPASS     0.25f // Droop compensation band: ratio of output rate
+
+/* With this struct one pointer will convey everything necessary. */
+struct ADCCIC
+{
+	uint64_t integ[ADCCICMAXORDER]; // Integrators
+	uint64_t comb[ADCCICMAXORDER];  // Comb delays
+	uint64_t gdiv;  // Output divisor rate^(order-1) (0 = power of 2: 'gshift')
+	uint32_t x1;    // Compensation: previous output
+	uint32_t x2;    // Compensation: output before that
+	uint32_t full;  // Full scale of the output (compensation is clamped to it)
+	int32_t  compa; // Compensation coefficient 'a': Q16 (0 = none)
+	uint16_t rate;  // Inputs per output
+	uint16_t ct;    // Count down to the next output
+	uint8_t  order; // 1 - 4 (0 = not set up)
+	uint8_t  gshift;// Output right shift (gdiv = 0)
+	uint8_t  fill;  // Outputs still to drop (start-up)
+	uint8_t  prime; // 1 = next output fills the compensation history
+};
+
+/* *************************************************************************/
+int adccic_init(struct ADCCIC* pc, uint8_t order, uint16_t rate, uint16_t pre, uint8_t comp, uint32_t full);
+/* @brief	: Set up and zero a CIC decimator
+ * @param	: pc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: order = 1 - ADCCICMAXORDER
+ * @param	: rate = inputs per output (ADCCICMINRATE - ADCCICMAXRATE)
+ * @param	: pre = samples summed in each input (1 = raw; droop compensation only)
+ * @param	: comp = 1: droop compensation FIR on the output
+ * @param	: full = output full scale (largest input * rate)
+ * @return	: 0 = OK; -1 = bad order or rate ('order' left 0)
+ * *************************************************************************/
+int adccic_in(struct ADCCIC* pc, uint32_t x, uint32_t* pout);
+/* @brief	: One input
+ * @param	: pc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new input
+ * @param	: pout = Pointer for output (only stored when there is one)
+ * @return	: 1 = new output in *pout; 0 = not yet
+ * *************************************************************************/
+int adccic_blk(struct ADCCIC* pc, const uint16_t* px, int stride, int n, uint32_t* pout);
+/* @brief	: 'n' inputs, e.g. one channel's raw samples in the DMA buffer
+ * @param	: pc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: px = Pointer to first input
+ * @param	: stride = distance between inputs (e.g. ADC1IDX_ADCSCANSIZE)
+ * @param	: n = number of inputs
+ * @param	: pout = Pointer for output (latest, if more than one)
+ * @return	: number of outputs (0 = none)
+ * *************************************************************************/
+
+#endif
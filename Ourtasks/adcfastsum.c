@@ -0,0 +1,238 @@
+/******************************************************************************
+* File Name          : adcfastsum.c
+* Date First Issued  : 03/16/2019
+* Description        : Fast sum: ADC DMA buffering--'M' sequences, 'N' channels
+*******************************************************************************/
+/*
+10/17/2026 - Replaces adcfastsum16 (16 scans, 16b sums, one channel at a time).
+10/18/2026 - Packed and C bodies split out by name so both can be timed.
+
+The dma buffer is scans of ADC1IDX_ADCSCANSIZE uint16_t.  With an even channel
+count each 32b word is the same pair of channels in every scan, so one __UADD16
+adds two channels.  The 16b lanes are good for 16 scans (16 x 4095 = 65520),
+after which they are added into the 32b sums and cleared.
+
+The C version walks the buffer in order, adding each reading to its channel's
+32b sum.
+
+'adcfastsum_stat' does the sum plus min, max, and sum of squares in the same
+pass, so ripple (max - min) and RMS come at the 1/2 DMA buffer rate without a
+second walk through the buffer.  With the DSP extension the min/max are also
+two channels at a time: USUB16 sets the GE flags per halfword and SEL picks
+the larger (or smaller) halfword.  The squares are one multiply-accumulate
+per reading into 32b (4095^2 x 256 scans still fits).
+*/
+
+#include "adcfastsum.h"
+#include <math.h>
+#include "stm32f4xx_hal.h"
+#ifdef HOSTBUILD
+  #include "cmsis_simd.h" // C stand-ins for __UADD16, __USUB16, __SEL
+#endif
+
+#define ADCFASTSUMPAIRS (ADC1IDX_ADCSCANSIZE / 2) // Number of 32b words per scan
+
+/* *************************************************************************
+ * void adcfastsum(uint32_t* psum, uint16_t* pdma);
+ *	@brief	: Sum 1/2 dma buffer: ADC1DMANUMSEQ scans of ADC1IDX_ADCSCANSIZE channels
+ * @param	: psum = pointer to sums (ADC1IDX_ADCSCANSIZE)
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+void adcfastsum(uint32_t* psum, uint16_t* pdma)
+{
+#ifdef ADCFASTSUM_SIMD
+	adcfastsum_simd(psum, pdma);
+#else
+	adcfastsum_c(psum, pdma);
+#endif
+	return;
+}
+#ifdef ADCFASTSUM_PACKED
+/* *************************************************************************
+ * void adcfastsum_simd(uint32_t* psum, uint16_t* pdma);
+ *	@brief	: Packed (__UADD16) summation, two channels per add
+ * @param	: psum = pointer to sums (ADC1IDX_ADCSCANSIZE)
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+void adcfastsum_simd(uint32_t* psum, uint16_t* pdma)
+{
+	uint32_t acc[ADCFASTSUMPAIRS]; // Two 16b lanes: channels 2k (low), 2k+1 (high)
+	uint32_t* pw = (uint32_t*)pdma;
+	uint32_t nblk;
+	uint32_t i;
+	uint32_t j;
+	int k;
+
+	for (k = 0; k < ADC1IDX_ADCSCANSIZE; k++) psum[k] = 0;
+
+	for (i = 0; i < ADC1DMANUMSEQ; i += ADCFASTSUMBLK)
+	{
+		nblk = ADC1DMANUMSEQ - i;
+		if (nblk > ADCFASTSUMBLK) nblk = ADCFASTSUMBLK;
+
+		for (k = 0; k < ADCFASTSUMPAIRS; k++) acc[k] = 0;
+
+		for (j = 0; j < nblk; j++)
+		{ // One scan: ADCFASTSUMPAIRS packed adds (unrolled by the compiler)
+			for (k = 0; k < ADCFASTSUMPAIRS; k++)
+				acc[k] = __UADD16(acc[k], pw[k]);
+			pw += ADCFASTSUMPAIRS;
+		}
+
+		/* Spill lanes to 32b sums */
+		for (k = 0; k < ADCFASTSUMPAIRS; k++)
+		{
+			psum[2*k + 0] += (acc[k] & 0xffff);
+			psum[2*k + 1] += (acc[k] >> 16);
+		}
+	}
+	return;
+}
+#endif
+/* *************************************************************************
+ * void adcfastsum_c(uint32_t* psum, uint16_t* pdma);
+ *	@brief	: Portable C summation (same result as adcfastsum)
+ * @param	: psum = pointer to sums (ADC1IDX_ADCSCANSIZE)
+ * @param	: pdma = pointer to 1/2 dma buffer
+ * *************************************************************************/
+void adcfastsum_c(uint32_t* psum, uint16_t* pdma)
+{
+	uint16_t* pend = pdma + (ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE);
+	int k;
+
+	for (k = 0; k < ADC1IDX_ADCSCANSIZE; k++) psum[k] = 0;
+
+	do
+	{
+		for (k = 0; k < ADC1IDX_ADCSCANSIZE; k++)
+			psum[k] += pdma[k];
+		pdma += ADC1IDX_ADCSCANSIZE;
+	} while (pdma != pend);
+	return;
+}
+/* *************************************************************************
+ * void adcfastsum_stat(struct ADC1DATA* padc1, uint16_t* pdma);
+ *	@brief	: Sum, sum of squares, min, max of 1/2 dma buffer, one pass
+ * @param	: padc1 = pointer to adcs1sum, adcs1sumsq, adcs1min, adcs1max
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+void adcfastsum_stat(struct ADC1DATA* padc1, uint16_t* pdma)
+{
+#ifdef ADCFASTSUM_SIMD
+	adcfastsum_stat_simd(padc1, pdma);
+#else
+	adcfastsum_stat_c(padc1, pdma);
+#endif
+	return;
+}
+#ifdef ADCFASTSUM_PACKED
+/* *************************************************************************
+ * void adcfastsum_stat_simd(struct ADC1DATA* padc1, uint16_t* pdma);
+ *	@brief	: Packed adcfastsum_stat: __UADD16 sums, __USUB16/__SEL min/max
+ * @param	: padc1 = pointer to adcs1sum, adcs1sumsq, adcs1min, adcs1max
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+void adcfastsum_stat_simd(struct ADC1DATA* padc1, uint16_t* pdma)
+{
+	uint32_t* psum = &padc1->adcs1sum[0];
+	uint32_t* psq  = &padc1->adcs1sumsq[0];
+	uint32_t acc[ADCFASTSUMPAIRS]; // Two 16b lanes: channels 2k (low), 2k+1 (high)
+	uint32_t mn[ADCFASTSUMPAIRS];  // Min, two 16b lanes
+	uint32_t mx[ADCFASTSUMPAIRS];  // Max, two 16b lanes
+	uint32_t* pw = (uint32_t*)pdma;
+	uint32_t w;
+	uint32_t nblk;
+	uint32_t i;
+	uint32_t j;
+	int k;
+
+	for (k = 0; k < ADC1IDX_ADCSCANSIZE; k++) {psum[k] = 0; psq[k] = 0;}
+	for (k = 0; k < ADCFASTSUMPAIRS; k++) {mn[k] = 0xffffffff; mx[k] = 0;}
+
+	for (i = 0; i < ADC1DMANUMSEQ; i += ADCFASTSUMBLK)
+	{
+		nblk = ADC1DMANUMSEQ - i;
+		if (nblk > ADCFASTSUMBLK) nblk = ADCFASTSUMBLK;
+
+		for (k = 0; k < ADCFASTSUMPAIRS; k++) acc[k] = 0;
+
+		for (j = 0; j < nblk; j++)
+		{
+			for (k = 0; k < ADCFASTSUMPAIRS; k++)
+			{
+				w = pw[k];
+				acc[k] = __UADD16(acc[k], w);
+				__USUB16(w, mx[k]);           // GE per halfword: w >= mx
+				mx[k] = __SEL(w, mx[k]);
+				__USUB16(mn[k], w);           // GE per halfword: mn >= w
+				mn[k] = __SEL(w, mn[k]);
+				psq[2*k + 0] += (w & 0xffff) * (w & 0xffff);
+				psq[2*k + 1] += (w >> 16) * (w >> 16);
+			}
+			pw += ADCFASTSUMPAIRS;
+		}
+
+		/* Spill lanes to 32b sums */
+		for (k = 0; k < ADCFASTSUMPAIRS; k++)
+		{
+			psum[2*k + 0] += (acc[k] & 0xffff);
+			psum[2*k + 1] += (acc[k] >> 16);
+		}
+	}
+	for (k = 0; k < ADCFASTSUMPAIRS; k++)
+	{
+		padc1->adcs1min[2*k + 0] = mn[k] & 0xffff;
+		padc1->adcs1min[2*k + 1] = mn[k] >> 16;
+		padc1->adcs1max[2*k + 0] = mx[k] & 0xffff;
+		padc1->adcs1max[2*k + 1] = mx[k] >> 16;
+	}
+	return;
+}
+#endif
+/* *************************************************************************
+ * void adcfastsum_stat_c(struct ADC1DATA* padc1, uint16_t* pdma);
+ *	@brief	: Portable C adcfastsum_stat (same result)
+ * @param	: padc1 = pointer to adcs1sum, adcs1sumsq, adcs1min, adcs1max
+ * @param	: pdma = pointer to 1/2 dma buffer
+ * *************************************************************************/
+void adcfastsum_stat_c(struct ADC1DATA* padc1, uint16_t* pdma)
+{
+	uint32_t* psum = &padc1->adcs1sum[0];
+	uint32_t* psq  = &padc1->adcs1sumsq[0];
+	uint16_t* pmin = &padc1->adcs1min[0];
+	uint16_t* pmax = &padc1->adcs1max[0];
+	uint16_t* pend = pdma + (ADC1DMANUMSEQ * ADC1IDX_ADCSCANSIZE);
+	uint32_t x;
+	int k;
+
+	for (k = 0; k < ADC1IDX_ADCSCANSIZE; k++)
+		{psum[k] = 0; psq[k] = 0; pmin[k] = 0xffff; pmax[k] = 0;}
+
+	do
+	{
+		for (k = 0; k < ADC1IDX_ADCSCANSIZE; k++)
+		{
+			x = pdma[k];
+			psum[k] += x;
+			psq[k]  += x * x;
+			if (x < pmin[k]) pmin[k] = x;
+			if (x > pmax[k]) pmax[k] = x;
+		}
+		pdma += ADC1IDX_ADCSCANSIZE;
+	} while (pdma != pend);
+	return;
+}
+/* *************************************************************************
+ * float adcfastsum_acrms(struct ADC1DATA* padc1, uint8_t adcidx);
+ *	@brief	: AC (ripple) RMS of a channel's last 1/2 dma buffer
+ * @param	: padc1 = pointer to sums from adcfastsum_stat
+ * @param	: adcidx = index into ADC1 array
+ * @return	: sqrt(mean of squares - mean^2), raw ADC counts
+ * *************************************************************************/
+float adcfastsum_acrms(struct ADC1DATA* padc1, uint8_t adcidx)
+{
+	float mean = (float)padc1->adcs1sum[adcidx] * (1.0f / ADC1DMANUMSEQ);
+	float var  = (float)padc1->adcs1sumsq[adcidx] * (1.0f / ADC1DMANUMSEQ) - mean * mean;
+	if (var <= 0) return 0;
+	return sqrtf(var);
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+* File Name          : adcfastsum.h
+* Date First Issued  : 03/16/2019
+* Description        : Fast sum for summimng ADC DMA buffering
+*******************************************************************************/
+/*
+10/17/2026 - Replaces adcfastsum16: any ADC1DMANUMSEQ, 32b sums, packed add.
+10/17/2026 - adcfastsum_stat: min, max, sum of squares in the same pass.
+10/18/2026 - Packed versions callable by name; host build compiles them too.
+
+Peak-to-peak: adcs1max - adcs1min.  True RMS (raw counts):
+sqrt(adcs1sumsq/ADC1DMANUMSEQ); ripple (AC) RMS: adcfastsum_acrms.
+*/
+
+#ifndef __ADCFASTSUM
+#define __ADCFASTSUM
+
+#include <stdint.h>
+#include "adcparams.h"
+
+/* Cortex-M4 DSP packed add: two channels per __UADD16.  Needs an even number
+   of channels so each 32b word of the dma buffer is the same channel pair in
+   every scan.  The host build compiles the packed versions with the C
+   stand-ins in 'Host/Inc/cmsis_simd.h' so they can be checked ('a' mode). */
+#if ((ADC1IDX_ADCSCANSIZE & 1) == 0) && (defined (__ARM_FEATURE_DSP) || defined (HOSTBUILD))
+  #define ADCFASTSUM_PACKED // adcfastsum_simd, adcfastsum_stat_simd exist
+#endif
+
+/* adcfastsum, adcfastsum_stat use the packed versions on the board.
+   'ADCFASTSUM_NOSIMD' forces the C loop (for comparing cycles). */
+#if defined (ADCFASTSUM_PACKED) && !defined (HOSTBUILD) && !defined (ADCFASTSUM_NOSIMD)
+  #define ADCFASTSUM_SIMD
+#endif
+
+/* 16b lanes hold 16 x 4095 max, so lanes are added into the 32b sums every 16 scans. */
+#define ADCFASTSUMBLK  16
+
+/* Sum of squares is 32b: 4095^2 x 256 < 2^32 */
+#if (ADC1DMANUMSEQ > 256)
+  #error "adcfastsum_stat: ADC1DMANUMSEQ > 256 overflows adcs1sumsq"
+#endif
+
+/* *************************************************************************/
+void adcfastsum(uint32_t* psum, uint16_t* pdma);
+/*	@brief	: Sum 1/2 dma buffer: ADC1DMANUMSEQ scans of ADC1IDX_ADCSCANSIZE channels
+ * @param	: psum = pointer to sums (ADC1IDX_ADCSCANSIZE)
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+void adcfastsum_c(uint32_t* psum, uint16_t* pdma);
+/*	@brief	: Portable C summation (same result as adcfastsum)
+ * @param	: psum = pointer to sums (ADC1IDX_ADCSCANSIZE)
+ * @param	: pdma = pointer to 1/2 dma buffer
+ * *************************************************************************/
+void adcfastsum_stat(struct ADC1DATA* padc1, uint16_t* pdma);
+/*	@brief	: Sum, sum of squares, min, max of 1/2 dma buffer, one pass
+ * @param	: padc1 = pointer to adcs1sum, adcs1sumsq, adcs1min, adcs1max
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+void adcfastsum_stat_c(struct ADC1DATA* padc1, uint16_t* pdma);
+/*	@brief	: Portable C adcfastsum_stat (same result)
+ * @param	: padc1 = pointer to adcs1sum, adcs1sumsq, adcs1min, adcs1max
+ * @param	: pdma = pointer to 1/2 dma buffer
+ * *************************************************************************/
+#ifdef ADCFASTSUM_PACKED
+void adcfastsum_simd(uint32_t* psum, uint16_t* pdma);
+/*	@brief	: Packed (__UADD16) summation, two channels per add
+ * @param	: psum = pointer to sums (ADC1IDX_ADCSCANSIZE)
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+void adcfastsum_stat_simd(struct ADC1DATA* padc1, uint16_t* pdma);
+/*	@brief	: Packed adcfastsum_stat: __UADD16 sums, __USUB16/__SEL min/max
+ * @param	: padc1 = pointer to adcs1sum, adcs1sumsq, adcs1min, adcs1max
+ * @param	: pdma = pointer to 1/2 dma buffer (word aligned)
+ * *************************************************************************/
+#endif
+float adcfastsum_acrms(struct ADC1DATA* padc1, uint8_t adcidx);
+/*	@brief	: AC (ripple) RMS of a channel's last 1/2 dma buffer
+ * @param	: padc1 = pointer to sums from adcfastsum_stat
+ * @param	: adcidx = index into ADC1 array
+ * @return	: sqrt(mean of squares - mean^2), raw ADC counts
+ * *************************************************************************/
+
+#endif
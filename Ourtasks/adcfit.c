@@ -0,0 +1,296 @@
+/******************************************************************************
+* File Name          : adcfit.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : On-board least squares fit of ADC channel calibrations
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "adcfit.h"
+
+struct ADCFIT adcfit;
+
+static void fit_done(struct ADCFIT* p, int ret);
+static void fit_point(struct ADCFITCHAN* pch, double x, double y, double xfs);
+
+/* *************************************************************************
+ * int adcfit_init(struct CAN_CTLBLOCK* pctl, uint32_t canid, uint32_t notebit);
+ * @brief	: Initialize; optionally add a CAN command mailbox
+ * @param	: pctl = CAN control block for commands; NULL = no CAN commands
+ * @param	: canid = CAN ID of command msg
+ * @param	: notebit = ADCTask notification bit for the command mailbox
+ * @return	: 0 = OK; -1 = mailbox add failed
+ * NOTE: call from the ADCTask (mailbox notifications go to the current task)
+ * *************************************************************************/
+int adcfit_init(struct CAN_CTLBLOCK* pctl, uint32_t canid, uint32_t notebit)
+{
+	struct ADCFIT* p = &adcfit;
+
+	memset(p->ch, 0, sizeof(p->ch));
+	p->reqflag = 0;
+	p->pmbx = NULL;
+
+	if (pctl == NULL) return 0;
+
+	/* The command is taken from the raw payload, so the payload type is not used. */
+	p->pmbx = MailboxTask_add(pctl, canid, NULL, notebit, 0, 0);
+	if (p->pmbx == NULL) return -1;
+	return 0;
+}
+/* *************************************************************************
+ * int adcfit_req(uint8_t cmd, uint8_t chan, float val);
+ * @brief	: Post a command (any task)
+ * @param	: cmd = ADCFITCMD_
+ * @param	: chan = ADC1 channel index
+ * @param	: val = point: known value; fit: order
+ * @return	: 0 = posted; -1 = busy with the last one; -2 = bad command/channel
+ * *************************************************************************/
+int adcfit_req(uint8_t cmd, uint8_t chan, float val)
+{
+	struct ADCFIT* p = &adcfit;
+
+	if ((cmd > ADCFITCMD_CLEAR) || (chan >= ADC1IDX_ADCSCANSIZE)) return -2;
+	if ((chan == ADC1IDX_INTERNALVREF) || (chan == ADC1IDX_INTERNALTEMP) ||
+	    (chan == ADC1IDX_5VOLTSUPPLY)) return -2; // Done in adcparams_internal
+	if ((cmd == ADCFITCMD_FIT) && ((val < 1) || (val > ADCFITORDMAX))) return -2;
+
+taskENTER_CRITICAL();
+	if (p->reqflag != 0)
+	{
+taskEXIT_CRITICAL();
+		return -1;
+	}
+	p->req.cmd   = cmd;
+	p->req.chan  = chan;
+	p->req.val   = val;
+	p->req.order = (cmd == ADCFITCMD_FIT) ? (uint8_t)val : 0;
+	p->xacc = 0;
+	p->navg = 0;
+	p->reqflag = 1;
+taskEXIT_CRITICAL();
+	return 0;
+}
+/* *************************************************************************
+ * int adcfit_line(char* pline);
+ * @brief	: Post a command from a text line (any task)
+ * @param	: pline = pointer to zero terminated line
+ * @return	: as adcfit_req; -3 = not a "cal" line
+ * *************************************************************************/
+int adcfit_line(char* pline)
+{
+	char* pc;
+	unsigned long chan;
+
+	while (*pline == ' ') pline++;
+	if (strncmp(pline, "cal ", 4) != 0) return -3;
+
+	chan = strtoul(pline + 4, &pc, 0);
+	if (pc == pline + 4) return -3;
+	if (chan >= ADC1IDX_ADCSCANSIZE) return -2; // Before it is cut to uint8_t
+	while (*pc == ' ') pc++;
+
+	switch (*pc)
+	{
+	case 'p': return adcfit_req(ADCFITCMD_POINT, chan, strtof(pc + 1, NULL));
+	case 'f': return adcfit_req(ADCFITCMD_FIT,   chan, strtoul(pc + 1, NULL, 0));
+	case 'c': return adcfit_req(ADCFITCMD_CLEAR, chan, 0);
+	}
+	return -3;
+}
+/* *************************************************************************
+ * void adcfit_cancmd(void);
+ * @brief	: Handle CAN command mailbox notification (ADCTask)
+ * *************************************************************************/
+void adcfit_cancmd(void)
+{
+	struct CANRCVBUF* pcan;
+	float val;
+
+	if (adcfit.pmbx == NULL) return;
+	pcan = &adcfit.pmbx->ncan.can;
+	if ((pcan->dlc & 0xf) < 2) return;
+
+	switch (pcan->cd.uc[0])
+	{
+	case ADCFITCMD_POINT:
+		if ((pcan->dlc & 0xf) < 6) return;
+		memcpy(&val, &pcan->cd.uc[2], sizeof(float)); // Little endian, same as ours
+		adcfit_req(ADCFITCMD_POINT, pcan->cd.uc[1], val);
+		break;
+
+	case ADCFITCMD_FIT:
+		if ((pcan->dlc & 0xf) < 3) return;
+		adcfit_req(ADCFITCMD_FIT, pcan->cd.uc[1], pcan->cd.uc[2]);
+		break;
+
+	case ADCFITCMD_CLEAR:
+		adcfit_req(ADCFITCMD_CLEAR, pcan->cd.uc[1], 0);
+		break;
+	}
+	return;
+}
+/* *************************************************************************
+ * void adcfit_poll(uint32_t ready);
+ * @brief	: Carry out a posted command (ADCTask, after adcparams_all)
+ * @param	: ready = bit per channel with a new output (adc1data.decready)
+ * *************************************************************************/
+void adcfit_poll(uint32_t ready)
+{
+	struct ADCFIT* p = &adcfit;
+	struct ADCFITCHAN* pch;
+	uint8_t chan;
+	float g;
+	float c[ADCCALIBSIZE];
+	int ret;
+
+	if (p->reqflag == 0) return;
+	chan = p->req.chan;
+	pch  = &p->ch[chan];
+
+	switch (p->req.cmd)
+	{
+	case ADCFITCMD_POINT:
+		if ((ready & (1 << chan)) == 0) return; // Only new outputs
+		g = adcparams_calg(chan);
+		p->xacc += adc1soa.decsum[chan] * g;
+		p->navg += 1;
+		if (p->navg < ADCFIT_NAVG) return;
+
+		p->done.x = p->xacc / p->navg;
+		fit_point(pch, p->done.x, p->req.val, (4095.0 * ADC1DMANUMSEQ) * adc1soa.decn[chan] * g);
+		fit_done(p, pch->n);
+		break;
+
+	case ADCFITCMD_FIT:
+		ret = adcfit_solve(pch, p->req.order, c);
+		if (ret == 0)
+		{
+			if (adcparams_setcal(chan, p->req.order, c) != 0)
+				ret = ADCFITERR_SETCAL;
+		}
+		fit_done(p, ret);
+		break;
+
+	default: // ADCFITCMD_CLEAR
+		memset(pch, 0, sizeof(struct ADCFITCHAN));
+		fit_done(p, 0);
+		break;
+	}
+	return;
+}
+/* Record the result and take the next command. */
+static void fit_done(struct ADCFIT* p, int ret)
+{
+	p->done.req = p->req;
+	p->done.ret = ret;
+	p->done.seq += 1;
+	p->reqflag = 0;
+	return;
+}
+/* Add {x, y} to the sums.  xfs = full scale x, for the scale of u. */
+static void fit_point(struct ADCFITCHAN* pch, double x, double y, double xfs)
+{
+	double u;
+	double uk = 1.0;
+	int k;
+
+	if (pch->n == 0)
+	{
+		pch->xs = (xfs < 0) ? -xfs : xfs;
+		if (pch->xs == 0) pch->xs = 1.0;
+	}
+	u = x / pch->xs;
+	for (k = 0; k < 2*ADCFITORDMAX + 1; k++)
+	{
+		pch->su[k] += uk;
+		if (k <= ADCFITORDMAX) pch->sy[k] += y * uk;
+		uk *= u;
+	}
+	pch->syy += y * y;
+	pch->n += 1;
+	return;
+}
+/* *************************************************************************
+ * int adcfit_solve(struct ADCFITCHAN* pch, int order, float* pc);
+ * @brief	: Least squares coefficients from a channel's sums
+ * @param	: pch = pointer to channel sums
+ * @param	: order = 1 - ADCFITORDMAX
+ * @param	: pc = pointer to coefficients c0 ... c'order' (x units)
+ * @return	: 0 = OK; ADCFITERR_POINTS, ADCFITERR_SINGULAR
+ * *************************************************************************/
+/*
+Normal equations: sum_k su[j+k] a[k] = sy[j], j = 0..order, solved by
+Gaussian elimination with partial pivoting; then c[k] = a[k] / xs^k.
+*/
+int adcfit_solve(struct ADCFITCHAN* pch, int order, float* pc)
+{
+	double m[ADCFITORDMAX + 1][ADCFITORDMAX + 2]; // Augmented matrix
+	double a[ADCFITORDMAX + 1];
+	double t;
+	double sse;
+	double xsk = 1.0;
+	int n = order + 1;
+	int i;
+	int j;
+	int k;
+	int piv;
+
+	if ((order < 1) || (order > ADCFITORDMAX)) return ADCFITERR_POINTS;
+	if (pch->n < n) return ADCFITERR_POINTS;
+
+	for (j = 0; j < n; j++)
+	{
+		for (k = 0; k < n; k++)
+			m[j][k] = pch->su[j + k];
+		m[j][n] = pch->sy[j];
+	}
+
+	for (i = 0; i < n; i++)
+	{
+		piv = i;
+		for (j = i + 1; j < n; j++)
+			if (fabs(m[j][i]) > fabs(m[piv][i])) piv = j;
+		if (fabs(m[piv][i]) <= 1E-12 * pch->su[0]) return ADCFITERR_SINGULAR;
+		if (piv != i)
+		{
+			for (k = i; k <= n; k++)
+				{t = m[i][k]; m[i][k] = m[piv][k]; m[piv][k] = t;}
+		}
+		for (j = i + 1; j < n; j++)
+		{
+			t = m[j][i] / m[i][i];
+			for (k = i; k <= n; k++)
+				m[j][k] -= t * m[i][k];
+		}
+	}
+	for (i = n - 1; i >= 0; i--)
+	{
+		t = m[i][n];
+		for (k = i + 1; k < n; k++)
+			t -= m[i][k] * a[k];
+		a[i] = t / m[i][i];
+	}
+
+	/* Residual: sum (y - p(u))^2 = syy - 2 a.sy + a.SU.a */
+	sse = pch->syy;
+	for (j = 0; j < n; j++)
+	{
+		sse -= 2 * a[j] * pch->sy[j];
+		for (k = 0; k < n; k++)
+			sse += a[j] * a[k] * pch->su[j + k];
+	}
+	pch->rms = (sse > 0) ? sqrt(sse / pch->n) : 0;
+
+	for (k = 0; k < ADCCALIBSIZE; k++)
+	{
+		pc[k] = 0;
+		if (k < n) pc[k] = a[k] / xsk;
+		xsk *= pch->xs;
+		pch->c[k] = pc[k];
+	}
+	return 0;
+}
@@ -0,0 +1,148 @@
+/******************************************************************************
+* File Name          : adcfit.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : On-board least squares fit of ADC channel calibrations
+*******************************************************************************/
+/*
+Calibration without recompiling 'adcparamsinit.c'--
+
+ 1. Apply a known input (e.g. 10.0 A) and send a "point" command with the
+    channel and the known value.  ADCTask averages the channel's next
+    ADCFIT_NAVG calibration inputs (the compensated reading that
+    cal.f[] is applied to) and adds the pair {x, known value} to the
+    channel's sums.
+ 2. Repeat for as many points as wanted.
+ 3. Send a "fit" command with the order (1 = offset & scale, 2, 3).  The
+    least squares coefficients are solved from the sums and put into
+    adc1channelstuff[].cal by adcparams_setcal, which rebuilds the
+    channel's handlers.  ADCTask does this between 1/2 buffers; the ADC
+    DMA is not stopped.
+ 4. "clear" starts the channel's points over.
+
+Each point adds to running sums (x^0..x^6, y*x^0..y*x^3, y^2), so adding
+a point is the same small amount of work no matter how many there are,
+and a fit solves at most a 4x4 set of normal equations.  x is scaled by
+the channel's full scale input to keep the sums well conditioned.
+
+Commands come from any task with adcfit_req, from a serial line with
+adcfit_line, or as a CAN msg (ADCFIT_CANID)--
+ [0] ADCFITCMD_, [1] channel, [2]-[5] point: known value (float, little
+ endian); fit: [2] = order.
+One command at a time: adcfit_req returns -1 while the last one is being
+done.  The result of the last one done is in adcfit.done.
+*/
+
+#ifndef __ADCFIT
+#define __ADCFIT
+
+#include <stdint.h>
+#include "adcparams.h"
+#include "stm32f4xx_hal.h"
+#include "MailboxTask.h"
+
+#define ADCFITORDMAX 3 // Highest order fit
+
+/* Calibration inputs averaged per point */
+#ifndef ADCFIT_NAVG
+  #define ADCFIT_NAVG 16
+#endif
+
+/* CAN command msg ID (CAN1) */
+#ifndef ADCFIT_CANID
+  #define ADCFIT_CANID 0xD0A00000
+#endif
+
+/* Commands */
+#define ADCFITCMD_POINT 0 // Add a point: known value
+#define ADCFITCMD_FIT   1 // Solve and apply: order
+#define ADCFITCMD_CLEAR 2 // Drop the channel's points
+
+/* Fit errors (ADCFITDONE.ret < 0) */
+#define ADCFITERR_POINTS  -1 // Fewer points than order + 1
+#define ADCFITERR_SINGULAR -2 // Points do not determine the coefficients (e.g. same x)
+#define ADCFITERR_SETCAL  -3 // adcparams_setcal did not take it
+
+/* Running sums for one channel */
+struct ADCFITCHAN
+{
+	double su[2*ADCFITORDMAX + 1]; // Sum u^k, u = x/xs
+	double sy[ADCFITORDMAX + 1];   // Sum y*u^k
+	double syy;   // Sum y^2
+	double xs;    // x scale (full scale calibration input at the first point)
+	float  c[ADCCALIBSIZE]; // Last fit: coefficients (in x)
+	float  rms;   // Last fit: rms residual
+	uint16_t n;   // Number of points
+};
+
+/* Command */
+struct ADCFITREQ
+{
+	float   val;  // Point: known value
+	uint8_t cmd;  // ADCFITCMD_
+	uint8_t chan; // ADC1 channel index
+	uint8_t order;// Fit: 1 - ADCFITORDMAX
+};
+
+/* Last command done */
+struct ADCFITDONE
+{
+	struct ADCFITREQ req;
+	float    x;   // Point: averaged calibration input
+	int      ret; // Point: number of points; fit: 0; < 0 = ADCFITERR_
+	uint32_t seq; // Incremented for each command done
+};
+
+struct ADCFIT
+{
+	struct ADCFITCHAN ch[ADC1IDX_ADCSCANSIZE];
+	struct ADCFITREQ  req;      // Command being done
+	struct ADCFITDONE done;     // Result of the last one
+	double   xacc;              // Point: calibration input sum
+	uint16_t navg;              // Point: number in 'xacc'
+	volatile uint8_t reqflag;   // 1 = 'req' posted, not done yet
+	struct MAILBOXCAN* pmbx;    // CAN command mailbox; NULL = none
+};
+
+/* *************************************************************************/
+int adcfit_init(struct CAN_CTLBLOCK* pctl, uint32_t canid, uint32_t notebit);
+/* @brief	: Initialize; optionally add a CAN command mailbox
+ * @param	: pctl = CAN control block for commands; NULL = no CAN commands
+ * @param	: canid = CAN ID of command msg
+ * @param	: notebit = ADCTask notification bit for the command mailbox
+ * @return	: 0 = OK; -1 = mailbox add failed
+ * NOTE: call from the ADCTask (mailbox notifications go to the current task)
+ * *************************************************************************/
+int adcfit_req(uint8_t cmd, uint8_t chan, float val);
+/* @brief	: Post a command (any task)
+ * @param	: cmd = ADCFITCMD_
+ * @param	: chan = ADC1 channel index
+ * @param	: val = point: known value; fit: order
+ * @return	: 0 = posted; -1 = busy with the last one; -2 = bad command/channel
+ * *************************************************************************/
+int adcfit_line(char* pline);
+/* @brief	: Post a command from a text line (any task)
+ *          :  "cal <chan> p <known value>"  add point
+ *          :  "cal <chan> f <order>"        fit and apply
+ *          :  "cal <chan> c"                clear points
+ * @param	: pline = pointer to zero terminated line
+ * @return	: as adcfit_req; -3 = not a "cal" line
+ * *************************************************************************/
+void adcfit_cancmd(void);
+/* @brief	: Handle CAN command mailbox notification (ADCTask)
+ * *************************************************************************/
+void adcfit_poll(uint32_t ready);
+/* @brief	: Carry out a posted command (ADCTask, after adcparams_all)
+ * @param	: ready = bit per channel with a new output (adc1data.decready)
+ * *************************************************************************/
+int adcfit_solve(struct ADCFITCHAN* pch, int order, float* pc);
+/* @brief	: Least squares coefficients from a channel's sums
+ * @param	: pch = pointer to channel sums
+ * @param	: order = 1 - ADCFITORDMAX
+ * @param	: pc = pointer to coefficients c0 ... c'order' (x units)
+ * @return	: 0 = OK; ADCFITERR_POINTS, ADCFITERR_SINGULAR
+ * *************************************************************************/
+
+extern struct ADCFIT adcfit;
+
+#endif
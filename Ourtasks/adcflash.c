@@ -0,0 +1,290 @@
+/******************************************************************************
+* File Name          : adcflash.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : ADC parameter & calibration images in high flash
+*******************************************************************************/
+/*
+See adcflash.h for the layout.  An image is good when the magic, version,
+size, CRC, and piecewise linear point indices all check.
+*/
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "adcflash.h"
+
+struct ADCFLASH adcflash;
+
+static const uint32_t slotaddr[2] = {ADCFLASH_ADDR0, ADCFLASH_ADDR1};
+
+/* CRC-32, reflected polynomial 0xEDB88320, four bits at a time. */
+static const uint32_t crctab[16] =
+{
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static int img_good(const struct ADCFLASHIMG* pi);
+static void img_apply(struct ADCCHANNELSTUFF* pacsx, const struct ADCFLASHIMG* pi);
+static int slot_blank(uint8_t slot, uint32_t off);
+static int slot_erase(uint8_t slot);
+
+/* *************************************************************************
+ * uint32_t adcflash_crc(const void* p, uint32_t n);
+ * @brief	: CRC-32 (IEEE 802.3, as zlib)
+ * @param	: p = pointer to bytes
+ * @param	: n = number of bytes
+ * @return	: CRC
+ * *************************************************************************/
+uint32_t adcflash_crc(const void* p, uint32_t n)
+{
+	const uint8_t* pc = (const uint8_t*)p;
+	uint32_t crc = 0xffffffff;
+
+	while (n-- != 0)
+	{
+		crc ^= *pc++;
+		crc = (crc >> 4) ^ crctab[crc & 0xf];
+		crc = (crc >> 4) ^ crctab[crc & 0xf];
+	}
+	return ~crc;
+}
+/* *************************************************************************
+ * int adcflash_load(struct ADCCHANNELSTUFF* pacsx);
+ * @brief	: Find the newest good image; load it into the channel tables (adcparams_init)
+ * @param	: pacsx = Pointer to struct "everything" for this ADC module
+ * @return	: 0 = loaded; -1 = no good image (compiled-in values stand)
+ * *************************************************************************/
+int adcflash_load(struct ADCCHANNELSTUFF* pacsx)
+{
+	struct ADCFLASH* p = &adcflash;
+	const struct ADCFLASHIMG* pi;
+	const struct ADCFLASHIMG* pbest = NULL;
+	uint32_t end[2];
+	uint32_t off;
+	uint8_t s;
+
+	p->slot = 0;
+	for (s = 0; s < 2; s++)
+	{
+		end[s] = ADCFLASH_SLOTSIZE;
+		for (off = 0; off + ADCFLASH_STRIDE <= ADCFLASH_SLOTSIZE; off += ADCFLASH_STRIDE)
+		{
+			pi = ADCFLASHMEM(slotaddr[s] + off);
+			if (pi->magic == 0xffffffff)
+			{ // Never written: neither is the rest of the slot
+				end[s] = off;
+				break;
+			}
+			if (img_good(pi) == 0) continue; // Cut off, or another version
+
+			if ((pbest == NULL) || ((int32_t)(pi->seq - pbest->seq) > 0))
+			{
+				pbest   = pi;
+				p->slot = s;
+			}
+		}
+	}
+	p->next = end[p->slot];
+	p->pnew = NULL;
+	p->pcur = pbest;
+	if (pbest == NULL)
+	{
+		p->seq = 0;
+		return -1;
+	}
+	p->seq = pbest->seq;
+	img_apply(pacsx, pbest);
+	return 0;
+}
+/* *************************************************************************
+ * int adcflash_build(struct ADCFLASHIMG* pimg);
+ * @brief	: Fill an image from the live channel tables
+ * @param	: pimg = pointer to image (RAM)
+ * @return	: 0 = OK; -1 = too many piecewise linear points
+ * *************************************************************************/
+/*
+The filter specs go in as they were put in use ('fspec'), not the live
+working values: a loaded image starts its filters over (adcparams_reload).
+*/
+int adcflash_build(struct ADCFLASHIMG* pimg)
+{
+	struct ADCCHANNELSTUFF* pstuff;
+	struct ADCFLASHCHAN* pc;
+	uint16_t nlut = 0;
+	int i;
+
+	memset(pimg, 0, sizeof(struct ADCFLASHIMG));
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		pstuff = &adc1channelstuff[i];
+		pc = &pimg->ch[i];
+		pc->xprms = pstuff->xprms;
+		pc->cal   = pstuff->cal;
+		pc->fpw   = pstuff->fspec;
+
+		if ((pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_LUT) && (pstuff->lut.ppts != NULL))
+		{
+			if (nlut + pstuff->lut.npts > ADCFLASH_LUTPTS) return -1;
+			memcpy(&pimg->lut[nlut], pstuff->lut.ppts, pstuff->lut.npts * sizeof(pimg->lut[0]));
+			pc->lutidx = nlut;
+			pc->lutn   = pstuff->lut.npts;
+			nlut += pstuff->lut.npts;
+		}
+	}
+	return 0;
+}
+/* *************************************************************************
+ * int adcflash_write(struct ADCFLASHIMG* pimg);
+ * @brief	: Program an image (version, sequence, CRC filled in); ADCTask puts it in use
+ * @param	: pimg = pointer to image (RAM)
+ * @return	: 0 = OK; -1 = last one not in use yet; -2 = erase failed;
+ *          : -3 = program failed; -4 = check of flash failed
+ * *************************************************************************/
+int adcflash_write(struct ADCFLASHIMG* pimg)
+{
+	struct ADCFLASH* p = &adcflash;
+	const struct ADCFLASHIMG* pi;
+	const uint32_t* pw = (const uint32_t*)pimg;
+	uint32_t addr;
+	uint32_t off  = p->next;
+	uint8_t  slot = p->slot;
+	int ret = 0;
+	int i;
+
+	if (p->pnew != NULL) return -1;
+
+	pimg->magic   = ADCFLASH_MAGIC;
+	pimg->version = ADCFLASH_VERSION;
+	pimg->size    = sizeof(struct ADCFLASHIMG);
+	pimg->seq     = p->seq + 1;
+	pimg->crc     = adcflash_crc(pimg, offsetof(struct ADCFLASHIMG, crc));
+
+	/* First unwritten place in the slot; none: erase and start the other one. */
+	while ((off + ADCFLASH_STRIDE <= ADCFLASH_SLOTSIZE) && (slot_blank(slot, off) == 0))
+		off += ADCFLASH_STRIDE;
+
+	HAL_FLASH_Unlock();
+	if (off + ADCFLASH_STRIDE > ADCFLASH_SLOTSIZE)
+	{
+		slot ^= 1;
+		off = 0;
+		p->erasect += 1;
+		if (slot_erase(slot) != 0)
+		{
+			HAL_FLASH_Lock();
+			return -2;
+		}
+	}
+
+	/* In address order: the CRC goes in last. */
+	addr = slotaddr[slot] + off;
+	for (i = 0; i < (int)(sizeof(struct ADCFLASHIMG) / sizeof(uint32_t)); i++)
+	{
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + i * sizeof(uint32_t), pw[i]) != HAL_OK)
+		{
+			ret = -3;
+			break;
+		}
+	}
+	HAL_FLASH_Lock();
+
+#ifndef HOSTBUILD
+	/* The data cache may hold the erased words read by slot_blank. */
+	__HAL_FLASH_DATA_CACHE_DISABLE();
+	__HAL_FLASH_DATA_CACHE_RESET();
+	__HAL_FLASH_DATA_CACHE_ENABLE();
+#endif
+
+	/* Next one goes after this place, good or not. */
+	p->slot = slot;
+	p->next = off + ADCFLASH_STRIDE;
+	if (ret != 0) return ret;
+
+	pi = ADCFLASHMEM(addr);
+	if ((memcmp(pi, pimg, sizeof(struct ADCFLASHIMG)) != 0) || (img_good(pi) == 0))
+		return -4;
+
+	p->seq  = pimg->seq;
+	p->pnew = pi; // ADCTask takes it from here
+	return 0;
+}
+/* *************************************************************************
+ * void adcflash_poll(void);
+ * @brief	: Put a newly written image into the channel tables (ADCTask)
+ * *************************************************************************/
+void adcflash_poll(void)
+{
+	const struct ADCFLASHIMG* pi = adcflash.pnew;
+
+	if (pi == NULL) return;
+
+	img_apply(&adc1channelstuff[0], pi);
+	adcparams_reload();
+
+	adcflash.pcur = pi;
+	adcflash.applyct += 1;
+	adcflash.pnew = NULL;
+	return;
+}
+/* Magic, version, size, CRC, and piecewise linear points in range. */
+static int img_good(const struct ADCFLASHIMG* pi)
+{
+	int i;
+
+	if ((pi->magic != ADCFLASH_MAGIC) || (pi->version != ADCFLASH_VERSION) ||
+	    (pi->size != sizeof(struct ADCFLASHIMG))) return 0;
+	if (adcflash_crc(pi, offsetof(struct ADCFLASHIMG, crc)) != pi->crc) return 0;
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		if (pi->ch[i].lutidx + pi->ch[i].lutn > ADCFLASH_LUTPTS) return 0;
+	}
+	return 1;
+}
+/* Image -> channel tables.  Piecewise linear points stay in flash. */
+static void img_apply(struct ADCCHANNELSTUFF* pacsx, const struct ADCFLASHIMG* pi)
+{
+	struct ADCCHANNELSTUFF* pstuff;
+	const struct ADCFLASHCHAN* pc;
+	int i;
+
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		pstuff = pacsx + i;
+		pc = &pi->ch[i];
+		pstuff->xprms = pc->xprms;
+		pstuff->cal   = pc->cal;
+		pstuff->fpw   = pc->fpw;
+		if (pc->lutn != 0)
+		{
+			pstuff->lut.ppts = &pi->lut[pc->lutidx];
+			pstuff->lut.npts = pc->lutn;
+		}
+	}
+	return;
+}
+/* 1 = the image's place at 'off' in 'slot' is all erased. */
+static int slot_blank(uint8_t slot, uint32_t off)
+{
+	const uint32_t* pw = ADCFLASHMEM(slotaddr[slot] + off);
+	int i;
+
+	for (i = 0; i < (int)(ADCFLASH_STRIDE / sizeof(uint32_t)); i++)
+		if (pw[i] != 0xffffffff) return 0;
+	return 1;
+}
+/* Erase the slot's sector (flash unlocked). */
+static int slot_erase(uint8_t slot)
+{
+	FLASH_EraseInitTypeDef erase;
+	uint32_t err;
+
+	erase.TypeErase    = FLASH_TYPEERASE_SECTORS;
+	erase.Banks        = FLASH_BANK_1;
+	erase.Sector       = (slot == 0) ? ADCFLASH_SECTOR0 : ADCFLASH_SECTOR1;
+	erase.NbSectors    = 1;
+	erase.VoltageRange = FLASH_VOLTAGE_RANGE_3; // 2.7 - 3.6v: 32b parallelism
+	if (HAL_FLASHEx_Erase(&erase, &err) != HAL_OK) return -1;
+	return 0;
+}
@@ -0,0 +1,132 @@
+/******************************************************************************
+* File Name          : adcflash.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : ADC parameter & calibration images in high flash
+*******************************************************************************/
+/*
+The ADC channel parameters (ADCPARAM), calibrations, filter specs, and
+piecewise linear points can come from an image in high flash in place of
+the compiled-in 'adcparamsinit.c' values.
+
+Flash: two 128K sectors at the top of the 1MB (sectors 10 & 11; the linker
+script stops the program below them), "slot" 0 and 1.
+
+ - Images are written one after the other in a slot.  When the slot is
+   full the other slot is erased and started: 118 images fit in a slot,
+   so each sector is erased once per ~236 saves, and the previous image is
+   never erased before the new one is in flash.
+ - Each image has a version (image layout), a sequence number (newest
+   wins), and a CRC-32 as its last word.  Words are programmed in address
+   order, so an image cut off by a reset fails the CRC and is passed over.
+ - At boot (adcparams_init) both slots are scanned and the newest good
+   image with this version is used.  It is read in place: the parameters
+   are loaded into adc1channelstuff[] and the piecewise linear tables use
+   the points in flash.  No good image: the compiled-in values stand.
+
+Saving the live parameters (e.g. after an adcfit calibration):
+   adcflash_build(&img); adcflash_write(&img);
+adcflash_write programs and checks the image, then ADCTask (adcflash_poll)
+puts it into the channel tables between two 1/2 DMA buffers, so the next
+1/2 buffer uses all of it.
+
+NOTE: the F4 stalls instruction fetch from flash while programming or
+erasing, so the tasks stop (the ADC DMA does not): a few ms to program an
+image, a second or two when a sector is erased.  adctiming counts the 1/2
+buffers missed.
+*/
+
+#ifndef __ADCFLASH
+#define __ADCFLASH
+
+#include <stdint.h>
+#include <stddef.h>
+#include "adcparams.h"
+
+#define ADCFLASH_ADDR0    0x080C0000 // Slot 0: sector 10
+#define ADCFLASH_ADDR1    0x080E0000 // Slot 1: sector 11
+#define ADCFLASH_SECTOR0  10
+#define ADCFLASH_SECTOR1  11
+#define ADCFLASH_SLOTSIZE (128 * 1024)
+
+#define ADCFLASH_MAGIC   0x46434441 // "ADCF"
+#define ADCFLASH_VERSION 3  // Image layout; bump when ADCFLASHIMG changes
+#define ADCFLASH_LUTPTS  64 // Piecewise linear points, all channels
+
+/* Flash address -> pointer */
+#ifdef HOSTBUILD
+  /* Host build: 'hal_stubs.c' has RAM standing in for the two sectors. */
+  extern uint8_t halstub_flash[2 * ADCFLASH_SLOTSIZE];
+  #define ADCFLASHMEM(a) ((const void*)&halstub_flash[(a) - ADCFLASH_ADDR0])
+#else
+  #define ADCFLASHMEM(a) ((const void*)(a))
+#endif
+
+/* One channel */
+struct ADCFLASHCHAN
+{
+	struct ADCPARAM xprms;   // Parameters
+	union  ADCCALIB cal;     // Calibration
+	union  ADCPARAMWORK fpw; // Filter spec, starting values (as in adcparamsinit.c)
+	uint16_t lutidx;         // LUT: first point in 'lut'
+	uint8_t  lutn;           // LUT: number of points (0 = none)
+};
+
+/* One image */
+struct ADCFLASHIMG
+{
+	uint32_t magic;    // ADCFLASH_MAGIC
+	uint16_t version;  // ADCFLASH_VERSION
+	uint16_t size;     // sizeof(struct ADCFLASHIMG)
+	uint32_t seq;      // Sequence number: newest (largest) is used
+	struct ADCFLASHCHAN ch[ADC1IDX_ADCSCANSIZE];
+	float lut[ADCFLASH_LUTPTS][2]; // Piecewise linear points {x, y}
+	uint32_t crc;      // CRC-32 of everything above: last word programmed
+};
+
+/* Images are this far apart in a slot. */
+#define ADCFLASH_STRIDE ((sizeof(struct ADCFLASHIMG) + 15) & ~15)
+
+/* State */
+struct ADCFLASH
+{
+	const struct ADCFLASHIMG* pcur;          // Image in use (NULL = compiled-in)
+	const struct ADCFLASHIMG* volatile pnew; // Written, waiting for ADCTask
+	uint32_t seq;     // Newest sequence number in flash
+	uint32_t next;    // Offset in 'slot' for the next image
+	uint32_t erasect; // Sectors erased (since boot)
+	uint32_t applyct; // Images put into the channel tables (since boot)
+	uint8_t  slot;    // Slot with the newest image (0, 1)
+};
+
+/* *************************************************************************/
+int adcflash_load(struct ADCCHANNELSTUFF* pacsx);
+/* @brief	: Find the newest good image; load it into the channel tables (adcparams_init)
+ * @param	: pacsx = Pointer to struct "everything" for this ADC module
+ * @return	: 0 = loaded; -1 = no good image (compiled-in values stand)
+ * *************************************************************************/
+int adcflash_build(struct ADCFLASHIMG* pimg);
+/* @brief	: Fill an image from the live channel tables
+ * @param	: pimg = pointer to image (RAM)
+ * @return	: 0 = OK; -1 = too many piecewise linear points
+ * *************************************************************************/
+int adcflash_write(struct ADCFLASHIMG* pimg);
+/* @brief	: Program an image (version, sequence, CRC filled in); ADCTask puts it in use
+ * @param	: pimg = pointer to image (RAM)
+ * @return	: 0 = OK; -1 = last one not in use yet; -2 = erase failed;
+ *          : -3 = program failed; -4 = check of flash failed
+ * NOTE: call from a task other than ADCTask (see NOTE above)
+ * *************************************************************************/
+void adcflash_poll(void);
+/* @brief	: Put a newly written image into the channel tables (ADCTask)
+ * *************************************************************************/
+uint32_t adcflash_crc(const void* p, uint32_t n);
+/* @brief	: CRC-32 (IEEE 802.3, as zlib)
+ * @param	: p = pointer to bytes
+ * @param	: n = number of bytes
+ * @return	: CRC
+ * *************************************************************************/
+
+extern struct ADCFLASH adcflash;
+
+#endif
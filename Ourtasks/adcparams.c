@@ -5,10 +5,17 @@
 * Description        : Parameters for ADC app configuration
 *******************************************************************************/
 /*
-Not thread safe.
+Not thread safe.  adc1data and adcommon are only for ADCTask; other tasks
+get a consistent copy with adcsnap_read (adcsnap.h).
 */
+#include <stdlib.h>
+#include <float.h>
 #include "adcparams.h"
 #include "adcparamsinit.h"
+#include "adcflash.h"
+#include "fir_coef.h"
+#include "iir_coef.h"
+#include "adccic.h"
 #include "ADCTask.h"
 
 #include "DTW_counter.h"
@@ -52,6 +59,13 @@ Temp(degree) = (V_sense - V_25)/Avg_slope + 25
 
 #define VREFINT_CAL_ADDR 
 
+static void adcparams_decimate_init(struct ADCCHANNELSTUFF* pacsx);
+static void adcparams_pipe_init(struct ADCCHANNELSTUFF* pacsx);
+static int adcparams_pipe_chan(struct ADCCHANNELSTUFF* pstuff, int i, int init);
+static void adcparams_iir2_init(struct ADCCHANNELSTUFF* pacsx);
+static int adcparams_lut_init(struct ADCLUT* plut);
+static float adcparams_compfactor(uint8_t comptype);
+
 /* Calibration values common to all ADC modules. */
 struct ADCCALCOMMON adcommon;
 
@@ -61,6 +75,33 @@ struct ADCCHANNELSTUFF adc1channelstuff[ADC1IDX_ADCSCANSIZE];
 /* Raw and calibrated ADC1 readings. */
 struct ADC1DATA adc1data;
 
+/* Per-channel working data, one array per field. */
+struct ADC1SOA adc1soa;
+
+/* ADCFILTERTYPE_IIR2: channels with the same spec and decimation are the
+   lanes of one biquad bank, filtered in one pass by adcparams_all. */
+struct ADCIIR2BANK
+{
+	struct BIQUADBANK bq;
+	float in[ADC1IDX_ADCSCANSIZE];     // Lane inputs (calibrated readings), then outputs
+	uint8_t chan[ADC1IDX_ADCSCANSIZE]; // Lane -> ADC1 channel index
+	uint32_t mask;                     // Bit per channel in the bank
+};
+static struct ADCIIR2BANK adciir2bank[ADC1IDX_ADCSCANSIZE];
+static uint8_t adciir2num; // Number of banks in use
+
+/* ADCFILTERTYPE_IIR2, _Q calibtypes: one filter per channel. */
+static struct FILTERBIQUADQ adcbqq[ADC1IDX_ADCSCANSIZE];
+
+/* ADCFILTERTYPE_FIR: delay lines, by channel. */
+static struct FIRPOLY adcfir[ADC1IDX_ADCSCANSIZE];
+
+/* ADCFILTERTYPE_MEDIAN: windows, by channel. */
+static struct FILTERMEDF adcmed[ADC1IDX_ADCSCANSIZE];
+
+/* CIC decimators ('xprms.cic'), by channel. */
+static struct ADCCIC adccic[ADC1IDX_ADCSCANSIZE];
+
 /* *************************************************************************
  * void adcparams_init(void);
  *	@brief	: Copy parameters into structs
@@ -71,15 +112,212 @@ void adcparams_init(void)
 	/* Load parameter values for ADC channels. */
 	adcparamsinit_init(&adc1channelstuff[0]);
 
+	/* A valid image in high flash replaces them (adcflash.h). */
+	adcflash_load(&adc1channelstuff[0]);
+
 	/* Common to board, plus some pre-computed values. */
 	adcparamsinit_init_common(&adcommon,&adc1channelstuff[0]);
 
+	/* Decimation counts and output scaling. */
+	adcparams_decimate_init(&adc1channelstuff[0]);
+
+	/* IIR2 banks (before the handler chains, which need them). */
+	adcparams_iir2_init(&adc1channelstuff[0]);
+
+	/* Handler chain for each channel. */
+	adcparams_pipe_init(&adc1channelstuff[0]);
+
+	return;
+}
+/* *************************************************************************
+ * void adcparams_reload(void);
+ *	@brief	: Redo everything built from the parameters, after they were replaced (ADCTask)
+ * *************************************************************************/
+/*
+Same as adcparams_init less loading the parameters.  Decimation and the
+filters start over.  Only ADCTask runs the handlers, so calling this from
+ADCTask between 1/2 buffers swaps the whole set at once.
+*/
+void adcparams_reload(void)
+{
+	adcparamsinit_init_common(&adcommon,&adc1channelstuff[0]);
+	adcparams_decimate_init(&adc1channelstuff[0]);
+	adcparams_iir2_init(&adc1channelstuff[0]);
+	adcparams_pipe_init(&adc1channelstuff[0]);
 	return;
 }
+/* *************************************************************************
+ * static void adcparams_decimate_init(struct ADCCHANNELSTUFF* pacsx);
+ *	@brief	: Set up decimation from 'decim' and 'outbits' parameters
+ * @param	: pacsx = Pointer to struct "everything" for this ADC module
+ * *************************************************************************/
+static void adcparams_decimate_init(struct ADCCHANNELSTUFF* pacsx)
+{
+	struct ADC1SOA* psoa = &adc1soa;
+	uint32_t summax;
+	uint8_t  sumbits;
+	uint8_t  cic;
+	int ret;
+	int i;
+
+	psoa->decbad = 0;
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		psoa->decn[i] = (pacsx + i)->xprms.decim;
+		if (psoa->decn[i] == 0) psoa->decn[i] = 1;
+		if (psoa->decn[i] > ADCDECIMMAX)
+		{ // Sum would overflow: adcparams_pipe_chan leaves the channel unprocessed
+			psoa->decn[i] = 1;
+			psoa->decbad |= (1 << i);
+		}
+		psoa->decct[i]    = psoa->decn[i];
+		psoa->decacc[i]   = 0;
+		psoa->decrecip[i] = 1.0f / psoa->decn[i];
+
+		/* Bits needed for the largest possible sum. */
+		summax = 4095 * ADC1DMANUMSEQ * psoa->decn[i];
+		sumbits = 0;
+		while (summax != 0) {summax >>= 1; sumbits += 1;}
+
+		psoa->decshift[i] = 0;
+		if (((pacsx + i)->xprms.outbits != 0) && ((pacsx + i)->xprms.outbits < sumbits))
+			psoa->decshift[i] = sumbits - (pacsx + i)->xprms.outbits;
+	}
+
+	/* CIC: same output (full scale 'summax') in place of the plain sum.  Bad
+	   order or rate: not in 'cicmask', and adcparams_pipe_chan leaves the
+	   channel unprocessed. */
+	psoa->cicmask = 0;
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		cic = (pacsx + i)->xprms.cic;
+		if ((cic & ADCCIC_ORDER) == 0) continue;
+		if ((cic & ADCCIC_RAW) != 0)
+			ret = adccic_init(&adccic[i], cic & ADCCIC_ORDER, ADC1DMANUMSEQ * psoa->decn[i], 1,
+				(cic & ADCCIC_COMP) != 0, 4095 * ADC1DMANUMSEQ * psoa->decn[i]);
+		else
+			ret = adccic_init(&adccic[i], cic & ADCCIC_ORDER, psoa->decn[i], ADC1DMANUMSEQ,
+				(cic & ADCCIC_COMP) != 0, 4095 * ADC1DMANUMSEQ * psoa->decn[i]);
+		if (ret == 0) psoa->cicmask |= (1 << i);
+	}
+	return;
+}
+/* *************************************************************************
+ * static void adcparams_iir2_init(struct ADCCHANNELSTUFF* pacsx);
+ *	@brief	: Group IIR2 channels into banks (same spec & decimation); init the banks
+ * @param	: pacsx = Pointer to struct "everything" for this ADC module
+ * *************************************************************************/
+static void adcparams_iir2_init(struct ADCCHANNELSTUFF* pacsx)
+{
+	struct ADCCHANNELSTUFF* pstuff;
+	struct ADCCHANNELSTUFF* pfirst;
+	struct ADCIIR2BANK* pb;
+	int i;
+	int j;
+
+	adciir2num = 0;
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		pstuff = pacsx + i;
+		if (pstuff->xprms.filttype != ADCFILTERTYPE_IIR2) continue; // ('fpw' is a union)
+		pstuff->fpw.iir2.bank = ADCIIR2NONE;
+		if ((pstuff->fpw.iir2.spec >= IIRSPECNUM) ||
+		    (iirspec[pstuff->fpw.iir2.spec].type != IIRSPECTYPE_BQ)) continue; // Bad code
+
+		/* Float channels only; Vref, temperature, and 5v are done in adcparams_internal. */
+		if ((pstuff->xprms.calibtype > ADC1PARAM_CALIBTYPE_POLY3) &&
+		    (pstuff->xprms.calibtype != ADC1PARAM_CALIBTYPE_LUT)) continue;
+		if ((i == ADC1IDX_INTERNALVREF) || (i == ADC1IDX_INTERNALTEMP) ||
+		    (i == ADC1IDX_5VOLTSUPPLY)) continue;
+
+		/* Find a bank with the same spec and rate, or start one. */
+		for (j = 0; j < adciir2num; j++)
+		{
+			pfirst = pacsx + adciir2bank[j].chan[0];
+			if ((pfirst->fpw.iir2.spec == pstuff->fpw.iir2.spec) &&
+			    (adc1soa.decn[adciir2bank[j].chan[0]] == adc1soa.decn[i])) break;
+		}
+		pb = &adciir2bank[j];
+		if (j == adciir2num)
+		{
+			adciir2num += 1;
+			pb->bq.nlane = 0;
+			pb->mask     = 0;
+		}
+		pstuff->fpw.iir2.bank = j;
+		pstuff->fpw.iir2.lane = pb->bq.nlane;
+		pb->chan[pb->bq.nlane] = i;
+		pb->bq.nlane += 1;
+		pb->mask |= (1 << i);
+	}
+
+	/* Coefficients and state memory. */
+	for (j = 0; j < adciir2num; j++)
+	{
+		pb = &adciir2bank[j];
+		pfirst = pacsx + pb->chan[0];
+		if (iir_biquad_init(&pb->bq, &iirspec[pfirst->fpw.iir2.spec].u.bq,
+		       pb->bq.nlane, pfirst->fpw.iir2.skipctr) != 0)
+		{ // Bad spec, or no memory: the bank's channels are not processed
+			for (i = 0; i < pb->bq.nlane; i++)
+				(pacsx + pb->chan[i])->fpw.iir2.bank = ADCIIR2NONE;
+			pb->mask = 0;
+		}
+	}
+	return;
+}
+/* *************************************************************************
+ * uint32_t adcparams_decimate(struct ADC1DATA* padc1, uint16_t* pdma);
+ *	@brief	: Accumulate 1/2 DMA buffer sums; publish channels whose count is reached
+ * @param	: padc1 = Pointer to array of ADC reading sums plus other stuff
+ * @param	: pdma = Pointer to the 1/2 DMA buffer (ADCCIC_RAW channels)
+ * @return	: bit per channel with a new output (also in padc1->decready)
+ * *************************************************************************/
+uint32_t adcparams_decimate(struct ADC1DATA* padc1, uint16_t* pdma)
+{
+	struct ADC1SOA* psoa = &adc1soa;
+	uint32_t ready = 0;
+	uint32_t out;
+	int i;
+
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		if ((psoa->cicmask & (1 << i)) != 0)
+		{ // CIC: raw samples, or this 1/2 buffer's sum
+			if ((adc1channelstuff[i].xprms.cic & ADCCIC_RAW) != 0)
+			{
+				if (adccic_blk(&adccic[i], pdma + i, ADC1IDX_ADCSCANSIZE, ADC1DMANUMSEQ, &out) == 0)
+					continue;
+			}
+			else
+			{
+				if (adccic_in(&adccic[i], padc1->adcs1sum[i], &out) == 0)
+					continue;
+			}
+			psoa->decsum[i] = out;
+			padc1->adcs1dec[i] = out >> psoa->decshift[i];
+			ready |= (1 << i);
+			continue;
+		}
+		psoa->decacc[i] += padc1->adcs1sum[i];
+		psoa->decct[i]  -= 1;
+		if (psoa->decct[i] == 0)
+		{ // Here, 'n' 1/2 DMA buffers summed
+			psoa->decsum[i] = psoa->decacc[i];
+			padc1->adcs1dec[i] = psoa->decacc[i] >> psoa->decshift[i];
+			psoa->decacc[i] = 0;
+			psoa->decct[i]  = psoa->decn[i];
+			ready |= (1 << i);
+		}
+	}
+	padc1->decready = ready;
+	return ready;
+}
 
 /* *************************************************************************
  * void adcparams_internal(struct ADCCALCOMMON* pacom, struct ADC1DATA* padc1);
  *	@brief	: Update values used for compensation from Vref and Temperature
+ *         :   (the float values only while adc1soa.fltmask != 0)
  * @param	: pacom = Pointer calibration parameters for Temperature and Vref
  * @param	: padc1 = Pointer to array of ADC reading sums plus other stuff
  * *************************************************************************/
@@ -94,14 +332,54 @@ void adcparams_internal(struct ADCCALCOMMON* pacom, struct ADC1DATA* padc1)
 #define PTS_CAL2     ((uint16_t*)0x1FFF7A2E))  // Pointer to factory calibration: Vtemp
 */
 
+	int32_t vddq;
+	float f;
+	float d;
+	float h;
+	int i;
+
 adcdbg1 = DTWTIME;
 /* The following two computaions with ints uses 119 machines cycles. */
 	pacom->ivdd = (3300 * ADC1DMANUMSEQ) * (*PVREFINT_CAL) / (padc1->adcs1sum[ADC1IDX_INTERNALVREF]);
 
-	pacom->ui_tmp = (pacom->ivdd * padc1->adcs1sum[ADC1IDX_INTERNALTEMP] ) / 3300; // Adjust for Vdd not at 3.3v calibration
-	pacom->degC  = pacom->ll_80caldiff * (pacom->ui_tmp - pacom->ui_cal1) + (30 * SCALE1 * ADC1DMANUMSEQ);
-	pacom->degC *= ((float)1.0/(SCALE1*ADC1DMANUMSEQ)); 
-	pacom->degCfilt = iir_f1_f(&adc1channelstuff[ADC1IDX_INTERNALTEMP].fpw.iir_f1, pacom->degC);
+	/* Temperature only when its decimated sum is ready (slow channel). */
+	if ((padc1->decready & (1 << ADC1IDX_INTERNALTEMP)) != 0)
+	{
+		pacom->ui_tmp = ((uint64_t)pacom->ivdd * adc1soa.decsum[ADC1IDX_INTERNALTEMP]) / 
+		                (3300 * adc1soa.decn[ADC1IDX_INTERNALTEMP]); // Adjust for Vdd not at 3.3v calibration
+		/* Signed difference: below 30 deg C the reading is under TS_CAL1. */
+		pacom->qdegC = (pacom->ll_80caldiff * (int32_t)(pacom->ui_tmp - pacom->ui_cal1) + 
+		                (30 * SCALE1 * ADC1DMANUMSEQ)) / ADC1DMANUMSEQ; // Q16
+		pacom->qdegCfilt = iir_q1_q(&pacom->iir_q1tmp, pacom->qdegC);
+	}
+
+	/* Fixed-point path (_Q calibtypes): ratios from the integer Vdd. */
+	vddq = iir_q1_q(&pacom->iir_q1vdd, (int32_t)pacom->ivdd << 16); // Vdd (mv): Q16
+	pacom->qvddr  = ((uint64_t)vddq << 14) / VREFCALVOLT; // Vdd/3.3v: Q30
+
+	/* 5v->Vdd ratio, Vref sum / 5v sum (about 0.5).  A 5v sum under half the
+	   Vref sum (5v supply off or shorted, including 0) would divide by zero
+	   or overflow the Q30 ratio: the last good ratios are kept. */
+	if (adc1data.adcs1sum[ADC1IDX_5VOLTSUPPLY] > (adc1data.adcs1sum[ADC1IDX_INTERNALVREF] >> 1))
+	{
+		/* Ratio < 2.0 (Q30), times Vdd/3.3v < 2.0: fits 32b. */
+		pacom->q5vddr = ((uint64_t)pacom->qvddr * 
+			((((uint64_t)adc1data.adcs1sum[ADC1IDX_INTERNALVREF]) << 30) / adc1data.adcs1sum[ADC1IDX_5VOLTSUPPLY])) >> 30;
+	}
+
+	/* The rest is float, for the float pipeline: skipped when every channel is
+	   _Q or RAW_UI (the float values then stay where they were). */
+	if (adc1soa.fltmask == 0)
+	{
+adcdbg2 = DTWTIME - adcdbg1;
+		return;
+	}
+
+	if ((padc1->decready & (1 << ADC1IDX_INTERNALTEMP)) != 0)
+	{
+		pacom->degC = pacom->qdegC * ((float)1.0/SCALE1);
+		pacom->degCfilt = iir_f1_f(&adc1channelstuff[ADC1IDX_INTERNALTEMP].fpw.iir_f1, pacom->degC);
+	}
 
 	pacom->fvdd = pacom->ivdd;
 	pacom->fvdd = pacom->fvdd + pacom->tcoef * (pacom->degC - (float)30);
@@ -112,9 +390,27 @@ adcdbg1 = DTWTIME;
 
 	pacom->fvddrecip = (float)1.0/pacom->fvddfilt; // Pre-compute for multple uses later
 
-	/* Scale up for fixed division, then convert to float and descale. */
-	pacom->f5_Vddratio = ( (adc1data.adcs1sum[ADC1IDX_INTERNALVREF] * (float)(1<<12)) / adc1data.adcs1sum[ADC1IDX_5VOLTSUPPLY]);
-	pacom->f5_Vddratio *= ((float)1.0/(float)(1<<12));
+	if (adc1data.adcs1sum[ADC1IDX_5VOLTSUPPLY] > (adc1data.adcs1sum[ADC1IDX_INTERNALVREF] >> 1))
+	{
+		/* Scale up for fixed division, then convert to float and descale. */
+		pacom->f5_Vddratio = ( (adc1data.adcs1sum[ADC1IDX_INTERNALVREF] * (float)(1<<12)) / adc1data.adcs1sum[ADC1IDX_5VOLTSUPPLY]);
+		pacom->f5_Vddratio *= ((float)1.0/(float)(1<<12));
+	}
+
+	/* Fused coefficient caches (adcparams_chan): a comptype's factor is held,
+	   and only its channels rebuild, until it moves more than ADCCOMPHYST. */
+	for (i = 0; i < ADC1PARAM_COMPTYPE_NUM; i++)
+	{
+		f = adcparams_compfactor(i);
+		d = f - pacom->compf[i];
+		h = pacom->compf[i] * ADCCOMPHYST;
+		if (h < 0) h = -h;
+		if ((d > h) || (d < -h) || (pacom->compseq[i] == 0))
+		{
+			pacom->compf[i]    = f;
+			pacom->compseq[i] += 1;
+		}
+	}
 
 	/* 5v supply voltage. */
 	pacom->f5vsupply = adc1data.adcs1sum[ADC1IDX_5VOLTSUPPLY] * pacom->fvddfilt * pacom->f5vsupplyprecal + pacom->f5vsupplyprecal_offset;
@@ -124,125 +420,777 @@ adcdbg2 = DTWTIME - adcdbg1;
 
 	return;
 }
+/* #######################################################################
+   Per-channel pipeline: handler chains built once by adcparams_pipe_init
+   from the filttype/calibtype/comptype codes.  Codes that do nothing (e.g.
+   COMPTYPE_NONE, CALIBTYPE_RAW_F) get no handler, so a channel only costs
+   the stages it uses, and no switch is evaluated per reading.
+   ####################################################################### */
+/* Load: decimated sum -> reading */
+#ifdef ADCPARAMS_NOFUSE
+static void pipe_load_f(struct ADCCHANNELSTUFF* pstuff)
+{
+	uint8_t i = pstuff->pipe.idx;
+	pstuff->pipe.pread->f = adc1soa.decsum[i] * adc1soa.decrecip[i]; // Decimated sum scaled to one 1/2 DMA buffer sum
+}
+#endif
+static void pipe_load_ui(struct ADCCHANNELSTUFF* pstuff)
+{
+	pstuff->pipe.pread->ui = adc1data.adcs1dec[pstuff->pipe.idx]; // Decimated adc sum as unsigned int ('outbits')
+	pstuff->pipe.preadfilt->ui = pstuff->pipe.pread->ui; // Not filtered
+}
+/* Compensation */
+static void pipe_comp_ratiovdd(struct ADCCHANNELSTUFF* pstuff)  // 1 Vdd (~3.3v nominal) ratiometric
+{
+	pstuff->pipe.pread->f *= adcommon.fvddratio;   // ratio: 0 - 100
+}
+static void pipe_comp_ratio5v(struct ADCCHANNELSTUFF* pstuff)   // 2 5v ratiometric with 5->Vdd measurement	
+{
+	pstuff->pipe.pread->f *= adcommon.fvddfilt * adcommon.f5_Vddratio;
+}
+static void pipe_comp_voltvdd(struct ADCCHANNELSTUFF* pstuff)   // 3 & 4 (same computation)
+{
+	pstuff->pipe.pread->f *= adcommon.fvddfilt * (float)(1.0/(4095.0 * ADCSEQNUM));
+}
+static void pipe_comp_voltvddno(struct ADCCHANNELSTUFF* pstuff) // 5 Vdd (absolute), no Vref compensation applied
+{
+	pstuff->pipe.pread->f *= adcommon.fvddfilt * (float)(1.0/3.3);
+}
+static void pipe_comp_voltv5no(struct ADCCHANNELSTUFF* pstuff)  // 7 5v (absolute), without 5->Vdd measurement applied
+{
+	pstuff->pipe.pread->f *= adcommon.sensor5vcal;
+}
+/* Calibration */
+static void pipe_cal_ofsc(struct ADCCHANNELSTUFF* pstuff)  // 1 Offset & scale (poly ord 0 & 1): FLOAT
+{
+	union ADCCALREADING* pread = pstuff->pipe.pread;
+	pread->f = pread->f * pstuff->cal.f[1] + pstuff->cal.f[0];
+}
+static void pipe_cal_poly2(struct ADCCHANNELSTUFF* pstuff) // 2 Polynomial 2nd ord: FLOAT
+{
+	union ADCCALREADING* pread = pstuff->pipe.pread;
+	pread->f = pstuff->cal.f[0] +
+              pstuff->cal.f[1] * pread->f +
+              pstuff->cal.f[2] * pread->f * pread->f;
+}
+static void pipe_cal_poly3(struct ADCCHANNELSTUFF* pstuff) // 3 Polynomial 3nd ord: FLOAT
+{
+	union ADCCALREADING* pread = pstuff->pipe.pread;
+	float ftmp[2];
+	ftmp[0] = pread->f * pread->f; // (this approach saves 4 cycles)
+	ftmp[1] = ftmp[0]  * pread->f;
+	pread->f = pstuff->cal.f[0] +
+              pstuff->cal.f[1] * pread->f +
+              pstuff->cal.f[2] * ftmp[0] +
+              pstuff->cal.f[3] * ftmp[1];
+}
+/* Piecewise linear table.  Uniform: f = (x - x0)/dx, segment = integer part.
+   Non-uniform: binary search of the breakpoints (log2(npts) compares). */
+static inline float lut_u(struct ADCLUT* plut, float f)
+{
+	int i = 0;
+	if (f > 0)
+	{
+		i = (int)f;
+		if (i > plut->npts - 2) i = plut->npts - 2;
+	}
+	return plut->py[i] + plut->pm[i] * (f - (float)i);
+}
+static inline float lut_n(struct ADCLUT* plut, float x)
+{
+	int lo = 0;
+	int hi = plut->npts - 1;
+	int mid;
+	while ((hi - lo) > 1)
+	{
+		mid = (lo + hi) >> 1;
+		if (x < plut->px[mid]) hi = mid;
+		else                   lo = mid;
+	}
+	return plut->py[lo] + plut->pm[lo] * (x - plut->px[lo]);
+}
+#ifdef ADCPARAMS_NOFUSE
+static void pipe_cal_lutn(struct ADCCHANNELSTUFF* pstuff) // 8 Piecewise linear, non-uniform: FLOAT
+{
+	pstuff->pipe.pread->f = lut_n(&pstuff->lut, pstuff->pipe.pread->f);
+}
+static void pipe_cal_lutu(struct ADCCHANNELSTUFF* pstuff) // 8 Piecewise linear, uniform: FLOAT
+{
+	struct ADCLUT* plut = &pstuff->lut;
+	pstuff->pipe.pread->f = lut_u(plut, (pstuff->pipe.pread->f - plut->x0) * plut->dxrecip);
+}
+#endif
+/* *************************************************************************
+ * static int adcparams_lut_init(struct ADCLUT* plut);
+ *	@brief	: Build the breakpoint table from the calibration points
+ * @param	: plut = Pointer to table (ppts, npts set)
+ * @return	: 0 = OK; -1 = bad points; -2 = calloc failed
+ * *************************************************************************/
+static int adcparams_lut_init(struct ADCLUT* plut)
+{
+	const float (*pp)[2] = plut->ppts;
+	int n = plut->npts;
+	float dx;
+	float d;
+	int i;
+
+	if ((pp == NULL) || (n < 2) || (n > ADCLUTMAX)) return -1;
+	for (i = 1; i < n; i++)
+		if (!(pp[i][0] > pp[i-1][0])) return -1; // x must increase
+
+taskENTER_CRITICAL();
+	free(plut->py);
+	plut->py = (float*)calloc(3 * n, sizeof(float));
+taskEXIT_CRITICAL();
+	if (plut->py == NULL) return -2;
+	plut->pm = plut->py + n;
+	plut->px = plut->py + 2 * n;
+
+	/* Equal spacing (to float rounding): direct index. */
+	dx = (pp[n-1][0] - pp[0][0]) / (n - 1);
+	plut->uniform = 1;
+	for (i = 1; i < n; i++)
+	{
+		d = (pp[i][0] - pp[i-1][0]) - dx;
+		if ((d > dx * 1E-4f) || (d < -dx * 1E-4f)) plut->uniform = 0;
+	}
+	plut->x0      = pp[0][0];
+	plut->dxrecip = 1.0f / dx;
+
+	for (i = 0; i < n; i++)
+	{
+		plut->px[i] = pp[i][0];
+		plut->py[i] = pp[i][1];
+	}
+	for (i = 0; i < n - 1; i++)
+	{
+		plut->pm[i] = plut->py[i+1] - plut->py[i];
+		if (plut->uniform == 0) plut->pm[i] /= (plut->px[i+1] - plut->px[i]);
+	}
+	return 0;
+}
+/* Filtering */
+static void pipe_filt_none(struct ADCCHANNELSTUFF* pstuff) // 0 Skip filtering
+{
+	pstuff->pipe.preadfilt->f = pstuff->pipe.pread->f;
+}
+static void pipe_filt_iir2(struct ADCCHANNELSTUFF* pstuff) // 2 IIR biquads: bank runs in adcparams_all
+{
+	adciir2bank[pstuff->fpw.iir2.bank].in[pstuff->fpw.iir2.lane] = pstuff->pipe.pread->f;
+}
+static void pipe_filt_fir(struct ADCCHANNELSTUFF* pstuff) // 3 FIR: filtered reading every 'm' outputs
+{
+	fir_poly_in(&adcfir[pstuff->pipe.idx], pstuff->pipe.pread->f, &pstuff->pipe.preadfilt->f);
+}
+static void pipe_filt_med(struct ADCCHANNELSTUFF* pstuff) // 4 Median / Hampel
+{
+	pstuff->pipe.preadfilt->f = median_f_f(&adcmed[pstuff->pipe.idx], pstuff->pipe.pread->f);
+}
+/* Compensation as one factor (what the pipe_comp_ handlers multiply by). */
+static float adcparams_compfactor(uint8_t comptype)
+{
+	switch(comptype)
+	{
+	case ADC1PARAM_COMPTYPE_RATIOVDD:  return adcommon.fvddratio;
+	case ADC1PARAM_COMPTYPE_RATIO5V:   return adcommon.fvddfilt * adcommon.f5_Vddratio;
+	case ADC1PARAM_COMPTYPE_RATIO5VNO:
+	case ADC1PARAM_COMPTYPE_VOLTVDD:   return adcommon.fvddfilt * (float)(1.0/(4095.0 * ADCSEQNUM));
+	case ADC1PARAM_COMPTYPE_VOLTVDDNO: return adcommon.fvddfilt * (float)(1.0/3.3);
+	case ADC1PARAM_COMPTYPE_VOLTV5NO:  return adcommon.sensor5vcal;
+	default:                           return 1.0f; // NONE (VOLTV5: adcparams_pipe_chan rejects)
+	}
+}
+/* Fused load + compensation + calibration.
+   With s = decimated sum, g = (1/n) * compensation factor, and x = s*g, the
+   calibration polynomial c0 + c1*x + c2*x^2 + c3*x^3 is the same as
+   d0 + d1*s + d2*s^2 + d3*s^3 with d[i] = c[i] * g^i.  The d[] cache is
+   rebuilt only when adcparams_internal changes the held factor for the
+   channel's comptype (adcommon.compseq[]); otherwise one Horner evaluation
+   per reading.  (adcparams_qcheck uses pipe_fuse_coef for the float side.) */
+static void pipe_fuse_coef(struct ADCCHANNELSTUFF* pstuff, float g)
+{
+	struct ADCFUSE* pfuse = &pstuff->fuse;
+	float gg = g;
+
+	if (pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_LUT)
+	{ // Table input: compensated sum (uniform: already in segment units)
+		pfuse->d[0] = 0;
+		pfuse->d[1] = g;
+		if (pstuff->lut.uniform != 0)
+		{
+			pfuse->d[0] = -pstuff->lut.x0 * pstuff->lut.dxrecip;
+			pfuse->d[1] = g * pstuff->lut.dxrecip;
+		}
+		return;
+	}
+	if (pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_RAW_F)
+	{ // No calibration: reading is the compensated sum
+		pfuse->d[0] = 0;
+		pfuse->d[1] = g;
+		return;
+	}
+	pfuse->d[0] = pstuff->cal.f[0];
+	pfuse->d[1] = pstuff->cal.f[1] * gg; gg *= g;
+	pfuse->d[2] = pstuff->cal.f[2] * gg; gg *= g;
+	pfuse->d[3] = pstuff->cal.f[3] * gg;
+	return;
+}
+#ifndef ADCPARAMS_NOFUSE
+static void pipe_fuse_update(struct ADCCHANNELSTUFF* pstuff)
+{
+	uint8_t comptype = pstuff->xprms.comptype;
+	pipe_fuse_coef(pstuff, adc1soa.decrecip[pstuff->pipe.idx] * adcommon.compf[comptype]);
+	pstuff->fuse.seq = adcommon.compseq[comptype];
+	return;
+}
+static void pipe_fused1(struct ADCCHANNELSTUFF* pstuff) // RAW_F, OFSC
+{
+	struct ADCFUSE* pfuse = &pstuff->fuse;
+	float s = adc1soa.decsum[pstuff->pipe.idx];
+	if (pfuse->seq != adcommon.compseq[pstuff->xprms.comptype]) pipe_fuse_update(pstuff);
+	pstuff->pipe.pread->f = pfuse->d[1] * s + pfuse->d[0];
+}
+static void pipe_fused2(struct ADCCHANNELSTUFF* pstuff) // POLY2
+{
+	struct ADCFUSE* pfuse = &pstuff->fuse;
+	float s = adc1soa.decsum[pstuff->pipe.idx];
+	if (pfuse->seq != adcommon.compseq[pstuff->xprms.comptype]) pipe_fuse_update(pstuff);
+	pstuff->pipe.pread->f = (pfuse->d[2] * s + pfuse->d[1]) * s + pfuse->d[0];
+}
+static void pipe_fused3(struct ADCCHANNELSTUFF* pstuff) // POLY3
+{
+	struct ADCFUSE* pfuse = &pstuff->fuse;
+	float s = adc1soa.decsum[pstuff->pipe.idx];
+	if (pfuse->seq != adcommon.compseq[pstuff->xprms.comptype]) pipe_fuse_update(pstuff);
+	pstuff->pipe.pread->f = ((pfuse->d[3] * s + pfuse->d[2]) * s + pfuse->d[1]) * s + pfuse->d[0];
+}
+static void pipe_fused_lutn(struct ADCCHANNELSTUFF* pstuff) // LUT, non-uniform
+{
+	struct ADCFUSE* pfuse = &pstuff->fuse;
+	float s = adc1soa.decsum[pstuff->pipe.idx];
+	if (pfuse->seq != adcommon.compseq[pstuff->xprms.comptype]) pipe_fuse_update(pstuff);
+	pstuff->pipe.pread->f = lut_n(&pstuff->lut, pfuse->d[1] * s);
+}
+static void pipe_fused_lutu(struct ADCCHANNELSTUFF* pstuff) // LUT, uniform
+{
+	struct ADCFUSE* pfuse = &pstuff->fuse;
+	float s = adc1soa.decsum[pstuff->pipe.idx];
+	if (pfuse->seq != adcommon.compseq[pstuff->xprms.comptype]) pipe_fuse_update(pstuff);
+	pstuff->pipe.pread->f = lut_u(&pstuff->lut, pfuse->d[1] * s + pfuse->d[0]);
+}
+#endif
+/* Fixed point (_Q calibtypes).
+   The compensation factor is split into a constant K, folded into the
+   coefficients at init, and a ratio r (Vdd/3.3v, etc.) that
+   adcparams_internal keeps in Q30.  With u = s/2^sumbits (Q31) and
+   v = u*r (Q30), the compensated reading x = s/n * K * r = G*v where
+   G = K * 2^sumbits/n, so c0 + c1*x + ... = e0 + e1*v + ... with
+   e[i] = c[i] * G^i.  e[] is scaled to the output, Q'qfrac', at init. */
+static const uint32_t qone = (1 << 30); // r when the compensation does not vary
+
+static double pipe_q_nominal(struct ADCCHANNELSTUFF* pstuff, const uint32_t** ppr)
+{
+	*ppr = &qone;
+	switch(pstuff->xprms.comptype)
+	{
+	case ADC1PARAM_COMPTYPE_RATIOVDD:  return adcommon.fvddratio;
+	case ADC1PARAM_COMPTYPE_RATIO5V:   *ppr = &adcommon.q5vddr; return VREFCALVOLT;
+	case ADC1PARAM_COMPTYPE_RATIO5VNO:
+	case ADC1PARAM_COMPTYPE_VOLTVDD:   *ppr = &adcommon.qvddr;  return VREFCALVOLT / (4095.0 * ADCSEQNUM);
+	case ADC1PARAM_COMPTYPE_VOLTVDDNO: *ppr = &adcommon.qvddr;  return VREFCALVOLT / 3.3;
+	case ADC1PARAM_COMPTYPE_VOLTV5NO:  return adcommon.sensor5vcal;
+	default:                           return 1.0; // NONE (VOLTV5: adcparams_pipe_chan rejects)
+	}
+}
+/* *************************************************************************
+ * static int adcparams_q_init(struct ADCCHANNELSTUFF* pstuff);
+ *	@brief	: Fixed-point coefficients from cal.f[], compensation type, decimation, 'qfrac'
+ * @param	: pstuff = Pointer to struct "everything" for this ADC channel
+ * @return	: 0 = OK; -1 = does not fit in an int32 with this 'qfrac'
+ * *************************************************************************/
+static int adcparams_q_init(struct ADCCHANNELSTUFF* pstuff)
+{
+	struct ADCQCAL* pq = &pstuff->q;
+	double e[ADCCALIBSIZE];
+	double G;
+	double Gi = 1.0;
+	double esum = 0;
+	uint16_t n = adc1soa.decn[pstuff->pipe.idx];
+	uint32_t summax = 4095 * ADC1DMANUMSEQ * n;
+	uint8_t sumbits = 0;
+	int ncoef = pstuff->xprms.calibtype - ADC1PARAM_CALIBTYPE_OFSC_Q + 2;
+	int i;
+
+	while (summax != 0) {summax >>= 1; sumbits += 1;}
+	if ((sumbits > 31) || (pstuff->xprms.qfrac > 30)) return -1;
+	pq->ushift = 31 - sumbits;
+
+	G = pipe_q_nominal(pstuff, &pq->pr) * (double)((uint64_t)1 << sumbits) / n;
+
+	for (i = 0; i < ADCCALIBSIZE; i++)
+	{
+		e[i] = 0;
+		if (i < ncoef)
+			e[i] = pstuff->cal.f[i] * Gi * (double)((uint64_t)1 << pstuff->xprms.qfrac);
+		Gi *= G;
+		esum += (e[i] < 0) ? -e[i] : e[i];
+	}
+	/* v < 2.0 so every Horner partial sum is < 8 * sum|e|.  Keeping that
+	   under 2^30 also keeps the reading in range for iir_q1. */
+	if (esum * 16 >= 2147483648.0) return -1;
+
+	for (i = 0; i < ADCCALIBSIZE; i++)
+		pq->e[i] = (int32_t)((e[i] < 0) ? (e[i] - 0.5) : (e[i] + 0.5));
+	return 0;
+}
+static int32_t q_v(struct ADCQCAL* pq, uint32_t sum)
+{
+	uint32_t u = sum << pq->ushift;                        // Q31
+	return (int32_t)(((uint64_t)u * *pq->pr) >> 31);       // Q30
+}
+static int32_t q_poly1(int32_t* e, int32_t v)
+{
+	return (int32_t)((((int64_t)e[1] * v) >> 30) + e[0]);
+}
+static int32_t q_poly2(int32_t* e, int32_t v)
+{
+	int64_t acc;
+	acc = (((int64_t)e[2] * v) >> 30) + e[1];
+	return (int32_t)(((acc * v) >> 30) + e[0]);
+}
+static int32_t q_poly3(int32_t* e, int32_t v)
+{
+	int64_t acc;
+	acc = (((int64_t)e[3] * v) >> 30) + e[2];
+	acc = ((acc * v) >> 30) + e[1];
+	return (int32_t)(((acc * v) >> 30) + e[0]);
+}
+static void pipe_q_ofsc(struct ADCCHANNELSTUFF* pstuff)  // 5 Offset & scale: FIXED
+{
+	pstuff->pipe.pread->n = q_poly1(pstuff->q.e, q_v(&pstuff->q, adc1soa.decsum[pstuff->pipe.idx]));
+}
+static void pipe_q_poly2(struct ADCCHANNELSTUFF* pstuff) // 6 Polynomial 2nd ord: FIXED
+{
+	pstuff->pipe.pread->n = q_poly2(pstuff->q.e, q_v(&pstuff->q, adc1soa.decsum[pstuff->pipe.idx]));
+}
+static void pipe_q_poly3(struct ADCCHANNELSTUFF* pstuff) // 7 Polynomial 3rd ord: FIXED
+{
+	pstuff->pipe.pread->n = q_poly3(pstuff->q.e, q_v(&pstuff->q, adc1soa.decsum[pstuff->pipe.idx]));
+}
+static void pipe_q_filt_none(struct ADCCHANNELSTUFF* pstuff) // 0 Skip filtering
+{
+	pstuff->pipe.preadfilt->n = pstuff->pipe.pread->n;
+}
+static void pipe_q_filt_iir1(struct ADCCHANNELSTUFF* pstuff) // 1 IIR single pole
+{
+	pstuff->pipe.preadfilt->n = iir_q1_q(&pstuff->fpw.iir_q1, pstuff->pipe.pread->n);
+}
+static void pipe_q_filt_iir2(struct ADCCHANNELSTUFF* pstuff) // 2 IIR biquads
+{
+	pstuff->pipe.preadfilt->n = iir_biquad_q_q(&adcbqq[pstuff->pipe.idx], pstuff->pipe.pread->n);
+}
+/* *************************************************************************
+ * static void adcparams_pipe_init(struct ADCCHANNELSTUFF* pacsx);
+ *	@brief	: Build the handler chain for each channel from its parameter codes
+ * @param	: pacsx = Pointer to struct "everything" for this ADC module
+ * *************************************************************************/
+/* Handlers indexed by code; NULL = nothing to do for that code. */
+static const ADCPIPESTAGE pipe_comp[] =
+{
+	NULL,                // 0 ADC1PARAM_COMPTYPE_NONE
+	pipe_comp_ratiovdd,  // 1 ADC1PARAM_COMPTYPE_RATIOVDD
+	pipe_comp_ratio5v,   // 2 ADC1PARAM_COMPTYPE_RATIO5V
+	pipe_comp_voltvdd,   // 3 ADC1PARAM_COMPTYPE_RATIO5VNO
+	pipe_comp_voltvdd,   // 4 ADC1PARAM_COMPTYPE_VOLTVDD
+	pipe_comp_voltvddno, // 5 ADC1PARAM_COMPTYPE_VOLTVDDNO
+	NULL,                // 6 ADC1PARAM_COMPTYPE_VOLTV5: rejected (ADCPIPEERR_COMP)
+	pipe_comp_voltv5no,  // 7 ADC1PARAM_COMPTYPE_VOLTV5NO
+};
+static const ADCPIPESTAGE pipe_cal[] =
+{
+	NULL,                // 0 ADC1PARAM_CALIBTYPE_RAW_F
+	pipe_cal_ofsc,       // 1 ADC1PARAM_CALIBTYPE_OFSC
+	pipe_cal_poly2,      // 2 ADC1PARAM_CALIBTYPE_POLY2
+	pipe_cal_poly3,      // 3 ADC1PARAM_CALIBTYPE_POLY3
+};
+#ifdef ADCPARAMS_NOFUSE
+static const ADCPIPESTAGE pipe_cal_lut[] =
+{
+	pipe_cal_lutn,       // ADC1PARAM_CALIBTYPE_LUT, 'lut.uniform' 0
+	pipe_cal_lutu,       // ADC1PARAM_CALIBTYPE_LUT, 'lut.uniform' 1
+};
+#else
+static const ADCPIPESTAGE pipe_fused[] =
+{
+	pipe_fused1,         // 0 ADC1PARAM_CALIBTYPE_RAW_F (c0 = 0, c1 = 1)
+	pipe_fused1,         // 1 ADC1PARAM_CALIBTYPE_OFSC
+	pipe_fused2,         // 2 ADC1PARAM_CALIBTYPE_POLY2
+	pipe_fused3,         // 3 ADC1PARAM_CALIBTYPE_POLY3
+};
+static const ADCPIPESTAGE pipe_fused_lut[] =
+{
+	pipe_fused_lutn,     // ADC1PARAM_CALIBTYPE_LUT, 'lut.uniform' 0
+	pipe_fused_lutu,     // ADC1PARAM_CALIBTYPE_LUT, 'lut.uniform' 1
+};
+#endif
+static const ADCPIPESTAGE pipe_filt[] =
+{
+	pipe_filt_none,      // 0 ADCFILTERTYPE_NONE
+	NULL,                // 1 ADCFILTERTYPE_IIR1: adcparams_all loop (adc1soa)
+	pipe_filt_iir2,      // 2 ADCFILTERTYPE_IIR2
+	pipe_filt_fir,       // 3 ADCFILTERTYPE_FIR
+	pipe_filt_med,       // 4 ADCFILTERTYPE_MEDIAN
+};
+static const ADCPIPESTAGE pipe_qcal[] =
+{
+	pipe_q_ofsc,         // 5 ADC1PARAM_CALIBTYPE_OFSC_Q
+	pipe_q_poly2,        // 6 ADC1PARAM_CALIBTYPE_POLY2_Q
+	pipe_q_poly3,        // 7 ADC1PARAM_CALIBTYPE_POLY3_Q
+};
+static const ADCPIPESTAGE pipe_qfilt[] =
+{
+	pipe_q_filt_none,    // 0 ADCFILTERTYPE_NONE
+	pipe_q_filt_iir1,    // 1 ADCFILTERTYPE_IIR1
+	pipe_q_filt_iir2,    // 2 ADCFILTERTYPE_IIR2
+	NULL,                // 3 ADCFILTERTYPE_FIR: float only
+	NULL,                // 4 ADCFILTERTYPE_MEDIAN: float only
+};
+#define PIPESIZE(a) (sizeof(a)/sizeof(a[0]))
+
+static void adcparams_pipe_init(struct ADCCHANNELSTUFF* pacsx)
+{
+	int i;
+
+	adc1soa.iir1mask = 0;
+	adc1soa.fltmask  = 0;
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
+	{
+		(pacsx + i)->fspec = (pacsx + i)->fpw; // Filter spec with its starting values
+		adc1soa.pipeerr[i] = adcparams_pipe_chan(pacsx + i, i, 1);
+	}
+	return;
+}
+/* *************************************************************************
+ * static int adcparams_pipe_chan(struct ADCCHANNELSTUFF* pstuff, int i, int init);
+ *	@brief	: Build the handler chain for one channel (init, and adcparams_setcal)
+ * @param	: pstuff = Pointer to struct "everything" for this ADC channel
+ * @param	: i = ADC1 channel index
+ * @param	: init = 1: also set up the filter and table (calloc, state reset);
+ *         :   0: calibration only, filter and table as they are (adcparams_setcal)
+ * @return	: 0 = OK; ADCPIPEERR_ (adcparams.h) = not processed (no handlers)
+ * *************************************************************************/
+static int adcparams_pipe_chan(struct ADCCHANNELSTUFF* pstuff, int i, int init)
+{
+	struct ADCPIPE* ppipe;
+	ADCPIPESTAGE* pstage;
+
+	ppipe  = &pstuff->pipe;
+	ppipe->idx       = i;
+	ppipe->pread     = &adc1data.adc1calreading[i];
+	ppipe->preadfilt = &adc1data.adc1calreadingfilt[i];
+	ppipe->nstage    = 0;
+	pstage = &ppipe->stage[0];
+	adc1soa.iir1mask &= ~(1 << i); // Set again below if an IIR1 float channel
+	adc1soa.fltmask  &= ~(1 << i); // Set again below if a float channel
+
+	/* Vref, temperature, and 5v are done in adcparams_internal. */
+	if ((i == ADC1IDX_INTERNALVREF) || (i == ADC1IDX_INTERNALTEMP) ||
+	    (i == ADC1IDX_5VOLTSUPPLY)) return 0;
+
+	/* Codes out of range: channel is not processed (as before). */
+	if (pstuff->xprms.comptype >= PIPESIZE(pipe_comp)) return ADCPIPEERR_CODE;
+	if (pstuff->xprms.filttype >= PIPESIZE(pipe_filt)) return ADCPIPEERR_CODE;
+	if (pstuff->xprms.comptype == ADC1PARAM_COMPTYPE_VOLTV5) return ADCPIPEERR_COMP;
+	if ((adc1soa.decbad & (1 << i)) != 0) return ADCPIPEERR_DECIM; // 'decim' too large
+	if (((pstuff->xprms.cic & ADCCIC_ORDER) != 0) &&
+	    ((adc1soa.cicmask & (1 << i)) == 0)) return ADCPIPEERR_CIC; // Bad CIC order or rate
+
+	if (pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_RAW_UI)
+	{ // Unsigned int: no compensation, calibration, or filtering
+		*pstage++ = pipe_load_ui;
+	}
+	else if ((pstuff->xprms.calibtype >= ADC1PARAM_CALIBTYPE_OFSC_Q) &&
+	         (pstuff->xprms.calibtype <= ADC1PARAM_CALIBTYPE_POLY3_Q))
+	{ // Fixed point: compensation, calibration, and filtering with integers
+		if (pstuff->xprms.calibtype >= ADC1PARAM_CALIBTYPE_OFSC_Q + PIPESIZE(pipe_qcal)) return ADCPIPEERR_CODE;
+		if (pipe_qfilt[pstuff->xprms.filttype] == NULL) return ADCPIPEERR_QFILT; // Float-only filter
+		if (adcparams_q_init(pstuff) != 0) return ADCPIPEERR_QFIT; // Does not fit 'qfrac': not processed
+		if ((pstuff->xprms.filttype == ADCFILTERTYPE_IIR2) && (init != 0))
+		{ // Coefficients from the build-time tables, to Q29
+			if ((pstuff->fpw.iir2.spec >= IIRSPECNUM) ||
+			    (iirspec[pstuff->fpw.iir2.spec].type != IIRSPECTYPE_BQ)) return ADCPIPEERR_FILT; // Bad code
+			if (iir_biquad_q_init(&adcbqq[i], &iirspec[pstuff->fpw.iir2.spec].u.bq,
+			       pstuff->fpw.iir2.skipctr) != 0) return ADCPIPEERR_FILT;
+		}
+
+		*pstage++ = pipe_qcal[pstuff->xprms.calibtype - ADC1PARAM_CALIBTYPE_OFSC_Q];
+		*pstage++ = pipe_qfilt[pstuff->xprms.filttype];
+	}
+	else
+	{
+		if (pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_LUT)
+		{ // Table from the calibration points
+			if ((init != 0) && (adcparams_lut_init(&pstuff->lut) != 0)) return ADCPIPEERR_LUT; // Bad points: not processed
+		}
+		else if (pstuff->xprms.calibtype >= PIPESIZE(pipe_cal)) return ADCPIPEERR_CODE;
+		if ((pstuff->xprms.filttype == ADCFILTERTYPE_IIR2) &&
+		    (pstuff->fpw.iir2.bank == ADCIIR2NONE)) return ADCPIPEERR_FILT; // No bank: not processed
+		if ((pstuff->xprms.filttype == ADCFILTERTYPE_FIR) && (init != 0))
+		{ // Coefficients from the build-time tables
+			if (pstuff->fpw.fir.spec >= FIRSPECNUM) return ADCPIPEERR_FILT; // Bad code: not processed
+			if (fir_poly_init(&adcfir[i], &firspec[pstuff->fpw.fir.spec]) != 0) return ADCPIPEERR_FILT;
+		}
+		if ((pstuff->xprms.filttype == ADCFILTERTYPE_MEDIAN) && (init != 0))
+		{ // Bad window: not processed
+			if (median_f_init(&adcmed[i], pstuff->fpw.med.n, pstuff->fpw.med.t, pstuff->fpw.med.dmin) != 0) return ADCPIPEERR_FILT;
+		}
+
+#ifndef ADCPARAMS_NOFUSE
+		/* Load, compensation, calibration as one Horner evaluation. */
+		pstuff->fuse.seq = ~adcommon.compseq[pstuff->xprms.comptype]; // Force first update
+		if (pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_LUT)
+			*pstage++ = pipe_fused_lut[pstuff->lut.uniform];
+		else
+			*pstage++ = pipe_fused[pstuff->xprms.calibtype];
+#else
+		/* Separate stages (for cycle comparison: adcchandbg). */
+		*pstage++ = pipe_load_f;
+		if (pipe_comp[pstuff->xprms.comptype] != NULL)
+			*pstage++ = pipe_comp[pstuff->xprms.comptype];
+		if (pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_LUT)
+			*pstage++ = pipe_cal_lut[pstuff->lut.uniform];
+		else if (pipe_cal[pstuff->xprms.calibtype] != NULL)
+			*pstage++ = pipe_cal[pstuff->xprms.calibtype];
+#endif
+		if (pipe_filt[pstuff->xprms.filttype] != NULL)
+			*pstage++ = pipe_filt[pstuff->xprms.filttype];
+
+		if (pstuff->xprms.filttype == ADCFILTERTYPE_IIR1)
+		{ // Filtered with the other IIR1 channels
+			if (init != 0)
+			{
+				adc1soa.iir1coef[i]     = pstuff->fpw.iir_f1.coef;
+				adc1soa.iir1onemcoef[i] = pstuff->fpw.iir_f1.onemcoef;
+				adc1soa.iir1z1[i]       = 0;
+				adc1soa.iir1skipctr[i]  = pstuff->fpw.iir_f1.skipctr;
+			}
+			adc1soa.iir1mask |= (1 << i);
+		}
+		adc1soa.fltmask |= (1 << i);
+	}
+	ppipe->nstage = pstage - &ppipe->stage[0];
+	return 0;
+}
 /* *************************************************************************
  * void adcparams_chan(uint8_t adcidx);
  *	@brief	: calibration, compensation, filtering for channels
+ *         :   (IIR1 & IIR2 float channels are filtered by adcparams_all)
  * @param	: adcidx = index into ADC1 array
  * *************************************************************************/
 void adcparams_chan(uint8_t adcidx)
 {
 	struct ADCCHANNELSTUFF* pstuff = &adc1channelstuff[adcidx];
-	struct ADC1DATA* padc1         = &adc1data;
-	union ADCCALREADING* pread     = &adc1data.adc1calreading[adcidx];
-	union ADCCALREADING* preadfilt = &adc1data.adc1calreadingfilt[adcidx];
-	struct ADCCALCOMMON* pacom     = &adcommon;
-
-float ftmp[2];
-
-	/* Compensation type */
-/* Assumes 5v sensor supply is measured with an ADC channel.
-#define ADC1PARAM_COMPTYPE_NONE      0     // No supply or temp compensation applied
-#define ADC1PARAM_COMPTYPE_RATIOVDD  1     // Vdd (3.3v nominal) ratiometric
-#define ADC1PARAM_COMPTYPE_RATIO5V   2     // 5v ratiometric with 5->Vdd measurement
-#define ADC1PARAM_COMPTYPE_RATIO5VNO 3     // 5v ratiometric without 5->Vdd measurement
-#define ADC1PARAM_COMPTYPE_VOLTVDD   4     // Vdd (absolute), Vref compensation applied
-#define ADC1PARAM_COMPTYPE_VOLTVDDNO 5     // Vdd (absolute), no Vref compensation applied
-#define ADC1PARAM_COMPTYPE_VOLTV5    6     // 5v (absolute), with 5->Vdd measurement applied
-#define ADC1PARAM_COMPTYPE_VOLTV5NO  7     // 5v (absolute), without 5->Vdd measurement applied
-*/
-	if (pstuff->xprms.filttype == ADC1PARAM_CALIBTYPE_RAW_UI)
+	ADCPIPESTAGE* pstage = &pstuff->pipe.stage[0];
+	ADCPIPESTAGE* pend   = pstage + pstuff->pipe.nstage;
+
+	while (pstage != pend)
 	{
-		pread->ui = padc1->adcs1sum[adcidx]; // adc sum as unsigned int
+		(*pstage)(pstuff);
+		pstage += 1;
 	}
-	else
+	pstuff->ctr += 1;
+	return;
+}
+/* *************************************************************************
+ * void adcparams_all(uint32_t ready);
+ *	@brief	: Run the pipeline for each channel with a new (decimated) output,
+ *         :   then the IIR2 banks of those channels
+ * @param	: ready = bit per channel (see adcparams_decimate)
+ * *************************************************************************/
+void adcparams_all(uint32_t ready)
+{
+	struct ADC1SOA* psoa = &adc1soa;
+	struct ADCIIR2BANK* pb;
+	uint32_t mask;
+	float x;
+	int i;
+	int j;
+
+	for (i = 0; i < ADC1IDX_ADCSCANSIZE; i++)
 	{
-		pread->f = padc1->adcs1sum[adcidx]; // Convert adc sum to float
+		if ((ready & (1 << i)) != 0)
+			adcparams_chan(i);
 	}
 
-	/* Apply compensation to reading. */
-	switch(pstuff->xprms.comptype)
+	/* IIR1: all ready float pipeline channels in one loop (same as iir_f1_f). */
+	mask = ready & psoa->iir1mask;
+	for (i = 0; mask != 0; i++, mask >>= 1)
 	{
-	case ADC1PARAM_COMPTYPE_NONE:      // 0 No supply or temp compensation applied
-		break;
+		if ((mask & 1) == 0) continue;
+		x = adc1data.adc1calreading[i].f;
+		if (psoa->iir1skipctr[i] > 0)
+		{ // Here, skip starting filter until a few readings
+			psoa->iir1skipctr[i] -= 1;
+			psoa->iir1z1[i] = x / psoa->iir1onemcoef[i];
+		}
+		else
+		{
+			psoa->iir1z1[i] = x + psoa->iir1z1[i] * psoa->iir1coef[i];
+		}
+		adc1data.adc1calreadingfilt[i].f = psoa->iir1z1[i] * psoa->iir1onemcoef[i];
+	}
 
-	case ADC1PARAM_COMPTYPE_RATIOVDD:  // 1 Vdd (~3.3v nominal) ratiometric
-		pread->f *= pacom->fvddratio;   // ratio: 0 - 100
-		break;
+	/* IIR2 banks: every lane of a bank has the same rate, so all are ready together. */
+	for (j = 0; j < adciir2num; j++)
+	{
+		pb = &adciir2bank[j];
+		if ((ready & pb->mask) == 0) continue;
+		iir_biquad_run(&pb->bq, pb->in, pb->in);
+		for (i = 0; i < pb->bq.nlane; i++)
+			adc1data.adc1calreadingfilt[pb->chan[i]].f = pb->in[i];
+	}
+	adc1data.ctr += 1;
+	return;
+}
+/* *************************************************************************
+ * double adcparams_qcheck(uint8_t adcidx, uint32_t r, uint8_t* pqfrac);
+ *	@brief	: Error of the fixed-point path vs. the float path, for a float channel's calibration
+ * @param	: adcidx = index into ADC1 array (calibtype RAW_F - POLY3)
+ * @param	: r = compensation ratio (Q30) used by both
+ * @param	: pqfrac = pointer for the 'qfrac' used (largest that fits)
+ * @return	: largest |difference| over the decimated sum range; < 0 = can't be done
+ * *************************************************************************/
+/*
+Both sides get the same decimated sum and the same compensation: the float
+side is the fused evaluation pipe_fused1-3 run (pipe_fuse_coef, Horner in
+float), with the factor the float path would hold for ratio 'r'.  With the
+largest 'qfrac' the fixed point has more bits than a float, so the float's
+own rounding (Horner bound, 2(n+1) float eps x sum |d[i]| s^i) is taken
+off each difference: what is left is fixed-point error.
+*/
+double adcparams_qcheck(uint8_t adcidx, uint32_t r, uint8_t* pqfrac)
+{
+	struct ADCCHANNELSTUFF tmp = adc1channelstuff[adcidx]; // Work on a copy
+	struct ADCCHANNELSTUFF tmpf;                           // Float side
+	static int32_t (* const q_poly[])(int32_t* e, int32_t v) = { q_poly1, q_poly2, q_poly3 };
+	const uint32_t* pr;
+	int32_t reading;
+	double K;
+	float  fs;
+	float  y;
+	double fb; // Float rounding bound
+	double err;
+	double errmax = 0;
+	uint32_t summax;
+	uint32_t step;
+	uint32_t s;
+	int ncoef;
+	int qfrac;
+	int i;
 
-	case ADC1PARAM_COMPTYPE_RATIO5V:   // 2 5v ratiometric with 5->Vdd measurement	
-		pread->f *= pacom->fvddfilt * pacom->f5_Vddratio;
-		break;
+	if (tmp.xprms.calibtype > ADC1PARAM_CALIBTYPE_POLY3) return -1;
+	if (tmp.xprms.comptype >= ADC1PARAM_COMPTYPE_NUM) return -1;
+	if (tmp.xprms.calibtype == ADC1PARAM_CALIBTYPE_RAW_F)
+	{ // Same as offset 0, scale 1
+		tmp.cal.f[0] = 0;
+		tmp.cal.f[1] = 1.0;
+		tmp.xprms.calibtype = ADC1PARAM_CALIBTYPE_OFSC;
+	}
+	ncoef = tmp.xprms.calibtype + 1;
+	tmpf  = tmp;
+	tmp.xprms.calibtype += (ADC1PARAM_CALIBTYPE_OFSC_Q - ADC1PARAM_CALIBTYPE_OFSC);
 
-	case ADC1PARAM_COMPTYPE_RATIO5VNO: // 3 5v ratiometric without 5->Vdd measurement
-		pread->f *= pacom->fvddfilt * (float)(1.0/(4095.0 * ADCSEQNUM));
-		break;
+	for (qfrac = 30; qfrac >= 0; qfrac--)
+	{
+		tmp.xprms.qfrac = qfrac;
+		if (adcparams_q_init(&tmp) == 0) break;
+	}
+	if (qfrac < 0) return -1;
+	*pqfrac = qfrac;
 
-	case ADC1PARAM_COMPTYPE_VOLTVDD:   // 4 Vdd (absolute), Vref compensation applied
-		pread->f *= pacom->fvddfilt * (float)(1.0/(4095.0 * ADCSEQNUM)); // 
-		break;
+	K = pipe_q_nominal(&tmp, &pr);
+	tmp.q.pr = &r;
+	pipe_fuse_coef(&tmpf, adc1soa.decrecip[adcidx] * (float)(K * ((double)r / (1 << 30))));
 
-	case ADC1PARAM_COMPTYPE_VOLTVDDNO: // 5 Vdd (absolute), no Vref compensation applied
-		pread->f *= pacom->fvddfilt * (float)(1.0/3.3);
-		break;
+	/* Sweep the decimated sum over its range, end points included. */
+	summax = 4095 * ADC1DMANUMSEQ * adc1soa.decn[adcidx];
+	step = summax / 4096 + 1;
+	for (s = 0; ; s += step)
+	{
+		if (s > summax) s = summax;
+		reading = q_poly[ncoef - 2](tmp.q.e, q_v(&tmp.q, s));
 
-	case ADC1PARAM_COMPTYPE_VOLTV5:    // 6 5v (absolute), with 5->Vdd measurement applied	
-		pread->f *= 1; // TODO
-		break;	
-	case ADC1PARAM_COMPTYPE_VOLTV5NO:  // 7 5v (absolute), without 5->Vdd measurement applied
-		pread->f *= pacom->sensor5vcal ;
-		break;
+		fs = s; // As pipe_fused1-3
+		if      (ncoef == 2) y = tmpf.fuse.d[1] * fs + tmpf.fuse.d[0];
+		else if (ncoef == 3) y = (tmpf.fuse.d[2] * fs + tmpf.fuse.d[1]) * fs + tmpf.fuse.d[0];
+		else                 y = ((tmpf.fuse.d[3] * fs + tmpf.fuse.d[2]) * fs + tmpf.fuse.d[1]) * fs + tmpf.fuse.d[0];
+		fb = 0;
+		for (i = ncoef - 1; i >= 0; i--)
+			fb = fb * fs + ((tmpf.fuse.d[i] < 0) ? -tmpf.fuse.d[i] : tmpf.fuse.d[i]);
+		fb *= 2 * (ncoef + 1) * (double)FLT_EPSILON / 2;
 
-	default:
-		return;
+		err = reading / (double)((uint64_t)1 << qfrac) - (double)y;
+		if (err < 0) err = -err;
+		err -= fb;
+		if (err > errmax) errmax = err;
+		if (s == summax) break;
 	}
-/* Reproduced for convenience 
-#define ADC1PARAM_CALIBTYPE_RAW_F  0    // No calibration applied: FLOAT
-#define ADC1PARAM_CALIBTYPE_OFSC   1    // Offset & scale (poly ord 0 & 1): FLOAT
-#define ADC1PARAM_CALIBTYPE_POLY2  2    // Polynomial 2nd ord: FLOAT
-#define ADC1PARAM_CALIBTYPE_POLY3  3    // Polynomial 3nd ord: FLOAT
-#define ADC1PARAM_CALIBTYPE_RAW_UI 4    // No calibration applied: UNSIGNED INT
+	return errmax;
+}
+/* *************************************************************************
+ * float adcparams_calg(uint8_t adcidx);
+ *	@brief	: Decimated sum -> calibration input (compensated reading) factor
+ * @param	: adcidx = index into ADC1 array
+ * @return	: g: calibration input x = adc1soa.decsum[adcidx] * g
+ * *************************************************************************/
+float adcparams_calg(uint8_t adcidx)
+{
+	return adc1soa.decrecip[adcidx] * adcparams_compfactor(adc1channelstuff[adcidx].xprms.comptype);
+}
+/* *************************************************************************
+ * int adcparams_setcal(uint8_t adcidx, uint8_t order, float* pc);
+ *	@brief	: Replace a channel's calibration polynomial and rebuild its handlers (ADCTask)
+ * @param	: adcidx = index into ADC1 array
+ * @param	: order = 1 (offset & scale), 2, 3
+ * @param	: pc = pointer to coefficients c0 ... c'order'
+ * @return	: 0 = OK; -1 = not a channel that can be set; -2 = does not fit (_Q): not changed
+ * *************************************************************************/
+/*
+_Q channels stay fixed point (same 'qfrac') with the new order; all others
+become OFSC/POLY2/POLY3 float.  Only ADCTask runs the handlers, so calling
+this from ADCTask between 1/2 buffers needs no lock.  Only the calibration
+coefficients and the handler chain are redone: no free/calloc, and the
+filter (IIR1, IIR2, FIR, median) keeps its state and settles to the new
+calibration.
 */
-	/* Apply calibration to reading. */
-	switch(pstuff->xprms.calibtype)
-	{
-	case ADC1PARAM_CALIBTYPE_RAW_F: // 0 No calibration applied: FLOAT
-		break;
-	case ADC1PARAM_CALIBTYPE_OFSC:  // 1 Offset & scale (poly ord 0 & 1): FLOAT
-		pread->f = pread->f * pstuff->cal.f[1] + pstuff->cal.f[0];
-		break;
-	case ADC1PARAM_CALIBTYPE_POLY2: // 2 Polynomial 2nd ord: FLOAT
-		pread->f = pstuff->cal.f[0] +
-                 pstuff->cal.f[1] * pread->f +
-                 pstuff->cal.f[2] * pread->f * pread->f;
-		break;
-	case ADC1PARAM_CALIBTYPE_POLY3: // 3 Polynomial 3nd ord: FLOAT
-		ftmp[0] = pread->f * pread->f; // (this approach saves 4 cycles)
-		ftmp[1] = ftmp[0]  * pread->f;
-		pread->f = pstuff->cal.f[0] +
-                 pstuff->cal.f[1] * pread->f +
-                 pstuff->cal.f[2] * ftmp[0] +
-                 pstuff->cal.f[3] * ftmp[1];
-		break;
-	case ADC1PARAM_CALIBTYPE_RAW_UI:// 4 No calibration applied: UNSIGNED INT */
-		break;
-	default:
-		return;
-	}
+int adcparams_setcal(uint8_t adcidx, uint8_t order, float* pc)
+{
+	struct ADCCHANNELSTUFF* pstuff;
+	struct ADCPARAM xprms; // Restore if the new one fails
+	union  ADCCALIB cal;
+	int i;
 
-	/* Apply filtering */
-	switch(pstuff->xprms.filttype)
-	{
-	case ADCFILTERTYPE_NONE:	//	0 Skip filtering
-		preadfilt->f = pread->f;
-		break;
-	case ADCFILTERTYPE_IIR1:	//	1 IIR single pole
-		preadfilt->f = iir_f1_f(&pstuff->fpw.iir_f1, pread->f);
-		break;
-	case ADCFILTERTYPE_IIR2:	//	2 IIR second order
-		// TODO
-		break;
-	default:
-		break;
+	if ((adcidx >= ADC1IDX_ADCSCANSIZE) || (order < 1) || (order > 3)) return -1;
+	pstuff = &adc1channelstuff[adcidx];
+	xprms  = pstuff->xprms;
+	cal    = pstuff->cal;
+	if (pstuff->pipe.nstage == 0) return -1; // Not processed (internal channels, etc.)
+	if (pstuff->xprms.calibtype == ADC1PARAM_CALIBTYPE_RAW_UI) return -1;
+
+	if ((xprms.calibtype >= ADC1PARAM_CALIBTYPE_OFSC_Q) && (xprms.calibtype <= ADC1PARAM_CALIBTYPE_POLY3_Q))
+		pstuff->xprms.calibtype = ADC1PARAM_CALIBTYPE_OFSC_Q + order - 1;
+	else
+		pstuff->xprms.calibtype = ADC1PARAM_CALIBTYPE_OFSC + order - 1;
+
+	for (i = 0; i < ADCCALIBSIZE; i++)
+		pstuff->cal.f[i] = (i <= order) ? pc[i] : 0;
+
+	if (adcparams_pipe_chan(pstuff, adcidx, 0) != 0)
+	{ // Back to what it was
+		pstuff->xprms = xprms;
+		pstuff->cal   = cal;
+		adcparams_pipe_chan(pstuff, adcidx, 0);
+		return -2;
 	}
-	return;
+	return 0;
 }
@@ -30,6 +30,11 @@ Compute
 
 #include "iir_f1.h"
 #include "iir_f2.h"
+#include "iir_q1.h"
+#include "iir_biquad.h"
+#include "iir_biquad_q.h"
+#include "fir_poly.h"
+#include "median_f.h"
 
 #define ADC1DMANUMSEQ        16 // Number of DMA scan sequences in 1/2 DMA buffer
 #define ADC1IDX_ADCSCANSIZE  10 // Number ADC channels read
@@ -54,6 +59,10 @@ Compute
 #define ADC1PARAM_CALIBTYPE_POLY2  2    // Polynomial 2nd ord: FLOAT
 #define ADC1PARAM_CALIBTYPE_POLY3  3    // Polynomial 3nd ord: FLOAT
 #define ADC1PARAM_CALIBTYPE_RAW_UI 4    // No calibration applied: UNSIGNED INT
+#define ADC1PARAM_CALIBTYPE_OFSC_Q  5   // Offset & scale (poly ord 0 & 1): FIXED ('qfrac')
+#define ADC1PARAM_CALIBTYPE_POLY2_Q 6   // Polynomial 2nd ord: FIXED ('qfrac')
+#define ADC1PARAM_CALIBTYPE_POLY3_Q 7   // Polynomial 3nd ord: FIXED ('qfrac')
+#define ADC1PARAM_CALIBTYPE_LUT     8   // Piecewise linear table ('lut'): FLOAT
 
 /* Compensation type                                         */
 /* Assumes 5v sensor supply is measured with an ADC channel. */
@@ -63,13 +72,27 @@ Compute
 #define ADC1PARAM_COMPTYPE_RATIO5VNO 3     // 5v ratiometric without 5->Vdd measurement
 #define ADC1PARAM_COMPTYPE_VOLTVDD   4     // Vdd (absolute), Vref compensation applied
 #define ADC1PARAM_COMPTYPE_VOLTVDDNO 5     // Vdd (absolute), no Vref compensation applied
-#define ADC1PARAM_COMPTYPE_VOLTV5    6     // 5v (absolute), with 5->Vdd measurement applied
+#define ADC1PARAM_COMPTYPE_VOLTV5    6     // 5v (absolute), with 5->Vdd measurement applied (not supported)
 #define ADC1PARAM_COMPTYPE_VOLTV5NO  7     // 5v (absolute), without 5->Vdd measurement applied
+#define ADC1PARAM_COMPTYPE_NUM       8     // Number of codes
+
+/* Fused coefficient caches: a comptype's factor (compf[]) is held until it
+   moves more than this fraction of itself (1 LSB of a 12b reading). */
+#define ADCCOMPHYST (1.0f/4096)
 
 /* Filter type codes */
 #define ADCFILTERTYPE_NONE		0  // Skip filtering
 #define ADCFILTERTYPE_IIR1		1  // IIR single pole
-#define ADCFILTERTYPE_IIR2		2  // IIR second order
+#define ADCFILTERTYPE_IIR2		2  // IIR second order (cascaded biquads, 'fpw.iir2')
+#define ADCFILTERTYPE_FIR		3  // FIR, decimating polyphase ('fpw.fir', fir_poly.h)
+#define ADCFILTERTYPE_MEDIAN	4  // Sliding median / Hampel ('fpw.med', median_f.h)
+
+/* Decimator ('xprms.cic'): CIC order, plus flags (adccic.h).
+   Order 0 = plain sum of 'decim' 1/2 DMA buffers.  CIC rate = 'decim'
+   (sums in) or ADC1DMANUMSEQ * 'decim' (raw in), 2 - 256. */
+#define ADCCIC_ORDER 0x07 // Order 1 - 4
+#define ADCCIC_RAW   0x10 // Input raw DMA samples (else 1/2 DMA buffer sums)
+#define ADCCIC_COMP  0x20 // Droop compensation FIR on the output
 
 /* Calibrated ADC reading. */
 union ADCCALREADING
@@ -123,6 +146,21 @@ struct ADCCALCOMMON
 	int64_t ll_80caldiff;
 	uint32_t ui_cal1;
 	uint32_t ui_tmp;
+
+	// Compensation factor per comptype, held for the fused caches (ADCCOMPHYST)
+	float    compf[ADC1PARAM_COMPTYPE_NUM];
+	uint32_t compseq[ADC1PARAM_COMPTYPE_NUM]; // Incremented when compf[] for the comptype changes
+
+	// Fixed-point (_Q calibtype) compensation ratios (Q30)
+	struct FILTERIIRQ1 iir_q1vdd; // Filter for integer Vdd
+	uint32_t qvddr;      // Vdd/3.3v
+	uint32_t q5vddr;     // (Vdd/3.3v) * (ADCsum[Vref]/ADCsum[5v supply])
+
+	// Integer temperature (always); the floats above it (fvdd, degC, f5vsupply,
+	// compf, ...) only while a channel runs the float pipeline (adc1soa.fltmask)
+	struct FILTERIIRQ1 iir_q1tmp; // Filter for integer temperature
+	int32_t qdegC;       // Temperature: degrees C, Q16
+	int32_t qdegCfilt;   // Temperature: degrees C, Q16, filtered
 };
 
 struct ADCVTEMPVREF
@@ -146,13 +184,63 @@ union ADCCALIB
 	 int32_t  n[ADCCALIBSIZE];
 };
 
+/* Piecewise linear calibration (ADC1PARAM_CALIBTYPE_LUT).
+   'ppts' and 'npts' are set in 'adcparamsinit.c': calibration points
+   {x, y}, x = compensated reading (what OFSC etc. would be applied to),
+   increasing.  adcparams_init builds the table from them: equal x spacing
+   is indexed directly; otherwise the segment is found by binary search.
+   Outside the points the end segments are extended. */
+#define ADCLUTMAX 64 // Max calibration points
+struct ADCLUT
+{
+	const float (*ppts)[2]; // Calibration points {x, y}
+	float* px;      // Breakpoints: x (non-uniform only)
+	float* py;      // Breakpoints: y
+	float* pm;      // Segment slope: dy/dx; uniform: dy per segment
+	float x0;       // Uniform: first x
+	float dxrecip;  // Uniform: 1/(x spacing)
+	uint8_t npts;   // Number of points (2 - ADCLUTMAX)
+	uint8_t uniform;// 1 = equal spacing (O(1) index)
+};
+
 /* ADC parameters (for one channel): initialized either 
-     from 'adcparamsinit.c' or high flash. */
+     from 'adcparamsinit.c' or high flash (adcflash.h). */
 struct ADCPARAM
 {
 	uint8_t filttype;   // Type of result filtering
 	uint8_t calibtype;  // Calibration type
 	uint8_t comptype;   // Compensation type
+	uint8_t outbits;    // Decimated output effective bits (0 = full sum, not scaled)
+	uint16_t decim;     // Number of 1/2 DMA buffers summed per output (0 or 1 = every one; max ADCDECIMMAX)
+	uint8_t qfrac;      // _Q calibtypes: fraction bits of the reading (.n)
+	uint8_t cic;        // Decimator: CIC order | ADCCIC_ flags (0 = plain sum)
+};
+
+/* ADCFILTERTYPE_IIR2 spec, plus where adcparams_init put the channel.
+   Channels with the same spec and decimation share a bank and are filtered
+   together by adcparams_all. */
+#define ADCIIR2NONE 0xff // 'bank' when the channel has no bank
+struct ADCIIR2
+{
+	uint8_t spec;     // IIRSPEC_ code (iir_coef.h), type IIRSPECTYPE_BQ
+	uint8_t bank;     // Bank index (ADCIIR2NONE = none)
+	uint8_t lane;     // This channel's lane in the bank
+	uint16_t skipctr; // Number of initial readings to not filter
+};
+
+/* ADCFILTERTYPE_FIR spec.  The filter itself is kept by adcparams.c.
+   The filtered reading updates once per 'm' channel outputs. */
+struct ADCFIR
+{
+	uint8_t spec;     // FIRSPEC_ code (fir_coef.h)
+};
+
+/* ADCFILTERTYPE_MEDIAN spec.  The filter itself is kept by adcparams.c. */
+struct ADCMED
+{
+	float t;          // Hampel threshold (MADs); 0 = plain median
+	float dmin;       // Hampel smallest threshold (reading units)
+	uint8_t n;        // Window: odd, 3 - MEDIANFMAX
 };
 
 /* Intermediate working variables for various filter types. */
@@ -160,6 +248,41 @@ union ADCPARAMWORK
 {
 	struct FILTERIIRF1 iir_f1;	// Filter block for iir_f1
 	struct FILTERIIRF2 iir_f2;	// Filter block for iir_f2
+	struct FILTERIIRQ1 iir_q1;	// Filter block for iir_q1 (_Q calibtypes)
+	struct ADCIIR2     iir2;  	// Spec for ADCFILTERTYPE_IIR2
+	struct ADCFIR      fir;   	// Spec for ADCFILTERTYPE_FIR
+	struct ADCMED      med;   	// Spec for ADCFILTERTYPE_MEDIAN
+};
+
+/* Compensation folded into calibration coefficients (see adcparams.c). */
+struct ADCFUSE
+{
+	float d[ADCCALIBSIZE]; // c[i] * g^i: polynomial in the decimated sum
+	uint32_t seq;          // adcommon.compseq[comptype] when d[] was computed
+};
+
+/* Fixed-point compensation + calibration (_Q calibtypes), see adcparams.c.
+   u = decimated sum as a Q31 fraction of its full scale,
+   v = u * (compensation ratio) in Q30,
+   reading = e0 + e1*v + e2*v^2 + e3*v^3 with e[] in Q'qfrac'. */
+struct ADCQCAL
+{
+	int32_t e[ADCCALIBSIZE]; // Coefficients: calibration with compensation and scaling folded in
+	const uint32_t* pr;      // Compensation ratio (Q30): adcommon.qvddr, etc.
+	uint8_t ushift;          // Decimated sum -> Q31 left shift
+};
+
+/* Per-channel processing: handler chain built at init from the ADCPARAM codes. */
+#define ADCPIPESTAGES 4 // Max handlers: load, compensation, calibration, filter
+struct ADCCHANNELSTUFF;
+typedef void (*ADCPIPESTAGE)(struct ADCCHANNELSTUFF* pstuff);
+struct ADCPIPE
+{
+	ADCPIPESTAGE stage[ADCPIPESTAGES]; // Handlers, in order
+	union ADCCALREADING* pread;        // Pointer to calibrated reading
+	union ADCCALREADING* preadfilt;    // Pointer to filtered reading
+	uint8_t idx;    // ADC1 channel index
+	uint8_t nstage; // Number of handlers (0 = not processed by adcparams_chan)
 };
 
 /* "Everthing" for one ADC channel. */
@@ -168,16 +291,77 @@ struct ADCCHANNELSTUFF
 	struct ADCPARAM xprms;   // ADC fixed parameters
 	union  ADCCALIB cal;     // ADC calibrations
 	union  ADCPARAMWORK fpw; // ADC filter params and working variables
+	union  ADCPARAMWORK fspec; // 'fpw' as put in use, before any filtering (adcflash_build)
+	struct ADCPIPE pipe;     // Processing handler chain
+	struct ADCFUSE fuse;     // Compensation+calibration coefficient cache
+	struct ADCQCAL q;        // Fixed-point compensation+calibration
+	struct ADCLUT lut;       // Piecewise linear calibration table
 	uint32_t ctr;            // Update counter
 };
 
+/* Per-channel working data that is run through for all channels at once,
+   one array per field (index = ADC1 channel), so those loops walk
+   contiguous memory rather than stepping through ADCCHANNELSTUFF.
+   The readings themselves stay in ADC1DATA (also one array per field).
+
+   Decimation (oversampling) of 1/2 DMA buffer sums.
+   Output rate = (1/2 DMA buffer rate) / n.
+   Each 4x of oversampling gives 1 bit beyond the 12b ADC, e.g.
+   16 scans x 64 = 1024 readings -> 17 bits possible; 'outbits' 16 -> shift 6.
+   CIC channels ('cicmask') give 'decsum' with the same full scale, from
+   the CIC instead of 'decacc'.
+
+   IIR1 of the float pipeline channels: coefficients and state copied from
+   'fpw.iir_f1' at init, filtered in one loop by adcparams_all. */
+struct ADC1SOA
+{
+	/* Decimation */
+	uint32_t decacc[ADC1IDX_ADCSCANSIZE];   // Accumulating sum
+	uint32_t decsum[ADC1IDX_ADCSCANSIZE];   // Latest complete sum of 'n' 1/2 DMA buffers
+	float    decrecip[ADC1IDX_ADCSCANSIZE]; // 1/n: scales 'sum' to one 1/2 DMA buffer sum
+	uint16_t decn[ADC1IDX_ADCSCANSIZE];     // Number of 1/2 DMA buffers per output
+	uint16_t decct[ADC1IDX_ADCSCANSIZE];    // Count down to next output
+	uint8_t  decshift[ADC1IDX_ADCSCANSIZE]; // Right shift: 'sum' -> 'outbits' result
+	uint32_t cicmask; // Bit per channel decimated by a CIC ('xprms.cic', adccic.h)
+	uint32_t decbad;  // Bit per channel whose 'decim' is over ADCDECIMMAX (not processed)
+
+	/* IIR1, float pipeline channels */
+	float    iir1coef[ADC1IDX_ADCSCANSIZE];     // coefficient
+	float    iir1onemcoef[ADC1IDX_ADCSCANSIZE]; // 1 - coef
+	float    iir1z1[ADC1IDX_ADCSCANSIZE];       // Z^-1
+	uint16_t iir1skipctr[ADC1IDX_ADCSCANSIZE];  // Number of initial readings to not filter
+	uint32_t iir1mask; // Bit per channel filtered by the IIR1 loop
+
+	uint32_t fltmask;  // Bit per channel with a float pipeline (0 = adcparams_internal skips the floats)
+
+	int8_t   pipeerr[ADC1IDX_ADCSCANSIZE]; // Handler chain build: 0 = OK; ADCPIPEERR_ = not processed
+};
+
+/* adc1soa.pipeerr[]: why a channel's parameters were not taken */
+#define ADCPIPEERR_CODE  -1 // filttype, calibtype, or comptype code out of range
+#define ADCPIPEERR_COMP  -2 // comptype not supported (VOLTV5)
+#define ADCPIPEERR_QFILT -3 // _Q calibtype with a float-only filter (FIR, MEDIAN)
+#define ADCPIPEERR_QFIT  -4 // _Q coefficients do not fit 'qfrac'
+#define ADCPIPEERR_FILT  -5 // Filter spec bad (IIR2 spec or bank, FIR spec, median window)
+#define ADCPIPEERR_LUT   -6 // Table points bad, or calloc failed
+#define ADCPIPEERR_CIC   -7 // CIC order or rate bad
+#define ADCPIPEERR_DECIM -8 // 'decim' over ADCDECIMMAX: the sum would overflow 32 bits
+
+/* Largest 'decim': a full scale sum of 'decim' 1/2 DMA buffers fits 32 bits. */
+#define ADCDECIMMAX (0xffffffffU / (4095U * ADC1DMANUMSEQ))
+
 /* struct allows pointer to access raw and calibrated ADC1 data. */
 struct ADC1DATA
 {
   union ADCCALREADING adc1calreading[ADC1IDX_ADCSCANSIZE]; // Calibrated readings
   union ADCCALREADING adc1calreadingfilt[ADC1IDX_ADCSCANSIZE]; // Calibrated readings: filtered
   uint32_t ctr; // Running count of updates.
-  uint16_t adcs1sum[ADC1IDX_ADCSCANSIZE]; // Sum of 1/2 DMA buffer for each channel
+  uint32_t adcs1sum[ADC1IDX_ADCSCANSIZE]; // Sum of 1/2 DMA buffer for each channel
+  uint32_t adcs1sumsq[ADC1IDX_ADCSCANSIZE]; // Sum of squares, same readings (adcfastsum_stat)
+  uint16_t adcs1min[ADC1IDX_ADCSCANSIZE];   // Smallest reading, same readings
+  uint16_t adcs1max[ADC1IDX_ADCSCANSIZE];   // Largest reading, same readings
+  uint32_t adcs1dec[ADC1IDX_ADCSCANSIZE]; // Decimated sums, scaled to 'outbits'
+  uint32_t decready; // Bit per channel: new decimated output this 1/2 DMA buffer
 };
 
 /* *************************************************************************/
@@ -185,15 +369,50 @@ void adcparams_init(void);
 /*	@brief	: Copy parameters into structs
  * NOTE: => ASSUMES ADC1 ONLY <==
  * *************************************************************************/
+void adcparams_reload(void);
+/*	@brief	: Redo everything built from the parameters, after they were replaced (ADCTask)
+ * *************************************************************************/
 void adcparams_internal(struct ADCCALCOMMON* pacom, struct ADC1DATA* padc1);
 /*	@brief	: Update values used for compensation from Vref and Temperature
+ *         :   (the float values only while adc1soa.fltmask != 0)
  * @param	: pacom = Pointer calibration parameters for Temperature and Vref
  * @param	: padc1 = Pointer to array of ADC reading sums plus other stuff
  * *************************************************************************/
 void adcparams_chan(uint8_t adcidx);
 /*	@brief	: calibration, compensation, filtering for channels
+ *         :   (IIR1 & IIR2 float channels are filtered by adcparams_all)
  * @param	: adcidx = index into ADC1 array
  * *************************************************************************/
+void adcparams_all(uint32_t ready);
+/*	@brief	: Run the pipeline for each channel with a new (decimated) output,
+ *         :   then the IIR2 banks of those channels
+ * @param	: ready = bit per channel (see adcparams_decimate)
+ * *************************************************************************/
+uint32_t adcparams_decimate(struct ADC1DATA* padc1, uint16_t* pdma);
+/*	@brief	: Accumulate 1/2 DMA buffer sums; publish channels whose count is reached
+ * @param	: padc1 = Pointer to array of ADC reading sums plus other stuff
+ * @param	: pdma = Pointer to the 1/2 DMA buffer (ADCCIC_RAW channels)
+ * @return	: bit per channel with a new output (also in padc1->decready)
+ * *************************************************************************/
+double adcparams_qcheck(uint8_t adcidx, uint32_t r, uint8_t* pqfrac);
+/*	@brief	: Error of the fixed-point path vs. the float path, for a float channel's calibration
+ * @param	: adcidx = index into ADC1 array (calibtype RAW_F - POLY3)
+ * @param	: r = compensation ratio (Q30) used by both
+ * @param	: pqfrac = pointer for the 'qfrac' used (largest that fits)
+ * @return	: largest |difference| over the decimated sum range; < 0 = can't be done
+ * *************************************************************************/
+float adcparams_calg(uint8_t adcidx);
+/*	@brief	: Decimated sum -> calibration input (compensated reading) factor
+ * @param	: adcidx = index into ADC1 array
+ * @return	: g: calibration input x = adc1soa.decsum[adcidx] * g
+ * *************************************************************************/
+int adcparams_setcal(uint8_t adcidx, uint8_t order, float* pc);
+/*	@brief	: Replace a channel's calibration polynomial and rebuild its handlers (ADCTask)
+ * @param	: adcidx = index into ADC1 array
+ * @param	: order = 1 (offset & scale), 2, 3
+ * @param	: pc = pointer to coefficients c0 ... c'order'
+ * @return	: 0 = OK; -1 = not a channel that can be set; -2 = not taken (e.g. _Q does not fit): not changed
+ * *************************************************************************/
 
 /* Raw and calibrated ADC1 readings. */
 extern struct ADC1DATA adc1data;
@@ -201,4 +420,10 @@ extern struct ADC1DATA adc1data;
 /* Calibration values common to all ADC modules. */
 extern struct ADCCALCOMMON adcommon;
 
+/* Per-channel working data, one array per field. */
+extern struct ADC1SOA adc1soa;
+
+/* "Everything" for each ADC1 channel. */
+extern struct ADCCHANNELSTUFF adc1channelstuff[ADC1IDX_ADCSCANSIZE];
+
 #endif
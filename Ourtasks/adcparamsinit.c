@@ -42,6 +42,12 @@ void adcparamsinit_init_common(struct ADCCALCOMMON* padccommon, struct ADCCHANNE
 	padccommon->ll_80caldiff = (80 * SCALE1) /(padccommon->uicaldiff);
 	padccommon->ui_cal1      =	(*PTS_CAL1) * ADC1DMANUMSEQ;
 
+	/* Fixed-point path (_Q calibtypes): Vdd filter (same as the float Vref channel). */
+	padccommon->iir_q1vdd.skipctr  = 12;
+	padccommon->iir_q1vdd.onemcoef = IIR_Q1_COEF(1 - 0.9999);
+	padccommon->iir_q1tmp.skipctr  = 4; // Same as the float temperature channel
+	padccommon->iir_q1tmp.onemcoef = IIR_Q1_COEF(1 - 0.5);
+
 	/* Data sheet gave these values.  May not need them. */
 	padccommon->v25     = 0.76; // Voltage at 25 °C, typ
 	padccommon->slope   = 2.0;  // Average slope (mv/deg C), typ
@@ -72,6 +78,65 @@ void adcparamsinit_init_common(struct ADCCALCOMMON* padccommon, struct ADCCHANNE
 #define ADC1PARAM_CALIBTYPE_POLY2  2    // Polynomial 2nd ord: FLOAT
 #define ADC1PARAM_CALIBTYPE_POLY3  3    // Polynomial 3nd ord: FLOAT
 #define ADC1PARAM_CALIBTYPE_RAW_UI 4    // No calibration applied: UNSIGNED INT
+#define ADC1PARAM_CALIBTYPE_OFSC_Q  5   // Offset & scale (poly ord 0 & 1): FIXED ('qfrac')
+#define ADC1PARAM_CALIBTYPE_POLY2_Q 6   // Polynomial 2nd ord: FIXED ('qfrac')
+#define ADC1PARAM_CALIBTYPE_POLY3_Q 7   // Polynomial 3nd ord: FIXED ('qfrac')
+#define ADC1PARAM_CALIBTYPE_LUT     8   // Piecewise linear table ('lut'): FLOAT
+
+Fixed point (_Q) channels: calibration coefficients are still entered as
+floats in cal.f[] (converted at init); the reading is in .n with 'qfrac'
+fraction bits; IIR1 uses fpw.iir_q1, IIR2 fpw.iir2 (as below, one filter
+per channel, iir_biquad_q.h), e.g.--
+	pacs->xprms.calibtype = ADC1PARAM_CALIBTYPE_OFSC_Q;
+	pacs->xprms.qfrac     = 16;
+	pacs->fpw.iir_q1.skipctr  = 4;
+	pacs->fpw.iir_q1.onemcoef = IIR_Q1_COEF(1 - 0.9);
+If the coefficients do not fit an int32 with 'qfrac' the channel is not
+processed; 'host_main q' lists the largest 'qfrac' that fits each channel.
+With no float channels at all, adcparams_internal skips its float values
+(adcommon.fvdd, degC, ...); adcommon.qdegC, qdegCfilt are kept either way.
+
+IIR2 (float and _Q channels): low pass, cascaded biquads: one of the iir_coef.h
+BIQUAD specs (made and checked by Host/iirgen.c; its sample rate is the
+channel's output rate, ADCRATE(decim)).  Channels with the same spec and
+decimation are filtered together (float), e.g.--
+	pacs->xprms.filttype   = ADCFILTERTYPE_IIR2;
+	pacs->fpw.iir2.spec    = IIRSPEC_ADCLP4; // 4th order Butterworth, 40 Hz
+	pacs->fpw.iir2.skipctr = 4;     // Initial readings skip count
+
+FIR (float channels): one of the fir_coef.h tables (made by Host/firgen.c).
+A decimating table ('m' > 1) updates the filtered reading once every 'm'
+readings, e.g. anti-alias ahead of a slower reader--
+	pacs->xprms.filttype = ADCFILTERTYPE_FIR;
+	pacs->fpw.fir.spec   = FIRSPEC_CURAA4;
+
+Median / Hampel (float channels): sliding median of 'n' readings, or with
+'t' > 0 the readings themselves except spikes more than 't' MADs (at least
+'dmin') from the median, which are replaced by it, e.g. inverter switching
+spikes on a current channel--
+	pacs->xprms.filttype = ADCFILTERTYPE_MEDIAN;
+	pacs->fpw.med.n      = 7;    // Window (odd, 3 - 63)
+	pacs->fpw.med.t      = 3.0;  // MADs (0 = plain median)
+	pacs->fpw.med.dmin   = 0.05; // Smallest threshold (amps)
+
+CIC decimation (any channel): in place of the plain sum of 'decim' 1/2 DMA
+buffers, a CIC of order 1 - 4 (adccic.h), with nulls at every multiple of
+the output rate.  Input either the 1/2 buffer sums (rate = 'decim', 2 - 256)
+or the raw samples (ADCCIC_RAW: rate = ADC1DMANUMSEQ * 'decim', <= 256);
+ADCCIC_COMP flattens the pass band droop.  The decimated sum has the same
+full scale either way, so calibration is unchanged.  Bad order or rate: the
+channel is not processed, e.g. motor current at 1/4 the 1/2 buffer rate--
+	pacs->xprms.decim = 4;
+	pacs->xprms.cic   = 3 | ADCCIC_RAW | ADCCIC_COMP;
+
+Piecewise linear (float channels): calibration points {x, y}, x increasing,
+x = the compensated reading (what OFSC etc. would be applied to).  Equally
+spaced x is looked up by index, otherwise by binary search; cal.f[] is not
+used.  Up to ADCLUTMAX points; bad points: the channel is not processed, e.g.--
+	static const float hall_lut[][2] = { {0, 0}, {10, 0}, {50, 42.5}, {90, 100}, {100, 100} };
+	pacs->xprms.calibtype = ADC1PARAM_CALIBTYPE_LUT;
+	pacs->lut.ppts = hall_lut;
+	pacs->lut.npts = sizeof(hall_lut) / sizeof(hall_lut[0]);
 */
 
 void adcparamsinit_init(struct ADCCHANNELSTUFF* pacsx)
@@ -103,13 +168,17 @@ void adcparamsinit_init(struct ADCCHANNELSTUFF* pacsx)
 	pacs->xprms.calibtype = ADC1PARAM_CALIBTYPE_RAW_F; // Raw; no calibration applied
 	pacs->xprms.comptype  = ADC1PARAM_COMPTYPE_NONE; // No temperature compensation
 
+	// Decimation: slow channel
+	pacs->xprms.decim     = 64;  // One output per 64 1/2 DMA buffers
+	pacs->xprms.outbits   = 16;  // Decimated output effective bits
+
 	// Calibration coefficients.
 	pacs->cal.f[0] = 0.0;  // Offset
 	pacs->cal.f[1] = 1.0;  // Scale (jic calibration not skipped)
 
 	// Filter initialize, coefficients, and pre-computed value. */
 	pacs->fpw.iir_f1.skipctr  = 4; 	  // Initial readings skip count
-	pacs->fpw.iir_f1.coef     = 0.99;  // Filter coefficient (< 1.0)
+	pacs->fpw.iir_f1.coef     = 0.5;   // Filter coefficient (< 1.0) (rate is 1/64: 0.99^64)
 	pacs->fpw.iir_f1.onemcoef = (1 - pacs->fpw.iir_f1.coef);
 
 /* Hall effect lever.  5v supply. */
@@ -169,7 +238,7 @@ void adcparamsinit_init(struct ADCCHANNELSTUFF* pacsx)
 	// Filter type, calibration option, compensation option. */
 	pacs->xprms.filttype  = ADCFILTERTYPE_IIR1;        // Single pole IIR
 	pacs->xprms.calibtype = ADC1PARAM_CALIBTYPE_OFSC;  // Offset & scale (poly ord 0 & 1)
-	pacs->xprms.comptype  = ADC1PARAM_COMPTYPE_VOLTV5; // 5v w Vref abs w temp
+	pacs->xprms.comptype  = ADC1PARAM_COMPTYPE_NONE; // (was VOLTV5, which was never more than x1)
 
 	// Calibration coefficients.
 	pacs->cal.f[0] = 2047.5;  // Offset
@@ -205,13 +274,17 @@ void adcparamsinit_init(struct ADCCHANNELSTUFF* pacsx)
 	pacs->xprms.calibtype = ADC1PARAM_CALIBTYPE_OFSC;  // Offset & scale (poly ord 0 & 1)
 	pacs->xprms.comptype  = ADC1PARAM_COMPTYPE_VOLTVDD; // 5v w Vref abs w temp
 
+	// Decimation: slow channel
+	pacs->xprms.decim     = 64;  // One output per 64 1/2 DMA buffers
+	pacs->xprms.outbits   = 16;  // Decimated output effective bits
+
 	// Calibration coefficients.
 	pacs->cal.f[0] = 0.0;     // Offset
 	pacs->cal.f[1] = 0.1525; // Scale (volts) (1.8K-10K)
 
 	// Filter initialize, coefficients, and pre-computed value. */
 	pacs->fpw.iir_f1.skipctr  = 4; 	 // Initial readings skip count
-	pacs->fpw.iir_f1.coef     = 0.9;   // Filter coefficient (< 1.0)
+	pacs->fpw.iir_f1.coef     = 0.0012; // Filter coefficient (< 1.0) (rate is 1/64: 0.9^64)
 	pacs->fpw.iir_f1.onemcoef = (1 - pacs->fpw.iir_f1.coef);
 
 /* 5v supply. */
@@ -14,9 +14,17 @@
 #define SCALE1 (1 << 16)
 
 /* Factory calibration pointers. */
+#ifdef HOSTBUILD
+/* Host build: system memory is not there; 'hal_stubs.c' supplies typical values. */
+extern uint16_t halstub_factorycal[3];
+#define PVREFINT_CAL (&halstub_factorycal[0])  // Pointer to stand-in calibration: Vref
+#define PTS_CAL1     (&halstub_factorycal[1])  // Pointer to stand-in calibration: Vtemp
+#define PTS_CAL2     (&halstub_factorycal[2])  // Pointer to stand-in calibration: Vtemp
+#else
 #define PVREFINT_CAL ((uint16_t*)0x1FFF7A2A)  // Pointer to factory calibration: Vref
 #define PTS_CAL1     ((uint16_t*)0x1FFF7A2C)  // Pointer to factory calibration: Vtemp
 #define PTS_CAL2     ((uint16_t*)0x1FFF7A2E)  // Pointer to factory calibration: Vtemp
+#endif
 
 /* Factory Vdd for Vref calibration. */
 #define VREFCALVOLT 3300  // Factory cal voltage (mv)
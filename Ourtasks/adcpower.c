@@ -0,0 +1,123 @@
+/******************************************************************************
+* File Name          : adcpower.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Electrical power and energy from the ADC current channels
+*******************************************************************************/
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "adcpower.h"
+#include "DTW_counter.h"
+
+/* Window lengths: DTW ticks */
+static const uint32_t winticks[ADCPOWERWINNUM] =
+{
+	DTWTIMEHZ / 10, // 100 ms
+	DTWTIMEHZ,      // 1 s
+};
+
+/* ADC channel of each power channel */
+static const uint8_t pidx[ADCPOWERNUM] =
+{
+	ADC1IDX_CURRENTTOTAL,
+	ADC1IDX_CURRENTMOTOR1,
+	ADC1IDX_CURRENTMOTOR2,
+};
+
+#define MWTICKSPERJ (1000.0 * DTWTIMEHZ) // mW x DTW ticks per joule
+
+struct ADCPOWER adcpower = {.reset = 1};
+
+/* *************************************************************************
+ * void adcpower_reset(void);
+ * @brief	: Start a new run: zero energy, run time, and windows (at next update)
+ * *************************************************************************/
+void adcpower_reset(void)
+{
+	adcpower.reset = 1;
+	return;
+}
+/* *************************************************************************
+ * void adcpower_update(struct ADC1DATA* padc1);
+ * @brief	: Power, energy, averages for one 1/2 DMA buffer (ADCTask)
+ * @param	: padc1 = Pointer to calibrated readings
+ * *************************************************************************/
+void adcpower_update(struct ADC1DATA* padc1)
+{
+	struct ADCPOWER* p = &adcpower;
+	struct ADCPOWERSNAP* ps = &p->snap;
+	uint32_t dtw = DTWTIME;
+	uint32_t dt  = dtw - p->dtwprev; // Wraps OK (< 25 sec between updates)
+	int32_t  pmw[ADCPOWERNUM];
+	float v = padc1->adc1calreading[ADCPOWER_VIDX].f;
+	float pw;
+	int i;
+	int w;
+
+	p->dtwprev = dtw;
+
+	if (p->reset != 0)
+	{ // No interval yet: start the run at this update
+		p->reset = 0;
+		for (i = 0; i < ADCPOWERNUM; i++)
+		{
+			ps->e[i] = 0;
+			for (w = 0; w < ADCPOWERWINNUM; w++) p->ewin[w][i] = 0;
+		}
+		for (w = 0; w < ADCPOWERWINNUM; w++) p->twin[w] = 0;
+		ps->trun = 0;
+		dt = 0;
+	}
+
+	/* Instantaneous power; integer mW for the accumulators. */
+	for (i = 0; i < ADCPOWERNUM; i++)
+	{
+		pw = padc1->adc1calreading[pidx[i]].f * v;
+		ps->p[i] = pw;
+		pmw[i] = (int32_t)(pw * 1000.0f);
+		ps->e[i] += (int64_t)pmw[i] * dt;
+	}
+	ps->trun += dt;
+	ps->v = v;
+
+	/* Windows: average published when the window is full, then restarted. */
+	for (w = 0; w < ADCPOWERWINNUM; w++)
+	{
+		p->twin[w] += dt;
+		for (i = 0; i < ADCPOWERNUM; i++)
+			p->ewin[w][i] += (int64_t)pmw[i] * dt;
+
+		if (p->twin[w] >= winticks[w])
+		{
+			for (i = 0; i < ADCPOWERNUM; i++)
+			{
+				ps->pwin[w][i] = (float)p->ewin[w][i] / ((float)p->twin[w] * 1000.0f);
+				p->ewin[w][i] = 0;
+			}
+			p->twin[w] = 0;
+		}
+	}
+
+	/* Run average and energy in SI units (float: the accumulators stay exact) */
+	for (i = 0; i < ADCPOWERNUM; i++)
+	{
+		ps->ej[i] = (float)ps->e[i] * (float)(1.0 / MWTICKSPERJ);
+		if (ps->trun != 0)
+			ps->prun[i] = (float)ps->e[i] / ((float)ps->trun * 1000.0f);
+	}
+	ps->ctr += 1;
+	return;
+}
+/* *************************************************************************
+ * void adcpower_snapshot(struct ADCPOWERSNAP* psnap);
+ * @brief	: Copy the latest results (any task)
+ * @param	: psnap = pointer to struct to receive copy
+ * *************************************************************************/
+void adcpower_snapshot(struct ADCPOWERSNAP* psnap)
+{
+taskENTER_CRITICAL();
+	*psnap = adcpower.snap;
+taskEXIT_CRITICAL();
+	return;
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+* File Name          : adcpower.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Electrical power and energy from the ADC current channels
+*******************************************************************************/
+/*
+Every 1/2 DMA buffer (after adcparams_all) each current channel's calibrated
+reading (amps) times the supply reading (volts) gives the power.  The power
+is integrated with the DTWTIME interval since the previous update--
+
+  e += P(mW) x dt(DTW ticks)   (int64_t)
+
+Integer accumulation does not drift, and the run time is the exact sum of
+the intervals.  1 J = 1000 x DTWTIMEHZ mW-ticks, so int64 holds ~15 kWh.
+
+Averages: 100 ms and 1 s windows (back to back, each published when full),
+and the run (since adcpower_reset).
+
+The supply is the one voltage ADC channel there is (12v raw supply,
+decimated, so it holds between its updates); ADCPOWER_VIDX selects another.
+*/
+
+#ifndef __ADCPOWER
+#define __ADCPOWER
+
+#include <stdint.h>
+#include "adcparams.h"
+
+/* Power channels */
+#define ADCPOWER_TOTAL  0 // ADC1IDX_CURRENTTOTAL
+#define ADCPOWER_MOTOR1 1 // ADC1IDX_CURRENTMOTOR1
+#define ADCPOWER_MOTOR2 2 // ADC1IDX_CURRENTMOTOR2
+#define ADCPOWERNUM     3
+
+#ifndef ADCPOWER_VIDX
+  #define ADCPOWER_VIDX ADC1IDX_12VRAWSUPPLY // Supply voltage channel
+#endif
+
+/* Averaging windows */
+#define ADCPOWERWIN_100MS 0
+#define ADCPOWERWIN_1S    1
+#define ADCPOWERWINNUM    2
+
+/* Published results (adcpower_snapshot) */
+struct ADCPOWERSNAP
+{
+	int64_t  e[ADCPOWERNUM];    // Energy since reset: mW x DTW ticks
+	uint64_t trun;              // Run time: DTW ticks
+	float    p[ADCPOWERNUM];    // Latest power (W)
+	float    pwin[ADCPOWERWINNUM][ADCPOWERNUM]; // Last full window average power (W)
+	float    prun[ADCPOWERNUM]; // Run average power (W)
+	float    ej[ADCPOWERNUM];   // Energy since reset (J)
+	float    v;                 // Supply voltage used (V)
+	uint32_t ctr;               // Update count
+};
+
+/* Working accumulators */
+struct ADCPOWER
+{
+	struct ADCPOWERSNAP snap;
+	int64_t  ewin[ADCPOWERWINNUM][ADCPOWERNUM]; // Window energy accumulators
+	uint32_t twin[ADCPOWERWINNUM]; // Window ticks so far
+	uint32_t dtwprev; // DTWTIME at last update
+	uint8_t  reset;   // 1 = next update starts a run
+};
+
+/* *************************************************************************/
+void adcpower_reset(void);
+/* @brief	: Start a new run: zero energy, run time, and windows (at next update)
+ * *************************************************************************/
+void adcpower_update(struct ADC1DATA* padc1);
+/* @brief	: Power, energy, averages for one 1/2 DMA buffer (ADCTask)
+ * @param	: padc1 = Pointer to calibrated readings
+ * *************************************************************************/
+void adcpower_snapshot(struct ADCPOWERSNAP* psnap);
+/* @brief	: Copy the latest results (any task)
+ * @param	: psnap = pointer to struct to receive copy
+ * *************************************************************************/
+
+extern struct ADCPOWER adcpower;
+
+#endif
@@ -0,0 +1,87 @@
+/******************************************************************************
+* File Name          : adcsnap.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Tear-free snapshot of ADC readings for other tasks
+*******************************************************************************/
+/*
+See adcsnap.h for the sequence counter/double buffer scheme.
+
+The barriers keep the compiler (and, on the host, the CPU) from moving the
+buffer copies across the 'seq' reads and writes.  On the single core F4 a
+DMB is more than enough.
+*/
+#include <string.h>
+#include "adcsnap.h"
+#include "DTW_counter.h"
+
+#ifdef HOSTBUILD
+  #define ADCSNAPBARRIER() __sync_synchronize()
+#else
+  #include "stm32f4xx_hal.h"
+  #define ADCSNAPBARRIER() __DMB()
+#endif
+
+struct ADCSNAPDB adcsnapdb;
+
+/* *************************************************************************
+ * void adcsnap_publish(void);
+ * @brief	: Copy adc1data & adcommon into the unpublished buffer, publish it (ADCTask)
+ * *************************************************************************/
+void adcsnap_publish(void)
+{
+	struct ADCSNAPDB* pdb = &adcsnapdb;
+	struct ADCSNAP* p;
+	uint32_t seq = pdb->seq;
+
+	pdb->seq = seq + 1; // Odd: write in progress
+	ADCSNAPBARRIER();
+
+	p = &pdb->b[((seq >> 1) + 1) & 1];
+	memcpy(p->cal,     adc1data.adc1calreading,     sizeof(p->cal));
+	memcpy(p->calfilt, adc1data.adc1calreadingfilt, sizeof(p->calfilt));
+	memcpy(p->sum,     adc1data.adcs1sum,   sizeof(p->sum));
+	memcpy(p->sumsq,   adc1data.adcs1sumsq, sizeof(p->sumsq));
+	memcpy(p->min,     adc1data.adcs1min,   sizeof(p->min));
+	memcpy(p->max,     adc1data.adcs1max,   sizeof(p->max));
+	p->fvdd          = adcommon.fvdd;
+	p->fvddfilt      = adcommon.fvddfilt;
+	p->degC          = adcommon.degC;
+	p->degCfilt      = adcommon.degCfilt;
+	p->f5_Vddratio   = adcommon.f5_Vddratio;
+	p->f5vsupply     = adcommon.f5vsupply;
+	p->f5vsupplyfilt = adcommon.f5vsupplyfilt;
+	p->ivdd          = adcommon.ivdd;
+	p->qdegCfilt     = adcommon.qdegCfilt;
+	p->dmact         = adcommon.dmact;
+	p->ctr           = adc1data.ctr;
+	p->dtw           = DTWTIME;
+
+	ADCSNAPBARRIER();
+	pdb->seq = seq + 2; // Even: published
+	return;
+}
+/* *************************************************************************
+ * uint32_t adcsnap_read(struct ADCSNAP* psnap);
+ * @brief	: Copy the latest published set (any task; no lock)
+ * @param	: psnap = pointer to struct to receive copy
+ * @return	: publish number of the copy (0 = nothing published yet)
+ * *************************************************************************/
+uint32_t adcsnap_read(struct ADCSNAP* psnap)
+{
+	struct ADCSNAPDB* pdb = &adcsnapdb;
+	uint32_t s1;
+	uint32_t s2;
+
+	for (;;)
+	{
+		s1 = pdb->seq & ~1U; // 2 x publishes completed
+		ADCSNAPBARRIER();
+		memcpy(psnap, &pdb->b[(s1 >> 1) & 1], sizeof(struct ADCSNAP));
+		ADCSNAPBARRIER();
+		s2 = pdb->seq;
+		if ((s2 - s1) < 3) break; // Writer has not come back to this buffer
+		pdb->retry += 1;
+	}
+	return (s1 >> 1);
+}
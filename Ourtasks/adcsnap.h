@@ -0,0 +1,78 @@
+/******************************************************************************
+* File Name          : adcsnap.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Tear-free snapshot of ADC readings for other tasks
+*******************************************************************************/
+/*
+ADCTask rewrites adc1data and adcommon every 1/2 DMA buffer, at a higher
+priority than the tasks that read them, so a reader going through those
+structs directly can get part of one update and part of the next.
+
+After each update ADCTask publishes a copy (adcsnap_publish) into one of two
+buffers, and readers copy the last published one (adcsnap_read) with no
+lock and no critical section--
+
+ 'seq' goes up by one when a write starts (odd) and again when it ends
+ (even); seq/2 = number of publishes, and publish n is in buffer n & 1.
+
+ Writer: seq += 1; fill buffer ((seq/2)+1) & 1; seq += 1
+ Reader: s1 = seq; copy buffer (s1/2) & 1; s2 = seq
+         The writer only comes back to that buffer when it starts the
+         publish after next (seq = 2*(s1/2) + 3), so the copy is good if
+         s2 - 2*(s1/2) < 3; otherwise copy again.
+
+The writer never waits, and a reader only retries if it was held off for
+two whole 1/2 DMA buffers in the middle of its copy.
+*/
+
+#ifndef __ADCSNAP
+#define __ADCSNAP
+
+#include <stdint.h>
+#include "adcparams.h"
+
+/* One consistent set of readings */
+struct ADCSNAP
+{
+	union ADCCALREADING cal[ADC1IDX_ADCSCANSIZE];     // adc1calreading
+	union ADCCALREADING calfilt[ADC1IDX_ADCSCANSIZE]; // adc1calreadingfilt
+	uint32_t sum[ADC1IDX_ADCSCANSIZE];   // adcs1sum
+	uint32_t sumsq[ADC1IDX_ADCSCANSIZE]; // adcs1sumsq
+	uint16_t min[ADC1IDX_ADCSCANSIZE];   // adcs1min
+	uint16_t max[ADC1IDX_ADCSCANSIZE];   // adcs1max
+	float fvdd;          // adcommon...
+	float fvddfilt;
+	float degC;
+	float degCfilt;
+	float f5_Vddratio;
+	float f5vsupply;
+	float f5vsupplyfilt;
+	uint16_t ivdd;
+	int32_t qdegCfilt;   // Q16 (kept when there are no float channels)
+	uint32_t dmact;
+	uint32_t ctr;        // adc1data.ctr
+	uint32_t dtw;        // DTWTIME when published
+};
+
+/* Publish double buffer */
+struct ADCSNAPDB
+{
+	struct ADCSNAP b[2];
+	volatile uint32_t seq; // Odd = write in progress; seq/2 = publishes
+	uint32_t retry;        // Reader retries (debug)
+};
+
+/* *************************************************************************/
+void adcsnap_publish(void);
+/* @brief	: Copy adc1data & adcommon into the unpublished buffer, publish it (ADCTask)
+ * *************************************************************************/
+uint32_t adcsnap_read(struct ADCSNAP* psnap);
+/* @brief	: Copy the latest published set (any task; no lock)
+ * @param	: psnap = pointer to struct to receive copy
+ * @return	: publish number of the copy (0 = nothing published yet)
+ * *************************************************************************/
+
+extern struct ADCSNAPDB adcsnapdb;
+
+#endif
@@ -0,0 +1,119 @@
+/******************************************************************************
+* File Name          : adctiming.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : ADC 1/2 DMA buffer overrun count, latency & processing time
+*******************************************************************************/
+
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "adctiming.h"
+#include "adcparams.h"
+#include "DTW_counter.h"
+
+struct ADCTIMINGBLK adctiming;
+
+/* log2 bucket: b for 2^b <= t < 2^(b+1); 0 and 1 both in 0 (CLZ instruction) */
+static inline uint32_t bucket(uint32_t t)
+{
+	return 31 - __builtin_clz(t | 1);
+}
+/* *************************************************************************
+ * void adctiming_isr(int half);
+ * @brief	: Stamp 1/2 buffer complete (DMA callbacks)
+ * @param	: half = 0 for 1st 1/2 (ConvHalfCplt), 1 for 2nd 1/2 (ConvCplt)
+ * *************************************************************************/
+void adctiming_isr(int half)
+{
+	struct ADCTIMINGBLK* p = &adctiming;
+	uint32_t dtw = DTWTIME;
+	uint32_t period = dtw - p->dtwisr[half ^ 1];
+
+	p->dtwisr[half] = dtw;
+	p->lasthalf = half;
+	if (p->init != 0)
+	{ // Other half's stamp is good once the task is running
+		p->t.period = period;
+		if (period > p->t.periodmax) p->t.periodmax = period;
+	}
+	return;
+}
+/* *************************************************************************
+ * int adctiming_begin(uint32_t pend1, uint32_t pend2);
+ * @brief	: Start of processing: select 1/2 buffer, count misses, latency (ADCTask)
+ * @param	: pend1 = not zero if 1st 1/2 notification bit is pending
+ * @param	: pend2 = not zero if 2nd 1/2 notification bit is pending
+ * @return	: 0 = process 1st 1/2 buffer; 1 = 2nd 1/2 buffer
+ * *************************************************************************/
+int adctiming_begin(uint32_t pend1, uint32_t pend2)
+{
+	struct ADCTIMINGBLK* p = &adctiming;
+	uint32_t dtw = DTWTIME;
+	uint32_t dmact = adcommon.dmact;
+	uint32_t lat;
+	int half;
+
+	if ((pend1 != 0) && (pend2 != 0))
+	{ // Fell behind: the newer half is the one the DMA is not writing
+		p->t.bothpend += 1;
+		half = p->lasthalf;
+	}
+	else
+	{
+		half = (pend1 != 0) ? 0 : 1;
+	}
+
+	/* Every callback after the previous one processed is a 1/2 buffer missed,
+	   except the one being processed now. */
+	if ((p->init != 0) && ((dmact - p->dmactprev) > 1))
+		p->t.missed += (dmact - p->dmactprev) - 1;
+	p->dmactprev = dmact;
+	p->init = 1;
+
+	lat = dtw - p->dtwisr[half];
+	p->t.lat = lat;
+	if (lat > p->t.latmax) p->t.latmax = lat;
+	p->t.hlat[bucket(lat)] += 1;
+
+	p->dtwbegin = dtw;
+	return half;
+}
+/* *************************************************************************
+ * void adctiming_end(void);
+ * @brief	: End of processing: processing time (ADCTask)
+ * *************************************************************************/
+void adctiming_end(void)
+{
+	struct ADCTIMINGBLK* p = &adctiming;
+	uint32_t proc = DTWTIME - p->dtwbegin;
+
+	p->t.proc = proc;
+	if (proc > p->t.procmax) p->t.procmax = proc;
+	p->t.hproc[bucket(proc)] += 1;
+	p->t.processed += 1;
+	return;
+}
+/* *************************************************************************
+ * void adctiming_get(struct ADCTIMING* pt);
+ * @brief	: Copy counts and histograms (any task)
+ * @param	: pt = pointer to struct to receive copy
+ * *************************************************************************/
+void adctiming_get(struct ADCTIMING* pt)
+{
+taskENTER_CRITICAL();
+	*pt = adctiming.t;
+taskEXIT_CRITICAL();
+	return;
+}
+/* *************************************************************************
+ * void adctiming_reset(void);
+ * @brief	: Zero counts, maximums, and histograms (any task)
+ * *************************************************************************/
+void adctiming_reset(void)
+{
+taskENTER_CRITICAL();
+	memset(&adctiming.t, 0, sizeof(struct ADCTIMING));
+taskEXIT_CRITICAL();
+	return;
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+* File Name          : adctiming.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : ADC 1/2 DMA buffer overrun count, latency & processing time
+*******************************************************************************/
+/*
+The ADC DMA callbacks (adctask.c) stamp DTWTIME for the 1/2 buffer that just
+filled.  ADCTask then--
+
+ adctiming_begin: picks the 1/2 buffer to process.  Both notification bits
+   pending means the task fell a whole buffer behind; the older half is
+   being overwritten by the DMA, so the newer one is processed.  Missed
+   1/2 buffers are counted from the callback count (adcommon.dmact), which
+   also catches more than one.  Latency = callback stamp to now.
+
+ adctiming_end: processing time = begin to end.
+
+Latency and processing time go into log2 histograms: bucket b counts times
+of 2^b to 2^(b+1)-1 DTW ticks (bucket 0: 0 and 1).  1/2 buffer period
+(callback to callback) is kept too, so headroom = period - (latency +
+processing) before a 1/2 buffer gets missed.
+
+adctiming_get copies it all for any task.
+*/
+
+#ifndef __ADCTIMING
+#define __ADCTIMING
+
+#include <stdint.h>
+
+#define ADCTIMINGNBKT 32 // log2 histogram buckets (uint32_t ticks)
+
+struct ADCTIMING
+{
+	uint32_t hlat[ADCTIMINGNBKT];  // Histogram: callback to processing start
+	uint32_t hproc[ADCTIMINGNBKT]; // Histogram: processing time
+	uint32_t processed; // 1/2 buffers processed
+	uint32_t missed;    // 1/2 buffers not processed (overrun)
+	uint32_t bothpend;  // Times both notification bits were pending
+	uint32_t lat;       // Latest latency (DTW ticks)
+	uint32_t latmax;    // Largest latency
+	uint32_t proc;      // Latest processing time
+	uint32_t procmax;   // Largest processing time
+	uint32_t period;    // Latest callback to callback time
+	uint32_t periodmax; // Largest callback to callback time
+};
+
+/* Callback side (ISR) and task side working values */
+struct ADCTIMINGBLK
+{
+	struct ADCTIMING t;
+	volatile uint32_t dtwisr[2]; // DTWTIME at callback: [0] 1/2 cplt, [1] cplt
+	volatile uint8_t  lasthalf;  // Last callback: 0 = 1/2 cplt, 1 = cplt
+	uint32_t dtwbegin;  // DTWTIME at adctiming_begin
+	uint32_t dmactprev; // adcommon.dmact at last adctiming_begin
+	uint8_t  init;      // 0 = no adctiming_begin yet
+};
+
+/* *************************************************************************/
+void adctiming_isr(int half);
+/* @brief	: Stamp 1/2 buffer complete (DMA callbacks)
+ * @param	: half = 0 for 1st 1/2 (ConvHalfCplt), 1 for 2nd 1/2 (ConvCplt)
+ * *************************************************************************/
+int adctiming_begin(uint32_t pend1, uint32_t pend2);
+/* @brief	: Start of processing: select 1/2 buffer, count misses, latency (ADCTask)
+ * @param	: pend1 = not zero if 1st 1/2 notification bit is pending
+ * @param	: pend2 = not zero if 2nd 1/2 notification bit is pending
+ * @return	: 0 = process 1st 1/2 buffer; 1 = 2nd 1/2 buffer
+ * *************************************************************************/
+void adctiming_end(void);
+/* @brief	: End of processing: processing time (ADCTask)
+ * *************************************************************************/
+void adctiming_get(struct ADCTIMING* pt);
+/* @brief	: Copy counts and histograms (any task)
+ * @param	: pt = pointer to struct to receive copy
+ * *************************************************************************/
+void adctiming_reset(void);
+/* @brief	: Zero counts, maximums, and histograms (any task)
+ * *************************************************************************/
+
+extern struct ADCTIMINGBLK adctiming;
+
+#endif
@@ -0,0 +1,44 @@
+/******************************************************************************
+* File Name          : fir_coef.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : FIR coefficient tables (fir_poly.h)
+*******************************************************************************/
+/* Generated by Host/firgen.c: edit the specs there, then 'make firtables'. */
+
+#include "fir_coef.h"
+
+/* CURAA4: Motor current: anti-alias, then 1/4 rate
+   32 taps, Blackman window, 1/4, fc 0.0800: -6.00 dB at fc; stop band (f >= 0.2100) -74.3 dB max
+   Phase order: 4 phases of 8 taps. */
+static const float h_CURAA4[32] =
+{
+	-2.850696410e-19f, -9.550771533e-04f, -9.144168973e-03f, 7.265669591e-02f, 1.580080491e-01f, 3.856497298e-02f, -9.099734484e-03f, 6.140338996e-19f,
+	6.969252770e-05f, -3.085736657e-03f, -2.924237951e-03f, 1.091649236e-01f, 1.401642166e-01f, 1.262431373e-02f, -6.221944146e-03f, 1.780349066e-04f,
+	1.780349066e-04f, -6.221944146e-03f, 1.262431373e-02f, 1.401642166e-01f, 1.091649236e-01f, -2.924237951e-03f, -3.085736657e-03f, 6.969252770e-05f,
+	6.140338996e-19f, -9.099734484e-03f, 3.856497298e-02f, 1.580080491e-01f, 7.265669591e-02f, -9.144168973e-03f, -9.550771533e-04f, -2.850696410e-19f,
+};
+
+/* TORQUE15: Torque lever: linear phase smoothing
+   15 taps, Hamming window, 1/1, fc 0.0500: -2.86 dB at fc; stop band (f >= 0.2000) -42.9 dB max
+   Phase order: 1 phases of 15 taps. */
+static const float h_TORQUE15[15] =
+{
+	4.394110136e-03f, 9.458191100e-03f, 2.406611222e-02f, 4.945213631e-02f, 8.232580298e-02f, 1.154817330e-01f, 1.401699527e-01f, 1.493039230e-01f, 1.401699527e-01f, 1.154817330e-01f, 8.232580298e-02f, 4.945213631e-02f, 2.406611222e-02f, 9.458191100e-03f, 4.394110136e-03f,
+};
+
+/* MBX2: Mailbox readings: smooth, then 1/2 rate
+   16 taps, Hamming window, 1/2, fc 0.2000: -6.04 dB at fc; stop band (f >= 0.4000) -56.8 dB max
+   Phase order: 2 phases of 8 taps. */
+static const float h_MBX2[16] =
+{
+	1.245935220e-18f, 7.889558418e-03f, -5.080560271e-02f, 1.838717131e-01f, 3.699948258e-01f, 1.199212649e-17f, -1.652199738e-02f, 5.571502754e-03f,
+	5.571502754e-03f, -1.652199738e-02f, 1.199212649e-17f, 3.699948258e-01f, 1.838717131e-01f, -5.080560271e-02f, 7.889558418e-03f, 1.245935220e-18f,
+};
+
+const struct FIRPOLYSPEC firspec[FIRSPECNUM] =
+{
+	{h_CURAA4, 32, 4, 8},
+	{h_TORQUE15, 15, 1, 15},
+	{h_MBX2, 16, 2, 8},
+};
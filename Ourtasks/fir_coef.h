@@ -0,0 +1,22 @@
+/******************************************************************************
+* File Name          : fir_coef.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : FIR coefficient tables (fir_poly.h)
+*******************************************************************************/
+/* Generated by Host/firgen.c: edit the specs there, then 'make firtables'. */
+
+#ifndef __FIR_COEF
+#define __FIR_COEF
+
+#include "fir_poly.h"
+
+/* Codes for 'fpw.fir.spec' and index into firspec[] */
+#define FIRSPEC_CURAA4     0 // Motor current: anti-alias, then 1/4 rate
+#define FIRSPEC_TORQUE15   1 // Torque lever: linear phase smoothing
+#define FIRSPEC_MBX2       2 // Mailbox readings: smooth, then 1/2 rate
+#define FIRSPECNUM 3
+
+extern const struct FIRPOLYSPEC firspec[FIRSPECNUM];
+
+#endif
@@ -0,0 +1,89 @@
+/******************************************************************************
+* File Name          : fir_poly.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : FIR filter: decimating, polyphase, float
+*******************************************************************************/
+/*
+Which phase an input belongs to: the output is at the last input of a block
+of 'm', so the k'th input of the block (k = 0 .. m-1) is m-1-k inputs before
+it and goes with taps h[m-1-k], h[m-1-k + m], ...
+*/
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "fir_poly.h"
+
+/* *************************************************************************
+ * int fir_poly_init(struct FIRPOLY* pf, const struct FIRPOLYSPEC* ps);
+ * @brief	: Set coefficients; get delay line memory
+ * @param	: pf = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: ps = Pointer to coefficients (e.g. &firspec[FIRSPEC_...])
+ * @return	: 0 = OK; -1 = bad spec; -2 = calloc failed
+ * NOTE: 'pd' must be NULL or from a previous init (it is freed: re-init OK)
+ * *************************************************************************/
+int fir_poly_init(struct FIRPOLY* pf, const struct FIRPOLYSPEC* ps)
+{
+	if ((ps == NULL) || (ps->ph == NULL) || (ps->m == 0) || (ps->l == 0)) return -1;
+
+	pf->ps    = ps;
+	pf->acc   = 0;
+	pf->k     = 0;
+	pf->pos   = 0;
+	pf->prime = 1;
+
+taskENTER_CRITICAL();
+	free(pf->pd);
+	pf->pd = (float*)calloc(2 * ps->m * ps->l, sizeof(float));
+taskEXIT_CRITICAL();
+	if (pf->pd == NULL) return -2;
+	return 0;
+}
+/* *************************************************************************
+ * int fir_poly_in(struct FIRPOLY* pf, float x, float* py);
+ * @brief	: Filter one new value
+ * @param	: pf = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter
+ * @param	: py = Pointer for output (only stored when there is one)
+ * @return	: 1 = new output in *py; 0 = not yet (decimating)
+ * *************************************************************************/
+int fir_poly_in(struct FIRPOLY* pf, float x, float* py)
+{
+	const struct FIRPOLYSPEC* ps = pf->ps;
+	const float* ph;
+	float* pd;
+	float acc;
+	int l = ps->l;
+	int p;
+	int j;
+
+	if (pf->prime != 0)
+	{ // First input: as if it had always been there
+		pf->prime = 0;
+		for (j = 0; j < 2 * ps->m * l; j++)
+			pf->pd[j] = x;
+	}
+
+	if (pf->k == 0)
+	{ // New block: every delay line moves one place
+		pf->pos = (pf->pos == 0) ? (l - 1) : (pf->pos - 1);
+		pf->acc = 0;
+	}
+
+	/* Into this phase's delay line (both copies), then its taps. */
+	p  = ps->m - 1 - pf->k;
+	pd = pf->pd + (p * 2 * l) + pf->pos;
+	pd[0] = x;
+	pd[l] = x;
+	ph = ps->ph + (p * l);
+	acc = pf->acc;
+	for (j = 0; j < l; j++)
+		acc += ph[j] * pd[j];
+	pf->acc = acc;
+
+	pf->k += 1;
+	if (pf->k < ps->m) return 0;
+	pf->k = 0;
+	*py = acc;
+	return 1;
+}
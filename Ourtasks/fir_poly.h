@@ -0,0 +1,73 @@
+/******************************************************************************
+* File Name          : fir_poly.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : FIR filter: decimating, polyphase, float
+*******************************************************************************/
+/*
+Low pass FIR with decimation by 'm': one output per 'm' inputs,
+y = sum h[i] * x[n - i], i = 0 .. ntap-1.
+
+Polyphase: the taps are split into 'm' sub-filters (phases) of 'l' taps,
+phase p = h[p], h[p+m], h[p+2m] ...  Each input goes in its phase's delay
+line and that phase's 'l' taps are added in right away, so every input
+costs the same 'l' = ntap/m multiply-adds and the output is ready on the
+m'th input (no burst of ntap multiply-adds at the output).
+
+The delay lines are circular, each held twice over so the sum never wraps.
+
+Coefficient tables are made at build time by Host/firgen.c (fir_coef.c/.h,
+already in polyphase order): edit the specs there.
+
+The first input fills the history (no start-up ramp from zero).
+
+ADC channels: ADCFILTERTYPE_FIR with 'fpw.fir.spec' = FIRSPEC_ code.  Any
+other float, e.g. a mailbox reading, in the task that takes it--
+	static struct FIRPOLY fir; // pd = NULL
+	fir_poly_init(&fir, &firspec[FIRSPEC_MBX2]);
+	...
+	if (fir_poly_in(&fir, pmbx->mbx.u.f[0], &y) != 0) { new output 'y' }
+*/
+
+#ifndef __FIR_POLY
+#define __FIR_POLY
+
+#include <stdint.h>
+
+/* Build-time coefficients (fir_coef.c) */
+struct FIRPOLYSPEC
+{
+	const float* ph;  // Taps in phase order: phase 0 [l], phase 1 [l], ...
+	uint16_t ntap;    // Number of taps (before padding to m * l)
+	uint8_t  m;       // Decimation: one output per 'm' inputs (1 = none)
+	uint8_t  l;       // Taps per phase
+};
+
+/* With this struct one pointer will convey everything necessary. */
+struct FIRPOLY
+{
+	const struct FIRPOLYSPEC* ps; // Coefficients
+	float* pd;      // Delay lines: per phase, 2 * l
+	float acc;      // Output being summed
+	uint8_t k;      // Inputs so far in this output's block (0 .. m-1)
+	uint8_t pos;    // Delay line newest (0 .. l-1)
+	uint8_t prime;  // 1 = next input fills the history
+};
+
+/* *************************************************************************/
+int fir_poly_init(struct FIRPOLY* pf, const struct FIRPOLYSPEC* ps);
+/* @brief	: Set coefficients; get delay line memory
+ * @param	: pf = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: ps = Pointer to coefficients (e.g. &firspec[FIRSPEC_...])
+ * @return	: 0 = OK; -1 = bad spec; -2 = calloc failed
+ * NOTE: 'pd' must be NULL or from a previous init (it is freed: re-init OK)
+ * *************************************************************************/
+int fir_poly_in(struct FIRPOLY* pf, float x, float* py);
+/* @brief	: Filter one new value
+ * @param	: pf = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter
+ * @param	: py = Pointer for output (only stored when there is one)
+ * @return	: 1 = new output in *py; 0 = not yet (decimating)
+ * *************************************************************************/
+
+#endif
@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name          : iir_biquad.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : IIR filter: cascaded biquads (DF2T), float, multi-lane
+*******************************************************************************/
+
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iir_biquad.h"
+
+/* *************************************************************************
+ * int iir_biquad_init(struct BIQUADBANK* pbank, const struct BIQUADSPEC* ps, uint8_t nlane, uint16_t skipct);
+ * @brief	: Load coefficients for a low pass cascade; get state memory
+ * @param	: pbank = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: ps = Pointer to coefficients
+ * @param	: nlane = number of inputs run together
+ * @param	: skipct = Number of initial readings to not filter
+ * @return	: 0 = OK; -1 = bad section or lane count; -2 = calloc failed
+ * NOTE: 'pz' must be NULL or from a previous init (it is freed: re-init OK)
+ * *************************************************************************/
+int iir_biquad_init(struct BIQUADBANK* pbank, const struct BIQUADSPEC* ps, uint8_t nlane, uint16_t skipct)
+{
+	int i;
+
+	if ((ps->nsect < 1) || (ps->nsect > BIQUADMAXSECT)) return -1;
+	if (nlane == 0) return -1;
+
+	pbank->nsect   = ps->nsect;
+	pbank->nlane   = nlane;
+	pbank->skipctr = skipct;
+
+	/* A copy: RAM is faster to load than flash. */
+	for (i = 0; i < pbank->nsect; i++)
+		pbank->sect[i] = ps->sect[i];
+
+taskENTER_CRITICAL();
+	free(pbank->pz);
+	pbank->pz = (float*)calloc(2 * pbank->nsect * nlane, sizeof(float));
+taskEXIT_CRITICAL();
+	if (pbank->pz == NULL) return -2;
+	return 0;
+}
+/* *************************************************************************
+ * void iir_biquad_run(struct BIQUADBANK* pbank, float* pin, float* pout);
+ * @brief	: Filter one new value for every lane
+ * @param	: pbank = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: pin  = Pointer to inputs, one per lane
+ * @param	: pout = Pointer to outputs, one per lane (may be the same as pin)
+ * *************************************************************************/
+void iir_biquad_run(struct BIQUADBANK* pbank, float* pin, float* pout)
+{
+	struct BIQUADCOEF* pc = &pbank->sect[0];
+	float* pz1 = pbank->pz;
+	float* pz2;
+	float* px = pin;  // Section input: 'pin', then the previous section's output
+	float x;
+	float y;
+	int n = pbank->nlane;
+	int i;
+	int j;
+
+	if (pbank->skipctr > 0)
+	{ // Here, skip starting filter until a few readings.
+		pbank->skipctr -= 1;
+		/* Load the state that a steady input would leave (unity dc gain). */
+		for (i = 0; i < pbank->nsect; i++, pc++)
+		{
+			pz2 = pz1 + n;
+			for (j = 0; j < n; j++)
+			{
+				x = pin[j];
+				pz1[j] = x * (1 - pc->b0);
+				pz2[j] = x * (pc->b2 - pc->a2);
+			}
+			pz1 = pz2 + n;
+		}
+		for (j = 0; j < n; j++) pout[j] = pin[j];
+		return;
+	}
+
+	for (i = 0; i < pbank->nsect; i++, pc++)
+	{
+		float b0 = pc->b0, b1 = pc->b1, b2 = pc->b2, a1 = pc->a1, a2 = pc->a2;
+		pz2 = pz1 + n;
+		for (j = 0; j < n; j++)
+		{
+			x = px[j];
+			y = b0 * x + pz1[j];
+			pz1[j] = b1 * x - a1 * y + pz2[j];
+			pz2[j] = b2 * x - a2 * y;
+			pout[j] = y;
+		}
+		pz1 = pz2 + n;
+		px  = pout;
+	}
+	return;
+}
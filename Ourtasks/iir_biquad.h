@@ -0,0 +1,76 @@
+/******************************************************************************
+* File Name          : iir_biquad.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : IIR filter: cascaded biquads (DF2T), float, multi-lane
+*******************************************************************************/
+/*
+A "bank" is one low pass filter spec (BIQUADSPEC) run on 'nlane'
+independent inputs (lanes), e.g. several ADC channels with the same spec and
+rate.  Coefficients are shared; the state is laid out section by section,
+lanes contiguous, so each section's coefficients are loaded once per pass
+and the inner loop walks the lanes.
+
+The coefficients are made at build time by Host/iirgen.c (iir_coef.h),
+which also checks each spec's response: no trig on the target.
+Order 2: one section with the Q given.
+Order 4, 6, 8: Butterworth; the section Q's come from the pole angles and
+the Q given is not used.
+
+Section (Direct Form II Transposed)--
+  y  = b0*x + z1
+  z1 = b1*x - a1*y + z2
+  z2 = b2*x - a2*y
+*/
+
+#ifndef __IIR_BIQUAD
+#define __IIR_BIQUAD
+
+#include <stdint.h>
+
+#define BIQUADMAXSECT 4  // Max sections (order 8)
+
+/* One section's coefficients (a0 = 1). */
+struct BIQUADCOEF
+{
+	float b0;
+	float b1;
+	float b2;
+	float a1;
+	float a2;
+};
+
+/* A low pass cascade (e.g. &iirspec[IIRSPEC_xxx].u.bq) */
+struct BIQUADSPEC
+{
+	struct BIQUADCOEF sect[BIQUADMAXSECT];
+	uint8_t nsect;    // Number of sections (order / 2)
+};
+
+/* With this struct one pointer will convey everything necessary. */
+struct BIQUADBANK
+{
+	struct BIQUADCOEF sect[BIQUADMAXSECT]; // Coefficients, shared by all lanes
+	float* pz;        // State: per section, z1[nlane] then z2[nlane]
+	uint8_t nsect;    // Number of sections
+	uint8_t nlane;    // Number of lanes
+	uint16_t skipctr; // Number of initial readings to not filter
+};
+
+/* *************************************************************************/
+int iir_biquad_init(struct BIQUADBANK* pbank, const struct BIQUADSPEC* ps, uint8_t nlane, uint16_t skipct);
+/* @brief	: Load coefficients for a low pass cascade; get state memory
+ * @param	: pbank = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: ps = Pointer to coefficients
+ * @param	: nlane = number of inputs run together
+ * @param	: skipct = Number of initial readings to not filter
+ * @return	: 0 = OK; -1 = bad section or lane count; -2 = calloc failed
+ * NOTE: 'pz' must be NULL or from a previous init (it is freed: re-init OK)
+ * *************************************************************************/
+void iir_biquad_run(struct BIQUADBANK* pbank, float* pin, float* pout);
+/* @brief	: Filter one new value for every lane
+ * @param	: pbank = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: pin  = Pointer to inputs, one per lane
+ * @param	: pout = Pointer to outputs, one per lane (may be the same as pin)
+ * *************************************************************************/
+#endif
@@ -0,0 +1,119 @@
+/******************************************************************************
+* File Name          : iir_biquad_q.c
+* Date First Issued  : 10/18/2026
+* Board              : DiscoveryF4
+* Description        : IIR filter: cascaded biquads (DF1), fixed point, one lane
+*******************************************************************************/
+
+#include <stdlib.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iir_biquad_q.h"
+
+/* Largest past output: the int32 input range, 29 fraction bits below it */
+#define YQMAX ((int64_t)INT32_MAX * ((int64_t)1 << BIQUADQFRAC))
+#define YQMIN ((int64_t)INT32_MIN * ((int64_t)1 << BIQUADQFRAC))
+
+/* Float coefficient to Q29, rounded */
+static int32_t coefq(float c)
+{
+	double d = (double)c * (double)(1 << BIQUADQFRAC);
+	return (int32_t)((d < 0) ? (d - 0.5) : (d + 0.5));
+}
+static float absf(float c)
+{
+	return (c < 0) ? -c : c;
+}
+/* *************************************************************************
+ * int iir_biquad_q_init(struct FILTERBIQUADQ* pbq, const struct BIQUADSPEC* ps, uint16_t skipct);
+ * @brief	: Q29 coefficients from a low pass cascade; get state memory
+ * @param	: pbq = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: ps = Pointer to (float) coefficients
+ * @param	: skipct = Number of initial readings to not filter
+ * @return	: 0 = OK; -1 = bad section count, or coefficients too large; -2 = calloc failed
+ * NOTE: 'pz' must be NULL or from a previous init (it is freed: re-init OK)
+ * *************************************************************************/
+int iir_biquad_q_init(struct FILTERBIQUADQ* pbq, const struct BIQUADSPEC* ps, uint16_t skipct)
+{
+	const struct BIQUADCOEF* pf;
+	struct BIQUADCOEFQ* pc;
+	int i;
+
+	if ((ps->nsect < 1) || (ps->nsect > BIQUADMAXSECT)) return -1;
+
+	for (i = 0; i < ps->nsect; i++)
+	{
+		pf = &ps->sect[i];
+		if ((absf(pf->b0) + absf(pf->b1) + absf(pf->b2) +
+		     absf(pf->a1) + absf(pf->a2)) >= 4.0f) return -1;
+	}
+
+	pbq->nsect   = ps->nsect;
+	pbq->skipctr = skipct;
+	for (i = 0; i < pbq->nsect; i++)
+	{
+		pf = &ps->sect[i];
+		pc = &pbq->sect[i];
+		pc->b0 = coefq(pf->b0);
+		pc->b2 = coefq(pf->b2);
+		pc->a1 = coefq(pf->a1);
+		pc->a2 = coefq(pf->a2);
+		/* b1 takes the rounding: dc gain exactly 1. */
+		pc->b1 = (1 << BIQUADQFRAC) + pc->a1 + pc->a2 - pc->b0 - pc->b2;
+	}
+
+taskENTER_CRITICAL();
+	free(pbq->pz);
+	pbq->pz = (struct BIQUADSTATEQ*)calloc(pbq->nsect, sizeof(struct BIQUADSTATEQ));
+taskEXIT_CRITICAL();
+	if (pbq->pz == NULL) return -2;
+	return 0;
+}
+/* (a * y) >> 29, 32 x 64 bits: y = hi * 2^32 + lo */
+static int64_t mul_q29(int32_t a, int64_t y)
+{
+	return ((int64_t)a * (int32_t)(y >> 32)) * (1 << (32 - BIQUADQFRAC)) +
+	       (((int64_t)a * (uint32_t)y) >> BIQUADQFRAC);
+}
+/* *************************************************************************
+ * int32_t iir_biquad_q_q(struct FILTERBIQUADQ* pbq, int32_t x);
+ * @brief	: filter input value
+ * @param	: pbq = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter (fixed point, any format)
+ * @param	: filter output, given new input (same format)
+ * *************************************************************************/
+int32_t iir_biquad_q_q(struct FILTERBIQUADQ* pbq, int32_t x)
+{
+	struct BIQUADCOEFQ* pc = &pbq->sect[0];
+	struct BIQUADSTATEQ* pz = pbq->pz;
+	int64_t acc;
+	int i;
+
+	if (pbq->skipctr > 0)
+	{ // Here, skip starting filter until a few readings.
+		pbq->skipctr -= 1;
+		/* Load the state that a steady input would leave (unity dc gain). */
+		for (i = 0; i < pbq->nsect; i++, pz++)
+		{
+			pz->x1 = x;
+			pz->x2 = x;
+			pz->y1 = (int64_t)x * ((int64_t)1 << BIQUADQFRAC);
+			pz->y2 = pz->y1;
+		}
+		return x;
+	}
+
+	for (i = 0; i < pbq->nsect; i++, pc++, pz++)
+	{
+		acc  = (int64_t)pc->b0 * x + (int64_t)pc->b1 * pz->x1 + (int64_t)pc->b2 * pz->x2;
+		acc -= mul_q29(pc->a1, pz->y1) + mul_q29(pc->a2, pz->y2);
+		if (acc > YQMAX) acc = YQMAX;
+		if (acc < YQMIN) acc = YQMIN;
+		pz->x2 = pz->x1;
+		pz->x1 = x;
+		pz->y2 = pz->y1;
+		pz->y1 = acc;
+		x = (int32_t)((acc + (1 << (BIQUADQFRAC - 1))) >> BIQUADQFRAC); // Next section input
+	}
+	return x;
+}
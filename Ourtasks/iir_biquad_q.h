@@ -0,0 +1,80 @@
+/******************************************************************************
+* File Name          : iir_biquad_q.h
+* Date First Issued  : 10/18/2026
+* Board              : DiscoveryF4
+* Description        : IIR filter: cascaded biquads (DF1), fixed point, one lane
+*******************************************************************************/
+/*
+Same low pass specs as iir_biquad (iir_coef.h), integer only, for the _Q
+calibtypes.  Input and output are the same fixed-point format (any 'qfrac').
+
+Coefficients are Q29 (a1 and b1 reach 2.0).  The float coefficients are
+converted at init, and b1 takes the rounding so that the dc gain,
+(b0+b1+b2)/(1+a1+a2), is exactly 1: a steady input comes out unchanged.
+The specs are low pass, unity dc gain (the same assumption as the
+start-up state, below).
+
+Section (Direct Form I)--
+  y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+The past inputs x1, x2 are int32; the past outputs y1, y2 are int64 with
+29 fraction bits below the input format (as iir_q1 keeps 31), so narrow
+filters, whose poles are near 1, do not stall or limit cycle on the
+rounding.  a*y is 32 x 64 bits, done as two 32 x 32 multiplies.
+
+init refuses a section with |b0|+|b1|+|b2|+|a1|+|a2| >= 4: then no sum
+can overflow 64 bits.  A section output is held to the int32 range (a
+section with Q > 0.707 overshoots its input).
+*/
+
+#ifndef __IIR_BIQUAD_Q
+#define __IIR_BIQUAD_Q
+
+#include <stdint.h>
+#include "iir_biquad.h"
+
+#define BIQUADQFRAC 29 // Coefficient fraction bits
+
+/* One section's coefficients (a0 = 1): Q29 */
+struct BIQUADCOEFQ
+{
+	int32_t b0;
+	int32_t b1;
+	int32_t b2;
+	int32_t a1;
+	int32_t a2;
+};
+
+/* One section's state */
+struct BIQUADSTATEQ
+{
+	int32_t x1;       // Past inputs: input format
+	int32_t x2;
+	int64_t y1;       // Past outputs: 29 fraction bits below the input format
+	int64_t y2;
+};
+
+/* With this struct one pointer will convey everything necessary. */
+struct FILTERBIQUADQ
+{
+	struct BIQUADCOEFQ sect[BIQUADMAXSECT]; // Coefficients
+	struct BIQUADSTATEQ* pz; // State: one per section
+	uint8_t nsect;    // Number of sections
+	uint16_t skipctr; // Number of initial readings to not filter
+};
+
+/* *************************************************************************/
+int iir_biquad_q_init(struct FILTERBIQUADQ* pbq, const struct BIQUADSPEC* ps, uint16_t skipct);
+/* @brief	: Q29 coefficients from a low pass cascade; get state memory
+ * @param	: pbq = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: ps = Pointer to (float) coefficients
+ * @param	: skipct = Number of initial readings to not filter
+ * @return	: 0 = OK; -1 = bad section count, or coefficients too large; -2 = calloc failed
+ * NOTE: 'pz' must be NULL or from a previous init (it is freed: re-init OK)
+ * *************************************************************************/
+int32_t iir_biquad_q_q(struct FILTERBIQUADQ* pbq, int32_t x);
+/* @brief	: filter input value
+ * @param	: pbq = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter (fixed point, any format)
+ * @param	: filter output, given new input (same format)
+ * *************************************************************************/
+#endif
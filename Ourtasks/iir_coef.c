@@ -0,0 +1,97 @@
+/******************************************************************************
+* File Name          : iir_coef.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : IIR coefficient tables (iir_spec.h)
+*******************************************************************************/
+/* Generated by Host/iirgen.c: edit the specs there, then 'make iirtables'. */
+
+#include "iir_coef.h"
+
+/* F2TEST: DefaultTask iir_f2 step printout
+   IIR2 order 2, fc 50.000 Hz at 1000.000 Hz (0.050000), Q 0.7070
+   dc gain 1.0000000; -2.80 dB at fc; step overshoot 4.6%, within 1% after 20 samples */
+
+/* ADCLP4: ADC channels: 4th order Butterworth
+   BIQUAD order 4, fc 40.000 Hz at 858.966 Hz (0.046568)
+   dc gain 1.0000000; -3.01 dB at fc; step overshoot 11.0%, within 1% after 36 samples */
+
+/* ADCLP2: Slow ADC channels (decim 16): no overshoot
+   BIQUAD order 2, fc 2.000 Hz at 53.685 Hz (0.037254), Q 0.5000
+   dc gain 1.0000000; -6.02 dB at fc; step overshoot 0.0%, within 1% after 28 samples */
+
+/* ADCF1: ADC channels: one pole (iir_f1, iir_q1)
+   IIR1 order 1, fc 5.000 Hz at 858.966 Hz (0.005821)
+   dc gain 1.0000000; -3.01 dB at fc; step overshoot 0.0%, within 1% after 125 samples */
+
+const struct IIRSPEC iirspec[IIRSPECNUM] =
+{
+	{ /* F2TEST */
+		.u.f2 = {-1.560975790e+00f, -6.413070560e-01f, 8.033128828e-02f},
+		.fc = 5.000000000e-02f, .q = 7.070000000e-01f, .type = IIRSPECTYPE_F2, .order = 2
+	},
+	{ /* ADCLP4 */
+		.u.bq = {{
+			{1.677912474e-02f, 3.355824947e-02f, 1.677912474e-02f, -1.512063503e+00f, 5.791800022e-01f},
+			{1.913797855e-02f, 3.827595711e-02f, 1.913797855e-02f, -1.724633813e+00f, 8.011857271e-01f},
+			}, 2},
+		.fc = 4.656761905e-02f, .q = 7.071000000e-01f, .type = IIRSPECTYPE_BQ, .order = 4
+	},
+	{ /* ADCLP2 */
+		.u.bq = {{
+			{1.106812060e-02f, 2.213624120e-02f, 1.106812060e-02f, -1.579179645e+00f, 6.234521270e-01f},
+			}, 1},
+		.fc = 3.725409524e-02f, .q = 5.000000000e-01f, .type = IIRSPECTYPE_BQ, .order = 2
+	},
+	{ /* ADCF1 */
+		.u.f1coef = 9.640905857e-01f,
+		.fc = 5.820952381e-03f, .q = 0.000000000e+00f, .type = IIRSPECTYPE_F1, .order = 1
+	},
+};
+
+/* Response (float coefficients): not used by the firmware; 'host_main i' checks the filters against it. */
+const float iirrespf[IIRRESPNF] =
+{
+	8.891397050e-05f, 1.581138830e-04f, 2.811706626e-04f, 5.000000000e-04f, 8.891397050e-04f, 1.581138830e-03f, 2.811706626e-03f, 5.000000000e-03f,
+	8.891397050e-03f, 1.581138830e-02f, 2.811706626e-02f, 5.000000000e-02f, 8.891397050e-02f, 1.581138830e-01f, 2.811706626e-01f, 5.000000000e-01f,
+};
+
+const struct IIRRESP iirresp[IIRSPECNUM] =
+{
+	{ /* F2TEST */
+		{0.000f, 0.000f, 0.000f, 0.000f, 0.000f, 0.000f, 0.001f, 0.002f,
+		 0.002f, -0.021f, -0.338f, -2.796f, -10.017f, -19.168f, -27.537f, -32.011f,},
+		{8.033128828e-02f, 3.499483168e-01f, 6.280565858e-01f, 8.381155133e-01f, 9.661512375e-01f, 1.027516484e+00f, 1.045675993e+00f, 1.041394711e+00f,
+		 1.028985381e+00f, 1.016425490e+00f, 1.007034540e+00f, 1.001362681e+00f, 9.986794591e-01f, 9.979156256e-01f, 9.981377125e-01f, 9.987080693e-01f,
+		 9.992750287e-01f, 9.996947050e-01f, 9.999458194e-01f, 1.000063062e+00f, 1.000095010e+00f, 1.000083804e+00f, 1.000057578e+00f, 1.000031948e+00f,
+		 1.000013232e+00f, 1.000002146e+00f, 9.999970198e-01f, 9.999957085e-01f, 9.999962449e-01f, 9.999974370e-01f, 9.999986291e-01f, 9.999994636e-01f,},
+		4.567600e-02f, 2, 20
+	},
+	{ /* ADCLP4 */
+		{0.000f, 0.000f, 0.000f, 0.000f, 0.000f, 0.000f, 0.000f, 0.000f,
+		 -0.000f, -0.001f, -0.073f, -4.444f, -23.163f, -45.256f, -73.381f, -200.000f,},
+		{3.211185394e-04f, 2.997514978e-02f, 1.894555688e-01f, 4.879246056e-01f, 8.078157902e-01f, 1.028472781e+00f, 1.109341502e+00f, 1.087329984e+00f,
+		 1.028441072e+00f, 9.831107855e-01f, 9.690194726e-01f, 9.784088731e-01f, 9.948084354e-01f, 1.006058574e+00f, 1.008663058e+00f, 1.005423665e+00f,
+		 1.000887752e+00f, 9.980854988e-01f, 9.976588488e-01f, 9.986796975e-01f, 9.999041557e-01f, 1.000584602e+00f, 1.000624657e+00f, 1.000314355e+00f,
+		 9.999881387e-01f, 9.998266697e-01f, 9.998354912e-01f, 9.999271631e-01f, 1.000012875e+00f, 1.000050187e+00f, 1.000042796e+00f, 1.000016332e+00f,},
+		1.102519e-01f, 3, 36
+	},
+	{ /* ADCLP2 */
+		{-0.000f, -0.000f, -0.000f, -0.002f, -0.005f, -0.015f, -0.049f, -0.154f,
+		 -0.477f, -1.429f, -3.903f, -8.989f, -16.842f, -26.949f, -40.692f, -200.000f,},
+		{1.106812060e-02f, 1.174094602e-01f, 2.838847041e-01f, 4.501292706e-01f, 5.927126408e-01f, 7.058823705e-01f, 7.915731072e-01f, 8.544329405e-01f,
+		 8.995058537e-01f, 9.312742352e-01f, 9.533669353e-01f, 9.685661793e-01f, 9.789310098e-01f, 9.859470725e-01f, 9.906666875e-01f, 9.938245416e-01f,
+		 9.959275723e-01f, 9.973224401e-01f, 9.982442260e-01f, 9.988514781e-01f, 9.992503524e-01f, 9.995117188e-01f, 9.996825457e-01f, 9.997939467e-01f,
+		 9.998664260e-01f, 9.999135733e-01f, 9.999441504e-01f, 9.999639392e-01f, 9.999767542e-01f, 9.999850392e-01f, 9.999903440e-01f, 9.999938011e-01f,},
+		0.000000e+00f, 2, 28
+	},
+	{ /* ADCF1 */
+		{-0.001f, -0.003f, -0.010f, -0.032f, -0.100f, -0.309f, -0.911f, -2.400f,
+		 -5.228f, -9.229f, -13.851f, -18.703f, -23.586f, -28.326f, -32.522f, -34.759f,},
+		{3.590941429e-02f, 3.062892556e-01f, 5.008409023e-01f, 6.408303976e-01f, 7.415597439e-01f, 8.140394688e-01f, 8.661922216e-01f, 9.037187099e-01f,
+		 9.307208657e-01f, 9.501502514e-01f, 9.641306400e-01f, 9.741902351e-01f, 9.814286232e-01f, 9.866369367e-01f, 9.903846383e-01f, 9.930812716e-01f,
+		 9.950216413e-01f, 9.964178205e-01f, 9.974224567e-01f, 9.981453419e-01f, 9.986654520e-01f, 9.990397096e-01f, 9.993090630e-01f, 9.995028377e-01f,
+		 9.996422529e-01f, 9.997425675e-01f, 9.998147488e-01f, 9.998667240e-01f, 9.999040961e-01f, 9.999309778e-01f, 9.999503493e-01f, 9.999642968e-01f,},
+		0.000000e+00f, 9, 125
+	},
+};
@@ -0,0 +1,25 @@
+/******************************************************************************
+* File Name          : iir_coef.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : IIR coefficient tables (iir_spec.h)
+*******************************************************************************/
+/* Generated by Host/iirgen.c: edit the specs there, then 'make iirtables'. */
+
+#ifndef __IIR_COEF
+#define __IIR_COEF
+
+#include "iir_spec.h"
+
+/* Codes for 'fpw.iir2.spec' and index into iirspec[], iirresp[] */
+#define IIRSPEC_F2TEST   0 // DefaultTask iir_f2 step printout
+#define IIRSPEC_ADCLP4   1 // ADC channels: 4th order Butterworth
+#define IIRSPEC_ADCLP2   2 // Slow ADC channels (decim 16): no overshoot
+#define IIRSPEC_ADCF1    3 // ADC channels: one pole (iir_f1, iir_q1)
+#define IIRSPECNUM 4
+
+extern const struct IIRSPEC iirspec[IIRSPECNUM];
+extern const struct IIRRESP iirresp[IIRSPECNUM];
+extern const float iirrespf[IIRRESPNF];
+
+#endif
@@ -6,23 +6,19 @@
 *******************************************************************************/
 
 #include "iir_f2.h"
-#include <math.h>
 
 /* *************************************************************************
- * void iir_f2_coefficients(struct FILTERIIRF2* pfc, float Fc, float Q, uint16_t skipct);
- * @brief	: Compute coefficients for Butterworth 2nd order IIR
+ * void iir_f2_init(struct FILTERIIRF2* pfc, const struct IIRF2SPEC* ps, uint16_t skipct);
+ * @brief	: Load coefficients (e.g. &iirspec[IIRSPEC_xxx].u.f2) and zero the state
  * @param	: pfc = Pointer to struct holding fixed parameters and intermediate variables
- * @param	: Fc = cutoff freq as ratio, e.g. 0.1
- * @param	: Q = e.g. .707
+ * @param	: ps = Pointer to coefficients
  * @param	: skipct = Number of initial readings to not filter
  * *************************************************************************/
-void iir_f2_coefficients(struct FILTERIIRF2* pfc, float Fc, float Q, uint16_t skipct)
+void iir_f2_init(struct FILTERIIRF2* pfc, const struct IIRF2SPEC* ps, uint16_t skipct)
 {
-	float K    = tanf(Fc * 3.14159265);
-	float norm = 1 / (1 + K / Q + K * K);
-   pfc->b1    = 2 * (K * K - 1) * norm;
-   pfc->b2    = -(1 - K / Q + K * K) * norm;
-	pfc->gain  = 4 * (K * K * norm);
+	pfc->b1    = ps->b1;
+	pfc->b2    = ps->b2;
+	pfc->gain  = ps->gain;
 	pfc->z1    = 0;
 	pfc->z2    = 0;
 	pfc->skipctr = skipct; // Number of initial readings to not filter
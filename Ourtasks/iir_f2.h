@@ -10,6 +10,14 @@
 
 #include <stdint.h>
 
+/* Coefficients: made at build time (Host/iirgen.c, iir_coef.h) */
+struct IIRF2SPEC
+{
+	float b1;      // coefficient 1
+	float b2;      // coefficient 2
+	float gain;    // gain scale factor
+};
+
 /* With this struct one pointer will convey everything necessary. */
 struct FILTERIIRF2
 {
@@ -41,11 +49,10 @@ float iir_f2_32b(struct FILTERIIRF2* pfc, uint32_t val);
  * @param	: val = 32b new value input to filter
  * @param	: filter output, given new input
  * *************************************************************************/
-void iir_f2_coefficients(struct FILTERIIRF2* pfc, float Fc, float Q, uint16_t skipct);
-/* @brief	: Compute coefficients for Butterworth 2nd order IIR
+void iir_f2_init(struct FILTERIIRF2* pfc, const struct IIRF2SPEC* ps, uint16_t skipct);
+/* @brief	: Load coefficients (e.g. &iirspec[IIRSPEC_xxx].u.f2) and zero the state
  * @param	: pfc = Pointer to struct holding fixed parameters and intermediate variables
- * @param	: Fc = cutoff freq as ratio, e.g. 0.1
- * @param	: Q = e.g. .707
+ * @param	: ps = Pointer to coefficients
  * @param	: skipct = Number of initial readings to not filter
  * *************************************************************************/
 #endif
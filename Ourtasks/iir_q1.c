@@ -0,0 +1,29 @@
+/******************************************************************************
+* File Name          : iir_q1.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : IIR filter: single pole, fixed point
+*******************************************************************************/
+
+#include "iir_q1.h"
+
+/* *************************************************************************
+ * int32_t iir_q1_q(struct FILTERIIRQ1* pfc, int32_t x);
+ * @brief	: filter input value 
+ * @param	: pfc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter (fixed point, any format)
+ * @param	: filter output, given new input (same format)
+ * *************************************************************************/
+int32_t iir_q1_q(struct FILTERIIRQ1* pfc, int32_t x)
+{
+	if (pfc->skipctr > 0)
+	{ // Here, skip starting filter until a few readings
+		pfc->skipctr -= 1;
+		pfc->z1 = (int64_t)x * ((int64_t)1 << 31);
+	}
+	else
+	{ // y += (1 - coef) * (x - y)
+		pfc->z1 += (int64_t)(x - (int32_t)(pfc->z1 >> 31)) * pfc->onemcoef;
+	}
+	return (int32_t)(pfc->z1 >> 31);
+}
@@ -0,0 +1,37 @@
+/******************************************************************************
+* File Name          : iir_q1.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : IIR filter: single pole, fixed point
+*******************************************************************************/
+/*
+Same response as iir_f1 (y = coef*y + (1-coef)*x), integer only.
+The state carries 31 fraction bits below the input format, so slow filters
+(coef near 1.0) do not stall short of the input.  Input and output are the
+same fixed-point format; |input| must stay below 2^30.
+*/
+
+#ifndef __IIR_Q1
+#define __IIR_Q1
+
+#include <stdint.h>
+
+/* Float coefficient (0 < x < 1.0) to Q31. */
+#define IIR_Q1_COEF(x) ((int32_t)((x) * 2147483648.0))
+
+/* With this struct one pointer will convey everything necessary. */
+struct FILTERIIRQ1
+{
+	int64_t z1;       // Output, Q31 below the input format
+	int32_t onemcoef; // 1 - coef: Q31
+	uint16_t skipctr; // Number of initial readings to not filter
+};
+
+/* *************************************************************************/
+int32_t iir_q1_q(struct FILTERIIRQ1* pfc, int32_t x);
+/* @brief	: filter input value 
+ * @param	: pfc = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter (fixed point, any format)
+ * @param	: filter output, given new input (same format)
+ * *************************************************************************/
+#endif
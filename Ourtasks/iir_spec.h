@@ -0,0 +1,63 @@
+/******************************************************************************
+* File Name          : iir_spec.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : IIR filter specs with build-time coefficients (iir_coef.c)
+*******************************************************************************/
+/*
+Host/iirgen.c designs each IIR filter from its spec (type, order, fc, Q,
+sample rate) on the workstation and writes the coefficients as iirspec[],
+indexed by the IIRSPEC_ codes in iir_coef.h, so nothing on the target
+calls tanf/cosf to set up a filter--
+	iir_f2_init(&filt, &iirspec[IIRSPEC_F2TEST].u.f2, 0);
+	pacs->fpw.iir2.spec = IIRSPEC_ADCLP4; // ADCFILTERTYPE_IIR2 (type _BQ)
+
+iirresp[] has each filter's response as iirgen.c computed it with the
+float coefficients: gain at the iirrespf[] frequencies and the step
+response.  iirgen.c fails the build when a filter is unstable, its dc
+gain is not 1, its gain at fc is not the design's, fc is not below half
+the sample rate, or the step response does not settle at 1.  The firmware
+does not reference iirresp[] (the linker drops it); 'host_main i' runs the
+filter code against it.
+
+fc, iirrespf[]: ratio of the filter's sample rate, e.g. 0.05.
+*/
+
+#ifndef __IIR_SPEC
+#define __IIR_SPEC
+
+#include <stdint.h>
+#include "iir_f2.h"
+#include "iir_biquad.h"
+
+/* 'type' */
+#define IIRSPECTYPE_F1 1 // One pole (iir_f1 'coef'; iir_q1 IIR_Q1_COEF(1 - coef)): 'u.f1coef'
+#define IIRSPECTYPE_F2 2 // Two pole, no zeros (iir_f2): 'u.f2'
+#define IIRSPECTYPE_BQ 3 // Low pass biquad cascade (iir_biquad): 'u.bq'
+
+struct IIRSPEC
+{
+	union
+	{
+		float f1coef;          // _F1: y = coef*y + (1 - coef)*x
+		struct IIRF2SPEC f2;   // _F2
+		struct BIQUADSPEC bq;  // _BQ
+	}u;
+	float fc;       // Cutoff freq (-3 dB; order 2: gain Q) as ratio of the sample rate
+	float q;        // Q (order 2); 0.7071 for Butterworth
+	uint8_t type;   // IIRSPECTYPE_
+	uint8_t order;  // 1 (_F1), 2 (_F2), 2 - 8 even (_BQ)
+};
+
+#define IIRRESPNF    16 // Gain points: iirrespf[]
+#define IIRRESPNSTEP 32 // Step response points
+struct IIRRESP
+{
+	float db[IIRRESPNF];         // Gain (dB) at iirrespf[]
+	float step[IIRRESPNSTEP];    // Step response at samples 0, dt, 2*dt, ...
+	float overshoot;             // Step response peak - 1 (0 = none)
+	uint16_t dt;                 // Samples between step[] points
+	uint16_t settle;             // Samples for the step to stay within 1% of 1 (step[] goes to 2x)
+};
+
+#endif
@@ -0,0 +1,178 @@
+/******************************************************************************
+* File Name          : median_f.c
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Sliding median and Hampel (spike rejection) filter, float
+*******************************************************************************/
+/*
+Window layout (see median_f.h): 'pv' the inputs in arrival order (a ring,
+oldest at 'idx'), 'ps' the same values in ascending order.  The window is
+always full (primed).
+*/
+#include <stdlib.h>
+#include <math.h>
+#include "stm32f4xx_hal.h"
+#include "MailboxTask.h"
+#include "median_f.h"
+
+#define MADSIGMA 1.4826f // MAD -> standard deviation, normal distribution
+
+/* *************************************************************************
+ * static int mw_init(struct MEDIANFWIN* pw, int n);
+ * @brief	: Window memory: ring and sorted values (one calloc)
+ * @return	: 0 = OK; -2 = calloc failed
+ * *************************************************************************/
+static int mw_init(struct MEDIANFWIN* pw, int n)
+{
+taskENTER_CRITICAL();
+	free(pw->pv);
+	pw->pv = (float*)calloc(2 * n, sizeof(float));
+taskEXIT_CRITICAL();
+	if (pw->pv == NULL) return -2;
+	pw->ps  = pw->pv + n;
+	pw->idx = 0;
+	return 0;
+}
+/* *************************************************************************
+ * static void mw_fill(struct MEDIANFWIN* pw, int n, float x);
+ * @brief	: Every value 'x'
+ * *************************************************************************/
+static void mw_fill(struct MEDIANFWIN* pw, int n, float x)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+	{
+		pw->pv[i] = x;
+		pw->ps[i] = x;
+	}
+	pw->idx = 0;
+	return;
+}
+/* *************************************************************************
+ * static float mw_insert(struct MEDIANFWIN* pw, int n, int h, float x);
+ * @brief	: Replace the oldest value with 'x'; keep the sorted values sorted
+ * @return	: median
+ * *************************************************************************/
+static float mw_insert(struct MEDIANFWIN* pw, int n, int h, float x)
+{
+	float* ps = pw->ps;
+	float old = pw->pv[pw->idx];
+	int lo = 0;
+	int hi = n - 1;
+	int i;
+
+	pw->pv[pw->idx] = x;
+	pw->idx = (pw->idx + 1 == n) ? 0 : pw->idx + 1;
+
+	/* Oldest value's place (binary search: any equal value will do). */
+	while (lo < hi)
+	{
+		i = (lo + hi) / 2;
+		if (ps[i] < old) lo = i + 1;
+		else hi = i;
+	}
+
+	/* Shift the values between it and the new value's place by one. */
+	i = lo;
+	if (old < x)
+	{
+		for (; (i < n - 1) && (ps[i + 1] < x); i++) ps[i] = ps[i + 1];
+	}
+	else
+	{
+		for (; (i > 0) && (x < ps[i - 1]); i--) ps[i] = ps[i - 1];
+	}
+	ps[i] = x;
+	return ps[h];
+}
+/* *************************************************************************
+ * int median_f_init(struct FILTERMEDF* pm, uint8_t n, float t, float dmin);
+ * @brief	: Set window and threshold; get window memory
+ * @param	: pm = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: n = window length: odd, 3 - MEDIANFMAX
+ * @param	: t = Hampel threshold in MADs (e.g. 3.0); 0 = plain median
+ * @param	: dmin = Hampel smallest threshold (input units)
+ * @return	: 0 = OK; -1 = bad 'n'; -2 = calloc failed
+ * NOTE: 'v.pv' and 'd.pv' must be NULL or from a previous init (freed: re-init OK)
+ * *************************************************************************/
+int median_f_init(struct FILTERMEDF* pm, uint8_t n, float t, float dmin)
+{
+	if ((n < 3) || (n > MEDIANFMAX) || ((n & 1) == 0)) return -1;
+
+	pm->n     = n;
+	pm->h     = (n - 1) / 2;
+	pm->t     = t * MADSIGMA;
+	pm->dmin  = dmin;
+	pm->nrej  = 0;
+	pm->prime = 1;
+
+	if (mw_init(&pm->v, n) != 0) return -2;
+	if (t > 0)
+	{
+		if (mw_init(&pm->d, n) != 0) return -2;
+	}
+	return 0;
+}
+/* *************************************************************************
+ * float median_f_f(struct FILTERMEDF* pm, float x);
+ * @brief	: Filter one new value
+ * @param	: pm = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter
+ * @return	: median, or Hampel output ((n-1)/2 inputs behind)
+ * *************************************************************************/
+float median_f_f(struct FILTERMEDF* pm, float x)
+{
+	float m;
+	float mad;
+	float xc;
+	float thr;
+	int i;
+
+	if (pm->prime != 0)
+	{ // First input: as if it had always been there
+		pm->prime = 0;
+		mw_fill(&pm->v, pm->n, x);
+		if (pm->t > 0) mw_fill(&pm->d, pm->n, 0);
+	}
+
+	m = mw_insert(&pm->v, pm->n, pm->h, x);
+	if (pm->t <= 0) return m;
+
+	/* Hampel: middle of the window, unless it is too far from the median. */
+	mad = mw_insert(&pm->d, pm->n, pm->h, fabsf(x - m));
+	i = pm->v.idx + pm->h; // Oldest + h = h inputs back from the newest
+	if (i >= pm->n) i -= pm->n;
+	xc = pm->v.pv[i];
+
+	thr = pm->t * mad;
+	if (thr < pm->dmin) thr = pm->dmin;
+	if (fabsf(xc - m) <= thr) return xc;
+	pm->nrej += 1;
+	return m;
+}
+/* *************************************************************************
+ * void median_f_mbx(struct MAILBOXCAN* pmbx, void* parg);
+ * @brief	: Mailbox post-processor: filter one value of the mailbox in place
+ * @param	: pmbx = pointer to mailbox (new reading just extracted)
+ * @param	: parg = pointer to struct MEDIANFMBX
+ * *************************************************************************/
+void median_f_mbx(struct MAILBOXCAN* pmbx, void* parg)
+{
+	struct MEDIANFMBX* p = (struct MEDIANFMBX*)parg;
+	union MAILBOXVALUES* pu = &pmbx->mbx.u;
+
+	switch (p->type)
+	{
+	case MEDIANFMBX_F:
+		pu->f[p->lane] = median_f_f(&p->med, pu->f[p->lane]);
+		break;
+	case MEDIANFMBX_S32:
+		pu->s32[p->lane] = lrintf(median_f_f(&p->med, (float)pu->s32[p->lane]));
+		break;
+	case MEDIANFMBX_S16:
+		pu->s16[p->lane] = lrintf(median_f_f(&p->med, (float)pu->s16[p->lane]));
+		break;
+	}
+	return;
+}
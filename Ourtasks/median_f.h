@@ -0,0 +1,102 @@
+/******************************************************************************
+* File Name          : median_f.h
+* Date First Issued  : 10/17/2026
+* Board              : DiscoveryF4
+* Description        : Sliding median and Hampel (spike rejection) filter, float
+*******************************************************************************/
+/*
+Median of the last 'n' inputs ('n' odd, 3 - MEDIANFMAX).
+
+The window is held twice: the inputs in arrival order (a ring) and the same
+values sorted.  Each new input overwrites the oldest value in the ring; in
+the sorted values the oldest is found by binary search and the values
+between its place and the new value's place move over by one.  That is
+O(n) per input, but for windows up to MEDIANFMAX it is a short run of
+loads and stores with no index bookkeeping: faster than a two-heap median
+(O(log n), with a position table updated on every compare-exchange).
+
+Hampel ('t' > 0): the output is the value at the middle of the window
+unless it is more than t * 1.4826 * MAD from the median, in which case the
+median replaces it (counted in 'nrej').  So good readings pass through
+unsmoothed and single spikes (up to (n-1)/2 in a row) are removed.  MAD is
+the median of |x - median| kept in a second window, each deviation taken
+against the median when its value came in (not recomputed as the median
+moves: one more window insert, and the same as the textbook MAD while the median is
+steady).  'dmin' is the smallest threshold, for quiet (quantized) inputs
+whose MAD is 0.
+
+Either way the output is (n-1)/2 inputs behind the input.
+
+The first input fills the window (no start-up from zero).
+
+ADC channels: ADCFILTERTYPE_MEDIAN with 'fpw.med'.  Mailbox readings:
+median_f_mbx as the mailbox post-processor (MailboxTask_add_post), e.g.--
+	static struct MEDIANFMBX spdmed = {.lane = 0, .type = MEDIANFMBX_S32};
+	median_f_init(&spdmed.med, 7, 3.0f, 10.0f);
+	MailboxTask_add_post(pmbx, median_f_mbx, &spdmed);
+*/
+
+#ifndef __MEDIAN_F
+#define __MEDIAN_F
+
+#include <stdint.h>
+
+struct MAILBOXCAN; // MailboxTask.h
+
+#define MEDIANFMAX 63 // Largest window
+
+/* One window */
+struct MEDIANFWIN
+{
+	float*  pv;    // Values in arrival order, oldest at 'idx' [n]
+	float*  ps;    // Same values, ascending [n]
+	uint8_t idx;   // Oldest value (next to be replaced)
+};
+
+/* With this struct one pointer will convey everything necessary. */
+struct FILTERMEDF
+{
+	struct MEDIANFWIN v;  // Inputs
+	struct MEDIANFWIN d;  // Hampel: |input - median| (t > 0)
+	float t;        // Hampel threshold: t (MADs) * 1.4826 (0 = plain median)
+	float dmin;     // Hampel: smallest threshold (input units)
+	uint32_t nrej;  // Hampel: count of values replaced by the median
+	uint8_t n;      // Window length (odd)
+	uint8_t h;      // (n-1)/2: values each side of the median
+	uint8_t prime;  // 1 = next input fills the window
+};
+
+/* Mailbox post-processor: which value in the mailbox union to filter */
+#define MEDIANFMBX_F   0 // u.f[lane]
+#define MEDIANFMBX_S32 1 // u.s32[lane]
+#define MEDIANFMBX_S16 2 // u.s16[lane]
+struct MEDIANFMBX
+{
+	struct FILTERMEDF med; // Filter (median_f_init)
+	uint8_t lane;          // Index in the union
+	uint8_t type;          // MEDIANFMBX_
+};
+
+/* *************************************************************************/
+int median_f_init(struct FILTERMEDF* pm, uint8_t n, float t, float dmin);
+/* @brief	: Set window and threshold; get window memory
+ * @param	: pm = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: n = window length: odd, 3 - MEDIANFMAX
+ * @param	: t = Hampel threshold in MADs (e.g. 3.0); 0 = plain median
+ * @param	: dmin = Hampel smallest threshold (input units)
+ * @return	: 0 = OK; -1 = bad 'n'; -2 = calloc failed
+ * NOTE: 'v.pv' and 'd.pv' must be NULL or from a previous init (freed: re-init OK)
+ * *************************************************************************/
+float median_f_f(struct FILTERMEDF* pm, float x);
+/* @brief	: Filter one new value
+ * @param	: pm = Pointer to struct holding fixed parameters and intermediate variables
+ * @param	: x = new value input to filter
+ * @return	: median, or Hampel output ((n-1)/2 inputs behind)
+ * *************************************************************************/
+void median_f_mbx(struct MAILBOXCAN* pmbx, void* parg);
+/* @brief	: Mailbox post-processor: filter one value of the mailbox in place
+ * @param	: pmbx = pointer to mailbox (new reading just extracted)
+ * @param	: parg = pointer to struct MEDIANFMBX
+ * *************************************************************************/
+
+#endif
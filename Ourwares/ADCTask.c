@@ -12,15 +12,27 @@
 #include "ADCTask.h"
 #include "adctask.h"
 #include "morse.h"
-#include "adcfastsum16.h"
+#include "adcfastsum.h"
+#include "DTW_counter.h"
 #include "adcparams.h"
+#include "adccapture.h"
+#include "adcpower.h"
+#include "adcsnap.h"
+#include "adctiming.h"
+#include "adcfit.h"
+#include "adcflash.h"
 
 extern ADC_HandleTypeDef hadc1;
+extern struct CAN_CTLBLOCK* pctl0;	// Pointer to CAN1 control block
 
 void StartADCTask(void const * argument);
 
 osThreadId ADCTaskHandle;
 
+uint32_t adcsumdbg; // DTWTIME cycles for adcfastsum_stat of 1/2 dma buffer
+uint32_t adcchandbg;    // DTWTIME cycles for adcparams_all (all channels)
+uint32_t adcchandbgmax; // Largest adcchandbg seen
+
 /* *************************************************************************
  * osThreadId xADCTaskCreate(uint32_t taskpriority);
  * @brief	: Create task; task handle created is global for all to enjoy!
@@ -43,6 +55,8 @@ void StartADCTask(void const * argument)
 {
 	#define TSK02BIT02	(1 << 0)  // Task notification bit for ADC dma 1st 1/2 (adctask.c)
 	#define TSK02BIT03	(1 << 1)  // Task notification bit for ADC dma end (adctask.c)
+	#define TSK02BIT04	(1 << 2)  // Task notification bit for capture CAN command (adccapture.c)
+	#define TSK02BIT05	(1 << 3)  // Task notification bit for calibration fit CAN command (adcfit.c)
 
 	uint16_t* pdma;
 
@@ -56,6 +70,12 @@ void StartADCTask(void const * argument)
 	struct ADCDMATSKBLK* pblk = adctask_init(&hadc1,TSK02BIT02,TSK02BIT03,&noteval);
 	if (pblk == NULL) {morse_trap(15);}
 
+	/* Raw reading capture; CAN commands on CAN1. */
+	if (adccapture_init(pctl0, ADCCAPTURE_CANID, TSK02BIT04) != 0) morse_trap(18);
+
+	/* Calibration fit; CAN commands on CAN1. */
+	if (adcfit_init(pctl0, ADCFIT_CANID, TSK02BIT05) != 0) morse_trap(19);
+
   /* Infinite loop */
   for(;;)
   {
@@ -63,10 +83,25 @@ void StartADCTask(void const * argument)
 		xTaskNotifyWait(noteused, 0, &noteval, portMAX_DELAY);
 		noteused = 0;	// Accumulate bits in 'noteval' processed.
 
+		if (noteval & TSK02BIT04)
+		{ // Capture CAN command
+			noteused |= TSK02BIT04;
+			adccapture_cancmd();
+		}
+
+		if (noteval & TSK02BIT05)
+		{ // Calibration fit CAN command
+			noteused |= TSK02BIT05;
+			adcfit_cancmd();
+		}
+
+		if ((noteval & (TSK02BIT02 | TSK02BIT03)) == 0) continue;
+
 		/* We handled one, or both, noteval bits */
 		noteused |= (pblk->notebit1 | pblk->notebit2);
 
-		if (noteval & TSK02BIT02)
+		/* Both bits pending = overrun: adctiming picks the newer 1/2 and counts the miss. */
+		if (adctiming_begin(noteval & TSK02BIT02, noteval & TSK02BIT03) == 0)
 		{
 			pdma = adc1dmatskblk[0].pdma1;
 		}
@@ -75,14 +110,40 @@ void StartADCTask(void const * argument)
 			pdma = adc1dmatskblk[0].pdma2;
 		}
 
+		/* Raw readings to the capture ring (when armed). */
+		adccapture_put(pdma);
+
 		/* Sum the readings 1/2 of DMA buffer to an array. */
-		adcfastsum16(&adc1data.adcs1sum[0], pdma); // Fast in-line addition
+adcsumdbg = DTWTIME;
+		adcfastsum_stat(&adc1data, pdma); // Fast packed addition, plus min/max/sum of squares
+adcsumdbg = DTWTIME - adcsumdbg;
+
+		/* Parameters just written to flash go in use as a set, before this 1/2 buffer. */
+		adcflash_poll();
+
+		/* Accumulate sums for decimated channels; flag channels with a new output. */
+		adcparams_decimate(&adc1data, pdma);
 
 		/* Compute internal reference, internal temperature, 5v sensor supply for adjustments to other readings. */
 		adcparams_internal(&adcommon, &adc1data);
 
-		/* Compensate and calibrate each of the other ADC readings. */
-		adcparams_chan(ADC1IDX_RESISRPOT);  // Resistor pot.	
+		/* Compensate, calibrate, filter each of the other ADC readings that have a new output. */
+adcchandbg = DTWTIME;
+		adcparams_all(adc1data.decready);
+adcchandbg = DTWTIME - adcchandbg;
+		if (adcchandbg > adcchandbgmax) adcchandbgmax = adcchandbg;
+
+		/* Calibration points/fit (changes cal only between 1/2 buffers). */
+		adcfit_poll(adc1data.decready);
+
+		/* Power and energy from the current channels and supply. */
+		adcpower_update(&adc1data);
+
+		/* Tear-free copy of the readings for other tasks. */
+		adcsnap_publish();
+
+		/* Processing time of this 1/2 buffer. */
+		adctiming_end();
 
   }
 }
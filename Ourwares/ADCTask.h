@@ -12,7 +12,7 @@
 #include "cmsis_os.h"
 #include "stm32f4xx_hal.h"
 
-#define ADCSEQNUM 16  // Number of ADC scans in 1/2 of the DMA buffer
+#define ADCSEQNUM ADC1DMANUMSEQ  // Number of ADC scans in 1/2 of the DMA buffer (adcparams.h)
 
 /* *************************************************************************/
 osThreadId xADCTaskCreate(uint32_t taskpriority);
@@ -22,6 +22,9 @@ osThreadId xADCTaskCreate(uint32_t taskpriority);
  * *************************************************************************/
 
 extern osThreadId ADCTaskHandle;
+extern uint32_t adcsumdbg; // DTWTIME cycles for adcfastsum_stat of 1/2 dma buffer
+extern uint32_t adcchandbg;    // DTWTIME cycles for adcparams_all (all channels)
+extern uint32_t adcchandbgmax; // Largest adcchandbg seen
 
 #endif
 
@@ -7,7 +7,15 @@
 #ifndef __DTW_COUNTER
 #define __DTW_COUNTER
 
+#ifdef HOSTBUILD
+/* Host (Linux) build: no DWT.  Read the workstation cycle counter instead. */
+unsigned int DTW_counter_host(void);
+#define DTWTIME	(DTW_counter_host())	// Read host cycle counter (low 32b)
+#else
 #define DTWTIME	(*(volatile unsigned int *)0xE0001004)	// Read DTW 32b system tick counter
+#endif
+
+#define DTWTIMEHZ 168000000 // DTWTIME counts per second (sysclk)
 /******************************************************************************/
 void DTW_counter_init(void);
 /* @brief 	: Setup the DTW counter so that it can be read
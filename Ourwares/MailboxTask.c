@@ -239,6 +239,24 @@ taskENTER_CRITICAL();
 taskEXIT_CRITICAL();
 	return pmbx;
 }
+/* *************************************************************************
+ * struct MAILBOXCAN* MailboxTask_add_post(struct MAILBOXCAN* pmbx, MAILBOXPOST ppost, void* parg);
+ *	@brief	: Set (or clear) a mailbox's post-processor
+ * @param	: pmbx = pointer to mailbox (from MailboxTask_add)
+ * @param	: ppost = function called with each new reading; NULL = none
+ * @param	: parg = argument passed to 'ppost'
+ * @return	: pmbx; NULL = failed
+ * *************************************************************************/
+struct MAILBOXCAN* MailboxTask_add_post(struct MAILBOXCAN* pmbx, MAILBOXPOST ppost, void* parg)
+{
+	if (pmbx == NULL) return NULL;
+
+taskENTER_CRITICAL();
+	pmbx->ppost    = ppost;
+	pmbx->ppostarg = parg;
+taskEXIT_CRITICAL();
+	return pmbx;
+}
 
 /* *************************************************************************
  * osThreadId xMailboxTaskCreate(uint32_t taskpriority);
@@ -359,6 +377,7 @@ static struct MAILBOXCAN* loadmbx(struct MAILBOXCANNUM* pmbxnum, struct CANRCVBU
 	struct CANNOTIFYLIST* pnotetmp;	
 	struct CANNOTIFYLIST* pnotex;
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	uint32_t ctr;
 
 	/* Check if received CAN id is in the mailbox CAN id list. */
 	// 'lookup' is a straight loop; use 'lookupq' for binary search (when implemented)
@@ -367,8 +386,13 @@ static struct MAILBOXCAN* loadmbx(struct MAILBOXCANNUM* pmbxnum, struct CANRCVBU
 
 	/* Here, this CAN msg has a mailbox. */
 	// Copy CAN msg into mailbox, and extract payload
+	ctr = pmbx->ctr;
 	payload_extract(pmbx, pncan);
 
+	/* Post-process a new reading (not a short payload), before notifying. */
+	if ((pmbx->ppost != NULL) && (pmbx->ctr != ctr))
+		pmbx->ppost(pmbx, pmbx->ppostarg);
+
 	/* Execute notifications */
 	pnotetmp = pmbx->pnote; // Get ptr to head of linked list
 	if (pnotetmp == NULL) return pmbx; // CANID found, but no notifications
@@ -51,6 +51,11 @@ struct MAILBOXREADINGS
 	uint8_t pre8[4];
 };
 
+/* Post-processor: MailboxTask calls it after a new reading is extracted,
+   before the notifications (e.g. median_f_mbx) */
+struct MAILBOXCAN;
+typedef void (*MAILBOXPOST)(struct MAILBOXCAN* pmbx, void* parg);
+
 /* CAN readings mailbox */
 struct MAILBOXCAN
 {
@@ -58,6 +63,8 @@ struct MAILBOXCAN
 	struct MAILBOXREADINGS mbx;  // Readings extracted from CAN msg
 	struct CANNOTIFYLIST* pnote; // Pointer to notification block; NULL = none 
 	uint32_t ctr;                // Update counter (increment each update)
+	MAILBOXPOST ppost;           // Post-processor; NULL = none
+	void* ppostarg;              // Post-processor argument
 	uint8_t paytype;             // Code for payload type
 };
 
@@ -94,6 +101,13 @@ struct MAILBOXCAN* MailboxTask_add(struct CAN_CTLBLOCK* pctl,\
  * @param	: paytype = payload type code (see 'PAYLOAD_TYPE_INSERT.sql' in 'GliderWinchCommons/embed/svn_common/db')
  * @return	: Pointer to mailbox; NULL = failed
  * *************************************************************************/
+struct MAILBOXCAN* MailboxTask_add_post(struct MAILBOXCAN* pmbx, MAILBOXPOST ppost, void* parg);
+/*	@brief	: Set (or clear) a mailbox's post-processor
+ * @param	: pmbx = pointer to mailbox (from MailboxTask_add)
+ * @param	: ppost = function called with each new reading; NULL = none
+ * @param	: parg = argument passed to 'ppost'
+ * @return	: pmbx; NULL = failed
+ * *************************************************************************/
 osThreadId xMailboxTaskCreate(uint32_t taskpriority);
 /* @brief	: Create task; task handle created is global for all to enjoy!
  * @param	: taskpriority = Task priority (just as it says!)
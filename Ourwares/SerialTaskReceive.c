@@ -11,6 +11,7 @@
 #include "malloc.h"
 
 #include "SerialTaskReceive.h"
+#include "periphidx.h"
 
 #include "stm32f4xx_hal_usart.h"
 #include "stm32f4xx_hal_uart.h"
@@ -83,6 +84,9 @@ struct SERIALRCVBCB
 // Initial is NULL; pnext in last points to last
 static struct SERIALRCVBCB* prbhd = NULL;
 
+/* Same blocks, indexed by PERIPHIDX(uart Instance), for the callback lookups */
+static struct SERIALRCVBCB* prbtbl[PERIPHIDXSIZE];
+
 /* *************************************************************************
  * struct SERIALRCVBCB* xSerialTaskRxAdduart(\
 		UART_HandleTypeDef* phuart,\
@@ -162,6 +166,7 @@ taskENTER_CRITICAL();
 	ptmp1->phuart    = phuart;
 	ptmp1->tskhandle = xTaskGetCurrentTaskHandle();
 	ptmp1->errorct   = 0;
+	prbtbl[PERIPHIDX(phuart->Instance)] = ptmp1;
 
 	/* Initialize line buffer pointers */
 	ptmp1->pbegin = pbuf; // First line buffer beginning
@@ -408,8 +413,8 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *phuart)
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
 	/* Look up buffer control block, given uart handle */
-	struct SERIALRCVBCB* prtmp = prbhd;
-	while (prtmp->phuart != phuart) prtmp++;
+	struct SERIALRCVBCB* prtmp = prbtbl[PERIPHIDX(phuart->Instance)];
+	if (prtmp == NULL) return; // Not one of ours
 
 	/* Note char-by-char mode from dma mode. */
 	if (prtmp->dmaflag == 0)
@@ -439,9 +444,8 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *phuart)
 void HAL_UART_ErrorCallback(UART_HandleTypeDef *phuart)
 {
 	/* Look up buffer control block, given uart handle */
-	/* Look up buffer control block, given uart handle */
-	struct SERIALRCVBCB* prtmp = prbhd;
-	while (prtmp->phuart != phuart) prtmp++;
+	struct SERIALRCVBCB* prtmp = prbtbl[PERIPHIDX(phuart->Instance)];
+	if (prtmp == NULL) return; // Not one of ours
 	prtmp->errorct += 1;
 	return;
 }
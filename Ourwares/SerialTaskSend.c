@@ -11,6 +11,7 @@
 #include "malloc.h"
 
 #include "SerialTaskSend.h"
+#include "periphidx.h"
 
 #include "stm32f4xx_hal_usart.h"
 #include "stm32f4xx_hal_uart.h"
@@ -134,6 +135,9 @@ struct SSCIRBUF
 /* Points to first of list of struct SSCIRBUF */
 struct SSCIRBUF* pbhd = NULL;
 
+/* Same blocks, indexed by PERIPHIDX(uart Instance), for the lookups */
+static struct SSCIRBUF* psstbl[PERIPHIDXSIZE];
+
 
 /* *************************************************************************
  * BaseType_t xSerialTaskSendAdd(UART_HandleTypeDef* p, uint16_t qsize, int8_t dmaflag);
@@ -179,6 +183,9 @@ taskENTER_CRITICAL();
 	ptmp1->pend    = pssb + qsize;
 	ptmp1->phuart  = p;
 	ptmp1->dmaflag = dmaflag;
+
+	/* Lookup table entry for this uart */
+	psstbl[PERIPHIDX(p->Instance)] = ptmp1;
 taskEXIT_CRITICAL();
 	return 0;
 }
@@ -208,11 +215,10 @@ void StartSerialTaskSend(void* argument1)
 		/* Add Q item to linked list for this uart/usart */
 
 		/* Find uart/usart list for this item from Q */
-		ptmp = pbhd;
-		while (ptmp->phuart != pssb->phuart) ptmp = ptmp->pnext;
+		ptmp = psstbl[PERIPHIDX(pssb->phuart->Instance)];
 
-	 	if ((pssb->pbuf == NULL) || (pssb->size == 0))
-		{ // Here, HAL is going to reject it
+	 	if ((ptmp == NULL) || (pssb->pbuf == NULL) || (pssb->size == 0))
+		{ // Here, not one of ours, or HAL is going to reject it
   			/* Release buffer just sent so it can be reused. */
 			xSemaphoreGive(pssb->semaphore);
 		}
@@ -269,11 +275,8 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *phuart)
 	struct SSCIRBUF* ptmp1;	// Linked list of usarts
 
 	/* Find bcb circular buffer for this uart */
-	ptmp1 = pbhd; // Polnt to first on list
-	while (ptmp1->phuart != phuart) 
-	{
-		ptmp1 = ptmp1->pnext; // Step to next uart
-	}
+	ptmp1 = psstbl[PERIPHIDX(phuart->Instance)];
+	if (ptmp1 == NULL) return; // Not one of ours
 
 	/* Pointr to buffer control block for next buffer to send. */
 	pbcb = *ptmp1->ptake;
@@ -9,8 +9,9 @@
 #include "malloc.h"
 #include "adctask.h"
 #include "adcparams.h"
-#include "adcfastsum16.h"
+#include "adcfastsum.h"
 #include "ADCTask.h"
+#include "adctiming.h"
 
 #include "morse.h"
 
@@ -47,9 +48,6 @@ struct ADCDMATSKBLK* adctask_init(ADC_HandleTypeDef* phadc,\
 	/* 'adcparams.h' MUST match what STM32CubeMX set up. */
 	if (ADC1IDX_ADCSCANSIZE != phadc->Init.NbrOfConversion) return NULL;
 
-	/* ADC DMA summation length must match 1/2 DMA buffer sizing. */
-	if (ADCFASTSUM16SIZE != ADC1DMANUMSEQ) return NULL;
-
 	/* length = total number of uint16_t in dma buffer */
 	uint32_t length = ADC1DMANUMSEQ * 2 * phadc->Init.NbrOfConversion;
 
@@ -111,6 +109,7 @@ taskEXIT_CRITICAL();
  * *************************************************************************/
 void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
 {
+	adctiming_isr(0);    // DTWTIME stamp for latency
 	adcommon.dmact += 1; // Running count
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	struct ADCDMATSKBLK* ptmp = &adc1dmatskblk[0];
@@ -131,6 +130,7 @@ void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc)
  * *************************************************************************/
 void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc)
 {
+	adctiming_isr(1);    // DTWTIME stamp for latency
 	adcommon.dmact += 1; // Running count
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	struct ADCDMATSKBLK* ptmp = &adc1dmatskblk[0];
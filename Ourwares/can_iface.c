@@ -13,6 +13,41 @@ This simplifies the issue of disabling of interrupts
 
 06/02/2016 - Add rejection of loading bogus CAN ids.
 
+10/17/2026 - The pending TX msgs are a priority queue (can_txq.c) in place of the
+sorted linked list, so 'can_driver_put' does not walk the list with interrupts off.
+The msg in the mailbox is held out of the queue ('ptx') and put back (keeping
+its order among msgs with its id) when it is aborted or is to be retried.
+
+10/17/2026 - TX uses all three mailboxes.  'loadmbx2' fills every empty one from
+the queue, completions (and aborts, errors) are handled for any mailbox, and
+when all are busy and a waiting msg is higher priority than one of them, the
+lowest priority mailbox is aborted and its msg goes back in the queue.  A
+load only goes ahead when the mailbox the hardware will use (the lowest empty
+one) is also empty to us: one the hardware has finished with, but whose
+interrupt has not run yet, would have its completion lost (RQCP is cleared by
+the new TXRQ).
+
+10/17/2026 - CHEATINGONHAL (make CANDIRECT=1) is a complete direct register path:
+TX loads the mailbox registers, and RX reads the FIFO output mailbox, with the
+CANRCVBUF words as they are (they are the register layout), in place of
+HAL_CAN_AddTxMessage/HAL_CAN_GetRxMessage and the expand/compress to the HAL
+headers.  The HAL IRQ handler and callbacks are the same for both.  The id
+masking matches the HAL path bit for bit ('make cancheck' on the host).
+
+10/17/2026 - 'getpctl' (every CAN interrupt callback) is a table lookup indexed
+from the CAN module's register base address (periphidx.h) in place of
+stepping through the list of control blocks.
+
+10/17/2026 - RX circular buffer readers: 'rxadd' checks each 'take' pointer
+before a msg goes in, so a reader that falls behind loses its oldest msg (or,
+CANRXDROPNEW, the new msg is held out) and it is counted, instead of the
+buffer wrapping over it unseen.  Lag high-water mark per reader.  bxCAN RX
+FIFO overruns are counted (can_rx0err, can_rx1err).
+
+10/18/2026 - A full CANRXDROPNEW reader no longer keeps the new msg out of the
+buffer for every reader.  It stops at what it holds ('pstop') and skips what
+came in after when it has taken that (can_iface_get_CANmsg); the others go on.
+
 06/14/2015 rev 720: can.driver.[ch] replaced with can.driverR.[ch] and 
   old can.driver[ch] deleted from svn.
 */
@@ -20,15 +55,30 @@ This simplifies the issue of disabling of interrupts
 /* The following sends all outgoing CAN msgs back into FreeRTOS CAN receive queue */
 //#define CANMSGLOOPBACKSALL
 
-#ifdef CHEATINGONHAL
-#include "stm32f407.h" 	// **** CHEATING (processor dependent) ****
-#endif
-
 #include <malloc.h>
 #include "stm32f4xx_hal.h"
 #include "stm32f4xx_hal_can.h"
 #include "can_iface.h"
 #include "DTW_counter.h"
+#include "periphidx.h"
+
+#ifdef CHEATINGONHAL
+/* **** CHEATING (processor dependent) ****
+   bxCAN register writes that start something in the hardware.  The host build's
+   registers are RAM, so there these go to 'hal_stubs.c', which plays the bxCAN. */
+#ifdef HOSTBUILD
+  #include "hal_stubs.h"
+  #define CANTXRQ(pinst,i,tir) halstub_can_txrq((pinst),(i),(tir))
+  #define CANABRQ(pinst,i)     halstub_can_abrq((pinst),(i))
+  #define CANRFOM(pinst,f)     halstub_can_rfom((pinst),(f))
+#else
+  #define CANTXRQ(pinst,i,tir) ((pinst)->sTxMailBox[(i)].TIR = (tir) | CAN_TI0R_TXRQ)
+  #define CANABRQ(pinst,i)     ((pinst)->TSR = (CAN_TSR_ABRQ0 << (8 * (i)))) // (rc_w1 bits: 0 = no change)
+  #define CANRFOM(pinst,f)     (*(((f) == 0) ? &(pinst)->RF0R : &(pinst)->RF1R) = CAN_RF0R_RFOM0)
+#endif
+/* Standard id msgs: HAL keeps only STID & RTR (the extended id field is not theirs) */
+#define CANSTDIDMASK (CAN_TI0R_STID | CAN_TI0R_RTR)
+#endif
 
 /* Debugging */
 #include "morse.h"
@@ -46,13 +96,15 @@ extern CAN_HandleTypeDef hcan2;
 
 /* subroutine declarations */
 static void loadmbx2(struct CAN_CTLBLOCK* pctl);
-static void moveremove2(struct CAN_CTLBLOCK* pctl);
+static void rxadd(struct CAN_CTLBLOCK* pctl, struct CANRCVBUFN* pncan);
+static void abortmbx2(struct CAN_CTLBLOCK* pctl);
+static void moveremove2(struct CAN_CTLBLOCK* pctl, int i);
+static void requeue2(struct CAN_CTLBLOCK* pctl, int i);
 
-#define MAXCANMODULES	4	// Max number of CAN modules + 1
-/* Pointers to control blocks for each CAN module */
-static struct CAN_CTLBLOCK* pctllist[MAXCANMODULES];
-static struct CAN_CTLBLOCK** ppctllist = NULL;	// Pointer to end of active pctllist
+/* Pointers to control blocks for each CAN module, indexed by PERIPHIDX(Instance) */
+static struct CAN_CTLBLOCK* pctlidx[PERIPHIDXSIZE];
 
+#ifndef CHEATINGONHAL
 /* *************************************************************************
  * static void canmsg_compress(struct CANRCVBUF *pcan, CAN_RxHeaderTypeDef *phal, uint8_t *pdat);
  * @brief	: Convert silly HAL expanded format to hardware compressed format
@@ -84,6 +136,7 @@ static void canmsg_compress(struct CANRCVBUF *pcan, CAN_RxHeaderTypeDef *phal, u
 	pcan->cd.uc[7] = *(pdat+7);
 	return;
 }
+#endif
 /******************************************************************************
  * struct CANTAKEPTR* can_iface_add_take(struct CAN_CTLBLOCK*  pctl);
  * @brief 	: Create a 'take' pointer for accessing CAN msgs in the circular buffer
@@ -109,6 +162,11 @@ taskENTER_CRITICAL();
       CAN msgs are currently being added. */
 	p->ptake = pctl->cirptrs.pwork;
 
+	/* Add to list of readers the interrupt checks when adding a msg. */
+	p->policy = CANRXDROPOLD;
+	p->pnext  = pctl->cirptrs.ptakelist;
+	pctl->cirptrs.ptakelist = p;
+
 taskEXIT_CRITICAL();
 	return p;
 }
@@ -144,20 +202,42 @@ struct CANTAKEPTR* can_iface_mbx_init(struct CAN_CTLBLOCK* pctl, osThreadId tskh
  struct CANRCVBUFN* can_iface_get_CANmsg(struct CANTAKEPTR* p)
 {
 	struct CANRCVBUFN* ptmp = NULL;
-	if (p->pcir->pwork == p->ptake) return ptmp;
 
-	ptmp = p->ptake;
-	p->ptake += 1;
-	if (p->ptake == p->pcir->pend) p->ptake = p->pcir->pbegin;
+taskENTER_CRITICAL(); // 'rxadd' steps 'ptake' of a full reader
+	if ((p->pstop != NULL) && (p->ptake == p->pstop))
+	{ // Full CANRXDROPNEW reader has taken what it held: skip what was held out
+		p->ptake = p->pcir->pwork;
+		p->pstop = NULL;
+	}
+	if (p->pcir->pwork != p->ptake)
+	{
+		ptmp = p->ptake;
+		p->ptake += 1;
+		if (p->ptake == p->pcir->pend) p->ptake = p->pcir->pbegin;
+	}
+taskEXIT_CRITICAL();
 
 	return ptmp;	
 }
+/******************************************************************************
+ * uint16_t can_iface_take_lag(struct CANTAKEPTR* p);
+ * @brief 	: Number of msgs waiting for this reader
+ * @param	: p = pointer to struct with 'take' and 'add' pointers
+ * @return	: msgs in the circular buffer not yet taken (0 - numrx-1)
+*******************************************************************************/
+uint16_t can_iface_take_lag(struct CANTAKEPTR* p)
+{
+	struct CANRCVBUFN* pend = (p->pstop != NULL) ? p->pstop : p->pcir->pwork;
+	int lag = pend - p->ptake;
+	if (lag < 0) lag += (p->pcir->pend - p->pcir->pbegin);
+	return lag;
+}
 /******************************************************************************
  * struct CAN_CTLBLOCK* can_iface_init(CAN_HandleTypeDef *phcan, uint8_t canidx, uint16_t numtx, uint16_t numrx);
  * @brief 	: Setup linked list for TX priority sorted buffering
  * @param	: phcan = Pointer "handle" to HAL control block for CAN module
  * @param	: cannum = CAN module index, CAN1 = 0, CAN2 = 1, CAN3 = 2
- * @param	: numtx = number of CAN msgs for TX buffering
+ * @param	: numtx = number of CAN msgs for TX buffering (1 - CANTXQMAXPOOL)
  * @param	: numrx = number of incoming (and loopback) CAN msgs in circular buffer
  * @return	: Pointer to our knows-all control block for this CAN
  *		:  NULL = calloc failed
@@ -174,7 +254,7 @@ struct CAN_CTLBLOCK* can_iface_init(CAN_HandleTypeDef *phcan, uint8_t canidx, ui
 	int i;
 
 	struct CAN_CTLBLOCK*  pctl;
-	struct CAN_CTLBLOCK** ppx;
+	struct CAN_CTLBLOCK** ppx = &pctlidx[PERIPHIDX(phcan->Instance)];
 
 	struct CAN_POOLBLOCK* plst;
 	struct CAN_POOLBLOCK* ptmp;
@@ -182,6 +262,9 @@ struct CAN_CTLBLOCK* can_iface_init(CAN_HandleTypeDef *phcan, uint8_t canidx, ui
 	struct CANRCVBUFN* pcann;
 
 taskENTER_CRITICAL();
+	/* Check for duplicates, i.e. check for bozo programmers */
+	if (*ppx != NULL) { taskEXIT_CRITICAL();return NULL;} // Duplicate
+
 	/* Get a control block for this CAN module. */
 	pctl = (struct CAN_CTLBLOCK*)calloc(1, sizeof(struct CAN_CTLBLOCK));
 	if (pctl == NULL){ taskEXIT_CRITICAL();return NULL;}
@@ -192,34 +275,17 @@ taskENTER_CRITICAL();
 	/* Save CAN module index (CAN1 = 0). */
 	pctl->canidx = canidx;
 
-	/* Add new control block to list of control blocks */
-	if (ppctllist != NULL) // Not first time?
-	{ // Yes. Check for duplicates, i.e. check for bozo programmers
-		ppx = &pctllist[0];	// NOTE: don't confuse ppctllist with pctllist
-		while (ppx != ppctllist)
-		{
-			if ( (*ppx)->phcan == phcan)
-			{
-				taskEXIT_CRITICAL();
-				return NULL; // Duplicate
-			}
-			ppx++;;
-		}
-	}
-	else
-	{
-		ppctllist = &pctllist[0];
-	}
-	/* Save control block pointer on list, and advance list pointer */
-	*ppctllist = pctl;	
-	ppctllist++;
-	if (ppctllist == &pctllist[MAXCANMODULES]) { taskEXIT_CRITICAL();return NULL;} //JIC too many entries
+	/* Keep all TX mailboxes loaded. */
+	pctl->ntxmbx = CANTXMBX;
+
+	/* Save control block pointer in table for callback lookups */
+	*ppx = pctl;
 	
 	/* Now that we have control block in memory, we can use it to return errors. 
 	   by setting the error code in pctl->ret. */
 
 	/* Get CAN xmit linked list. */	
-	if (numtx == 0)  {pctl->ret = -1; return pctl;} // Bogus tx buffering count
+	if ((numtx == 0) || (numtx > CANTXQMAXPOOL)) {pctl->ret = -1; return pctl;} // Bogus tx buffering count
 	ptmp = (struct CAN_POOLBLOCK*)calloc(numtx, sizeof(struct CAN_POOLBLOCK));
 	if (ptmp == NULL){pctl->ret = -2; taskEXIT_CRITICAL(); return NULL;} // Get buff failed
 
@@ -232,6 +298,9 @@ taskENTER_CRITICAL();
 		plst = ptmp++;
 	}
 
+	/* Pending msgs queue: room for all of them. */
+	if (can_txq_init(&pctl->txq, pctl->frii.plinknext, numtx) != 0){pctl->ret = -2; taskEXIT_CRITICAL(); return NULL;} // Get buff failed
+
 	/* Setup circular buffer for receive CAN msgs */
 	if (numrx == 0)  {pctl->ret = -3; return pctl;} // Bogus rx buffering count
 	pcann = (struct CANRCVBUFN*)calloc(numrx, sizeof(struct CANRCVBUFN));
@@ -267,7 +336,6 @@ extern uint32_t debugTX1c;
 int can_driver_put(struct CAN_CTLBLOCK* pctl,struct CANRCVBUF *pcan,uint8_t maxretryct,uint8_t bits)
 {
 	volatile struct CAN_POOLBLOCK* pnew;
-	volatile struct CAN_POOLBLOCK* pfor; 	// Loop pointer for the 'for’ loop.
 
 	if (pctl == NULL) return -3;
 
@@ -308,116 +376,167 @@ int can_driver_put(struct CAN_CTLBLOCK* pctl,struct CANRCVBUF *pcan,uint8_t maxr
 	pnew->x.xb[3] = 0;	// not used for now
 	pnew->x.xb[0] = 0;	// Retry counter for TERRs
 
-	/* Find location to insert new msg.  Lower value CAN ids are higher priority, 
-           and when the CAN id msg to be inserted has the same CAN id as the 'pfor' one
-           already in the list, then place the new one further down so that msgs with 
-           the same CAN id do not get their order of transmission altered. */
-//	disable_TXints(pctl, save);
-
-	for (pfor = &pctl->pend; pfor->plinknext != NULL; pfor = pfor->plinknext)
-	{
-		if (pnew->can.id < (pfor->plinknext)->can.id) // Pay attention: "value" vs "priority"
-			break;
-	}
+	/* Add new msg to pending queue.  Lower value CAN ids are higher priority, 
+           and a msg with the same CAN id as ones already queued goes after them
+           so that msgs with the same CAN id do not get their order of transmission
+           altered.  (TX interrupt is still disabled) */
+	can_txq_put(&pctl->txq, pnew); // (Room for every pool block: cannot fail)
 
-	/* Add new msg to pending list. (TX interrupt is still disabled) */
-	pnew->plinknext = pfor->plinknext; 	// Insert new msg into 
-	pfor->plinknext = pnew;			//   pending list.
+	/* Load empty mailboxes, if any (CAN may have been idle). */
+	loadmbx2(pctl);
 
-	if (pctl->pxprv == NULL) // Is sending complete?
-	{ // pxprv == NULL means CAN mailbox did not get loaded, so CAN is idle.
-		loadmbx2(pctl); // Start sending
-	}
-	else
-	{ // CAN sending is in progress.
-		if ((pctl->pxprv)->plinknext == pnew) // Does pxprv need adjustment?
-		{ // Here yes. We inserted a msg between 'pxprv' and 'pxprv->linknext'
-			pctl->pxprv = pnew;	// Update 'pxprv' so that it still points to msg TX using.
-			pctl->can_errors.can_pxprv_fwd_one += 1;	// Count: Instances that pxprv was adjusted in 'for' loop
-		}
-		/* Check if new msg is higher CAN priority than msg in mailbox */
-#ifdef CHEATINGONHAL
-		if ( (pctl->pend.plinknext)->can.id < (pctl->phcan->Instance->sTxMailBox[0] & ~0x1)  )
-#else
-		if ( (pctl->pend.plinknext)->can.id < (pctl->mbx0 & ~0x1)  ) // Use mailbox shadow id
-#endif
-		{ // Here, new msg has higher CAN priority than msg in mailbox
 /* &&&&&&&&&&&&&& BEGIN ABORT MODS &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& */
 #ifdef YESABORTCODE
-			pctl->abortflag = 1;	// Set flag for interrupt routine use
-//		taskEXIT_CRITICAL(); // ==> NOTE: allow interrupts before setting abort!
-			HAL_CAN_AbortTxRequest(pctl->phcan, CAN_TX_MAILBOX0);
-		taskEXIT_CRITICAL(); // ==> AFTER! Which fails!
-			return 0;
+	/* All mailboxes busy: make room if the next msg outranks one of them. */
+	if (pctl->abortflag == 0) // One abort at a time
+		abortmbx2(pctl);
 #endif
-		}
 /* &&&&&&&&&&&&&& END ABORT MODS &&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&&& */
-	}
 	taskEXIT_CRITICAL(); // Re-enable interrupts
 	return 0;	// Success!
 }
+/*---------------------------------------------------------------------------------------------
+ * static int hwnext(struct CAN_CTLBLOCK* pctl)
+ * @brief	: TX mailbox the next load goes into: the lowest the hardware shows empty
+ * @return	: 0 - 2; CANTXMBX = none empty
+ ----------------------------------------------------------------------------------------------*/
+static int hwnext(struct CAN_CTLBLOCK* pctl)
+{
+#ifdef CHEATINGONHAL
+	uint32_t tsr = pctl->phcan->Instance->TSR;
+	if ((tsr & (CAN_TSR_TME0 | CAN_TSR_TME1 | CAN_TSR_TME2)) == 0) return CANTXMBX;
+	return (tsr & CAN_TSR_CODE) >> CAN_TSR_CODE_Pos;
+#else
+	int i;
+	for (i = 0; i < CANTXMBX; i++)
+		if (HAL_CAN_IsTxMessagePending(pctl->phcan, (CAN_TX_MAILBOX0 << i)) == 0) break;
+	return i;
+#endif
+}
 /*---------------------------------------------------------------------------------------------
  * static void loadmbx2(struct CAN_CTLBLOCK* pctl)
- * @brief	: Load mailbox
+ * @brief	: Load empty mailboxes from the pending queue
  ----------------------------------------------------------------------------------------------*/
 static void loadmbx2(struct CAN_CTLBLOCK* pctl)
 {
+#ifdef CHEATINGONHAL
+	CAN_TypeDef* pinst = pctl->phcan->Instance;
+#else
 	uint32_t uidata[2];
 	uint32_t TxMailbox;
 	CAN_TxHeaderTypeDef halmsg;
+#endif
+	volatile struct CAN_POOLBLOCK* p;
+	int i;
+	int k;
 
-	volatile struct CAN_POOLBLOCK* p = pctl->pend.plinknext;
-
-	if (p == NULL)
+	for (;;)
 	{
-		pctl->pxprv = NULL;
-		return; // Return if no more to send
+		/* The load goes in the lowest empty mailbox.  If we still hold that one
+		   its interrupt is pending: loading now would lose the completion, so
+		   leave it to the callback, which reloads. */
+		i = hwnext(pctl);
+		if ((i >= pctl->ntxmbx) || (pctl->ptx[i] != NULL)) return;
+
+		p = can_txq_top(&pctl->txq);
+		if (p == NULL)
+			return; // Return if no more to send
+
+		/* bxCAN sends equal ids lowest mailbox first, which might not be the
+		   order loaded: a msg waits until none with its id is in a mailbox. */
+		for (k = 0; k < pctl->ntxmbx; k++)
+			if ((pctl->ptx[k] != NULL) && (pctl->ptx[k]->can.id == p->can.id)) return;
+
+		can_txq_pop(&pctl->txq);
+
+#ifdef CHEATINGONHAL
+		/* Load the mailbox with the message.  CAN ID low bit starts xmission. */
+		pinst->sTxMailBox[i].TDTR = (p->can.dlc & 0xf);	// CAN_TDTxR: mailbox time & length
+		pinst->sTxMailBox[i].TDLR = p->can.cd.ui[0];	// CAN_TDLxR: mailbox data low  register
+		pinst->sTxMailBox[i].TDHR = p->can.cd.ui[1];	// CAN_TDHxR: mailbox data high register
+		/* Load CAN ID with TX Request bit set (CAN_TIxR: mailbox identifier register) */
+		CANTXRQ(pinst, i, ((p->can.id & CAN_ID_EXT) != 0) ? (p->can.id & ~CAN_TI0R_TXRQ) : (p->can.id & CANSTDIDMASK));
+#else
+		/* Expand hardware friendly format to HAL format (which gets changed back to hardware friendly) */
+		halmsg.StdId = (p->can.id >> 21);
+		halmsg.ExtId = (p->can.id >>  3);
+		halmsg.IDE   = (p->can.id & CAN_ID_EXT);
+		halmsg.RTR   = (p->can.id & CAN_RTR_REMOTE);
+		halmsg.DLC   = (p->can.dlc & 0xf);
+		uidata[0]   = p->can.cd.ui[0];
+		uidata[1]   = p->can.cd.ui[1];
+		if (HAL_CAN_AddTxMessage(pctl->phcan, &halmsg, (uint8_t*)uidata, &TxMailbox) != HAL_OK)
+		{ // JIC: no empty mailbox after all
+			can_txq_requeue(&pctl->txq, p);
+			return;
+		}
+		i = (TxMailbox == CAN_TX_MAILBOX0) ? 0 : (TxMailbox == CAN_TX_MAILBOX1) ? 1 : 2;
+#endif
+		pctl->ptx[i] = p;	// Msg in the mailbox
 	}
+}
+/*---------------------------------------------------------------------------------------------
+ * static void abortmbx2(struct CAN_CTLBLOCK* pctl)
+ * @brief	: Abort the lowest priority mailbox if the next msg waiting outranks it
+ ----------------------------------------------------------------------------------------------*/
+static void abortmbx2(struct CAN_CTLBLOCK* pctl)
+{
+	volatile struct CAN_POOLBLOCK* ptop = can_txq_top(&pctl->txq);
+	uint32_t idmax = 0;
+	int m = 0;
+	int i;
 
-	pctl->pxprv = &pctl->pend;	// Save in a static var
+	if (ptop == NULL) return; // Nothing waiting
 
+	for (i = 0; i < pctl->ntxmbx; i++)
+	{
+		if (pctl->ptx[i] == NULL) return; // Not all busy: 'ptop' is held by its id, or a callback will load it
+		if (pctl->ptx[i]->can.id == ptop->can.id) return; // Must follow that one anyway
+		if (pctl->ptx[i]->can.id >= idmax)
+		{
+			idmax = pctl->ptx[i]->can.id;
+			m = i;
+		}
+	}
+	if (ptop->can.id >= idmax) return; // Outranks none of them
+
+	/* Here, new msg has higher CAN priority than the msg in mailbox 'm' */
+	pctl->abortflag |= (1 << m);	// Set flag for interrupt routine use
 #ifdef CHEATINGONHAL
-	/* Load the mailbox with the message.  CAN ID low bit starts xmission. */
-	pctl->phcan->sTxMailBox[0].TDTR = p->can.dlc;	 	// CAN_TDT0R:  mailbox 0 time & length
-	pctl->phcan->sTxMailBox[0].TDLR = p->can.cd.ui[0];	// CAN_TDL0RL: mailbox 0 data low  register
-	pctl->phcan->sTxMailBox[0].TDHR = p->can.cd.ui[1];	// CAN_TDL0RH: mailbox 0 data low  register
-	/* Load CAN ID with TX Request bit set */
-	pctl->phcan->sTxMailBox[0].TIR = (p->can.id | 0x1); 	// CAN_TI0R:   mailbox 0 identifier register
+	CANABRQ(pctl->phcan->Instance, m);
 #else
-	/* Expand hardware friendly format to HAL format (which gets changed back to hardware friendly) */
-	halmsg.StdId = (p->can.id >> 21);
-	halmsg.ExtId = (p->can.id >>  3);
-	halmsg.IDE   = (p->can.id & CAN_ID_EXT);
-	halmsg.RTR   = (p->can.id & CAN_RTR_REMOTE);
-	halmsg.DLC   = (p->can.dlc & 0xf);
-	uidata[0]   = p->can.cd.ui[0];
-	uidata[1]   = p->can.cd.ui[1];
-	pctl->mbx0  = p->can.id;	// Shadow MBX0 ID
-   HAL_CAN_AddTxMessage(pctl->phcan, &halmsg, (uint8_t*)uidata, &TxMailbox);
+	HAL_CAN_AbortTxRequest(pctl->phcan, (CAN_TX_MAILBOX0 << m));
 #endif
 	return;
 }
 /* --------------------------------------------------------------------------------------
-* static void moveremove2(struct CAN_CTLBLOCK* pctl);
-* @brief	: Remove msg from pending list and add to free list
+* static void moveremove2(struct CAN_CTLBLOCK* pctl, int i);
+* @brief	: Add msg that was in mailbox 'i' to free list
   --------------------------------------------------------------------------------------- */
-static void moveremove2(struct CAN_CTLBLOCK* pctl)
+static void moveremove2(struct CAN_CTLBLOCK* pctl, int i)
 {
-	volatile struct CAN_POOLBLOCK* pmov;
-//	uint32_t save[2];
-
-//	disable_TXints(pctl, save);	// TX or RX(other) interrupts might remove a msg from the free list.
-// Each CAN module has its own linked list and RX0,1 does not use the linked list, so disabling interrupts is not needed.
+	volatile struct CAN_POOLBLOCK* pmov = pctl->ptx[i];	// Pts to removed item
 
-	/* Remove from pending; move to free list. */
-	pmov = pctl->pxprv->plinknext;	// Pts to removed item
-	pctl->pxprv->plinknext = pmov->plinknext;
+// Each CAN module has its own pool and queue and RX0,1 does not use them, so disabling interrupts is not needed.
+	if (pmov == NULL) return;
+	pctl->ptx[i] = NULL;
+	pctl->abortflag &= ~(1 << i);
 
 	// Adding to free list
 	pmov->plinknext = pctl->frii.plinknext; 
 	pctl->frii.plinknext  = pmov;
-
-//	reenable_TXints(save);
+	return;
+}
+/* --------------------------------------------------------------------------------------
+* static void requeue2(struct CAN_CTLBLOCK* pctl, int i);
+* @brief	: Put msg that was in mailbox 'i' back on the pending queue (to be sent again)
+  --------------------------------------------------------------------------------------- */
+static void requeue2(struct CAN_CTLBLOCK* pctl, int i)
+{
+	if (pctl->ptx[i] == NULL) return;
+	can_txq_requeue(&pctl->txq, pctl->ptx[i]); // Ahead of later msgs with its id
+	pctl->ptx[i] = NULL;
+	pctl->abortflag &= ~(1 << i);
 	return;
 }
 
@@ -434,25 +553,28 @@ static void moveremove2(struct CAN_CTLBLOCK* pctl)
  * *********************************************************************/
 struct CAN_CTLBLOCK* getpctl(CAN_HandleTypeDef *phcan)
 {
-//if (pctl == pctl1) morse_trap(73);
-
-	struct CAN_CTLBLOCK** ppx = &pctllist[0];
-	while (ppx != ppctllist) // Step through list of pointers 
-	{
-		if ( (*ppx)->phcan == phcan) break;
-		ppx++;
-	}
-	return *ppx;
+	return pctlidx[PERIPHIDX(phcan->Instance)];
 }
-
-/* Transmission Mailbox 0 complete callback. */
-void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *phcan)
+/* *********************************************************************
+ * static void txcomplete(CAN_HandleTypeDef *phcan, int i);
+ * @brief	: Mailbox 'i' sent its msg: loop back, free, and load the next
+ * @param	: phcan = pointer to 'MX CAN handle (control block)
+ * @param	: i = mailbox (0 - 2)
+ * *********************************************************************/
+static void txcomplete(CAN_HandleTypeDef *phcan, int i)
 {
 	struct CAN_CTLBLOCK* pctl = getpctl(phcan); // Lookup our pointer
 
 	/* Loop back CAN =>TX<= msgs. */
-volatile	struct CAN_POOLBLOCK* p = pctl->pend.plinknext;
+volatile	struct CAN_POOLBLOCK* p = pctl->ptx[i];
 	struct CANRCVBUFN ncan;
+
+	if (p == NULL)
+	{ // Nothing was loaded by us
+		pctl->can_errors.txint_emptylist += 1;
+		return;
+	}
+	pctl->txcplt[i] += 1;
 	ncan.pctl = pctl;
 	ncan.can = p->can;
 	
@@ -463,10 +585,7 @@ volatile	struct CAN_POOLBLOCK* p = pctl->pend.plinknext;
 #endif
    {
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-			*pctl->cirptrs.pwork = ncan;
-			pctl->cirptrs.pwork++;
-			if (pctl->cirptrs.pwork == pctl->cirptrs.pend) pctl->cirptrs.pwork = pctl->cirptrs.pbegin;
-
+			rxadd(pctl, &ncan);
 			if (pctl->tsknote.tskhandle != NULL)
 			{ // Here, one task will be notified a msg added to circular buffer
 				xTaskNotifyFromISR(pctl->tsknote.tskhandle,\
@@ -475,45 +594,149 @@ volatile	struct CAN_POOLBLOCK* p = pctl->pend.plinknext;
 			}
 	}
 
-	moveremove2(pctl);	// remove from pending list, add to free list
-	pctl->abortflag = 0;
-	loadmbx2(pctl);		// Load mailbox 0.  Mailbox should be available/empty.
+	moveremove2(pctl, i);	// remove from mailbox, add to free list
+	loadmbx2(pctl);		// Load empty mailboxes
 //portYIELD_FROM_ISR( xHigherPriorityTaskWoken ); // Trigger scheduler
 }
 
-/* Transmission Mailbox 0 Abort callback. */
-void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *phcan)
+/* Transmission Mailbox 0, 1, 2 complete callbacks. */
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *phcan)
 {
+	txcomplete(phcan, 0);
+}
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *phcan)
+{
+	txcomplete(phcan, 1);
+}
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *phcan)
+{
+	txcomplete(phcan, 2);
+}
+
+/* Transmission Mailbox 0, 1, 2 Abort callbacks. */
 #ifdef YESABORTCODE
+static void txabort(CAN_HandleTypeDef *phcan, int i)
+{
 	struct CAN_CTLBLOCK* pctl = getpctl(phcan);
-	loadmbx2(pctl);		// Load mailbox 0.  Mailbox should be available/empty.
-	pctl->abortflag = 0;
+	requeue2(pctl, i);	// Aborted msg goes back in line
+	loadmbx2(pctl);		// Load the highest priority.  Mailbox should be available/empty.
+}
+#endif
+void HAL_CAN_TxMailbox0AbortCallback(CAN_HandleTypeDef *phcan)
+{
+#ifdef YESABORTCODE
+	txabort(phcan, 0);
+#endif
+}
+void HAL_CAN_TxMailbox1AbortCallback(CAN_HandleTypeDef *phcan)
+{
+#ifdef YESABORTCODE
+	txabort(phcan, 1);
+#endif
+}
+void HAL_CAN_TxMailbox2AbortCallback(CAN_HandleTypeDef *phcan)
+{
+#ifdef YESABORTCODE
+	txabort(phcan, 2);
 #endif
 }
 
 /* Error callback */
 void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *phcan)
 {
+	static const uint32_t alst[CANTXMBX] = {HAL_CAN_ERROR_TX_ALST0, HAL_CAN_ERROR_TX_ALST1, HAL_CAN_ERROR_TX_ALST2};
+	static const uint32_t terr[CANTXMBX] = {HAL_CAN_ERROR_TX_TERR0, HAL_CAN_ERROR_TX_TERR1, HAL_CAN_ERROR_TX_TERR2};
 	struct CAN_CTLBLOCK* pctl = getpctl(phcan);
-	if ((phcan->ErrorCode & HAL_CAN_ERROR_TX_ALST0) != 0 )
+	volatile struct CAN_POOLBLOCK* p;
+	int i;
+
+	/* RX FIFO overrun: bxCAN dropped a msg, FIFO full (RX interrupt late) */
+	if ((phcan->ErrorCode & HAL_CAN_ERROR_RX_FOV0) != 0) pctl->can_errors.can_rx0err += 1;
+	if ((phcan->ErrorCode & HAL_CAN_ERROR_RX_FOV1) != 0) pctl->can_errors.can_rx1err += 1;
+	phcan->ErrorCode &= ~(HAL_CAN_ERROR_RX_FOV0 | HAL_CAN_ERROR_RX_FOV1);
+
+	for (i = 0; i < CANTXMBX; i++)
 	{
-		pctl->can_errors.can_tx_alst0_err += 1; // Running ct of arb lost: Mostly for debugging/monitoring
-		if ((pctl->pxprv->plinknext->x.xb[2] & SOFTNART) != 0)
-		{ // Here this msg was not to be re-sent, i.e. NART
-			moveremove2(pctl);	// Remove msg from pending queue
-		}
+		p = pctl->ptx[i];	// Msg in mailbox 'i'
+		if ((phcan->ErrorCode & alst[i]) != 0 )
+		{
+			pctl->can_errors.can_tx_alst0_err += 1; // Running ct of arb lost: Mostly for debugging/monitoring
+			if ((p != NULL) && ((p->x.xb[2] & SOFTNART) != 0))
+			{ // Here this msg was not to be re-sent, i.e. NART
+				moveremove2(pctl, i);	// Drop msg
+			}
+			else
+				requeue2(pctl, i);	// Send again, in its turn
 debugTX1c += 1;
+		}
+		else if (((phcan->ErrorCode & terr[i]) != 0) && (p != NULL))
+		{
+			p->x.xb[0] += 1;	// Count errors for this msg
+			if (p->x.xb[0] > p->x.xb[1])
+			{ // Here, too many error, remove from list
+				pctl->can_errors.can_tx_bombed += 1;	// Number of bombouts
+				moveremove2(pctl, i);	// Drop msg
+			}
+			else
+				requeue2(pctl, i);	// Send again, in its turn
+		}
+		/* HAL accumulates ErrorCode: clear these so a later error is not taken for them. */
+		phcan->ErrorCode &= ~(alst[i] | terr[i]);
 	}
-	else if ((phcan->ErrorCode & HAL_CAN_ERROR_TX_TERR0) != 0 )
+	loadmbx2(pctl);		// Load empty mailboxes (nothing if other errors left them busy)
+	return;
+}
+/* *********************************************************************
+ * static void rxadd(struct CAN_CTLBLOCK* pctl, struct CANRCVBUFN* pncan);
+ * @brief	: Add msg to RX circular buffer, checking each reader ('take' pointer)
+ * @param	: pctl = pointer to our CAN control block
+ * @param	: pncan = pointer to msg to be added
+ * *********************************************************************/
+static void rxadd(struct CAN_CTLBLOCK* pctl, struct CANRCVBUFN* pncan)
+{
+	struct CANCIRBUFPTRS* pcir = &pctl->cirptrs;
+	struct CANTAKEPTR* p;
+	int n = pcir->pend - pcir->pbegin;
+	int lag;
+	int over = 0;
+
+	/* A drop-newest reader that is full stops at what it holds: this msg
+	   and the ones after it are held out for it. */
+	for (p = pcir->ptakelist; p != NULL; p = p->pnext)
 	{
-		pctl->pxprv->plinknext->x.xb[0] += 1;	// Count errors for this msg
-		if (pctl->pxprv->plinknext->x.xb[0] > pctl->pxprv->plinknext->x.xb[1])
-		{ // Here, too many error, remove from list
-			pctl->can_errors.can_tx_bombed += 1;	// Number of bombouts
-			moveremove2(pctl);	// Remove msg from pending queue
+		if ((p->policy == CANRXDROPNEW) && (p->pstop == NULL) &&
+		    (can_iface_take_lag(p) >= (n / 2)))
+			p->pstop = pcir->pwork;
+		if (p->pstop != NULL)
+		{
+			p->overrun += 1;
+			over = 1;
 		}
-	}	
-	loadmbx2(pctl);		// Load mailbox 0.  Mailbox should be available/empty.
+	}
+
+	*pcir->pwork = *pncan; // Copy struct
+	pcir->pwork++;         // Advance 'add' pointer
+	if (pcir->pwork == pcir->pend) pcir->pwork = pcir->pbegin;
+
+	/* A reader the 'add' pointer caught up with was full: drop its oldest. */
+	for (p = pcir->ptakelist; p != NULL; p = p->pnext)
+	{
+		if (p->ptake == pcir->pwork)
+		{
+			p->ptake += 1;
+			if (p->ptake == pcir->pend) p->ptake = pcir->pbegin;
+			p->overrun += 1;
+			over = 1;
+		}
+		if ((p->pstop != NULL) && (p->ptake == p->pstop))
+		{ // Drop-newest reader lost all it held: still full, holding nothing
+			p->ptake = pcir->pwork;
+			p->pstop = pcir->pwork;
+		}
+		lag = can_iface_take_lag(p);
+		if (lag > p->lagmax) p->lagmax = lag;
+	}
+	if (over != 0) pctl->can_errors.can_msgovrflow += 1;
 	return;
 }
 /* *********************************************************************
@@ -529,29 +752,47 @@ static void unloadfifo(CAN_HandleTypeDef *phcan, uint32_t RxFifo)
 	struct CANRCVBUFN ncan; // CAN msg plus pctl
 	ncan.toa = DTWTIME;
 debug1 += 1;
-	HAL_StatusTypeDef ret;
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+#ifdef CHEATINGONHAL
+	CAN_TypeDef* pinst = phcan->Instance;
+	CAN_FIFOMailBox_TypeDef* pfmb = &pinst->sFIFOMailBox[RxFifo]; // (CAN_RX_FIFO0 = 0, _FIFO1 = 1)
+	volatile uint32_t* prfr = (RxFifo == CAN_RX_FIFO0) ? &pinst->RF0R : &pinst->RF1R;
+	uint32_t rir;
+	int ret;
+#else
+	HAL_StatusTypeDef ret;
 	CAN_RxHeaderTypeDef header;
 	uint8_t data[8];
+#endif
 
 	struct CAN_CTLBLOCK* pctl = getpctl(phcan); // Lookup pctl given phcan
 
 	do /* Unload hardware RX FIFO */
 	{
-// NOTE: this could be done directly and avoid the expand/compress overhead
-// but it would become processor dependent and would cheat on HAL.
+#ifdef CHEATINGONHAL
+		/* The FIFO output mailbox is already our hardware format: copy the words. */
+		ret = ((*prfr & CAN_RF0R_FMP0) != 0); // Msgs pending (FMP1 is the same bits)
+		if (ret)
+		{
+			/* Setup msg with pctl for our format */
+			ncan.pctl = pctl;
+			rir = pfmb->RIR;
+			ncan.can.id  = ((rir & CAN_RI0R_IDE) != 0) ? (rir & ~0x1) : (rir & CANSTDIDMASK); // (bit 0 reserved)
+			ncan.can.dlc = pfmb->RDTR & CAN_RDT0R_DLC;
+			ncan.can.cd.ui[0] = pfmb->RDLR;
+			ncan.can.cd.ui[1] = pfmb->RDHR;
+			CANRFOM(pinst, RxFifo); // Release: next msg (if any) to the output mailbox
+#else
 		ret = HAL_CAN_GetRxMessage(pctl->phcan, RxFifo, &header, &data[0]);
 		if (ret == HAL_OK)
 		{
 			/* Setup msg with pctl for our format */
 			ncan.pctl = pctl;
 			canmsg_compress(&ncan.can, &header, &data[0]);
+#endif
 
 			/* Place on queue for Mailbox task to filter, distribute, notify, etc. */
-			*pctl->cirptrs.pwork = ncan; // Copy struct
-			pctl->cirptrs.pwork++;       // Advance 'add' pointer
-			if (pctl->cirptrs.pwork == pctl->cirptrs.pend) pctl->cirptrs.pwork = pctl->cirptrs.pbegin;
-
+			rxadd(pctl, &ncan);
 			if (pctl->tsknote.tskhandle != NULL)
 			{ // Here, notify one task a new msg added to circular buffer
 				xTaskNotifyFromISR(pctl->tsknote.tskhandle,\
@@ -559,7 +800,11 @@ debug1 += 1;
 					&xHigherPriorityTaskWoken );
 			}
 		}
+#ifdef CHEATINGONHAL
+	} while (ret); //JIC there is more than one in the hw fifo
+#else
 	} while (ret == HAL_OK); //JIC there is more than one in the hw fifo
+#endif
 	portYIELD_FROM_ISR( xHigherPriorityTaskWoken ); // Trigger scheduler
 }
 /* Rx FIFO 0 message pending callback. */
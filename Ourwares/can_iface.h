@@ -7,8 +7,33 @@
 /* 
 'iface is a hack of 'driver'.
 
-Implements the sorted linked list buffer for presenting the highest priority CAN msg
+Implements the priority queue (can_txq.h) for presenting the highest priority CAN msg
 at all times.
+
+TX keeps up to 'ntxmbx' of the three bxCAN mailboxes loaded from the queue, so the
+next msg is already waiting in the hardware when one finishes and the bus does not
+sit idle for the TX interrupt.  bxCAN sends the lowest id mailbox first
+(TransmitFifoPriority = DISABLE), and a msg is held in the queue while one with
+the same id is in a mailbox, since bxCAN sends equal ids in mailbox number order,
+not loading order.
+
+RX: one circular buffer per CAN module, written by the interrupt (unloadfifo, and
+TX loopback), with any number of readers, each with its own 'take' pointer
+(can_iface_add_take).  Every msg goes in the buffer; what a reader that is
+full loses is its 'policy'--
+  CANRXDROPOLD (default): full with 'numrx - 1' msgs waiting.  The reader's
+    oldest msg is dropped (its 'take' steps ahead).
+  CANRXDROPNEW: full with 'numrx / 2' msgs waiting.  The reader keeps what it
+    holds ('pstop' marks the end) and the msgs that come in after are held
+    out for it: when it has taken what it held it skips to the newest.  The
+    buffer goes on for the other readers, so what it holds lasts another
+    'numrx / 2 - 1' msgs; after that its oldest go as well.
+A stalled reader of either kind does not hold up the others.  The reader's
+'overrun' counts each msg it loses, and 'can_errors.can_msgovrflow' counts
+msgs that overran some reader.  'lagmax' is the high-water mark of
+msgs waiting for the reader.  (Without the check, a reader that fell a full
+buffer behind saw an empty buffer and lost all of it, uncounted.)
+Set the policy after can_iface_add_take, e.g. 'ptake->policy = CANRXDROPNEW;'.
 */
 
 #ifndef __CAN_IFACE
@@ -23,6 +48,7 @@ at all times.
 #include "stm32f4xx_hal.h"
 #include "stm32f4xx_hal_can.h"
 #include "common_can.h"
+#include "can_txq.h"
 #include "CanTask.h"
 #include "FreeRTOS.h"
 #include "task.h"
@@ -49,13 +75,23 @@ struct CANCIRBUFPTRS
 	struct CANRCVBUFN* pbegin;
 	struct CANRCVBUFN* pend;
 	struct CANRCVBUFN* pwork;
+	struct CANTAKEPTR* ptakelist; // Readers of this buffer (NULL = none)
 };
 
+/* Policy when a reader is full (see above) */
+#define CANRXDROPOLD	0	// Reader loses its oldest msg
+#define CANRXDROPNEW	1	// Reader loses the new msgs
+
 /* Task pointers for taking CAN msgs from circular buffer. */
 struct CANTAKEPTR
 {
 	struct CANCIRBUFPTRS* pcir;
 	struct CANRCVBUFN* ptake;
+	struct CANTAKEPTR* pnext; // Next reader of this buffer (NULL = last)
+	struct CANRCVBUFN* pstop; // CANRXDROPNEW full: end of the msgs it holds (NULL = not full)
+	uint32_t overrun;  // Running ct: msgs lost when full (dropped, or held out)
+	uint16_t lagmax;   // High-water mark: msgs waiting for this reader
+	uint8_t  policy;   // CANRXDROPOLD, CANRXDROPNEW
 };
 
 
@@ -76,6 +112,8 @@ struct CANTAKEPTR
 	CAN2_TX_IRQHandler; CAN2_RX0_IRQHandler CAN1_RX2_IRQHandler
 */  
 
+#define CANTXMBX	3	// bxCAN TX mailboxes
+
 /* In the following RX uses 'xw' and TX uses 'xb[]' */
 union CAN_X
 {
@@ -94,7 +132,7 @@ union CAN_X
 
 struct CAN_POOLBLOCK	// Used for common CAN TX/RX linked lists
 {
-volatile struct CAN_POOLBLOCK* volatile plinknext;	// Linked list pointer (low value id -> high value)
+volatile struct CAN_POOLBLOCK* volatile plinknext;	// Free list pointer
 	 struct CANRCVBUF can;		// Msg queued
 	 union  CAN_X x;			// Extra goodies that are different for TX and RX
 
@@ -107,12 +145,12 @@ struct CAN_CTLBLOCK
 
 	struct CAN_POOLBLOCK  frii;	// Always present block, i.e. list pointer head
 
-	uint32_t mbx0;	// CAN id last loaded into Mailbox 0
+	struct CANTXQ txq;	// Pending msgs, highest priority first
+volatile struct CAN_POOLBLOCK* volatile ptx[CANTXMBX];	// Msg in each mailbox (not in 'txq').  NULL = empty.
 
-volatile struct CAN_POOLBLOCK  pend;		// Always present block, i.e. list pointer head
-volatile struct CAN_POOLBLOCK* volatile pxprv;	// pxprv->plinknext points to msg being sent.  pxprv is NULL if TX is idle.
-
-	uint32_t abortflag;	// 1 = ABRQ0 bit in TSR was set.
+	uint32_t txcplt[CANTXMBX];	// Running ct of msgs sent, per mailbox
+	uint32_t abortflag;	// Bit per mailbox: 1 = ABRQx bit in TSR was set.
+	uint8_t  ntxmbx;	// TX mailboxes used: 1 - CANTXMBX (can_iface_init sets CANTXMBX)
 
 	/* Circular buffer for incoming CAN msgs.  One per CAN module */
 	struct CANCIRBUFPTRS cirptrs; // struct with circular buffer "add" pointers
@@ -164,6 +202,11 @@ struct CANRCVBUFN* can_iface_get_CANmsg(struct CANTAKEPTR* p);
  * @brief	: p = pointer to struct with 'take' and 'add' pointers
  * @return	: pointer to CAN msg struct; NULL = no msgs available.
 *******************************************************************************/
+uint16_t can_iface_take_lag(struct CANTAKEPTR* p);
+/* @brief 	: Number of msgs waiting for this reader
+ * @param	: p = pointer to struct with 'take' and 'add' pointers
+ * @return	: msgs in the circular buffer not yet taken (0 - numrx-1)
+*******************************************************************************/
 
 #endif 
 
@@ -0,0 +1,184 @@
+/******************************************************************************
+* File Name          : can_txq.c
+* Date First Issued  : 10/17/2026
+* Board              : F103 or F4
+* Description        : CAN TX pending msgs: priority queue (FIFO per id + two level bitmap)
+*******************************************************************************/
+/*
+See can_txq.h.  Key 'k' is bit (31 - k % 32) of map2[k / 32], and map2
+word 'w' is bit (31 - w % 32) of map1[w / 32], so __builtin_clz finds the
+first word, then the first key in it.  A key's map2 bit is set while either
+of its FIFOs has a msg.
+*/
+
+#include <stdlib.h>
+#include "can_iface.h"
+#include "can_txq.h"
+
+/* Pool block index + 1 <-> pointer */
+#define TXQBLK(pq,i) ((pq)->pool + ((i) - 1))
+#define TXQIDX(pq,p) ((uint8_t)((p) - (pq)->pool + 1))
+
+/* FIFO tail for the msg's id; its key */
+static inline uint8_t* txqtail(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* p, uint32_t* pk)
+{
+	*pk = p->can.id >> CANTXQKEYSHIFT;
+	return ((p->can.id & CAN_ID_EXT) != 0) ? &pq->tailext[*pk] : &pq->tailstd[*pk];
+}
+static inline void keyset(struct CANTXQ* pq, uint32_t k)
+{
+	pq->map2[k >> 5]  |= (0x80000000U >> (k & 31));
+	pq->map1[k >> 10] |= (0x80000000U >> ((k >> 5) & 31));
+	return;
+}
+static inline void keyclr(struct CANTXQ* pq, uint32_t k)
+{
+	pq->map2[k >> 5] &= ~(0x80000000U >> (k & 31));
+	if (pq->map2[k >> 5] == 0)
+		pq->map1[k >> 10] &= ~(0x80000000U >> ((k >> 5) & 31));
+	return;
+}
+/* FIFO tail of the next msg to send (NULL = none); its key */
+static inline uint8_t* toptail(struct CANTXQ* pq, uint32_t* pk)
+{
+	uint32_t w;
+
+	if (pq->map1[0] != 0)
+		w = __builtin_clz(pq->map1[0]);
+	else if (pq->map1[1] != 0)
+		w = 32 + __builtin_clz(pq->map1[1]);
+	else
+		return NULL;
+	*pk = (w << 5) + __builtin_clz(pq->map2[w]);
+	return (pq->tailstd[*pk] != 0) ? &pq->tailstd[*pk] : &pq->tailext[*pk];
+}
+/* *************************************************************************
+ * int can_txq_init(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* pool, uint16_t size);
+ * @brief	: Set queue empty
+ * @param	: pq = pointer to queue
+ * @param	: pool = pointer to the pool blocks (array) every queued msg is in
+ * @param	: size = max number of msgs (number of pool blocks)
+ * @return	: 0 = OK; -1 = size over CANTXQMAXPOOL
+ * *************************************************************************/
+int can_txq_init(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* pool, uint16_t size)
+{
+	int i;
+
+	if (size > CANTXQMAXPOOL) return -1;
+	for (i = 0; i < CANTXQKEYS; i++)
+	{
+		pq->tailstd[i] = 0;
+		pq->tailext[i] = 0;
+	}
+	for (i = 0; i < CANTXQKEYS/32; i++)
+		pq->map2[i] = 0;
+	for (i = 0; i < CANTXQKEYS/1024; i++)
+		pq->map1[i] = 0;
+	pq->pool = pool;
+	pq->n    = 0;
+	pq->size = size;
+	return 0;
+}
+/* *************************************************************************
+ * int can_txq_put(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* p);
+ * @brief	: Add a new msg (after all pending msgs with the same id)
+ * @param	: pq = pointer to queue
+ * @param	: p = pointer to pool block with the msg
+ * @return	: 0 = OK; -1 = full
+ * *************************************************************************/
+int can_txq_put(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* p)
+{
+	volatile struct CAN_POOLBLOCK* ptail;
+	uint32_t k;
+	uint8_t* pt = txqtail(pq, p, &k);
+
+	if (pq->n >= pq->size) return -1;
+	pq->n += 1;
+
+	if (*pt == 0)
+	{ // FIFO was empty
+		p->plinknext = p;
+		keyset(pq, k);
+	}
+	else
+	{ // After the tail, which still points to the head
+		ptail = TXQBLK(pq, *pt);
+		p->plinknext = ptail->plinknext;
+		ptail->plinknext = p;
+	}
+	*pt = TXQIDX(pq, p); // New tail
+	return 0;
+}
+/* *************************************************************************
+ * int can_txq_requeue(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* p);
+ * @brief	: Put back a msg that was popped (ahead of all pending msgs with its id)
+ * @param	: pq = pointer to queue
+ * @param	: p = pointer to pool block from can_txq_pop
+ * @return	: 0 = OK; -1 = full
+ * *************************************************************************/
+int can_txq_requeue(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* p)
+{
+	volatile struct CAN_POOLBLOCK* ptail;
+	uint32_t k;
+	uint8_t* pt = txqtail(pq, p, &k);
+
+	if (pq->n >= pq->size) return -1;
+	pq->n += 1;
+
+	if (*pt == 0)
+	{ // FIFO was empty
+		p->plinknext = p;
+		*pt = TXQIDX(pq, p);
+		keyset(pq, k);
+	}
+	else
+	{ // New head: between the tail and the old head (tail unchanged)
+		ptail = TXQBLK(pq, *pt);
+		p->plinknext = ptail->plinknext;
+		ptail->plinknext = p;
+	}
+	return 0;
+}
+/* *************************************************************************
+ * volatile struct CAN_POOLBLOCK* can_txq_top(struct CANTXQ* pq);
+ * @brief	: Next msg to send, not removed
+ * @param	: pq = pointer to queue
+ * @return	: pointer to pool block; NULL = none pending
+ * *************************************************************************/
+volatile struct CAN_POOLBLOCK* can_txq_top(struct CANTXQ* pq)
+{
+	uint32_t k;
+	uint8_t* pt = toptail(pq, &k);
+
+	if (pt == NULL) return NULL;
+	return TXQBLK(pq, *pt)->plinknext;
+}
+/* *************************************************************************
+ * volatile struct CAN_POOLBLOCK* can_txq_pop(struct CANTXQ* pq);
+ * @brief	: Remove the next msg to send
+ * @param	: pq = pointer to queue
+ * @return	: pointer to pool block; NULL = none pending
+ * *************************************************************************/
+volatile struct CAN_POOLBLOCK* can_txq_pop(struct CANTXQ* pq)
+{
+	volatile struct CAN_POOLBLOCK* ptail;
+	volatile struct CAN_POOLBLOCK* ptop;
+	uint32_t k;
+	uint8_t* pt = toptail(pq, &k);
+
+	if (pt == NULL) return NULL;
+	ptail = TXQBLK(pq, *pt);
+	ptop  = ptail->plinknext;
+	if (ptop == ptail)
+	{ // Was the only one
+		*pt = 0;
+		if ((pq->tailstd[k] == 0) && (pq->tailext[k] == 0))
+			keyclr(pq, k);
+	}
+	else
+	{
+		ptail->plinknext = ptop->plinknext;
+	}
+	pq->n -= 1;
+	return ptop;
+}
@@ -0,0 +1,91 @@
+/******************************************************************************
+* File Name          : can_txq.h
+* Date First Issued  : 10/17/2026
+* Board              : F103 or F4
+* Description        : CAN TX pending msgs: priority queue (FIFO per id + two level bitmap)
+*******************************************************************************/
+/*
+Pending TX msgs for one CAN module, highest CAN priority (lowest 'can.id'
+value) first.  Msgs with the same id come out in the order they were put.
+
+Each 11 bit id (the top 11 bits of 'can.id') is a key with its own FIFO,
+and a bit in a two level bitmap over the 2048 keys: 64 words, one bit per
+key, and two words with a bit per word that is not zero.  Key order is id
+order, so the next to send is the head of the FIFO of the first key set
+(two count leading zeros).  put (at the tail of its FIFO), requeue (at the
+head), top, and pop are all O(1), whatever the depth and whatever the ids:
+no list is walked with the CAN TX interrupt held off.
+
+Extended ids are the second level of a key: the top 11 bits of a 29 bit id
+are its key, and a key has a FIFO for extended ids after the one for the
+standard id, as the bus arbitrates them.  Extended ids with the same top 11
+bits come out in the order they were put, not by their low 18 bits; nor do
+a data and a remote frame with the same standard id.
+
+A FIFO is a ring linked through 'plinknext', and the key holds only its
+tail (the head is tail->plinknext), as a pool block index + 1 (0 = empty)
+so the tables are a byte per key.  The pool is at most CANTXQMAXPOOL blocks.
+
+A msg taken back out of the mailbox (abort, arbitration lost, error retry)
+goes back in with 'can_txq_requeue', at the head of its FIFO: loadmbx2 only
+loads a msg when none with its id is in a mailbox, so it is ahead of every
+msg still pending with its id.
+
+No locking here: the caller runs these with the CAN TX interrupt held off
+(taskENTER_CRITICAL), or from the CAN interrupt.
+*/
+
+#ifndef __CAN_TXQ
+#define __CAN_TXQ
+
+#include <stdint.h>
+
+struct CAN_POOLBLOCK; // can_iface.h
+
+#define CANTXQKEYS     2048 // Keys: standard id, or the top 11 bits of an extended id
+#define CANTXQKEYSHIFT 21   // can.id -> key
+#define CANTXQMAXPOOL  254  // Max pool blocks (index + 1 in a byte)
+
+struct CANTXQ
+{
+	volatile struct CAN_POOLBLOCK* pool; // Pool blocks: FIFO tails are index + 1
+	uint8_t tailstd[CANTXQKEYS];  // Each key, standard id: last to send (0 = none)
+	uint8_t tailext[CANTXQKEYS];  // Each key, extended ids: last to send (0 = none)
+	uint32_t map2[CANTXQKEYS/32]; // Bit (31 - key % 32) of word key / 32 set = key pending
+	uint32_t map1[CANTXQKEYS/1024]; // Bit (31 - w % 32) of word w / 32 set = map2[w] not 0
+	uint16_t n;     // Number of msgs pending
+	uint16_t size;  // Max number of msgs pending
+};
+
+/* *************************************************************************/
+int can_txq_init(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* pool, uint16_t size);
+/* @brief	: Set queue empty
+ * @param	: pq = pointer to queue
+ * @param	: pool = pointer to the pool blocks (array) every queued msg is in
+ * @param	: size = max number of msgs (number of pool blocks)
+ * @return	: 0 = OK; -1 = size over CANTXQMAXPOOL
+ * *************************************************************************/
+int can_txq_put(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* p);
+/* @brief	: Add a new msg (after all pending msgs with the same id)
+ * @param	: pq = pointer to queue
+ * @param	: p = pointer to pool block with the msg
+ * @return	: 0 = OK; -1 = full
+ * *************************************************************************/
+int can_txq_requeue(struct CANTXQ* pq, volatile struct CAN_POOLBLOCK* p);
+/* @brief	: Put back a msg that was popped (ahead of all pending msgs with its id)
+ * @param	: pq = pointer to queue
+ * @param	: p = pointer to pool block from can_txq_pop
+ * @return	: 0 = OK; -1 = full
+ * *************************************************************************/
+volatile struct CAN_POOLBLOCK* can_txq_top(struct CANTXQ* pq);
+/* @brief	: Next msg to send, not removed
+ * @param	: pq = pointer to queue
+ * @return	: pointer to pool block; NULL = none pending
+ * *************************************************************************/
+volatile struct CAN_POOLBLOCK* can_txq_pop(struct CANTXQ* pq);
+/* @brief	: Remove the next msg to send
+ * @param	: pq = pointer to queue
+ * @return	: pointer to pool block; NULL = none pending
+ * *************************************************************************/
+
+#endif
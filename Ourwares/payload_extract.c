@@ -7,7 +7,11 @@
 #include "payload_extract.h"
 
 /* Definitions of payload type generated from database. */
-#include "../../../GliderWinchCommons/embed/svn_common/trunk/db/gen_db.h"
+#ifdef HOSTBUILD
+  #include "gen_db.h" // Host/Inc: the payload type codes only
+#else
+  #include "../../../GliderWinchCommons/embed/svn_common/trunk/db/gen_db.h"
+#endif
 
 /* NOTE:
 If the CAN msg does not have a DLC big enough to accommodate the payload
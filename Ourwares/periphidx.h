@@ -0,0 +1,43 @@
+/******************************************************************************
+* File Name          : periphidx.h
+* Date First Issued  : 10/17/2026
+* Board              : F4
+* Description        : Table index from a peripheral's register base address
+*******************************************************************************/
+/*
+The HAL callbacks pass only the 'MX handle, so the CAN and uart routines
+looked up their own control block for it by walking a list, in the ISR.
+
+The APB peripherals are on 1 KB boundaries, and address bits 14:10 differ
+for every CAN and uart/usart module--
+
+  CAN1 25, CAN2 26, CAN3 13
+  USART1 4, USART2 17, USART3 18, UART4 19, UART5 20, USART6 5,
+  UART7 30, UART8 31
+
+so a table of PERIPHIDXSIZE pointers indexed with 'PERIPHIDX(phandle->Instance)'
+is the lookup: one shift, one mask, one load.  The init routine for each
+module fills its table entry.
+
+Host build: 'hal_stubs.c' has RAM standing in for the registers, aligned so
+that HOSTPERIPH(CAN1_BASE) etc. have the same bits 14:10 as on the board.
+*/
+
+#ifndef __PERIPHIDX
+#define __PERIPHIDX
+
+#include <stdint.h>
+
+#define PERIPHIDXSIZE 32 // Table size: address bits 14:10
+
+/* Register base address (Instance) -> table index */
+#define PERIPHIDX(pinst) ((uint32_t)(((uintptr_t)(pinst) >> 10) & (PERIPHIDXSIZE - 1)))
+
+#ifdef HOSTBUILD
+  /* Host build: peripheral base address -> RAM standing in for the registers */
+  #define HOSTPERIPHSIZE (PERIPHIDXSIZE * 1024)
+  extern uint8_t halstub_periph[HOSTPERIPHSIZE];
+  #define HOSTPERIPH(base) ((void*)&halstub_periph[(base) & (HOSTPERIPHSIZE - 1)])
+#endif
+
+#endif
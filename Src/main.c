@@ -74,6 +74,11 @@
 #include "yscanf.h"
 #include "adctask.h"
 #include "ADCTask.h"
+#include "adccapture.h"
+#include "adcsnap.h"
+#include "adctiming.h"
+#include "adcfit.h"
+#include "adcflash.h"
 #include "adcparams.h"
 #include "adcparamsinit.h"
 #include "gateway_PCtoCAN.h"
@@ -81,6 +86,7 @@
 #include "MailboxTask.h"
 #include "GatewayTask.h"
 #include "iir_f2.h"
+#include "iir_coef.h"
 
 /* USER CODE END Includes */
 
@@ -345,14 +351,18 @@ DiscoveryF4 LEDs --
 	HAL_CAN_ActivateNotification(&hcan1, \
 		CAN_IT_TX_MAILBOX_EMPTY     |  \
 		CAN_IT_RX_FIFO0_MSG_PENDING |  \
-		CAN_IT_RX_FIFO1_MSG_PENDING    );
+		CAN_IT_RX_FIFO1_MSG_PENDING |  \
+		CAN_IT_RX_FIFO0_OVERRUN     |  \
+		CAN_IT_RX_FIFO1_OVERRUN        );
 
 	/* Select interrupts for CAN2 */
 #ifdef CONFIGCAN2
 	HAL_CAN_ActivateNotification(&hcan2, \
 		CAN_IT_TX_MAILBOX_EMPTY     |  \
 		CAN_IT_RX_FIFO0_MSG_PENDING |  \
-		CAN_IT_RX_FIFO1_MSG_PENDING    );
+		CAN_IT_RX_FIFO1_MSG_PENDING |  \
+		CAN_IT_RX_FIFO0_OVERRUN     |  \
+		CAN_IT_RX_FIFO1_OVERRUN        );
 #endif
 
 	/* Start CANs */
@@ -783,13 +793,14 @@ float b2 = -0.64130712;
 int ict = 0;
 
 struct FILTERIIRF2 iir2;
-iir_f2_coefficients(&iir2, 0.05, 0.707, 0);
+iir_f2_init(&iir2, &iirspec[IIRSPEC_F2TEST].u.f2, 0); // Fc 0.05, Q 0.707
 // ::::::::::::::::::::::::::
 
 	int i;
 
 	#define DEFAULTTSKBIT00	(1 << 0)  // Task notification bit for sw timer: stackusage
 	#define DEFAULTTSKBIT01	(1 << 1)  // Task notification bit for sw timer: something else
+	#define DEFAULTTSKBIT02	(1 << 2)  // Task notification bit for huart6 line received
 
 	/* A notification copies the internal notification word to this. */
 	uint32_t noteval = 0;    // Receives notification word upon an API notify
@@ -809,6 +820,15 @@ iir_f2_coefficients(&iir2, 0.05, 0.707, 0);
 	struct SERIALSENDTASKBCB* pbuf4 = getserialbuf(&huart6,96);
 	if (pbuf1 == NULL) morse_trap(12);
 
+	/* Calibration fit commands ("cal ...") typed on the huart6 terminal. */
+	struct SERIALRCVBCB* prbcb6 = xSerialTaskRxAdduart(&huart6,1,DEFAULTTSKBIT02,\
+		&noteval,4,48,64,0); // 4 lines of 48 chars, 64 dma, ascii
+	if (prbcb6 == NULL) morse_trap(14);
+	char* pline;
+	uint32_t fitseq = 0;
+	static struct ADCFLASHIMG flashimg; // "save": image of the live parameters
+	int ret;
+
 	int ctr = 0; // Running count
 	uint32_t heapsize;
 
@@ -824,7 +844,10 @@ iir_f2_coefficients(&iir2, 0.05, 0.707, 0);
 
 HAL_GPIO_TogglePin(GPIOD,GPIO_PIN_15); // BLUE LED
 
-	uint32_t dmact_prev = adcommon.dmact;
+	struct ADCSNAP adcsnap; // Consistent copy of ADC readings
+	struct ADCTIMING adct;  // ADC overruns, latency, processing time
+	adcsnap_read(&adcsnap);
+	uint32_t dmact_prev = adcsnap.dmact;
 
 extern volatile uint32_t adcdbg2;
 
@@ -861,20 +884,63 @@ extern volatile uint32_t adcdbg2;
 			/* Note: an odd makes the LED flash since it toggles on each msg. */
 			for (i = 0; i < 7; i++)
 				xQueueSendToBack(CanTxQHandle,&testtx,portMAX_DELAY);
+
+			/* ADCTask headroom: 1/2 buffer period vs latency + processing (usec). */
+			adctiming_get(&adct);
+			yprintf(&pbuf3,"\n\rADC 1/2 bufs: %u missed %u both %u  usec: period %u lat %u max %u proc %u max %u",
+				adct.processed, adct.missed, adct.bothpend, adct.period/(DTWTIMEHZ/1000000),
+				adct.lat/(DTWTIMEHZ/1000000), adct.latmax/(DTWTIMEHZ/1000000),
+				adct.proc/(DTWTIMEHZ/1000000), adct.procmax/(DTWTIMEHZ/1000000));
+			for (i = 0; i < ADCTIMINGNBKT; i++)
+			{ // Non-empty log2 buckets, DTW ticks
+				if ((adct.hlat[i] | adct.hproc[i]) == 0) continue;
+				yprintf(&pbuf3,"\n\r  2^%2i ticks: lat %8u proc %8u",i,adct.hlat[i],adct.hproc[i]);
+			}
+		}
+		if ((noteval & DEFAULTTSKBIT02) != 0)
+		{ // Lines from the huart6 terminal
+			noteused |= DEFAULTTSKBIT02;
+			while ((pline = xSerialTaskReceiveGetline(prbcb6)) != NULL)
+			{
+				if (strncmp(pline,"save",4) == 0)
+				{ // Live ADC parameters & calibrations to high flash
+					ret = adcflash_build(&flashimg);
+					if (ret == 0) ret = adcflash_write(&flashimg);
+					yprintf(&pbuf1,"\n\rsave: %i seq %u slot %u next %u erased %u",
+						ret, adcflash.seq, adcflash.slot, adcflash.next, adcflash.erasect);
+				}
+				else if (adcfit_line(pline) == -1)
+					yprintf(&pbuf1,"\n\rcal: busy");
+			}
 		}
 		if ((noteval & DEFAULTTSKBIT01) != 0)
 		{
 			noteused |= DEFAULTTSKBIT01;
 		HAL_GPIO_TogglePin(GPIOD,GPIO_PIN_15); // BLUE LED
-			yprintf(&pbuf2,"\n\rADC: Vdd: %7.4f %8.4f   Temp: %6.1f %6.1f %i",adcommon.fvdd,adcommon.fvddfilt,adcommon.degC,adcommon.degCfilt,(adcommon.dmact-dmact_prev));
-			dmact_prev = adcommon.dmact;
+			adcsnap_read(&adcsnap);
+			yprintf(&pbuf2,"\n\rADC: Vdd: %7.4f %8.4f   Temp: %6.1f %6.1f %i",adcsnap.fvdd,adcsnap.fvddfilt,adcsnap.degC,adcsnap.degCfilt,(adcsnap.dmact-dmact_prev));
+			dmact_prev = adcsnap.dmact;
+
+			/* Result of the last calibration point/fit command. */
+			if (adcfit.done.seq != fitseq)
+			{
+				fitseq = adcfit.done.seq;
+				yprintf(&pbuf3,"\n\rcal %u: cmd %u ret %i x %10.5f c %g %g %g %g rms %g",
+					adcfit.done.req.chan, adcfit.done.req.cmd, adcfit.done.ret, adcfit.done.x,
+					adcfit.ch[adcfit.done.req.chan].c[0], adcfit.ch[adcfit.done.req.chan].c[1],
+					adcfit.ch[adcfit.done.req.chan].c[2], adcfit.ch[adcfit.done.req.chan].c[3],
+					adcfit.ch[adcfit.done.req.chan].rms);
+			}
+
+			/* Completed raw ADC capture goes out the USB (CDC) as binary. */
+			if (adccapture_ready()) adccapture_send(NULL);
 
 			yprintf(&pbuf4,"\n\r 3:   %d %d %d\n\r 5:   %d %7.4f %7.4f %7.1f",\
-                 adc1data.adcs1sum[ADC1IDX_INTERNALVREF]/ADC1DMANUMSEQ, adcommon.ivdd, adcdbg2,\
-                 adc1data.adcs1sum[ADC1IDX_5VOLTSUPPLY ]/ADC1DMANUMSEQ, adcommon.f5_Vddratio, adcommon.f5vsupply,adcommon.f5vsupplyfilt);
+                 adcsnap.sum[ADC1IDX_INTERNALVREF]/ADC1DMANUMSEQ, adcsnap.ivdd, adcdbg2,\
+                 adcsnap.sum[ADC1IDX_5VOLTSUPPLY ]/ADC1DMANUMSEQ, adcsnap.f5_Vddratio, adcsnap.f5vsupply,adcsnap.f5vsupplyfilt);
 
-			yprintf(&pbuf3,"\n\rR4: %d %7.2f %7.2f",	adc1data.adcs1sum[ADC1IDX_RESISRPOT]/ADC1DMANUMSEQ, adc1data.adc1calreading[ADC1IDX_RESISRPOT].f,\
-                 adc1data.adc1calreadingfilt[ADC1IDX_RESISRPOT].f);
+			yprintf(&pbuf3,"\n\rR4: %d %7.2f %7.2f",	adcsnap.sum[ADC1IDX_RESISRPOT]/ADC1DMANUMSEQ, adcsnap.cal[ADC1IDX_RESISRPOT].f,\
+                 adcsnap.calfilt[ADC1IDX_RESISRPOT].f);
 
 // ::::::::::::::::::::::::::::::::::::::::::
 		 out = in + z1;